@@ -25,28 +25,70 @@
  * Date         : 10/28/2012
  * Description  : "Fake" virtual to physical address translation. Uses a hash
  *function, and does not maintain page tables. Used to randomize DRAM bank
- *mappings.
+ *mappings. The FIRST_TOUCH mode instead keeps per-process page tables backed
+ *by a deterministic physical frame allocator.
  ***************************************************************************************/
 
 #include "addr_trans.h"
+#include "core.param.h"
 #include "debug/debug_macros.h"
 #include "globals/assert.h"
 #include "globals/utils.h"
+#include "libs/hash_lib.h"
 #include "memory/memory.param.h"
 #include "ramulator.param.h"
+#include "statistics.h"
 
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_ADDR_TRANS, ##args)
 
+#define HUGE_PAGE_SIZE_BYTES (2 * 1024 * 1024)
+#define NO_FRAME ((Addr)-1)
+
 DEFINE_ENUM(Addr_Translation, ADDR_TRANSLATION_LIST);
+DEFINE_ENUM(Frame_Alloc_Policy, FRAME_ALLOC_POLICY_LIST);
+
+/**************************************************************************************/
+/* Types */
+
+/* State of one 2MB-aligned virtual region of a process */
+typedef struct Huge_Region_struct {
+  Addr frame;        // 2MB physical region backing it, NO_FRAME if small pages
+  uns  small_pages;  // pages of the region mapped to small frames
+} Huge_Region;
+
+/* Physical memory and per-process page tables of the FIRST_TOUCH mode */
+typedef struct Frame_Alloc_struct {
+  Hash_Table* page_tables;    // per proc: virtual page -> small frame
+  Hash_Table* region_tables;  // per proc: virtual 2MB region -> Huge_Region
+  uns*        frame_refs;     // pages mapped to each small frame
+  uns*        region_used;    // used small frames per 2MB physical region
+  Addr        num_frames;
+  Addr        num_regions;
+  uns         frames_per_region;
+  Addr        next_frame;   // sequential cursors
+  Addr        next_region;
+  uns64       rand_state;
+} Frame_Alloc;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Frame_Alloc* frame_alloc = NULL;
+
+/**************************************************************************************/
+/* Static Prototypes */
 
 static uns32 hsieh_hash(const char* data, int len);
+static Addr  first_touch_translate(Addr virt_addr, Flag off_path);
 
 /**************************************************************************************/
 /* addr_translate: translate virtual address to physical address */
 
-Addr addr_translate(Addr virt_addr) {
+Addr addr_translate(Addr virt_addr, Flag off_path) {
   if(ADDR_TRANSLATION == ADDR_TRANS_NONE)
     return virt_addr;
+  if(ADDR_TRANSLATION == ADDR_TRANS_FIRST_TOUCH)
+    return first_touch_translate(virt_addr, off_path);
 
   /* We fake the virtual->physical address translation by scrambling the addr
    * bits just above the page offset. However, aliasing during the scrambling
@@ -119,6 +161,223 @@ Addr addr_translate(Addr virt_addr) {
   return cmp_addr;
 }
 
+/**************************************************************************************/
+/* frame_rand: xorshift64* so the allocator is deterministic under
+   ADDR_TRANS_SEED and independent of other users of rand() */
+
+static inline uns64 frame_rand(void) {
+  uns64 x = frame_alloc->rand_state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  frame_alloc->rand_state = x;
+  return x * 0x2545F4914F6CDD1DULL;
+}
+
+static inline void mark_frame(Addr frame, Flag used) {
+  Addr region = frame / frame_alloc->frames_per_region;
+  if(used) {
+    if(frame_alloc->frame_refs[frame]++ == 0)
+      frame_alloc->region_used[region]++;
+  } else {
+    ASSERT(0, frame_alloc->frame_refs[frame] > 0);
+    if(--frame_alloc->frame_refs[frame] == 0)
+      frame_alloc->region_used[region]--;
+  }
+}
+
+/**************************************************************************************/
+/* init_frame_alloc: size physical memory and, for the FRAGMENTED policy, take
+   about half of the small frames of ADDR_TRANS_FRAG_PERCENT of the 2MB
+   regions so that they can not back huge pages */
+
+static void init_frame_alloc(void) {
+  ASSERTM(0, HUGE_PAGE_SIZE_BYTES % VA_PAGE_SIZE_BYTES == 0,
+          "VA_PAGE_SIZE_BYTES must divide the 2MB huge page size\n");
+  frame_alloc = (Frame_Alloc*)calloc(1, sizeof(Frame_Alloc));
+  frame_alloc->frames_per_region = HUGE_PAGE_SIZE_BYTES / VA_PAGE_SIZE_BYTES;
+  frame_alloc->num_regions = (Addr)ADDR_TRANS_PHYS_MEM_MB * 1024 * 1024 /
+                             HUGE_PAGE_SIZE_BYTES;
+  frame_alloc->num_frames = frame_alloc->num_regions *
+                            frame_alloc->frames_per_region;
+  ASSERTM(0, frame_alloc->num_regions > 0,
+          "ADDR_TRANS_PHYS_MEM_MB must be at least 2\n");
+  frame_alloc->frame_refs  = (uns*)calloc(frame_alloc->num_frames,
+                                          sizeof(uns));
+  frame_alloc->region_used = (uns*)calloc(frame_alloc->num_regions,
+                                          sizeof(uns));
+  frame_alloc->rand_state  = ADDR_TRANS_SEED * 0x9E3779B97F4A7C15ULL + 1;
+
+  frame_alloc->page_tables   = (Hash_Table*)calloc(NUM_CORES,
+                                                   sizeof(Hash_Table));
+  frame_alloc->region_tables = (Hash_Table*)calloc(NUM_CORES,
+                                                   sizeof(Hash_Table));
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    init_hash_table(&frame_alloc->page_tables[proc_id], "page table",
+                    1 << 16, sizeof(Addr));
+    init_hash_table(&frame_alloc->region_tables[proc_id], "region table",
+                    1 << 12, sizeof(Huge_Region));
+  }
+
+  if(ADDR_TRANS_FRAME_POLICY == FRAME_ALLOC_FRAGMENTED) {
+    for(Addr region = 0; region < frame_alloc->num_regions; region++) {
+      if(frame_rand() % 100 >= ADDR_TRANS_FRAG_PERCENT)
+        continue;
+      Addr first = region * frame_alloc->frames_per_region;
+      for(uns ii = 0; ii < frame_alloc->frames_per_region; ii++)
+        if(frame_rand() & 1)
+          mark_frame(first + ii, TRUE);
+    }
+  }
+}
+
+/**************************************************************************************/
+/* alloc_small_frame: next free frame after the cursor (SEQUENTIAL,
+   FRAGMENTED) or after a random frame (RANDOM). Once physical memory is full,
+   frames are handed out again round-robin and shared by several pages, which
+   keeps the run going at the cost of some aliasing in the caches and DRAM. */
+
+static Addr alloc_small_frame(uns proc_id) {
+  Addr start = ADDR_TRANS_FRAME_POLICY == FRAME_ALLOC_RANDOM ?
+                 frame_rand() % frame_alloc->num_frames :
+                 frame_alloc->next_frame;
+  for(Addr ii = 0; ii < frame_alloc->num_frames; ii++) {
+    Addr frame = (start + ii) % frame_alloc->num_frames;
+    if(!frame_alloc->frame_refs[frame]) {
+      mark_frame(frame, TRUE);
+      frame_alloc->next_frame = (frame + 1) % frame_alloc->num_frames;
+      return frame;
+    }
+  }
+
+  WARNINGU_ONCE(proc_id,
+                "Out of physical memory (ADDR_TRANS_PHYS_MEM_MB=%u), sharing "
+                "frames between pages\n",
+                ADDR_TRANS_PHYS_MEM_MB);
+  Addr frame = frame_alloc->next_frame;
+  mark_frame(frame, TRUE);
+  frame_alloc->next_frame = (frame + 1) % frame_alloc->num_frames;
+  STAT_EVENT(proc_id, ADDR_TRANS_SHARED_FRAMES);
+  return frame;
+}
+
+/**************************************************************************************/
+/* alloc_huge_region: a completely free 2MB physical region, or NO_FRAME */
+
+static Addr alloc_huge_region(void) {
+  Addr start = ADDR_TRANS_FRAME_POLICY == FRAME_ALLOC_RANDOM ?
+                 frame_rand() % frame_alloc->num_regions :
+                 frame_alloc->next_region;
+  for(Addr ii = 0; ii < frame_alloc->num_regions; ii++) {
+    Addr region = (start + ii) % frame_alloc->num_regions;
+    if(frame_alloc->region_used[region] == 0) {
+      Addr first = region * frame_alloc->frames_per_region;
+      for(uns jj = 0; jj < frame_alloc->frames_per_region; jj++)
+        mark_frame(first + jj, TRUE);
+      frame_alloc->next_region = (region + 1) % frame_alloc->num_regions;
+      return region;
+    }
+  }
+  return NO_FRAME;
+}
+
+/**************************************************************************************/
+/* promote_region: collapse a virtual region whose pages are all mapped to
+   small frames into a free 2MB frame (like khugepaged), returning the small
+   frames to the free pool */
+
+static void promote_region(uns proc_id, Addr vregion, Huge_Region* region) {
+  Addr frame = alloc_huge_region();
+  if(frame == NO_FRAME)
+    return;
+  Hash_Table* page_table = &frame_alloc->page_tables[proc_id];
+  Addr        first_page = vregion * frame_alloc->frames_per_region;
+  for(uns ii = 0; ii < frame_alloc->frames_per_region; ii++) {
+    Addr* small_frame = (Addr*)hash_table_access(page_table, first_page + ii);
+    ASSERT(proc_id, small_frame);
+    mark_frame(*small_frame, FALSE);
+    hash_table_access_delete(page_table, first_page + ii);
+  }
+  region->frame       = frame;
+  region->small_pages = 0;
+  STAT_EVENT(proc_id, ADDR_TRANS_THP_PROMOTIONS);
+}
+
+/**************************************************************************************/
+/* unmapped_translate: an off-path access to a page that was never touched
+   does not map it; it reads the frame the va falls on, modulo physical
+   memory */
+
+static inline Addr unmapped_translate(uns proc_id, Addr vaddr) {
+  STAT_EVENT(proc_id, ADDR_TRANS_OFFPATH_UNMAPPED);
+  return convert_to_cmp_addr(
+    proc_id, vaddr % (frame_alloc->num_frames * VA_PAGE_SIZE_BYTES));
+}
+
+/**************************************************************************************/
+/* first_touch_translate: map a page to a physical frame the first time it is
+   touched on the correct path and keep the mapping. With ADDR_TRANS_THP, a
+   region is backed by a 2MB frame when one is free at the first touch, or
+   promoted once all of its pages have been touched. */
+
+static Addr first_touch_translate(Addr virt_addr, Flag off_path) {
+  if(!frame_alloc)
+    init_frame_alloc();
+
+  uns proc_id = get_proc_id_from_cmp_addr(virt_addr);
+  // drop the sign extension and the proc_id bits, as the hash modes do
+  Addr vaddr = convert_to_cmp_addr(
+    0, check_and_remove_addr_sign_extended_bits(
+         virt_addr, NUM_ADDR_NON_SIGN_EXTEND_BITS, FALSE));
+  Addr vpage   = vaddr / VA_PAGE_SIZE_BYTES;
+  Addr vregion = vaddr / HUGE_PAGE_SIZE_BYTES;
+  Flag new_entry;
+
+  Huge_Region* region = (Huge_Region*)hash_table_access(
+    &frame_alloc->region_tables[proc_id], vregion);
+  if(!region) {
+    if(off_path)
+      return unmapped_translate(proc_id, vaddr);
+    region = (Huge_Region*)hash_table_access_create(
+      &frame_alloc->region_tables[proc_id], vregion, &new_entry);
+    region->frame       = NO_FRAME;
+    region->small_pages = 0;
+    if(ADDR_TRANS_THP) {
+      region->frame = alloc_huge_region();
+      STAT_EVENT(proc_id, region->frame == NO_FRAME ? ADDR_TRANS_THP_FALLBACKS :
+                                                      ADDR_TRANS_HUGE_FAULTS);
+    }
+  }
+
+  if(region->frame == NO_FRAME) {
+    Addr* frame = (Addr*)hash_table_access(&frame_alloc->page_tables[proc_id],
+                                           vpage);
+    if(!frame) {
+      if(off_path)
+        return unmapped_translate(proc_id, vaddr);
+      frame = (Addr*)hash_table_access_create(
+        &frame_alloc->page_tables[proc_id], vpage, &new_entry);
+      *frame = alloc_small_frame(proc_id);
+      region->small_pages++;
+      STAT_EVENT(proc_id, ADDR_TRANS_SMALL_FAULTS);
+      if(ADDR_TRANS_THP &&
+         region->small_pages == frame_alloc->frames_per_region)
+        promote_region(proc_id, vregion, region);
+    }
+    if(region->frame == NO_FRAME) {
+      Addr phys_addr = *frame * VA_PAGE_SIZE_BYTES +
+                       vaddr % VA_PAGE_SIZE_BYTES;
+      DEBUG(proc_id, "%llx => %llx (small)\n", virt_addr, phys_addr);
+      return convert_to_cmp_addr(proc_id, phys_addr);
+    }
+  }
+
+  Addr phys_addr = region->frame * HUGE_PAGE_SIZE_BYTES +
+                   vaddr % HUGE_PAGE_SIZE_BYTES;
+  DEBUG(proc_id, "%llx => %llx (huge)\n", virt_addr, phys_addr);
+  return convert_to_cmp_addr(proc_id, phys_addr);
+}
+
   /**************************************************************************************
    * The code below was adapted from
    *http://www.azillionmonkeys.com/qed/hash.html
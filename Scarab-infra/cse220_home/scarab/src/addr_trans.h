@@ -25,7 +25,8 @@
  * Date         : 10/28/2012
  * Description  : "Fake" virtual to physical address translation. Uses a hash
  *function, and does not maintain page tables. Used to randomize DRAM bank
- *mappings.
+ *mappings. The FIRST_TOUCH mode instead keeps per-process page tables backed
+ *by a deterministic physical frame allocator.
  ***************************************************************************************/
 
 #ifndef __ADDR_TRANS_H__
@@ -37,14 +38,22 @@
 /**************************************************************************************/
 /* Types */
 
-#define ADDR_TRANSLATION_LIST(elem) \
-  elem(NONE) elem(FLIP) elem(RANDOM) elem(PRESERVE_BLP) elem(PRESERVE_STREAM)
+#define ADDR_TRANSLATION_LIST(elem)                                       \
+  elem(NONE) elem(FLIP) elem(RANDOM) elem(PRESERVE_BLP) elem(PRESERVE_STREAM) \
+    elem(FIRST_TOUCH)
 
 DECLARE_ENUM(Addr_Translation, ADDR_TRANSLATION_LIST, ADDR_TRANS_);
 
+/* free frame policy of the FIRST_TOUCH translation */
+#define FRAME_ALLOC_POLICY_LIST(elem) \
+  elem(SEQUENTIAL) elem(RANDOM) elem(FRAGMENTED)
+
+DECLARE_ENUM(Frame_Alloc_Policy, FRAME_ALLOC_POLICY_LIST, FRAME_ALLOC_);
+
 /**************************************************************************************/
 /* Prototypes */
 
-Addr addr_translate(Addr virt_addr);
+/* Off-path accesses never map new pages in the FIRST_TOUCH mode */
+Addr addr_translate(Addr virt_addr, Flag off_path);
 
 #endif  // __ADDR_TRANS_H__
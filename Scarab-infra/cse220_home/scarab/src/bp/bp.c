@@ -188,6 +188,7 @@ void bp_sched_recovery(Bp_Recovery_Info* bp_recovery_info, Op* op,
     bp_recovery_info->recovery_inst_uid      = op->inst_uid;
     bp_recovery_info->wpe_flag               = FALSE;
     bp_recovery_info->late_bp_recovery       = late_bp_recovery;
+    bp_recovery_info->load_recovery          = FALSE;
 
     if(force_offpath) {
       ASSERT(op->proc_id, late_bp_recovery);
@@ -201,6 +202,48 @@ void bp_sched_recovery(Bp_Recovery_Info* bp_recovery_info, Op* op,
   }
 }
 
+/******************************************************************************/
+/* bp_sched_load_recovery: called on a load that read memory before an older
+   store wrote it. Fetch restarts at the load's instruction, keeping keep_op,
+   the last op of the instruction before it. The predictor only checkpoints
+   its state at branches, so it is restored from cf_op, the youngest branch
+   older than the load's instruction. No branch lies between the two, so the
+   state after cf_op is the state the load's instruction was fetched with. */
+
+void bp_sched_load_recovery(Bp_Recovery_Info* bp_recovery_info, Op* load,
+                            Op* keep_op, Op* cf_op, Counter cycle) {
+  ASSERT(load->proc_id, bp_recovery_info->proc_id == load->proc_id);
+  ASSERT(load->proc_id, !load->off_path && !keep_op->off_path);
+  ASSERT(load->proc_id, cf_op->table_info->cf_type);
+  ASSERT(load->proc_id, cf_op->op_num <= keep_op->op_num &&
+                          keep_op->op_num < load->op_num);
+
+  if(bp_recovery_info->recovery_cycle == MAX_CTR ||
+     keep_op->op_num <= bp_recovery_info->recovery_op_num) {
+    DEBUG(bp_recovery_info->proc_id,
+          "Load recovery signaled for op_num:%s @ 0x%s  keep op_num:%s  "
+          "bp state from op_num:%s\n",
+          unsstr64(load->op_num), hexstr64s(load->inst_info->addr),
+          unsstr64(keep_op->op_num), unsstr64(cf_op->op_num));
+    bp_recovery_info->recovery_cycle         = cycle + 1;
+    bp_recovery_info->recovery_fetch_addr    = load->inst_info->addr;
+    bp_recovery_info->recovery_op_num        = keep_op->op_num;
+    bp_recovery_info->recovery_cf_type       = cf_op->table_info->cf_type;
+    bp_recovery_info->recovery_info          = cf_op->recovery_info;
+    bp_recovery_info->recovery_info.op_num   = cf_op->op_num;
+    bp_recovery_info->recovery_inst_info     = load->inst_info;
+    bp_recovery_info->recovery_force_offpath = FALSE;
+    bp_recovery_info->recovery_op            = keep_op;
+    bp_recovery_info->oracle_cp_num          = keep_op->oracle_cp_num;
+    bp_recovery_info->recovery_unique_num    = keep_op->unique_num;
+    bp_recovery_info->recovery_inst_uid      = keep_op->inst_uid;
+    bp_recovery_info->wpe_flag               = FALSE;
+    bp_recovery_info->late_bp_recovery       = FALSE;
+    bp_recovery_info->late_bp_recovery_wrong = FALSE;
+    bp_recovery_info->load_recovery          = TRUE;
+  }
+}
+
 void inc_bstat_fetched(Op* op) {
   Flag new_entry;
   int64 key = convert_to_cmp_addr(op->table_info->cf_type, op->inst_info->addr);
@@ -65,6 +65,8 @@ typedef struct Bp_Recovery_Info_struct {
                                 // prediction.
   Flag late_bp_recovery_wrong;  // TRUE if recovery is due to a late branch
                                 // prediction that is wrong.
+  Flag load_recovery;  // TRUE if recovery is due to a memory ordering
+                       // violation, on-path ops are flushed too
 
 } Bp_Recovery_Info;
 
@@ -277,6 +279,8 @@ void init_bp_recovery_info(uns8, Bp_Recovery_Info*);
 void bp_sched_recovery(Bp_Recovery_Info* bp_recovery_info, Op* op,
                        Counter cycle, Flag late_bp_recovery,
                        Flag force_offpath);
+void bp_sched_load_recovery(Bp_Recovery_Info* bp_recovery_info, Op* load,
+                            Op* keep_op, Op* cf_op, Counter cycle);
 void bp_sched_redirect(Bp_Recovery_Info*, Op*, Counter);
 
 void init_bp_data(uns8, Bp_Data*);
@@ -39,8 +39,12 @@
 #include "dvfs/perf_pred.h"
 #include "general.param.h"
 #include "globals/assert.h"
+#include "lsq.h"
 #include "memory/cache_part.h"
+#include "memory/coherence.h"
+#include "memory/compress.h"
 #include "memory/memory.param.h"
+#include "memory/tlb.h"
 #include "op_pool.h"
 #include "prefetcher/pref.param.h"
 #include "prefetcher/pref_common.h"
@@ -70,7 +74,8 @@ static void cmp_redirect(void);
 static void cmp_measure_chip_util(void);
 static void cmp_istreams(void);
 static void cmp_cores(void);
-static void warmup_uncore(uns proc_id, Addr addr, Flag write);
+static void warmup_uncore(uns proc_id, Addr addr, Flag write, Op* op,
+                          Flag ifetch);
 
 /**************************************************************************************/
 /* cmp_init */
@@ -115,6 +120,8 @@ void cmp_init(uns mode) {
 
     init_node_stage(proc_id, "NODE");
 
+    init_lsq(proc_id);
+
     init_exec_stage(proc_id, "EXEC");
 
     init_exec_ports(proc_id, "EXEC_PORTS");
@@ -145,6 +152,8 @@ void cmp_init(uns mode) {
     dvfs_init();
 
   cache_part_init();
+  init_tlb();
+  init_coherence();
 
   ASSERTM(0, !USE_LATE_BP || LATE_BP_LATENCY < (DECODE_CYCLES + MAP_CYCLES),
           "Late branch prediction latency should be less than the total "
@@ -225,6 +234,7 @@ void cmp_cores(void) {
       set_bp_recovery_info(&cmp_model.bp_recovery_info[proc_id]);
       cmp_set_all_stages(proc_id);
 
+      update_tlb(proc_id);
       update_dcache_stage(&exec->sd);
       update_exec_stage(&node->sd);
       update_node_stage(map->last_sd);
@@ -326,12 +336,10 @@ void cmp_wake(Op* src_op, Op* dep_op, uns8 rdy_bit) {
   simple_wake(src_op, dep_op, rdy_bit);
 
   if(dep_op->srcs_not_rdy_vector == 0x0 && cycle_count >= dep_op->issue_cycle &&
-     !dep_op->in_rdy_list) {
+     !dep_op->in_rdy_list && dep_op->fused != MACRO_FUSED) {
     _DEBUG(dep_op->proc_id, DEBUG_NODE_STAGE,
            "Adding to ready list  op_num:%s\n", unsstr64(dep_op->op_num));
-    dep_op->next_rdy    = node->rdy_head;
-    node->rdy_head      = dep_op;
-    dep_op->in_rdy_list = TRUE;
+    node_rdy_insert(dep_op);
   }
 }
 
@@ -407,36 +415,178 @@ void cmp_retire_hook(Op* op) {
   free_op(op);
 }
 
-void warmup_uncore(uns proc_id, Addr addr, Flag write) {
-  Addr dummy_line_addr;
-  ASSERTM(0, !MLC_PRESENT, "Warmup for MLC not implemented\n");
+/**************************************************************************************/
+/* warmup_pref_train: TRUE if the warmup access on behalf of op trains the data
+   prefetchers, mirroring the request types that train them in simulation
+   mode. Writebacks (op == NULL) never train. */
+
+static inline Flag warmup_pref_train(Op* op, Flag ifetch) {
+  return WARMUP_PREF_TRAIN && op && (!ifetch || PREF_I_TOGETHER);
+}
+
+/**************************************************************************************/
+/* warmup_l1_insert: functionally install a line into the L1. Dirty victims
+   would go to memory and are dropped. */
+
+static L1_Data* warmup_l1_insert(uns proc_id, Addr addr) {
+  Cache*   l1_cache = &(cmp_model.memory.uncores[proc_id].l1->cache);
+  Addr     dummy_line_addr;
+  Addr     repl_line_addr;
+  Flag     repl_line_valid;
+  L1_Data* repl_data;
+
+  if(L1_COMPRESS)
+    l1_compress_make_room(proc_id, addr, TRUE);
+  repl_data = get_next_repl_line(l1_cache, proc_id, addr, &repl_line_addr,
+                                 &repl_line_valid);
+  if(repl_line_valid) {
+    uns repl_proc_id = get_proc_id_from_cmp_addr(repl_line_addr);
+    STAT_EVENT(repl_proc_id, NORESET_L1_EVICT);
+    if(repl_data->prefetch)
+      STAT_EVENT(repl_proc_id, NORESET_L1_EVICT_PREF_UNUSED);
+    else
+      STAT_EVENT(repl_proc_id, NORESET_L1_EVICT_NONPREF);
+  }
+  L1_Data* l1_data = (L1_Data*)cache_insert(l1_cache, proc_id, addr,
+                                            &dummy_line_addr, &repl_line_addr);
+  if(L1_COMPRESS)
+    compress_fill(proc_id, addr);
+  l1_data->proc_id  = proc_id;
+  l1_data->prefetch = FALSE;
+  return l1_data;
+}
 
+/**************************************************************************************/
+/* warmup_l1: functional L1 access for a demand (op != NULL) or a writeback
+   (write == TRUE). */
+
+static void warmup_l1(uns proc_id, Addr addr, Flag write, Op* op,
+                      Flag ifetch) {
+  Addr     dummy_line_addr;
   Cache*   l1_cache = &(cmp_model.memory.uncores[proc_id].l1->cache);
   L1_Data* l1_data  = cache_access(l1_cache, addr, &dummy_line_addr, TRUE);
+  Flag     train    = warmup_pref_train(op, ifetch);
+  Addr     load_pc  = op ? op->inst_info->addr : 0;
+  uns32    hist     = op ? op->oracle_info.pred_global_hist : 0;
+
   if(l1_data) {  // hit
     if(write)
       l1_data->dirty = TRUE;
+    if(train && l1_data->prefetch && !l1_data->seen_prefetch) {
+      l1_data->seen_prefetch = TRUE;
+      pref_ul1_pref_hit(proc_id, addr, l1_data->pref_loadPC,
+                        l1_data->global_hist, -1, l1_data->prefetcher_id);
+    }
+    if(train)
+      pref_ul1_hit(proc_id, addr, load_pc, hist);
   } else {  // miss
-    Addr repl_line_addr;
-    Flag repl_line_valid;
-    get_next_repl_line(l1_cache, proc_id, addr, &repl_line_addr,
-                       &repl_line_valid);
     STAT_EVENT(proc_id, NORESET_L1_FILL);
     STAT_EVENT(proc_id, NORESET_L1_FILL_NONPREF);
-    if(repl_line_valid) {
-      uns repl_proc_id = get_proc_id_from_cmp_addr(repl_line_addr);
-      STAT_EVENT(repl_proc_id, NORESET_L1_EVICT);
-      STAT_EVENT(repl_proc_id, NORESET_L1_EVICT_NONPREF);
-    }
-    l1_data = (L1_Data*)cache_insert(l1_cache, proc_id, addr, &dummy_line_addr,
-                                     &repl_line_addr);
-    l1_data->proc_id = proc_id;
-    l1_data->dirty   = write;
+    l1_data        = warmup_l1_insert(proc_id, addr);
+    l1_data->dirty = write;
+    if(train)
+      pref_ul1_miss(proc_id, addr, load_pc, hist);
   }
   if(L1_PART_SHADOW_WARMUP)
     cache_part_l1_warmup(proc_id, addr);
 }
 
+/**************************************************************************************/
+/* warmup_mlc_insert: functionally install a line into the MLC, writing a
+   dirty victim back to the L1 unless the MLC is write-through. */
+
+static MLC_Data* warmup_mlc_insert(uns proc_id, Addr addr) {
+  Cache*    mlc_cache = &(cmp_model.memory.uncores[proc_id].mlc->cache);
+  Addr      dummy_line_addr;
+  Addr      repl_line_addr;
+  MLC_Data* mlc_data = (MLC_Data*)cache_insert(mlc_cache, proc_id, addr,
+                                               &dummy_line_addr,
+                                               &repl_line_addr);
+  if(repl_line_addr && mlc_data->dirty && !MLC_WRITE_THROUGH)
+    warmup_l1(get_proc_id_from_cmp_addr(repl_line_addr), repl_line_addr, TRUE,
+              NULL, FALSE);
+  mlc_data->proc_id  = proc_id;
+  mlc_data->dirty    = FALSE;
+  mlc_data->prefetch = FALSE;
+  return mlc_data;
+}
+
+/**************************************************************************************/
+/* warmup_uncore: functional MLC + L1 access. The hierarchy is
+   non-inclusive like the simulation mode: demand misses fill both levels,
+   writebacks allocate in the MLC (or pass through to the L1 when
+   MLC_WRITE_THROUGH is set). */
+
+static void warmup_uncore(uns proc_id, Addr addr, Flag write, Op* op,
+                          Flag ifetch) {
+  if(!MLC_PRESENT) {
+    warmup_l1(proc_id, addr, write, op, ifetch);
+    return;
+  }
+
+  Addr      dummy_line_addr;
+  Cache*    mlc_cache = &(cmp_model.memory.uncores[proc_id].mlc->cache);
+  MLC_Data* mlc_data  = cache_access(mlc_cache, addr, &dummy_line_addr, TRUE);
+  Flag      train     = warmup_pref_train(op, ifetch);
+  Addr      load_pc   = op ? op->inst_info->addr : 0;
+  uns32     hist      = op ? op->oracle_info.pred_global_hist : 0;
+
+  if(mlc_data) {  // hit
+    if(write && !MLC_WRITE_THROUGH)
+      mlc_data->dirty = TRUE;
+    if(train && mlc_data->prefetch && !mlc_data->seen_prefetch) {
+      mlc_data->seen_prefetch = TRUE;
+      pref_umlc_pref_hit(proc_id, addr, mlc_data->pref_loadPC,
+                         mlc_data->global_hist, -1, mlc_data->prefetcher_id);
+    }
+    if(train)
+      pref_umlc_hit(proc_id, addr, load_pc, hist);
+    if(write && MLC_WRITE_THROUGH)
+      warmup_l1(proc_id, addr, TRUE, NULL, FALSE);
+  } else if(write) {  // writeback miss
+    if(MLC_WRITE_THROUGH)
+      warmup_l1(proc_id, addr, TRUE, NULL, FALSE);
+    else
+      warmup_mlc_insert(proc_id, addr)->dirty = TRUE;
+  } else {  // demand miss
+    if(train)
+      pref_umlc_miss(proc_id, addr, load_pc, hist);
+    warmup_l1(proc_id, addr, FALSE, op, ifetch);
+    warmup_mlc_insert(proc_id, addr);
+  }
+}
+
+/**************************************************************************************/
+/* cmp_warmup_pref_fill: functionally install a prefetch drained from the
+   prefetcher request queues during warmup. Lines already present are left
+   alone. */
+
+void cmp_warmup_pref_fill(uns proc_id, Addr line_addr, Flag to_mlc,
+                          Pref_Mem_Req* pref_req) {
+  Addr      dummy_line_addr;
+  L1_Data*  data;
+  if(to_mlc) {
+    Cache* mlc_cache = &(cmp_model.memory.uncores[proc_id].mlc->cache);
+    if(cache_access(mlc_cache, line_addr, &dummy_line_addr, FALSE))
+      return;
+    data = warmup_mlc_insert(proc_id, line_addr);
+  } else {
+    Cache* l1_cache = &(cmp_model.memory.uncores[proc_id].l1->cache);
+    if(cache_access(l1_cache, line_addr, &dummy_line_addr, FALSE))
+      return;
+    STAT_EVENT(proc_id, NORESET_L1_FILL);
+    STAT_EVENT(proc_id, NORESET_L1_FILL_PREF);
+    data        = warmup_l1_insert(proc_id, line_addr);
+    data->dirty = FALSE;
+  }
+  data->prefetch      = TRUE;
+  data->seen_prefetch = FALSE;
+  data->pref_distance = pref_req->distance;
+  data->pref_loadPC   = pref_req->loadPC;
+  data->global_hist   = pref_req->global_hist;
+  data->prefetcher_id = pref_req->prefetcher_id;
+}
+
 /**************************************************************************************/
 /* Warm up select microarchitectural structures: BP, icache, dcache,
    and L1. No wrong path warmup.
@@ -458,8 +608,11 @@ void cmp_warmup(Op* op) {
   if(WP_COLLECT_STATS)
     line_info = (Icache_Data*)cache_access(&ic->icache_line_info, ia, &dummy_line_addr2, TRUE);
 
+  if(TLB_ENABLE)
+    tlb_warmup(proc_id, ia, TRUE);
+
   if(ic_data == NULL) {
-    warmup_uncore(proc_id, ia, FALSE);
+    warmup_uncore(proc_id, ia, FALSE, op, TRUE);
     Addr repl_line_addr;
     ic_data = (Inst_Info**)cache_insert(icache, proc_id, ia, &dummy_line_addr,
                                         &repl_line_addr);
@@ -485,22 +638,34 @@ void cmp_warmup(Op* op) {
   if(is_load || is_store) {
     Cache*       dcache  = &(cmp_model.dcache_stage[proc_id].dcache);
     Dcache_Data* dc_data = cache_access(dcache, va, &dummy_line_addr, TRUE);
+    if(TLB_ENABLE)
+      tlb_warmup(proc_id, va, FALSE);
+    if(WARMUP_PREF_TRAIN) {
+      if(dc_data)
+        pref_dl0_hit(dummy_line_addr, ia);
+      else
+        pref_dl0_miss(dummy_line_addr, ia);
+    }
     if(dc_data) {
       // set some fields to meet expectations of the simulation mode
       if(is_store)
         dc_data->dirty = TRUE;
+      if(COHERENCE_ON && is_store && dc_data->coh_state != COH_M)
+        dc_data->coh_state = coh_fill_now(proc_id, va, TRUE);
       dc_data->read_count[0] += is_load;
       dc_data->write_count[0] += is_store;
     } else {
-      warmup_uncore(proc_id, va, FALSE);
+      warmup_uncore(proc_id, va, FALSE, op, FALSE);
       Addr repl_line_addr;
       dc_data = (Dcache_Data*)cache_insert(dcache, proc_id, va,
                                            &dummy_line_addr, &repl_line_addr);
-      if(dc_data->dirty)
-        warmup_uncore(proc_id, repl_line_addr, TRUE);
+      if(repl_line_addr && dc_data->dirty)
+        warmup_uncore(proc_id, repl_line_addr, TRUE, NULL, FALSE);
       dc_data->dirty          = is_store;
       dc_data->read_count[0]  = is_load;
       dc_data->write_count[0] = is_store;
+      if(COHERENCE_ON)
+        dc_data->coh_state = coh_fill_now(proc_id, va, is_store);
     }
   }
 
@@ -515,6 +680,9 @@ void cmp_warmup(Op* op) {
     }
     bp_data->bp->retire_func(op);
   }
+
+  if(WARMUP_PREF_TRAIN)
+    pref_warmup_drain();
 }
 
 static void cmp_measure_chip_util() {
@@ -85,6 +85,7 @@ void cmp_done(void);
 void cmp_wake(Op*, Op*, uns8);
 void cmp_retire_hook(Op*);
 void cmp_warmup(Op*);
+void cmp_warmup_pref_fill(uns, Addr, Flag, Pref_Mem_Req*);
 
 /**************************************************************************************/
 
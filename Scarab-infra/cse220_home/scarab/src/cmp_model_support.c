@@ -33,6 +33,7 @@
 #include "general.param.h"
 #include "globals/assert.h"
 #include "globals/utils.h"
+#include "lsq.h"
 #include "statistics.h"
 #include "prefetcher/fdip_new.h"
 #include "prefetcher/eip.h"
@@ -66,6 +67,7 @@ void cmp_init_cmp_model() {
   alloc_mem_djolt(NUM_CORES);
   alloc_mem_fnlmma(NUM_CORES);
   alloc_mem_uop_cache(NUM_CORES);
+  alloc_mem_lsq(NUM_CORES);
 }
 
 
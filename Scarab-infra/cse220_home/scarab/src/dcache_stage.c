@@ -41,7 +41,9 @@
 
 #include "core.param.h"
 #include "debug/debug.param.h"
+#include "memory/coherence.h"
 #include "memory/memory.param.h"
+#include "memory/tlb.h"
 #include "prefetcher//stream.param.h"
 #include "prefetcher/pref.param.h"
 #include "prefetcher/pref_common.h"
@@ -260,6 +262,14 @@ void update_dcache_stage(Stage_Data* src_sd) {
       continue;
     }
 
+    /* the access waits in the stage until its translation is available */
+    if(TLB_ENABLE && !tlb_translate(dc->proc_id, op->oracle_info.va, FALSE,
+                                  op->off_path)) {
+      op->state = OS_WAIT_DCACHE;
+      STAT_EVENT(op->proc_id, DCACHE_TLB_STALL);
+      continue;
+    }
+
     /* compute the bank---the bank bits are the lowest order cache index bits */
     bank = op->oracle_info.va >> dc->dcache.shift_bits &
            N_BIT_MASK(LOG2(DCACHE_BANKS));
@@ -356,6 +366,10 @@ void update_dcache_stage(Stage_Data* src_sd) {
 
       if(!op->off_path) {
         line->dirty |= op->table_info->mem_type == MEM_ST;
+        if(COHERENCE_ON && op->table_info->mem_type == MEM_ST &&
+           line->coh_state != COH_M)
+          line->coh_state = coh_upgrade(dc->proc_id, line_addr,
+                                        line->coh_state);
       }
       line->read_count[op->off_path] = line->read_count[op->off_path] +
                                        (op->table_info->mem_type == MEM_LD);
@@ -605,6 +619,14 @@ Flag dcache_fill_line(Mem_Req* req) {
   ASSERT(dc->proc_id, req->op_count == req->op_ptrs.count);
   ASSERT(dc->proc_id, req->op_count == req->op_uniques.count);
 
+  /* off-path stores only ask for read permission, so they never invalidate
+     another core's copy */
+  Flag coh_write = req->dirty_l0 && !req->off_path;
+  if(COHERENCE_ON && !coh_fill_ready(dc->proc_id, req->addr, coh_write)) {
+    cycle_count = old_cycle_count;
+    return FAILURE;
+  }
+
   /* if it can't get a write port, fail */
   if(!get_write_port(&dc->ports[bank])) {
     cycle_count = old_cycle_count;
@@ -625,6 +647,8 @@ Flag dcache_fill_line(Mem_Req* req) {
 
     data = (Dcache_Data*)cache_insert(&dc->pref_dcache, dc->proc_id, req->addr,
                                       &line_addr, &repl_line_addr);
+    if(COHERENCE_ON)
+      data->coh_state = coh_fill(dc->proc_id, req->addr, coh_write);
     ASSERT(dc->proc_id, req->emitted_cycle);
     ASSERT(dc->proc_id, cycle_count >= req->emitted_cycle);
     // mark the data as HW_prefetch if prefetch mark it as
@@ -677,6 +701,8 @@ Flag dcache_fill_line(Mem_Req* req) {
 
     data = (Dcache_Data*)cache_insert(&dc->dcache, dc->proc_id, req->addr,
                                       &line_addr, &repl_line_addr);
+    if(COHERENCE_ON)
+      data->coh_state = coh_fill(dc->proc_id, req->addr, coh_write);
     DEBUG(dc->proc_id,
           "Filling dcache  off_path:%d addr:0x%s  :%7d index:%7d op_count:%d "
           "oldest:%lld\n",
@@ -76,6 +76,7 @@ typedef struct Dcache_Data_struct {
 
   Counter fetch_cycle;      /* when was this data fetched into the cache? */
   Counter onpath_use_cycle; /* when was this data last used by correct path? */
+  uns8    coh_state;        /* MESI state, see memory/coherence.h */
 } Dcache_Data;
 
 
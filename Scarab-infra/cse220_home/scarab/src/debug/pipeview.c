@@ -27,6 +27,7 @@
  ***************************************************************************************/
 
 #include "debug/pipeview.h"
+#include "bp/bp.h"
 #include "core.param.h"
 #include "debug/debug_print.h"
 #include "general.param.h"
@@ -99,7 +100,7 @@ void pipeview_print_op(struct Op_struct* op) {
     // op was ready at rdy_cycle only if all sources are ready
     print_event(file, op, "ready", MAX2(op->rdy_cycle, op->issue_cycle + 1));
   } else {
-    ASSERT(op->proc_id, op->off_path);
+    ASSERT(op->proc_id, op->off_path || bp_recovery_info->load_recovery);
   }
   print_event(file, op, "sched", op->sched_cycle);
   print_event(file, op, "exec", op->exec_cycle);
@@ -51,6 +51,7 @@
 #include "statistics.h"
 #include "memory/memory.param.h"
 #include "decoupled_frontend.h"
+#include "xed-interface.h"
 
 /**************************************************************************************/
 /* Macros */
@@ -70,6 +71,8 @@ bool decode_off_path;
 /* Local prototypes */
 
 static inline void update_cycles_stats(Stage_Data* src_sd, int empty_stage_idx);
+static inline Flag macro_fusible(Op* first, Op* jcc);
+static inline Flag reads_dest_of(Op* producer, Op* consumer);
 
 /**************************************************************************************/
 /* set_decode_stage: */
@@ -133,7 +136,8 @@ void recover_decode_stage() {
     for(jj = 0; jj < STAGE_MAX_OP_COUNT; jj++) {
       if(cur->ops[jj]) {
         if(FLUSH_OP(cur->ops[jj])) {
-          ASSERT(cur->ops[jj]->proc_id, cur->ops[jj]->off_path);
+          ASSERT(cur->ops[jj]->proc_id, cur->ops[jj]->off_path ||
+                                          bp_recovery_info->load_recovery);
           free_op(cur->ops[jj]);
           cur->ops[jj] = NULL;
         } else {
@@ -270,6 +274,95 @@ void decode_stage_process_op(Op* op) {
     if (FDIP_DUAL_PATH_PREF_UOC_ONLINE_ENABLE)
       increment_branch_count(op->inst_info->addr);
   }
+
+  if(op->fused_op)
+    decode_stage_process_op(op->fused_op);
+}
+
+/**************************************************************************************/
+/* decode_stage_fusion_type: returns how op fuses with prev, the op right before
+ * it in the same fetch target. The decision is made as the frontend builds the
+ * fetch target so that fetch, decode, the uop cache, issue and retire all see the
+ * pair in one slot; the partner then rides along with prev (prev->fused_op) until
+ * it is issued into the node table. */
+
+Fusion_Type decode_stage_fusion_type(Op* prev, Op* op) {
+  if(prev->fused)
+    return NOT_FUSED;  // a slot holds at most two uops
+
+  // load+op: the ALU uop that consumes the load of its own instruction
+  if(MICRO_FUSION && !op->bom && prev->table_info->mem_type == MEM_LD &&
+     op->table_info->mem_type == NOT_MEM && !op->table_info->cf_type &&
+     op->table_info->op_type != OP_NOP && reads_dest_of(prev, op))
+    return MICRO_FUSED;
+
+  // flag-setting op + Jcc, both single-uop instructions. The pair never
+  // fuses when the Jcc starts a new 64B line (fetch targets end there).
+  if(MACRO_FUSION && op->table_info->cf_type == CF_CBR && op->bom &&
+     op->eom && prev->bom && prev->eom &&
+     prev->table_info->mem_type == NOT_MEM && !prev->table_info->cf_type &&
+     op->inst_info->addr % ICACHE_LINE_SIZE &&
+     macro_fusible(prev, op))
+    return MACRO_FUSED;
+
+  return NOT_FUSED;
+}
+
+/**************************************************************************************/
+/* reads_dest_of: TRUE if one of consumer's sources is written by producer */
+
+static inline Flag reads_dest_of(Op* producer, Op* consumer) {
+  for(uns ii = 0; ii < consumer->table_info->num_src_regs; ii++)
+    for(uns jj = 0; jj < producer->table_info->num_dest_regs; jj++)
+      if(consumer->inst_info->srcs[ii].id == producer->inst_info->dests[jj].id)
+        return TRUE;
+  return FALSE;
+}
+
+/**************************************************************************************/
+/* macro_fusible: the instruction pairs that fuse. TEST and AND fuse with any
+ * Jcc, CMP/ADD/SUB with the Jcc that test carry, zero or the signed compares,
+ * and INC/DEC (which do not write carry) only with the zero and signed ones.
+ * Ops without an XED iclass (e.g. synthetic traces) go by their op type and
+ * are assumed to be followed by a Jcc that fuses. */
+
+static inline Flag macro_fusible(Op* first, Op* jcc) {
+  uns16 jcc_iclass = jcc->table_info->true_op_type;
+  Flag  no_carry   = jcc_iclass == XED_ICLASS_INVALID ||
+                  jcc_iclass == XED_ICLASS_JZ || jcc_iclass == XED_ICLASS_JNZ ||
+                  jcc_iclass == XED_ICLASS_JL || jcc_iclass == XED_ICLASS_JNL ||
+                  jcc_iclass == XED_ICLASS_JLE || jcc_iclass == XED_ICLASS_JNLE;
+  Flag cmp_jcc = no_carry || jcc_iclass == XED_ICLASS_JB ||
+                 jcc_iclass == XED_ICLASS_JNB || jcc_iclass == XED_ICLASS_JBE ||
+                 jcc_iclass == XED_ICLASS_JNBE;
+
+  switch(first->table_info->true_op_type) {
+    case XED_ICLASS_TEST:
+      return TRUE;
+    case XED_ICLASS_CMP:
+      return cmp_jcc;
+    case XED_ICLASS_AND:
+      return MACRO_FUSION_ADD_SUB;
+    case XED_ICLASS_ADD:
+    case XED_ICLASS_SUB:
+      return MACRO_FUSION_ADD_SUB && cmp_jcc;
+    case XED_ICLASS_INC:
+    case XED_ICLASS_DEC:
+      return MACRO_FUSION_INC_DEC && no_carry;
+    case XED_ICLASS_INVALID:
+      switch(first->table_info->op_type) {
+        case OP_ICMP:
+          return cmp_jcc;
+        case OP_LOGIC:
+          return MACRO_FUSION_ADD_SUB;
+        case OP_IADD:
+          return MACRO_FUSION_ADD_SUB && cmp_jcc;
+        default:
+          return FALSE;
+      }
+    default:
+      return FALSE;
+  }
 }
 
 // UNUSED, and not kept up to date with uop cache changes.
@@ -29,8 +29,12 @@
 #ifndef __DECODE_STAGE_H__
 #define __DECODE_STAGE_H__
 
+#include "op.h"
 #include "stage_data.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /**************************************************************************************/
 /* Types */
@@ -62,11 +66,16 @@ void debug_decode_stage(void);
 void update_decode_stage(Stage_Data*);
 // Needed when ops skip the decode stage when fetched from the uop cache.
 void decode_stage_process_op(Op*);
+// Fusion rules, applied as the frontend builds fetch targets.
+Fusion_Type decode_stage_fusion_type(Op* prev, Op* op);
 
 // For stats
 int get_decode_stages_filled(void);
 
 /**************************************************************************************/
 
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* #ifndef __DECODE_STAGE_H__ */
@@ -1,4 +1,5 @@
 #include "decoupled_frontend.h"
+#include "decode_stage.h"
 #include "frontend/frontend_intf.h"
 #include "op.h"
 #include "op_pool.h"
@@ -73,7 +74,9 @@ void alloc_mem_decoupled_fe(uns numCores) {
 }
 
 void init_decoupled_fe(uns proc_id, const char*) {
-  trace_mode = false;
+  // trace frontends replay the wrong path from the PCs they have seen and
+  // must be redirected at every predicted-taken off-path branch
+  trace_mode = (FRONTEND == FE_TRACE);
 
 #ifdef ENABLE_PT_MEMTRACE
   trace_mode |= (FRONTEND == FE_PT || FRONTEND == FE_MEMTRACE);
@@ -137,10 +140,13 @@ void recover_decoupled_fe(int proc_id) {
   else if (op->oracle_info.recover_at_exec)
     STAT_EVENT(proc_id, FTQ_RECOVER_EXEC);
 
-  uint64_t offpath_cycles = cycle_count - per_core_redirect_cycle[proc_id];
-  ASSERT(proc_id, cycle_count > per_core_redirect_cycle[proc_id]);
-  INC_STAT_EVENT(proc_id, FTQ_OFFPATH_CYCLES, offpath_cycles);
-  per_core_redirect_cycle[proc_id] = 0;
+  // a memory ordering flush can recover without a redirect
+  if(per_core_redirect_cycle[proc_id]) {
+    uint64_t offpath_cycles = cycle_count - per_core_redirect_cycle[proc_id];
+    ASSERT(proc_id, cycle_count > per_core_redirect_cycle[proc_id]);
+    INC_STAT_EVENT(proc_id, FTQ_OFFPATH_CYCLES, offpath_cycles);
+    per_core_redirect_cycle[proc_id] = 0;
+  }
 
   //FIXME always fetch off path ops? should we get rid of this parameter?
   frontend_recover(proc_id, bp_recovery_info->recovery_inst_uid);
@@ -350,8 +356,15 @@ bool decoupled_fe_fill_icache_stage_data(int proc_id, int requested, Stage_Data
   ASSERT(proc_id, requested && requested <= sd->max_op_count - sd->op_count);
   ASSERT(proc_id, per_core_current_ft_in_use[proc_id].ft_can_fetch_op());
 
-  while (requested && per_core_current_ft_in_use[proc_id].ft_can_fetch_op()) {
-    sd->ops[sd->op_count] = per_core_current_ft_in_use[proc_id].ft_fetch_op();
+  FT* ft = &per_core_current_ft_in_use[proc_id];
+  while (requested && ft->ft_can_fetch_op()) {
+    Op* op = ft->ft_fetch_op();
+    ASSERT(proc_id, !op->fused);
+    // an op fused with this one comes along in the same slot
+    if (ft->ft_can_fetch_op() && ft->ops[ft->op_pos]->fused) {
+      op->fused_op = ft->ft_fetch_op();
+    }
+    sd->ops[sd->op_count] = op;
     sd->op_count++;
     requested--;
   }
@@ -513,6 +526,7 @@ void FT::ft_add_op(Op *op, FT_Ended_By ft_ended_by) {
       // assert all uops of the same inst share the same addr
       ASSERT(set_proc_id, ops.back()->inst_info->addr == op->inst_info->addr);
     }
+    op->fused = decode_stage_fusion_type(ops.back(), op);
   }
   ops.emplace_back(op);
   if (ft_ended_by != FT_NOT_ENDED) {
@@ -207,6 +207,26 @@ void init_exec_ports_fu_list(uns proc_id, Func_Unit* fu) {
   ASSERTM(proc_id, check_fu_type == N_BIT_MASK(FU_TYPE_WIDTH),
           "FU types do not cover all possible ops");
   free(fu_types_copy);
+
+  // an empty list puts every FU in cluster 0
+  uns64 next_cluster;
+  char* fu_clusters_copy = strdup(FU_CLUSTERS);
+  tmp                    = parse_next_elt(fu_clusters_copy, &next_cluster);
+  Flag  one_cluster      = !tmp;
+  for(i = 0; i < NUM_FUS && !one_cluster;
+      ++i, tmp = parse_next_elt(NULL, &next_cluster)) {
+    ASSERTM(proc_id, tmp, "Found less FU_CLUSTERS than expected\n");
+    fu[i].cluster = next_cluster;
+  }
+  ASSERTM(proc_id, tmp == FALSE, "Found more FU_CLUSTERS than expected\n");
+  free(fu_clusters_copy);
+
+  for(i = 0; i < NUM_FUS; ++i) {
+    for(uns32 j = 0; j < NUM_FUS; ++j) {
+      if(fu[j].cluster == fu[i].cluster)
+        fu[i].cluster_fus |= 1ull << j;
+    }
+  }
 }
 
 void init_exec_ports_rs_list(uns proc_id, Reservation_Station* rs,
@@ -261,7 +281,7 @@ void init_exec_ports_rs_list(uns proc_id, Reservation_Station* rs,
               "Attempted connections with an FU that does not exist\n");
       rs[i].connected_fus[num_fus] = &local_fus[idx];
       num_fus++;
-      next = next & ~(0x01 << idx);  // Clear the bit we just connected
+      next = next & ~(1ull << idx);  // Clear the bit we just connected
       idx  = __builtin_ffs(next);    // Find the next set bit
     }
     rs[i].num_fus = num_fus;
@@ -273,6 +293,17 @@ void init_exec_ports_rs_list(uns proc_id, Reservation_Station* rs,
             "Decoded a different number of connections that was counted before "
             "the loop\n");
 
+    // precompute which connected FUs can execute each FU type so the
+    // scheduler can select with bit operations
+    rs[i].fu_eligible = (uns64*)calloc(FU_TYPE_WIDTH, sizeof(uns64));
+    for(uns32 type_idx = 0; type_idx < FU_TYPE_WIDTH; ++type_idx) {
+      for(uns32 fu_idx = 0; fu_idx < rs[i].num_fus; ++fu_idx) {
+        Func_Unit* fu = rs[i].connected_fus[fu_idx];
+        if(fu->type & (1ull << type_idx))
+          rs[i].fu_eligible[type_idx] |= 1ull << fu->fu_id;
+      }
+    }
+
     power_calc_instruction_window_size(&rs[i]);
   }
   ASSERTM(proc_id, tmp == FALSE, "Found more RS_CONNECTIONS than expected\n");
@@ -297,5 +328,9 @@ void init_exec_ports(uns8 proc_id, const char* name) {
 }
 
 uns64 get_fu_type(Op_Type op_type, Flag is_simd) {
-  return (1ull << op_type) << (is_simd ? NUM_OP_TYPES : 0);
+  return 1ull << get_fu_type_idx(op_type, is_simd);
+}
+
+uns get_fu_type_idx(Op_Type op_type, Flag is_simd) {
+  return op_type + (is_simd ? NUM_OP_TYPES : 0);
 }
@@ -43,5 +43,6 @@ typedef enum Power_FU_Type_enum {
 
 Power_FU_Type power_get_fu_type(Op_Type op_type, Flag is_simd);
 uns64         get_fu_type(Op_Type op_type, Flag is_simd);
+uns           get_fu_type_idx(Op_Type op_type, Flag is_simd);
 
 #endif /* #ifndef __EXEC_PORTS_H__ */
@@ -38,7 +38,9 @@
 #include "bp/bp.h"
 #include "exec_ports.h"
 #include "exec_stage.h"
+#include "lsq.h"
 #include "map.h"
+#include "node_stage.h"
 
 #include "bp/bp.param.h"
 #include "cmp_model.h"
@@ -66,6 +68,12 @@ int         exec_off_path;
 /* Prototypes */
 
 static void init_op_type_delays();
+static Flag exec_narrow_div(Op* op);
+static Flag exec_wb_free(Func_Unit* fu, Op* op, Counter cycle);
+static void exec_wb_reserve(Func_Unit* fu, Op* op);
+static void exec_wb_flush(Func_Unit* fu);
+static void exec_resolve_cf(Op* op);
+static void exec_fused_jcc(Op* op, Op* jcc);
 void        exec_stage_inc_power_stats(Op* op);
 
 /**************************************************************************************/
@@ -97,6 +105,127 @@ static void init_op_type_delays() {
     ASSERT(td->proc_id, op_type_delays[ii] != 0);
 }
 
+/**************************************************************************************/
+/* exec_narrow_div: divides on operands of 4 bytes or less finish early. The
+   traces carry no operand values, so the operand width stands in for the
+   early-out of a real divider. */
+
+static Flag exec_narrow_div(Op* op) {
+  Op_Type op_type = op->table_info->op_type;
+  uns     width   = op->table_info->lane_width_bytes;
+  return (op_type == OP_IDIV || op_type == OP_FDIV) && width && width <= 4 &&
+         !UNIFORM_OP_DELAY;
+}
+
+
+/**************************************************************************************/
+/* exec_latency: cycles from latching the op until its result is ready */
+
+uns exec_latency(Op* op) {
+  int latency = op->inst_info->latency;
+  if(exec_narrow_div(op)) {
+    uns narrow_delay = op->table_info->op_type == OP_IDIV ?
+                         OP_IDIV_NARROW_DELAY :
+                         OP_FDIV_NARROW_DELAY;
+    if(narrow_delay)
+      return narrow_delay;
+  }
+  return MAX2(latency, -latency);
+}
+
+
+/**************************************************************************************/
+/* exec_occupancy: cycles the op keeps its FU from latching another op. A
+   negative delay means the unit is not pipelined; the divider occupancy
+   params model a partially pipelined divider. */
+
+uns exec_occupancy(Op* op) {
+  int latency   = op->inst_info->latency;
+  uns occupancy = latency < 0 ? -latency : 1;
+
+  if(UNIFORM_OP_DELAY)
+    return occupancy;
+  if(op->table_info->op_type == OP_IDIV && OP_IDIV_OCCUPANCY)
+    occupancy = OP_IDIV_OCCUPANCY;
+  else if(op->table_info->op_type == OP_FDIV && OP_FDIV_OCCUPANCY)
+    occupancy = OP_FDIV_OCCUPANCY;
+  if(exec_narrow_div(op)) {
+    uns narrow_occupancy = op->table_info->op_type == OP_IDIV ?
+                             OP_IDIV_NARROW_OCCUPANCY :
+                             OP_FDIV_NARROW_OCCUPANCY;
+    if(narrow_occupancy)
+      occupancy = narrow_occupancy;
+  }
+  return MAX2(MIN2(occupancy, exec_latency(op)), 1);
+}
+
+
+/**************************************************************************************/
+/* exec_wb_free: whether the fu's writeback port is free in the cycle the op
+   would complete if latched at cycle. Memory ops return their data through
+   the dcache and do not use the port; latencies past the reservation window
+   are not tracked. */
+
+static Flag exec_wb_free(Func_Unit* fu, Op* op, Counter cycle) {
+  Counter offset;
+  if(op->table_info->mem_type != NOT_MEM)
+    return TRUE;
+  ASSERT(exec->proc_id, cycle >= fu->wb_base);
+  offset = cycle + exec_latency(op) - fu->wb_base;
+  return offset >= 64 || !(fu->wb_slots & (1ull << offset));
+}
+
+
+/**************************************************************************************/
+/* exec_wb_reserve: take the fu's writeback port for the cycle the op latched
+   this cycle completes */
+
+static void exec_wb_reserve(Func_Unit* fu, Op* op) {
+  Counter shift   = cycle_count - fu->wb_base;
+  uns     latency = exec_latency(op);
+  fu->wb_slots    = shift >= 64 ? 0 : fu->wb_slots >> shift;
+  fu->wb_base     = cycle_count;
+  if(op->table_info->mem_type == NOT_MEM && latency < 64) {
+    fu->wb_slots |= 1ull << latency;
+    fu->wb_op_nums[(cycle_count + latency) % 64] = op->op_num;
+  }
+}
+
+
+/**************************************************************************************/
+/* exec_wb_flush: release the writeback cycles of the ops being flushed */
+
+static void exec_wb_flush(Func_Unit* fu) {
+  uns64 slots;
+  for(slots = fu->wb_slots; slots; slots &= slots - 1) {
+    uns bit = __builtin_ctzll(slots);
+    if(fu->wb_op_nums[(fu->wb_base + bit) % 64] >
+       bp_recovery_info->recovery_op_num)
+      fu->wb_slots &= ~(1ull << bit);
+  }
+}
+
+
+/**************************************************************************************/
+/* exec_fus_ready: the FUs that can latch the op at cycle: with
+   SCHED_AVOID_BUSY_FUS, not held by a non-pipelined op; with
+   WB_PORT_CONFLICTS, with a free writeback port when the op completes */
+
+uns64 exec_fus_ready(Op* op, Counter cycle) {
+  uns64 fus = 0;
+  uns   ii;
+  for(ii = 0; ii < NUM_FUS; ii++) {
+    Func_Unit* fu = &exec->fus[ii];
+    if(SCHED_AVOID_BUSY_FUS && fu->avail_cycle > cycle)
+      continue;
+    if(WB_PORT_CONFLICTS && !exec_wb_free(fu, op, cycle))
+      continue;
+    fus |= 1ull << ii;
+  }
+  return fus;
+}
+
+
 /**************************************************************************************/
 /* init_exec_stage: */
 
@@ -146,6 +275,8 @@ void recover_exec_stage() {
       fu->avail_cycle = cycle_count + 1;
       fu->idle_cycle  = cycle_count + 1;
     }
+    if(WB_PORT_CONFLICTS)
+      exec_wb_flush(fu);
   }
 }
 
@@ -174,6 +305,73 @@ void debug_exec_stage() {
 }
 
 
+/**************************************************************************************/
+/* exec_resolve_cf: branch recovery/resolution of a cf op that executes */
+
+static void exec_resolve_cf(Op* op) {
+  // branch recovery currently does not like to be done more
+  // than 1 time.  since we don't have any way to know if an
+  // op is going to be replayed, we have to go with the
+  // first recovery (even though it is improper) for the
+  // time being
+
+  if(!BP_UPDATE_AT_RETIRE) {
+    // this code updates the branch prediction structures
+    if(op->table_info->cf_type >= CF_IBR)
+      bp_target_known_op(g_bp_data, op);
+
+    bp_resolve_op(g_bp_data, op);
+  }
+
+  if (op->oracle_info.recover_at_exec){
+    bp_sched_recovery(bp_recovery_info, op, op->exec_cycle,
+                      /*late_bp_recovery=*/FALSE, /*force_offpath=*/FALSE);
+    if(!op->off_path)
+      op->recovery_scheduled = TRUE;
+
+    // stats for the reason of resteer
+    if(op->oracle_info.mispred)
+      STAT_EVENT(op->proc_id, RESTEER_MISPRED_NOT_CF + op->table_info->cf_type);
+    else
+      STAT_EVENT(op->proc_id, RESTEER_MISFETCH_NOT_CF + op->table_info->cf_type);
+
+  }
+  /*      else if(op->table_info->cf_type >= CF_IBR &&
+            op->oracle_info.no_target) {
+    ASSERT(bp_recovery_info->proc_id,
+           bp_recovery_info->proc_id == op->proc_id);
+    bp_sched_redirect(bp_recovery_info, op, op->exec_cycle);
+    // stats for the reason of resteer
+    STAT_EVENT(op->proc_id, RESTEER_NO_TARGET_CF_IBR + op->table_info->cf_type - CF_IBR);
+    ASSERT(0,0);
+    }*/
+}
+
+
+/**************************************************************************************/
+/* exec_fused_jcc: latch the macro-fused Jcc along with op, on op's FU */
+
+static void exec_fused_jcc(Op* op, Op* jcc) {
+  ASSERT(exec->proc_id, jcc->table_info->cf_type);
+  jcc->fu_num      = op->fu_num;
+  jcc->sched_cycle = op->sched_cycle;
+  jcc->state       = OS_SCHEDULED;
+  jcc->exec_cycle  = op->exec_cycle;
+  jcc->done_cycle  = jcc->exec_cycle;
+  jcc->exec_count++;
+  exec_stage_inc_power_stats(jcc);
+
+  STAT_EVENT(jcc->proc_id, EXEC_ON_PATH_INST + jcc->off_path);
+  STAT_EVENT(jcc->proc_id, EXEC_ON_PATH_INST_MEM + 1 + 2 * jcc->off_path);
+  STAT_EVENT(jcc->proc_id, EXEC_ALL_INST);
+
+  DEBUG(exec->proc_id, "op_num:%s fused into op_num:%s fu_num:%d\n",
+        unsstr64(jcc->op_num), unsstr64(op->op_num), jcc->fu_num);
+
+  exec_resolve_cf(jcc);
+}
+
+
 /**************************************************************************************/
 /* exec_cycle: */
 
@@ -207,7 +405,8 @@ void update_exec_stage(Stage_Data* src_sd) {
     Func_Unit* fu  = &exec->fus[ii];
     Op*        op  = src_sd->ops[ii];
     Op*        fop = exec->sd.ops[ii];
-    int        latency;
+    Op*        jcc;
+    uns        latency;
     Counter    exec_cycle;
 
     if (!op) {
@@ -231,6 +430,15 @@ void update_exec_stage(Stage_Data* src_sd) {
       }
       continue;
     }
+    if(WB_PORT_CONFLICTS && op && !exec_wb_free(fu, op, cycle_count)) {
+      // another op completes on this fu's writeback port in the same cycle
+      op->delay_bit   = 1;
+      src_sd->ops[ii] = NULL;
+      src_sd->op_count--;
+      STAT_EVENT(exec->proc_id, FU_WB_CONFLICT);
+      src_op_assrtions[ii] = TRUE;
+      continue;
+    }
     if(fop && fop->table_info->mem_type) {
       if(fop->replay && fop->replay_cycle == cycle_count) {
         // it's a simultaneous replay...need to kill it
@@ -275,13 +483,13 @@ void update_exec_stage(Stage_Data* src_sd) {
     // into the execute stage because they happened to be
     // processed before the op causing the recovery or replay.
 
-    latency = op->inst_info->latency;
+    latency = exec_latency(op);
     ASSERTM(exec->proc_id, OP_SRCS_RDY(op), "op_num:%s\n",
             unsstr64(op->op_num));
     ASSERT(
       exec->proc_id,
       get_fu_type(op->table_info->op_type, op->table_info->is_simd) & fu->type);
-    exec_cycle      = cycle_count + MAX2(latency, -latency);
+    exec_cycle      = cycle_count + latency;
     op->sched_cycle = cycle_count;
 
     DEBUG(exec->proc_id, "op_num:%s fu_num:%d sched_cycle:%s off_path:%d\n",
@@ -292,6 +500,11 @@ void update_exec_stage(Stage_Data* src_sd) {
       // after the op's latency
       op->wake_cycle = exec_cycle;
       wake_up_ops(op, REG_DATA_DEP, model->wake_hook);
+      // a macro-fused Jcc resolves together with its pair
+      if(MACRO_FUSION && (jcc = node_fused_jcc(op))) {
+        jcc->wake_cycle = exec_cycle;
+        wake_up_ops(jcc, REG_DATA_DEP, model->wake_hook);
+      }
     } else if(op->table_info->mem_type == MEM_ST) {
       // stores have their addresses computed in this cycle and
       // also write their data into the store buffer
@@ -300,6 +513,7 @@ void update_exec_stage(Stage_Data* src_sd) {
         op->wake_cycle = exec_cycle;
         wake_up_ops(op, MEM_ADDR_DEP, model->wake_hook);
         wake_up_ops(op, MEM_DATA_DEP, model->wake_hook);
+        lsq_store_exec(op);
       }
     }
 
@@ -315,7 +529,7 @@ void update_exec_stage(Stage_Data* src_sd) {
     Func_Unit* fu  = &exec->fus[ii];
     Op*        op  = src_sd->ops[ii];
     Op*        fop = exec->sd.ops[ii];
-    int        latency;
+    uns        latency;
     Counter    exec_cycle;
     Flag       is_replay = FALSE;
 
@@ -352,15 +566,17 @@ void update_exec_stage(Stage_Data* src_sd) {
     ASSERT(exec->proc_id, src_sd->op_count >= 0);
 
     // busy the functional unit
-    latency = op->inst_info->latency;
+    latency = exec_latency(op);
     ASSERT(0, latency);  // otherwise ready list management breaks
-    exec_cycle       = cycle_count + MAX2(latency, -latency);
+    exec_cycle       = cycle_count + latency;
     exec->sd.ops[ii] = op;
     exec->sd.op_count++;
     ASSERT(exec->proc_id, exec->sd.op_count <= exec->sd.max_op_count);
     // if the op is not pipelined, then busy up the functional unit
-    fu->avail_cycle = cycle_count + (latency < 0 ? -latency : 1);
-    fu->idle_cycle  = cycle_count + (latency < 0 ? -latency : latency);
+    fu->avail_cycle = cycle_count + exec_occupancy(op);
+    fu->idle_cycle  = cycle_count + latency;
+    if(WB_PORT_CONFLICTS)
+      exec_wb_reserve(fu, op);
 
     // set the op's state to reflect it's execution
     if(op->table_info->mem_type == NOT_MEM || STALL_ON_WAIT_MEM) {
@@ -369,7 +585,7 @@ void update_exec_stage(Stage_Data* src_sd) {
       op->state = OS_TENTATIVE;  // mem op may fail if it misses and can't get a
                                  // mem req buffer
     }
-    op->exec_cycle = cycle_count + MAX2(latency, -latency);
+    op->exec_cycle = cycle_count + latency;
     op->exec_count++;
 
     if(op->table_info->mem_type == NOT_MEM)
@@ -388,45 +604,17 @@ void update_exec_stage(Stage_Data* src_sd) {
           unsstr64(op->done_cycle), op->off_path);
 
     // {{{ branch recovery/resolution code
-    if(op->table_info->cf_type && !is_replay) {
-      // branch recovery currently does not like to be done more
-      // than 1 time.  since we don't have any way to know if an
-      // op is going to be replayed, we have to go with the
-      // first recovery (even though it is improper) for the
-      // time being
-
-      if(!BP_UPDATE_AT_RETIRE) {
-        // this code updates the branch prediction structures
-        if(op->table_info->cf_type >= CF_IBR)
-          bp_target_known_op(g_bp_data, op);
-
-        bp_resolve_op(g_bp_data, op);
-      }
-
-      if (op->oracle_info.recover_at_exec){
-        bp_sched_recovery(bp_recovery_info, op, op->exec_cycle,
-                          /*late_bp_recovery=*/FALSE, /*force_offpath=*/FALSE);
-        if(!op->off_path)
-          op->recovery_scheduled = TRUE;
-
-        // stats for the reason of resteer
-        if(op->oracle_info.mispred)
-          STAT_EVENT(op->proc_id, RESTEER_MISPRED_NOT_CF + op->table_info->cf_type);
-        else
-          STAT_EVENT(op->proc_id, RESTEER_MISFETCH_NOT_CF + op->table_info->cf_type);
+    if(op->table_info->cf_type && !is_replay)
+      exec_resolve_cf(op);
+    // }}}
 
-      }
-      /*      else if(op->table_info->cf_type >= CF_IBR &&
-                op->oracle_info.no_target) {
-        ASSERT(bp_recovery_info->proc_id,
-               bp_recovery_info->proc_id == op->proc_id);
-        bp_sched_redirect(bp_recovery_info, op, op->exec_cycle);
-        // stats for the reason of resteer
-        STAT_EVENT(op->proc_id, RESTEER_NO_TARGET_CF_IBR + op->table_info->cf_type - CF_IBR);
-        ASSERT(0,0);
-        }*/
+    // the macro-fused Jcc takes no FU of its own: it executes on its
+    // pair's port in the same cycle
+    if(MACRO_FUSION && op->table_info->mem_type == NOT_MEM) {
+      Op* jcc = node_fused_jcc(op);
+      if(jcc)
+        exec_fused_jcc(op, jcc);
     }
-    // }}}
 
     /* value prediction recovery/resolution code  */  // if we know the value at
                                                       // this point if not ?
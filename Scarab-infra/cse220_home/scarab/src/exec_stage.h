@@ -45,6 +45,11 @@ typedef struct Func_Unit_struct {
        idle_cycle;  /* cycle when the FU becomes idle (no op in its pipeline) */
   Flag held_by_mem; /* when true, the memory system has determined a stall for
                        the func unit */
+  uns     cluster;     /* bypass cluster, from FU_CLUSTERS */
+  uns64   cluster_fus; /* bitmask of the FUs in the same cluster */
+  uns64   wb_slots; /* writeback port reservations, bit i is cycle wb_base + i */
+  Counter wb_base;
+  Counter wb_op_nums[64]; /* op holding each reserved cycle, by cycle mod 64 */
 } Func_Unit;
 
 
@@ -78,6 +83,10 @@ void debug_exec_stage(void);
 void update_exec_stage(Stage_Data*);
 void finalize_exec_stage(void);
 
+uns   exec_latency(Op*);
+uns   exec_occupancy(Op*);
+uns64 exec_fus_ready(Op*, Counter);
+
 /**************************************************************************************/
 
 
@@ -31,6 +31,7 @@
 #include "debug/debug_macros.h"
 #include "globals/assert.h"
 #include "globals/global_defs.h"
+#include "globals/utils.h"
 #include "memory/memory.param.h"
 #include "ramulator.param.h"
 #include "statistics.h"
@@ -65,6 +66,7 @@ Domain_Info    domains[MAX_FREQ_DOMAINS];
 Freq_Domain_Id FREQ_DOMAIN_CORES[MAX_NUM_PROCS];
 Freq_Domain_Id FREQ_DOMAIN_L1;
 Freq_Domain_Id FREQ_DOMAIN_MEMORY;
+Freq_Domain_Id FREQ_DOMAIN_DRAM_CACHE;
 
 /**************************************************************************************/
 /* Local prototypes */
@@ -117,6 +119,8 @@ void freq_init(void) {
   FREQ_DOMAIN_L1 = freq_domain_create("L1", l1_cycle_time);
   // FREQ_DOMAIN_MEMORY = freq_domain_create("MEMORY", MEMORY_CYCLE_TIME);
   FREQ_DOMAIN_MEMORY = freq_domain_create("MEMORY", RAMULATOR_TCK);
+  if(DRAM_CACHE_ON)
+    FREQ_DOMAIN_DRAM_CACHE = freq_domain_create("DRAM_CACHE", DRAM_CACHE_TCK);
   /* These stats simplify data analysis by allowing cycle times to
      be used in get_cmp_data stat formulas */
   GET_STAT_EVENT(0, PARAM_L1_CYCLE_TIME) = l1_cycle_time;
@@ -203,6 +207,62 @@ Counter freq_future_time(Freq_Domain_Id id, Counter cycles) {
   return freq_time() + (cycles - domains[id].cycles) * domains[id].cycle_time;
 }
 
+Counter freq_cycle_start_time(Freq_Domain_Id id, Counter cycles) {
+  ASSERT(0, id < num_domains);
+  Domain_Info* domain = &domains[id];
+  if(domain->time_until_next_cycle == 0) {
+    ASSERT(0, domain->cycles <= cycles);
+    return cur_time + (cycles - domain->cycles) * domain->cycle_time;
+  }
+  ASSERT(0, domain->cycles < cycles);
+  return cur_time + domain->time_until_next_cycle +
+         (cycles - domain->cycles - 1) * domain->cycle_time;
+}
+
+/* time of the domain's first cycle after the current time */
+static Counter freq_next_cycle_time(Domain_Info* domain) {
+  return cur_time + (domain->time_until_next_cycle ?
+                       domain->time_until_next_cycle :
+                       domain->cycle_time);
+}
+
+Counter freq_next_time(void) {
+  Counter next = MAX_CTR;
+  for(uns i = 0; i < num_domains; i++)
+    next = MIN2(next, freq_next_cycle_time(&domains[i]));
+  return next;
+}
+
+void freq_skip_to_time(Counter until) {
+  Counter next_cycle_times[MAX_FREQ_DOMAINS];
+  Counter new_time = cur_time;
+
+  /* Count the cycles starting before that time as done. The new
+     current time is the start of the last of them. */
+  for(uns i = 0; i < num_domains; i++) {
+    Counter next = freq_next_cycle_time(&domains[i]);
+    if(next < until) {
+      Counter skipped = (until - next - 1) / domains[i].cycle_time + 1;
+      domains[i].cycles += skipped;
+      next += (skipped - 1) * domains[i].cycle_time;
+      new_time = MAX2(new_time, next);
+      next += domains[i].cycle_time;
+    }
+    next_cycle_times[i] = next;
+  }
+  if(new_time == cur_time)
+    return;
+
+  for(uns i = 0; i < num_domains; i++) {
+    ASSERT(0, next_cycle_times[i] > new_time);
+    domains[i].time_until_next_cycle = next_cycle_times[i] - new_time;
+  }
+  INC_STAT_EVENT_ALL(EXECUTION_TIME, new_time - cur_time);
+  INC_STAT_EVENT_ALL(POWER_TIME, new_time - cur_time);
+  DEBUG(0, "Skipping time to %lld fs\n", new_time);
+  cur_time = new_time;
+}
+
 void freq_set_cycle_time(Freq_Domain_Id id, uns cycle_time) {
   ASSERT(0, id < num_domains);
   ASSERT(0, cycle_time > 0);
@@ -46,6 +46,7 @@ typedef unsigned int Freq_Domain_Id;
 extern Freq_Domain_Id FREQ_DOMAIN_CORES[];
 extern Freq_Domain_Id FREQ_DOMAIN_L1;
 extern Freq_Domain_Id FREQ_DOMAIN_MEMORY;
+extern Freq_Domain_Id FREQ_DOMAIN_DRAM_CACHE;  // only if DRAM_CACHE_ON
 
 /**************************************************************************************/
 /* Prototypes */
@@ -75,6 +76,19 @@ Counter freq_time(void);
    changing its frequency) */
 Counter freq_future_time(Freq_Domain_Id, Counter cycle_count);
 
+/* Returns the simulation time (in femtoseconds) when the specified
+   domain's cycle starts, for a cycle that has not been simulated yet
+   or is being simulated now */
+Counter freq_cycle_start_time(Freq_Domain_Id id, Counter cycle_count);
+
+/* Returns the time of the next cycle of any domain after this one */
+Counter freq_next_time(void);
+
+/* Skip every domain's cycles that start before the specified time
+   without simulating them, so that time advances straight to it. The
+   caller accounts for the skipped cycles. */
+void freq_skip_to_time(Counter time);
+
 /* Sets the cycle time of the specified frequency domain (takes effect
    on the next cycle of that domain) */
 void freq_set_cycle_time(Freq_Domain_Id, uns cycle_time);
@@ -42,12 +42,33 @@
 #include "frontend/pin_trace_fe.h"
 #include "frontend/pin_trace_read.h"
 #include "isa/isa.h"
+#include "libs/hash_lib.h"
 
 /**************************************************************************************/
 /* Macros */
 
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_TRACE_READ, ##args)
 
+#define HIST_ENTRY(hist, ii) \
+  (&(hist)->insts[((hist)->head + (ii)) & ((hist)->size - 1)])
+#define HIST_INIT_SIZE 1024
+
+/**************************************************************************************/
+/* Types */
+
+/* On-path rewind: a memory ordering flush refetches on-path instructions the
+   trace has already moved past. The ones fetched and not retired yet are kept
+   here, oldest first. Entries from replay on are fetched again before the
+   trace is read. */
+typedef struct Trace_Hist_struct {
+  ctype_pin_inst* insts;
+  uns             size;  // a power of two
+  uns             head;
+  uns             count;
+  uns             replay;
+  Flag            replaying;  // the instruction being fetched is from insts
+} Trace_Hist;
+
 
 /**************************************************************************************/
 /* Global Variables */
@@ -56,17 +77,44 @@ static char* trace_files[MAX_NUM_PROCS];
 
 ctype_pin_inst* next_pi;
 
+/* Wrong path: the trace only holds the correct path, so after a redirect
+   instructions are replayed from the last on-path instance seen at each PC.
+   PCs not seen yet become dummy NOPs. */
+static Hash_Table*     inst_map;     // per core, PC -> ctype_pin_inst
+static ctype_pin_inst* off_path_pi;  // next off-path instruction
+static Addr*           off_path_addr;
+static Flag*           off_path_mode;
+
+static Trace_Hist* hist;      // per core
+static uns64*      next_uid;  // per core, inst_uid of the last new instruction
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static void trace_record_inst(uns proc_id, ctype_pin_inst* pi);
+static void trace_gen_off_path_inst(uns proc_id);
+static void trace_hist_push(Trace_Hist* hist, ctype_pin_inst* pi);
+
 /**************************************************************************************/
 /* trace_init() */
 
 void trace_init() {
-  ASSERTM(0, !FETCH_OFF_PATH_OPS,
-          "Trace frontend does not support wrong path. Turn off "
-          "FETCH_OFF_PATH_OPS\n");
-
   uop_generator_init(NUM_CORES);
 
-  next_pi = (ctype_pin_inst*)malloc(NUM_CORES * sizeof(ctype_pin_inst));
+  next_pi       = (ctype_pin_inst*)malloc(NUM_CORES * sizeof(ctype_pin_inst));
+  inst_map      = (Hash_Table*)malloc(NUM_CORES * sizeof(Hash_Table));
+  off_path_pi   = (ctype_pin_inst*)calloc(NUM_CORES, sizeof(ctype_pin_inst));
+  off_path_addr = (Addr*)calloc(NUM_CORES, sizeof(Addr));
+  off_path_mode = (Flag*)calloc(NUM_CORES, sizeof(Flag));
+  hist          = (Trace_Hist*)calloc(NUM_CORES, sizeof(Trace_Hist));
+  next_uid      = (uns64*)calloc(NUM_CORES, sizeof(uns64));
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    init_hash_table(&inst_map[proc_id], "trace inst map", 4096,
+                    sizeof(ctype_pin_inst));
+    hist[proc_id].size  = HIST_INIT_SIZE;
+    hist[proc_id].insts = (ctype_pin_inst*)malloc(HIST_INIT_SIZE *
+                                                  sizeof(ctype_pin_inst));
+  }
 
   pin_trace_file_pointer_init(NUM_CORES);
 
@@ -100,13 +148,75 @@ void trace_init() {
 
 void trace_setup(uns proc_id) {
   pin_trace_open(proc_id, trace_files[proc_id]);
-  pin_trace_read(proc_id, &next_pi[proc_id]);
+  if(pin_trace_read(proc_id, &next_pi[proc_id]))
+    trace_record_inst(proc_id, &next_pi[proc_id]);
+}
+
+/**************************************************************************************/
+/* trace_record_inst: remember the latest on-path instance of each PC */
+
+static void trace_record_inst(uns proc_id, ctype_pin_inst* pi) {
+  Flag            new_entry;
+  ctype_pin_inst* entry = (ctype_pin_inst*)hash_table_access_create(
+    &inst_map[proc_id], pi->instruction_addr, &new_entry);
+  *entry = *pi;
+}
+
+/**************************************************************************************/
+/* trace_hist_push: add a new on-path instruction, growing the history if it
+   is full */
+
+static void trace_hist_push(Trace_Hist* hist, ctype_pin_inst* pi) {
+  ASSERT(0, hist->replay == hist->count);
+  if(hist->count == hist->size) {
+    ctype_pin_inst* insts = (ctype_pin_inst*)malloc(2 * hist->size *
+                                                    sizeof(ctype_pin_inst));
+    for(uns ii = 0; ii < hist->count; ii++)
+      insts[ii] = *HIST_ENTRY(hist, ii);
+    free(hist->insts);
+    hist->insts = insts;
+    hist->size *= 2;
+    hist->head = 0;
+  }
+  *HIST_ENTRY(hist, hist->count) = *pi;
+  hist->count++;
+  hist->replay++;
+}
+
+/**************************************************************************************/
+/* trace_gen_off_path_inst: produce the instruction at off_path_addr */
+
+static void trace_gen_off_path_inst(uns proc_id) {
+  Addr            addr  = off_path_addr[proc_id];
+  ctype_pin_inst* entry = (ctype_pin_inst*)hash_table_access(
+    &inst_map[proc_id], addr);
+  ctype_pin_inst* pi = &off_path_pi[proc_id];
+
+  if(entry) {
+    *pi = *entry;
+  } else {
+    memset(pi, 0, sizeof(ctype_pin_inst));
+    pi->instruction_addr      = addr;
+    pi->instruction_next_addr = addr + DUMMY_NOP_SIZE;
+    pi->size                  = DUMMY_NOP_SIZE;
+    pi->op_type               = OP_NOP;
+    strcpy(pi->pin_iclass, "DUMMY_NOP");
+    pi->fake_inst        = 1;
+    pi->fake_inst_reason = WPNM_REASON_REDIRECT_TO_NOT_INSTRUMENTED;
+  }
+  off_path_addr[proc_id] += pi->size;
+  DEBUG(proc_id, "Off-path inst addr:%llx size:%d known:%d\n", addr, pi->size,
+        entry != NULL);
 }
 
 /**************************************************************************************/
 /* trace_next_fetch_addr */
 
 Addr trace_next_fetch_addr(uns proc_id) {
+  Trace_Hist* h = &hist[proc_id];
+  if(h->replay < h->count)
+    return convert_to_cmp_addr(proc_id,
+                               HIST_ENTRY(h, h->replay)->instruction_addr);
   return convert_to_cmp_addr(proc_id, next_pi[proc_id].instruction_addr);
 }
 
@@ -125,20 +235,44 @@ void trace_close_trace_file(uns proc_id) {
 }
 
 Flag trace_can_fetch_op(uns proc_id) {
-  return !(uop_generator_get_eom(proc_id) && trace_read_done[proc_id]);
+  return !(uop_generator_get_eom(proc_id) && trace_read_done[proc_id] &&
+           hist[proc_id].replay == hist[proc_id].count);
 }
 
 void trace_fetch_op(uns proc_id, Op* op) {
+  Trace_Hist* h = &hist[proc_id];
   if(uop_generator_get_bom(proc_id)) {
-    ASSERT(proc_id, !trace_read_done[proc_id] && !reached_exit[proc_id]);
-    uop_generator_get_uop(proc_id, op, &next_pi[proc_id]);
+    h->replaying = FALSE;
+    if(off_path_mode[proc_id]) {
+      uop_generator_get_uop(proc_id, op, &off_path_pi[proc_id]);
+    } else if(h->replay < h->count) {
+      h->replaying = TRUE;
+      uop_generator_get_uop(proc_id, op, HIST_ENTRY(h, h->replay++));
+    } else {
+      ASSERT(proc_id, !trace_read_done[proc_id] && !reached_exit[proc_id]);
+      next_pi[proc_id].inst_uid = ++next_uid[proc_id];
+      trace_hist_push(h, &next_pi[proc_id]);
+      uop_generator_get_uop(proc_id, op, &next_pi[proc_id]);
+    }
   } else {
     uop_generator_get_uop(proc_id, op, NULL);
   }
 
   if(uop_generator_get_eom(proc_id)) {
+    if(off_path_mode[proc_id]) {
+      trace_gen_off_path_inst(proc_id);
+      return;
+    }
+    if(h->replaying) {
+      /* the trace was read past this instruction already */
+      if(h->replay == h->count && trace_read_done[proc_id])
+        op->exit = TRUE;
+      return;
+    }
     int success = pin_trace_read(proc_id, &next_pi[proc_id]);
-    if(!success) {
+    if(success) {
+      trace_record_inst(proc_id, &next_pi[proc_id]);
+    } else {
       trace_read_done[proc_id] = TRUE;
       reached_exit[proc_id]    = TRUE;
       /* this flag is supposed to be set in uop_generator_get_uop() but there
@@ -150,16 +284,29 @@ void trace_fetch_op(uns proc_id, Op* op) {
 }
 
 void trace_redirect(uns proc_id, uns64 inst_uid, Addr fetch_addr) {
-  FATAL_ERROR(proc_id, "Trace frontend does not support wrong path. Turn off "
-                       "FETCH_OFF_PATH_OPS\n");
+  off_path_mode[proc_id] = TRUE;
+  off_path_addr[proc_id] = fetch_addr & N_BIT_MASK(58);  // drop the proc_id bits
+  trace_gen_off_path_inst(proc_id);
 }
 
 void trace_recover(uns proc_id, uns64 inst_uid) {
-  FATAL_ERROR(proc_id, "Trace frontend does not support wrong path. Turn off "
-                       "FETCH_OFF_PATH_OPS\n");
+  Op          dummy_op;
+  Trace_Hist* h = &hist[proc_id];
+  off_path_mode[proc_id] = FALSE;
+  // finish decoding the current instruction before going back on path
+  while(!uop_generator_get_eom(proc_id))
+    uop_generator_get_uop(proc_id, &dummy_op, NULL);
+  // on-path instructions after inst_uid are fetched again
+  while(h->replay && HIST_ENTRY(h, h->replay - 1)->inst_uid > inst_uid)
+    h->replay--;
 }
 
 void trace_retire(uns proc_id, uns64 inst_uid) {
-  // Trace frontend does not need to communicate to PIN which instruction are
-  // retired.
+  Trace_Hist* h = &hist[proc_id];
+  while(h->count && HIST_ENTRY(h, 0)->inst_uid <= inst_uid) {
+    ASSERT(proc_id, h->replay);
+    h->head = (h->head + 1) & (h->size - 1);
+    h->count--;
+    h->replay--;
+  }
 }
@@ -36,6 +36,8 @@
 #include "dvfs/dvfs.h"
 #include "dvfs/perf_pred.h"
 #include "frontend/frontend_intf.h"
+#include "lsq.h"
 #include "memory/cache_part.h"
+#include "memory/nuca.h"
 
 #endif  // __PARAM_ENUM_HEADERS_H__
@@ -50,6 +50,7 @@
 #include "frontend/pin_trace_fe.h"
 #include "memory/memory.h"
 #include "memory/memory.param.h"
+#include "memory/tlb.h"
 #include "prefetcher/l2l1pref.h"
 #include "prefetcher/stream_pref.h"
 #include "statistics.h"
@@ -85,6 +86,7 @@ extern Rob_Block_Issue_Reason rob_block_issue_reason;
 /* Local prototypes */
 
 static inline void         icache_process_ops(Stage_Data* cur_data);
+static inline void         icache_process_op(Op* op, uns fetch_lag);
 static inline Inst_Info**  lookup_cache(void);
 static inline void         prefetcher_update_on_icache_access(Flag icache_hit);
 static inline void         icache_hit_events(Flag uop_cache_hit);
@@ -214,7 +216,8 @@ void recover_icache_stage() {
   for(ii = 0; ii < cur_data->max_op_count; ii++) {
     if(cur_data->ops[ii]) {
       ASSERT(ic->proc_id, FLUSH_OP(cur_data->ops[ii]));
-      ASSERT(ic->proc_id, cur_data->ops[ii]->off_path);
+      ASSERT(ic->proc_id, cur_data->ops[ii]->off_path ||
+                            bp_recovery_info->load_recovery);
       free_op(cur_data->ops[ii]);
       cur_data->ops[ii] = NULL;
     }
@@ -372,6 +375,11 @@ Flag mem_req_on_icache_miss() {
       ASSERTM(ic->proc_id, ic->line_addr, "ic fetch addr: %llu\n",
               ic->fetch_addr);
     ASSERT_PROC_ID_IN_ADDR(ic->proc_id, ic->line_addr)
+    /* the fill can only be sent once the line is translated */
+    if(TLB_ENABLE && !tlb_translate(ic->proc_id, ic->line_addr, TRUE, ic->off_path)) {
+      STAT_EVENT(ic->proc_id, ICACHE_TLB_STALL);
+      return FALSE;
+    }
     Flag success = FALSE;
     success = new_mem_req(MRT_IFETCH, ic->proc_id, ic->line_addr,
                     ICACHE_LINE_SIZE, 0, NULL, instr_fill_line,
@@ -665,6 +673,8 @@ void update_icache_stage() {
       // mark all ops as fetched from the uop cache
       for(int ii = 0; ii < ic->uopc_sd.op_count; ii++) {
         ic->uopc_sd.ops[ii]->fetched_from_uop_cache = TRUE;
+        if(ic->uopc_sd.ops[ii]->fused_op)
+          ic->uopc_sd.ops[ii]->fused_op->fetched_from_uop_cache = TRUE;
       }
     } else if (ic->state == ICACHE_LOOKUP_SERVING
             || ic->state == ICACHE_NO_LOOKUP_SERVING) {
@@ -816,99 +826,109 @@ static inline void icache_process_ops(Stage_Data* cur_data) {
   for (uns ii = 0; ii < cur_data->op_count; ii++) {
     Op* op = cur_data->ops[ii];
 
-    ASSERTM(ic->proc_id, ic->off_path == op->off_path,
-            "Inconsistent off-path op PC: %llx ic:%i op:%i\n", op->inst_info->addr, ic->off_path, op->off_path);
+    icache_process_op(op, fetch_lag);
+    /* an op fused into this slot is fetched right behind it */
+    if(op->fused_op)
+      icache_process_op(op->fused_op, fetch_lag);
+  }
+}
 
-    if (!op->off_path) {
-      STAT_EVENT(ic->proc_id, UOPS_SERVED_BY_ICACHE_ON_PATH + op->fetched_from_uop_cache);
-    } else {
-      STAT_EVENT(ic->proc_id, UOPS_SERVED_BY_ICACHE_OFF_PATH + op->fetched_from_uop_cache);
-    }
+/**************************************************************************************/
+/* icache_process_op: process a single fetched op in program order.*/
 
-    if(!op->off_path &&
-       (op->table_info->mem_type == MEM_LD ||
-        op->table_info->mem_type == MEM_ST) &&
-       op->oracle_info.va == 0) {
-      // don't care if the va is 0x0 if mem_type is MEM_PF(SW prefetch),
-      // MEM_WH(write hint), or MEM_EVICT(cache block eviction hint)
-      print_func_op(op);
-      FATAL_ERROR(ic->proc_id, "Access to 0x0\n");
-    }
+static inline void icache_process_op(Op* op, uns fetch_lag) {
+  ASSERTM(ic->proc_id, ic->off_path == op->off_path,
+          "Inconsistent off-path op PC: %llx ic:%i op:%i\n", op->inst_info->addr, ic->off_path, op->off_path);
 
-    if(DUMP_TRACE && DEBUG_RANGE_COND(ic->proc_id))
-      print_func_op(op);
+  if (!op->off_path) {
+    STAT_EVENT(ic->proc_id, UOPS_SERVED_BY_ICACHE_ON_PATH + op->fetched_from_uop_cache);
+  } else {
+    STAT_EVENT(ic->proc_id, UOPS_SERVED_BY_ICACHE_OFF_PATH + op->fetched_from_uop_cache);
+  }
 
-    if(DIE_ON_CALLSYS && !op->off_path) {
-      ASSERT(ic->proc_id, op->table_info->cf_type != CF_SYS);
-    }
+  if(!op->off_path &&
+     (op->table_info->mem_type == MEM_LD ||
+      op->table_info->mem_type == MEM_ST) &&
+     op->oracle_info.va == 0) {
+    // don't care if the va is 0x0 if mem_type is MEM_PF(SW prefetch),
+    // MEM_WH(write hint), or MEM_EVICT(cache block eviction hint)
+    print_func_op(op);
+    FATAL_ERROR(ic->proc_id, "Access to 0x0\n");
+  }
 
-    /* add to sequential op list */
-    add_to_seq_op_list(td, op);
-
-    ASSERT(ic->proc_id, td->seq_op_list.count <= op_pool_active_ops);
-
-    /* map the op based on true dependencies & set information in
-     * op->oracle_info */
-    /* num cycles since last group issued */
-    op->fetch_lag = fetch_lag;
-
-    thread_map_op(op);
-
-    STAT_EVENT(op->proc_id, FETCH_ALL_INST);
-    STAT_EVENT(op->proc_id, ORACLE_ON_PATH_INST + op->off_path);
-    STAT_EVENT(op->proc_id, ORACLE_ON_PATH_INST_MEM +
-               (op->table_info->mem_type == NOT_MEM) +
-               2 * op->off_path);
-
-    thread_map_mem_dep(op);
-    op->fetch_cycle = cycle_count;
-
-    op_count[ic->proc_id]++;          /* increment instruction counters */
-    unique_count_per_core[ic->proc_id]++;
-    unique_count++;
-    /* check trigger */
-    if(op->inst_info->trigger_op_fetched_hook)
-      model->op_fetched_hook(op);
-
-    INC_STAT_EVENT(ic->proc_id, INST_LOST_FETCH + ic->off_path, 1);
-
-    DEBUG(ic->proc_id,
-          "Fetching op from Icache addr: %s off: %d inst_info: %p ii_addr: %s "
-          "dis: %s opnum: (%s:%s)\n",
-          hexstr64s(op->inst_info->addr), op->off_path, op->inst_info,
-          hexstr64s(op->inst_info->addr), disasm_op(op, TRUE),
-          unsstr64(op->op_num), unsstr64(op->unique_num));
-
-    if(op->table_info->cf_type) {
-      //TODO: can we move this prefetch update to decoupled front-end or need it be here?
-      if(DJOLT_ENABLE)
-        update_djolt(ic->proc_id, op->inst_info->addr, op->table_info->cf_type, op->oracle_info.pred_npc);
-
-      ASSERT(ic->proc_id,
-             (op->oracle_info.mispred << 2 | op->oracle_info.misfetch << 1 |
-              op->oracle_info.btb_miss) <= 0x7);
-
-      inc_bstat_fetched(op);
-
-      ic->off_path = ic->off_path || op->oracle_info.recover_at_decode || op->oracle_info.recover_at_exec;
-
-      // Measuring basic block lengths
-      /*static int bbl_len = 0;
-      static int bbl_len_dont_end_pred_nt = 0;
-      bbl_len++;
-      bbl_len_dont_end_pred_nt++;
-      if (op->table_info->cf_type) {
-        STAT_EVENT(ic->proc_id, BBL_LENGTH_1 + bbl_len-1);
-        bbl_len = 0;
-        if (op->oracle_info.pred == TAKEN) {
-          STAT_EVENT(ic->proc_id, BBL_DONT_END_PRED_NT_LENGTH_1 + bbl_len_dont_end_pred_nt-1);
-          bbl_len_dont_end_pred_nt = 0;
-        }
-      }*/
-    } else {
-      // pass the global branch history to all the instructions
-      op->oracle_info.pred_global_hist = g_bp_data->global_hist;
-    }
+  if(DUMP_TRACE && DEBUG_RANGE_COND(ic->proc_id))
+    print_func_op(op);
+
+  if(DIE_ON_CALLSYS && !op->off_path) {
+    ASSERT(ic->proc_id, op->table_info->cf_type != CF_SYS);
+  }
+
+  /* add to sequential op list */
+  add_to_seq_op_list(td, op);
+
+  ASSERT(ic->proc_id, td->seq_op_list.count <= op_pool_active_ops);
+
+  /* map the op based on true dependencies & set information in
+   * op->oracle_info */
+  /* num cycles since last group issued */
+  op->fetch_lag = fetch_lag;
+
+  thread_map_op(op);
+
+  STAT_EVENT(op->proc_id, FETCH_ALL_INST);
+  STAT_EVENT(op->proc_id, ORACLE_ON_PATH_INST + op->off_path);
+  STAT_EVENT(op->proc_id, ORACLE_ON_PATH_INST_MEM +
+             (op->table_info->mem_type == NOT_MEM) +
+             2 * op->off_path);
+
+  thread_map_mem_dep(op);
+  op->fetch_cycle = cycle_count;
+
+  op_count[ic->proc_id]++;          /* increment instruction counters */
+  unique_count_per_core[ic->proc_id]++;
+  unique_count++;
+  /* check trigger */
+  if(op->inst_info->trigger_op_fetched_hook)
+    model->op_fetched_hook(op);
+
+  INC_STAT_EVENT(ic->proc_id, INST_LOST_FETCH + ic->off_path, 1);
+
+  DEBUG(ic->proc_id,
+        "Fetching op from Icache addr: %s off: %d inst_info: %p ii_addr: %s "
+        "dis: %s opnum: (%s:%s)\n",
+        hexstr64s(op->inst_info->addr), op->off_path, op->inst_info,
+        hexstr64s(op->inst_info->addr), disasm_op(op, TRUE),
+        unsstr64(op->op_num), unsstr64(op->unique_num));
+
+  if(op->table_info->cf_type) {
+    //TODO: can we move this prefetch update to decoupled front-end or need it be here?
+    if(DJOLT_ENABLE)
+      update_djolt(ic->proc_id, op->inst_info->addr, op->table_info->cf_type, op->oracle_info.pred_npc);
+
+    ASSERT(ic->proc_id,
+           (op->oracle_info.mispred << 2 | op->oracle_info.misfetch << 1 |
+            op->oracle_info.btb_miss) <= 0x7);
+
+    inc_bstat_fetched(op);
+
+    ic->off_path = ic->off_path || op->oracle_info.recover_at_decode || op->oracle_info.recover_at_exec;
+
+    // Measuring basic block lengths
+    /*static int bbl_len = 0;
+    static int bbl_len_dont_end_pred_nt = 0;
+    bbl_len++;
+    bbl_len_dont_end_pred_nt++;
+    if (op->table_info->cf_type) {
+      STAT_EVENT(ic->proc_id, BBL_LENGTH_1 + bbl_len-1);
+      bbl_len = 0;
+      if (op->oracle_info.pred == TAKEN) {
+        STAT_EVENT(ic->proc_id, BBL_DONT_END_PRED_NT_LENGTH_1 + bbl_len_dont_end_pred_nt-1);
+        bbl_len_dont_end_pred_nt = 0;
+      }
+    }*/
+  } else {
+    // pass the global branch history to all the instructions
+    op->oracle_info.pred_global_hist = g_bp_data->global_hist;
   }
 }
 
@@ -0,0 +1,892 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : interval_model.c
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Interval core model (see interval_model.h).
+ *
+ *   Each cycle a core retires, then lets the memory ops whose exec_cycle has
+ *   come access the dcache, then dispatches. Dispatch fetches ops straight
+ *   from the frontend, maps their dependences with map.c as the icache stage
+ *   does, predicts branches with bp.c and looks up the icache. An op is put
+ *   on its producers' wake up lists when it is dispatched, and producers wake
+ *   their consumers as soon as their completion time is known, which may be
+ *   in the future: the exec_cycle of an op is the latest wake_cycle of its
+ *   producers plus its latency (and, for a non-pipelined op, the time its
+ *   unit frees up). A chain of non-memory ops is thus timed in one go.
+ *   Loads and stores look up the dcache at their exec_cycle and misses go to
+ *   the memory system like the dcache stage's; the fill wakes the load's
+ *   consumers through dcache_fill_line. Independent loads behind a miss
+ *   still issue their own, so misses overlap up to the window size and the
+ *   memory system's request buffers.
+ *
+ *   A core is only stepped on the cycles something can happen to it: the
+ *   oldest op retires, a dispatch stall ends, a memory op accesses the dcache
+ *   or a fill completes an op it waits on. The cycles in between are counted
+ *   in bulk the next time it runs. When no core is due before the memory
+ *   system's next event (a queued request's rdy_cycle, or the end of
+ *   ramulator's idle ticks), time jumps straight there and the skipped
+ *   memory cycles are accounted for in bulk as well.
+ *
+ *   A mispredicted branch stops dispatch until it has executed plus the
+ *   frontend refill (icache, decode and map stages). The predictor is
+ *   recovered right away since no younger branch is predicted meanwhile, and
+ *   updated when the branch retires. There is no wrong-path fetch.
+ *
+ *   The model is built on the cmp model's per-core state (cmp_init): the
+ *   icache and dcache, branch predictor, memory system, prefetchers and TLB
+ *   are those of the cmp model and its warmup is reused. The pipeline stages
+ *   are initialized but never clocked.
+ ***************************************************************************************/
+
+#include "debug/debug_macros.h"
+#include "debug/debug_print.h"
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "bp/bp.h"
+#include "cmp_model.h"
+#include "decode_stage.h"
+#include "freq.h"
+#include "frontend/frontend.h"
+#include "interval_model.h"
+#include "map.h"
+#include "memory/cache_part.h"
+#include "memory/coherence.h"
+#include "memory/memory.h"
+#include "memory/tlb.h"
+#include "model.h"
+#include "node_stage.h"
+#include "op_pool.h"
+#include "prefetcher/pref_common.h"
+#include "sim.h"
+#include "statistics.h"
+#include "thread.h"
+
+#include "bp/bp.param.h"
+#include "core.param.h"
+#include "debug/debug.param.h"
+#include "general.param.h"
+#include "memory/memory.param.h"
+#include "prefetcher/pref.param.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_INTERVAL_MODEL, ##args)
+#define WINDOW_ENTRY(core, op_num) \
+  (&(core)->window[(uns)((op_num) % NODE_TABLE_OPS)])
+/* cycles from redirecting fetch to dispatching the first correct op */
+#define REFILL_CYCLES (ICACHE_LATENCY + DECODE_CYCLES + MAP_CYCLES)
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static void interval_reset_core(Interval_Core* core);
+static Counter interval_due_cycle(Interval_Core* core);
+static void interval_skip_idle_time(void);
+static void interval_core_cycle(Interval_Core* core);
+static Counter interval_next_cycle(Interval_Core* core);
+static uns  interval_idle_stat(Interval_Core* core);
+static void interval_retire(Interval_Core* core);
+static void interval_retire_op(Interval_Core* core, Op* op);
+static void interval_exec(Interval_Core* core);
+static void interval_ready(Interval_Core* core, Interval_Entry* entry);
+static void interval_complete(Interval_Entry* entry, Counter done_cycle);
+static void interval_mem_access(Interval_Core* core, Interval_Entry* entry);
+static void interval_dispatch(Interval_Core* core);
+static void interval_dispatch_op(Interval_Core* core, Op* op);
+static Flag interval_stall_done(Interval_Core* core);
+static Flag interval_icache_access(Interval_Core* core, Op* op);
+static void interval_recover(void);
+static Flag interval_icache_fill(Mem_Req* req);
+
+/**************************************************************************************/
+/* Global variables */
+
+static Interval_Core* cores;
+
+/**************************************************************************************/
+/* interval_init */
+
+void interval_init(uns mode) {
+  cmp_init(mode);
+  if(mode != WARMUP_MODE)
+    return;
+
+  cores = (Interval_Core*)calloc(NUM_CORES, sizeof(Interval_Core));
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Interval_Core* core = &cores[proc_id];
+    core->proc_id       = proc_id;
+    core->window = (Interval_Entry*)calloc(NODE_TABLE_OPS, sizeof(Interval_Entry));
+    core->exec_op_nums = (Counter*)calloc(NODE_TABLE_OPS, sizeof(Counter));
+    core->head_op_num = 1;
+    core->next_op_num = 1;
+    interval_reset_core(core);
+  }
+}
+
+/**************************************************************************************/
+/* interval_reset_core: flush the window and the dispatch state */
+
+static void interval_reset_core(Interval_Core* core) {
+  for(; core->head_op_num < core->next_op_num; core->head_op_num++) {
+    Interval_Entry* entry = WINDOW_ENTRY(core, core->head_op_num);
+    free_op(entry->op);
+    entry->op = NULL;
+  }
+  if(core->fetch_op)
+    free_op(core->fetch_op);
+  core->fetch_op        = NULL;
+  core->slots           = 0;
+  core->num_exec_ops    = 0;
+  core->next_exec_cycle = MAX_CTR;
+  core->stall           = INTERVAL_STALL_NONE;
+  core->stall_op        = NULL;
+  core->last_line_addr  = 0;
+  core->next_cycle      = 0;
+  core->last_cycle      = 0;
+  memset(core->unpipelined_free_cycle, 0,
+         sizeof(core->unpipelined_free_cycle));
+}
+
+/**************************************************************************************/
+/* interval_reset */
+
+void interval_reset() {
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    cmp_set_all_stages(proc_id);
+    interval_reset_core(&cores[proc_id]);
+  }
+  cmp_reset();
+}
+
+/**************************************************************************************/
+/* interval_cycle */
+
+void interval_cycle() {
+  update_memory();
+
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    if(DUMB_CORE_ON && DUMB_CORE == proc_id)
+      continue;
+
+    if(freq_is_ready(FREQ_DOMAIN_CORES[proc_id])) {
+      cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+
+      update_tlb(proc_id);
+      if(cycle_count < interval_due_cycle(&cores[proc_id]))
+        continue;
+
+      set_bp_data(&cmp_model.bp_data[proc_id]);
+      set_bp_recovery_info(&cmp_model.bp_recovery_info[proc_id]);
+      cmp_set_all_stages(proc_id);
+      interval_core_cycle(&cores[proc_id]);
+    }
+  }
+
+  cache_part_update();
+  interval_skip_idle_time();
+}
+
+/**************************************************************************************/
+/* interval_skip_idle_time: advance time straight to the next cycle on which
+   a core or the memory system has something to do. The cycles skipped are
+   those no core is due in and update_memory would only count. */
+
+static void interval_skip_idle_time() {
+  if(DUMB_CORE_ON || L1_PART_ON)
+    return;
+
+  Counter next_time = freq_next_time();
+  // do not skip the cycles sim.c checks forward progress at
+  Counter core0_cycle = freq_cycle_count(FREQ_DOMAIN_CORES[0]);
+  Counter until       = freq_cycle_start_time(
+    FREQ_DOMAIN_CORES[0],
+    (core0_cycle / FORWARD_PROGRESS_INTERVAL + 1) * FORWARD_PROGRESS_INTERVAL);
+
+  for(uns proc_id = 0; proc_id < NUM_CORES && until > next_time; proc_id++) {
+    Freq_Domain_Id domain = FREQ_DOMAIN_CORES[proc_id];
+    cycle_count           = freq_cycle_count(domain);
+    Counter cycle         = MIN2(interval_due_cycle(&cores[proc_id]),
+                                 tlb_next_cycle(proc_id));
+    if(cycle != MAX_CTR)
+      until = MIN2(until,
+                   freq_cycle_start_time(domain, MAX2(cycle, cycle_count + 1)));
+  }
+  if(until <= next_time)
+    return;
+  until = MIN2(until, memory_next_event_time());
+  if(until <= next_time)
+    return;
+
+  Counter l1_cycles  = freq_cycle_count(FREQ_DOMAIN_L1);
+  Counter mem_cycles = freq_cycle_count(FREQ_DOMAIN_MEMORY);
+  freq_skip_to_time(until);
+  l1_cycles  = freq_cycle_count(FREQ_DOMAIN_L1) - l1_cycles;
+  mem_cycles = freq_cycle_count(FREQ_DOMAIN_MEMORY) - mem_cycles;
+  memory_skip_cycles(l1_cycles, mem_cycles);
+  INC_STAT_EVENT(0, INTERVAL_SKIPPED_L1_CYCLES, l1_cycles);
+}
+
+/**************************************************************************************/
+/* interval_debug */
+
+void interval_debug() {
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Interval_Core* core = &cores[proc_id];
+    cycle_count         = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+
+    FPRINT_LINE(proc_id, GLOBAL_DEBUG_STREAM);
+    DPRINTF("# INTERVAL  ops:%llu  slots:%u  stall:%u  next_exec:%s\n",
+            core->next_op_num - core->head_op_num, core->slots, core->stall,
+            unsstr64(core->next_exec_cycle));
+    for(Counter op_num = core->head_op_num; op_num < core->next_op_num;
+        op_num++) {
+      Interval_Entry* entry = WINDOW_ENTRY(core, op_num);
+      DPRINTF("%s  %-20s  state:%u  not_rdy:%x  src_rdy:%s  done:%s\n",
+              unsstr64(op_num), disasm_op(entry->op, FALSE), entry->state,
+              entry->op->srcs_not_rdy_vector, unsstr64(entry->src_rdy),
+              unsstr64(entry->op->done_cycle));
+    }
+    FPRINT_LINE(proc_id, GLOBAL_DEBUG_STREAM);
+  }
+
+  debug_memory();
+}
+
+/**************************************************************************************/
+/* interval_wake: src_op's result is available at its wake_cycle. The not
+   ready bit has already been cleared by wake_up_ops. */
+
+void interval_wake(Op* src_op, Op* dep_op, uns8 rdy_bit) {
+  Interval_Core*  core  = &cores[dep_op->proc_id];
+  Interval_Entry* entry = WINDOW_ENTRY(core, dep_op->op_num);
+  UNUSED(rdy_bit);
+
+  ASSERT(dep_op->proc_id, entry->op == dep_op);
+  ASSERT(dep_op->proc_id, src_op->wake_cycle != MAX_CTR);
+  entry->src_rdy = MAX2(entry->src_rdy, src_op->wake_cycle);
+  if(entry->state == IOS_WAIT_SRC && !dep_op->srcs_not_rdy_vector)
+    interval_ready(core, entry);
+}
+
+/**************************************************************************************/
+/* interval_due_cycle: the cycle from which the core has something to do:
+   the cycle interval_next_cycle picked or the next memory op access, or
+   right away if since the core last ran a fill has completed the oldest op
+   or the mispredicted branch dispatch waits for. */
+
+static Counter interval_due_cycle(Interval_Core* core) {
+  Counter due = MIN2(core->next_cycle, core->next_exec_cycle);
+  Op*     op;
+
+  if(core->head_op_num < core->next_op_num) {
+    Interval_Entry* head = WINDOW_ENTRY(core, core->head_op_num);
+    op                   = head->op;
+    // a filled op leaves IOS_WAIT_MEM at the next retire attempt
+    if(head->state == IOS_WAIT_MEM && op->done_cycle != MAX_CTR)
+      return 0;
+    due = MIN2(due, op->done_cycle);
+  }
+  if(core->stall == INTERVAL_STALL_BR_RESOLVE) {
+    op = core->stall_op;
+    if(!op->op_pool_valid || op->unique_num != core->stall_unique ||
+       op->done_cycle != MAX_CTR)
+      return 0;
+  }
+  return due;
+}
+
+/**************************************************************************************/
+/* interval_core_cycle */
+
+static void interval_core_cycle(Interval_Core* core) {
+  uns8 proc_id = core->proc_id;
+
+  // the cycles the core sat out dispatched nothing, for the reason its last
+  // cycle left behind
+  if(cycle_count > core->last_cycle + 1) {
+    Counter idle_cycles = cycle_count - core->last_cycle - 1;
+    uns     idle_stat   = interval_idle_stat(core);
+    INC_STAT_EVENT(proc_id, NODE_CYCLE, idle_cycles);
+    INC_STAT_EVENT(proc_id, idle_stat, idle_cycles);
+    if(idle_stat == INTERVAL_CYCLES_WINDOW_FULL_MEM ||
+       idle_stat == INTERVAL_CYCLES_WINDOW_FULL_OTHER)
+      INC_STAT_EVENT(proc_id, FULL_WINDOW_STALL, idle_cycles);
+  }
+  STAT_EVENT(proc_id, NODE_CYCLE);
+
+  interval_retire(core);
+  if(cycle_count >= core->next_exec_cycle)
+    interval_exec(core);
+  interval_dispatch(core);
+
+  core->last_cycle = cycle_count;
+  core->next_cycle = interval_next_cycle(core);
+}
+
+/**************************************************************************************/
+/* interval_next_cycle: the next cycle the core has to run whatever happens in
+   the memory system: the oldest op retires, a dispatch stall ends or dispatch
+   goes on. Memory op accesses are timed by next_exec_cycle. */
+
+static Counter interval_next_cycle(Interval_Core* core) {
+  Counter next = MAX_CTR;
+  Op*     op;
+
+  if(core->head_op_num < core->next_op_num) {
+    Interval_Entry* head = WINDOW_ENTRY(core, core->head_op_num);
+    if(head->state == IOS_DONE)
+      next = MAX2(head->op->done_cycle, cycle_count + 1);
+  }
+
+  switch(core->stall) {
+    case INTERVAL_STALL_NONE:
+      // a full window waits for the oldest op to retire
+      if(core->slots < NODE_TABLE_SIZE &&
+         core->next_op_num - core->head_op_num < NODE_TABLE_OPS)
+        return cycle_count + 1;
+      break;
+    case INTERVAL_STALL_BR_RESOLVE:
+      op = core->stall_op;
+      if(!op->op_pool_valid || op->unique_num != core->stall_unique ||
+         op->done_cycle != MAX_CTR)
+        return cycle_count + 1;
+      break;
+    case INTERVAL_STALL_REFILL:
+      next = MIN2(next, MAX2(core->stall_cycle, cycle_count + 1));
+      break;
+    case INTERVAL_STALL_ICACHE:
+      // the line may come in with a request that has another done_func
+      return cycle_count + 1;
+    case INTERVAL_STALL_BAR_FETCH:
+      break;
+    default:
+      ASSERT(core->proc_id, FALSE);
+  }
+  return next;
+}
+
+/**************************************************************************************/
+/* interval_retire: retire up to NODE_RET_WIDTH window entries in order */
+
+static void interval_retire(Interval_Core* core) {
+  uns ret_count = 0;
+
+  while(core->head_op_num < core->next_op_num) {
+    Interval_Entry* entry = WINDOW_ENTRY(core, core->head_op_num);
+    Op*             op    = entry->op;
+
+    // dcache_fill_line sets the done_cycle of the ops waiting on a fill
+    if(entry->state == IOS_WAIT_MEM && op->done_cycle != MAX_CTR)
+      entry->state = IOS_DONE;
+    if(entry->state != IOS_DONE || !OP_DONE(op))
+      break;
+    // a fused pair takes one retire slot and retires as a whole
+    if(!op->fused) {
+      if(ret_count == NODE_RET_WIDTH)
+        break;
+      if(core->head_op_num + 1 < core->next_op_num) {
+        Interval_Entry* next = WINDOW_ENTRY(core, core->head_op_num + 1);
+        if(next->op->fused && (next->state != IOS_DONE || !OP_DONE(next->op)))
+          break;
+      }
+      ret_count++;
+    }
+
+    interval_retire_op(core, op);
+    entry->op = NULL;
+    core->head_op_num++;
+  }
+}
+
+/**************************************************************************************/
+/* interval_retire_op: the parts of node_retire that are not about the node
+   table */
+
+static void interval_retire_op(Interval_Core* core, Op* op) {
+  uns8 proc_id = core->proc_id;
+
+  DEBUG(proc_id, "Retiring op_num:%s\n", unsstr64(op->op_num));
+  STAT_EVENT(proc_id, RET_ALL_INST);
+  STAT_EVENT(proc_id, OP_RETIRED);
+
+  if(op->eom) {
+    inst_count[proc_id]++;
+    STAT_EVENT(proc_id, NODE_INST_COUNT);
+
+    if(op->fetched_instruction) {
+      inst_count_fetched[proc_id]++;
+      STAT_EVENT(proc_id, NODE_INST_COUNT_FETCHED);
+    }
+
+    Flag retire_op = IS_CALLSYS(op->table_info) ||
+                     op->table_info->bar_type & BAR_FETCH ||
+                     (inst_count[proc_id] % NODE_RETIRE_RATE == 0);
+
+    if(op->exit) {
+      retired_exit[proc_id] = TRUE;
+      frontend_retire(proc_id, -1);
+    } else if(retire_op) {
+      frontend_retire(proc_id, op->inst_uid);
+    }
+  }
+  uop_count[proc_id]++;
+  STAT_EVENT(proc_id, NODE_UOP_COUNT);
+  if(op->fused)  // both uops of the pair have retired now
+    INC_STAT_EVENT(proc_id, RET_UOP_MACRO_FUSED + op->fused - MACRO_FUSED, 2);
+  else
+    core->slots--;
+
+  if(op->table_info->cf_type) {
+    if(op->table_info->cf_type >= CF_IBR)
+      bp_target_known_op(g_bp_data, op);
+    bp_resolve_op(g_bp_data, op);
+    bp_retire_op(g_bp_data, op);
+  }
+
+  op->retire_cycle = cycle_count;
+  free_op(op);
+}
+
+/**************************************************************************************/
+/* interval_exec: let the memory ops whose exec_cycle has come access the
+   dcache, oldest first. An op that cannot get a translation, a port or a
+   request buffer tries again next cycle. */
+
+static void interval_exec(Interval_Core* core) {
+  uns num_exec_ops      = 0;
+  core->next_exec_cycle = MAX_CTR;
+
+  for(uns ii = 0; ii < core->num_exec_ops; ii++) {
+    Interval_Entry* entry = WINDOW_ENTRY(core, core->exec_op_nums[ii]);
+    Op*             op    = entry->op;
+
+    ASSERT(core->proc_id, entry->state == IOS_WAIT_EXEC);
+    if(cycle_count >= op->exec_cycle)
+      interval_mem_access(core, entry);
+    if(entry->state == IOS_WAIT_EXEC) {
+      core->exec_op_nums[num_exec_ops++] = op->op_num;
+      core->next_exec_cycle = MIN2(core->next_exec_cycle,
+                                   MAX2(op->exec_cycle, cycle_count + 1));
+    }
+  }
+  core->num_exec_ops = num_exec_ops;
+}
+
+/**************************************************************************************/
+/* interval_ready: all of the op's producers have woken it, so its exec_cycle
+   is known */
+
+static void interval_ready(Interval_Core* core, Interval_Entry* entry) {
+  Op*     op        = entry->op;
+  uns     latency   = exec_latency(op);
+  uns     occupancy = exec_occupancy(op);
+  Counter start     = entry->src_rdy;
+  uns     ii;
+
+  if(occupancy > 1) {
+    Counter* free_cycle = &core->unpipelined_free_cycle[op->table_info->op_type];
+    start               = MAX2(start, *free_cycle);
+    *free_cycle         = start + occupancy;
+  }
+  op->sched_cycle = start;
+  op->exec_cycle  = start + latency;
+
+  if(op->table_info->mem_type == NOT_MEM) {
+    interval_complete(entry, op->exec_cycle);
+    return;
+  }
+
+  if(op->table_info->mem_type == MEM_ST) {
+    // like the exec stage, a store hands its address and data to dependent
+    // loads when it executes
+    op->wake_cycle = op->exec_cycle;
+    wake_up_ops(op, MEM_ADDR_DEP, interval_wake);
+    wake_up_ops(op, MEM_DATA_DEP, interval_wake);
+  }
+
+  entry->state = IOS_WAIT_EXEC;
+  for(ii = core->num_exec_ops; ii > 0; ii--) {
+    if(core->exec_op_nums[ii - 1] < op->op_num)
+      break;
+    core->exec_op_nums[ii] = core->exec_op_nums[ii - 1];
+  }
+  core->exec_op_nums[ii] = op->op_num;
+  core->num_exec_ops++;
+  core->next_exec_cycle = MIN2(core->next_exec_cycle,
+                               MAX2(op->exec_cycle, cycle_count + 1));
+}
+
+/**************************************************************************************/
+/* interval_complete: the op's result is available at done_cycle */
+
+static void interval_complete(Interval_Entry* entry, Counter done_cycle) {
+  Op* op = entry->op;
+
+  op->done_cycle = done_cycle;
+  entry->state   = IOS_DONE;
+  if(op->table_info->mem_type != MEM_ST) {
+    op->wake_cycle = done_cycle;
+    wake_up_ops(op, REG_DATA_DEP, interval_wake);
+  }
+}
+
+/**************************************************************************************/
+/* interval_mem_access: the dcache stage's access for a memory op whose
+   address is ready. The op stays in IOS_WAIT_EXEC if it cannot get a
+   translation, a port or a request buffer. */
+
+static void interval_mem_access(Interval_Core* core, Interval_Entry* entry) {
+  Op*          op       = entry->op;
+  uns8         proc_id  = core->proc_id;
+  Addr         va       = op->oracle_info.va;
+  Mem_Type     mem_type = op->table_info->mem_type;
+  uns          latency  = DCACHE_CYCLES + op->inst_info->extra_ld_latency;
+  Dcache_Data* line;
+  Addr         line_addr;
+
+  if(TLB_ENABLE && !tlb_translate(proc_id, va, FALSE, op->off_path)) {
+    STAT_EVENT(proc_id, DCACHE_TLB_STALL);
+    return;
+  }
+
+  uns bank = va >> dc->dcache.shift_bits & N_BIT_MASK(LOG2(DCACHE_BANKS));
+  if(!PERFECT_DCACHE && ((mem_type == MEM_ST && !get_write_port(&dc->ports[bank])) ||
+                         (mem_type != MEM_ST && !get_read_port(&dc->ports[bank]))))
+    return;
+
+  if(PERFECT_DCACHE || (mem_type == MEM_PF && !ENABLE_SWPRF)) {
+    interval_complete(entry, cycle_count + latency);
+    return;
+  }
+
+  line = (Dcache_Data*)cache_access(&dc->dcache, va, &line_addr, TRUE);
+  op->dcache_cycle = cycle_count;
+
+  if(line) {
+    if(PREF_FRAMEWORK_ON) {
+      if(line->HW_prefetch) {
+        pref_dl0_pref_hit(line_addr, op->inst_info->addr, 0);
+        line->HW_prefetch = FALSE;
+      } else {
+        pref_dl0_hit(line_addr, op->inst_info->addr);
+      }
+    }
+    STAT_EVENT(proc_id, DCACHE_HIT);
+    STAT_EVENT(proc_id, DCACHE_HIT_ONPATH);
+
+    if(mem_type == MEM_ST) {
+      line->dirty = TRUE;
+      if(COHERENCE_ON && line->coh_state != COH_M)
+        line->coh_state = coh_upgrade(proc_id, line_addr, line->coh_state);
+    }
+    line->read_count[0] += mem_type == MEM_LD;
+    line->write_count[0] += mem_type == MEM_ST;
+
+    interval_complete(entry, cycle_count + latency);
+    return;
+  }
+
+  if(mem_type == MEM_LD) {
+    if(scan_stores(va, op->oracle_info.mem_size)) {
+      STAT_EVENT(proc_id, DCACHE_ST_BUFFER_HIT);
+      STAT_EVENT(proc_id, DCACHE_ST_BUFFER_HIT_ONPATH);
+      interval_complete(entry, cycle_count + latency);
+      return;
+    }
+    if(!new_mem_req(MRT_DFETCH, proc_id, line_addr, DCACHE_LINE_SIZE,
+                    latency - 1, op, dcache_fill_line, op->unique_num, 0)) {
+      STAT_EVENT(proc_id, DCACHE_MISS_WAITMEM);
+      return;
+    }
+    pref_dl0_miss(line_addr, op->inst_info->addr);
+    STAT_EVENT(proc_id, DCACHE_MISS);
+    STAT_EVENT(proc_id, DCACHE_MISS_ONPATH);
+    STAT_EVENT(proc_id, DCACHE_MISS_LD_ONPATH);
+    STAT_EVENT(proc_id, DCACHE_MISS_LD);
+    op->oracle_info.dcmiss = TRUE;
+    op->engine_info.dcmiss = TRUE;
+    entry->state           = IOS_WAIT_MEM;
+  } else if(mem_type == MEM_ST) {
+    if(!new_mem_req(MRT_DSTORE, proc_id, line_addr, DCACHE_LINE_SIZE,
+                    latency - 1, op, dcache_fill_line, op->unique_num, 0)) {
+      STAT_EVENT(proc_id, DCACHE_MISS_WAITMEM);
+      return;
+    }
+    STAT_EVENT(proc_id, DCACHE_MISS);
+    STAT_EVENT(proc_id, DCACHE_MISS_ONPATH);
+    STAT_EVENT(proc_id, DCACHE_MISS_ST_ONPATH);
+    STAT_EVENT(proc_id, DCACHE_MISS_ST);
+    op->oracle_info.dcmiss = TRUE;
+    entry->state           = IOS_WAIT_MEM;
+    if(STORES_DO_NOT_BLOCK_WINDOW)
+      interval_complete(entry, cycle_count + latency);
+  } else {
+    // software prefetches never hold up the window
+    if(!new_mem_req(MRT_DPRF, proc_id, line_addr, DCACHE_LINE_SIZE,
+                    latency - 1, NULL, dcache_fill_line, op->unique_num,
+                    0)) {
+      STAT_EVENT(proc_id, DCACHE_MISS_WAITMEM);
+      return;
+    }
+    interval_complete(entry, cycle_count + latency);
+  }
+}
+
+/**************************************************************************************/
+/* interval_dispatch: move up to ISSUE_WIDTH window entries' worth of ops from
+   the frontend into the window and attribute the cycle */
+
+static void interval_dispatch(Interval_Core* core) {
+  uns8 proc_id    = core->proc_id;
+  uns  dispatched = 0;
+  uns  cf_num     = 0;
+  Op*  prev       = NULL;
+
+  while(dispatched < ISSUE_WIDTH && interval_stall_done(core)) {
+    if(core->slots == NODE_TABLE_SIZE ||
+       core->next_op_num - core->head_op_num == NODE_TABLE_OPS) {
+      STAT_EVENT(proc_id, FULL_WINDOW_STALL);
+      break;
+    }
+
+    Op* op = core->fetch_op;
+    if(!op) {
+      if(!frontend_can_fetch_op(proc_id) ||
+         (BP_MECH != MTAGE_BP && !bp_is_predictable(g_bp_data, proc_id)))
+        break;
+      op = alloc_op(proc_id);
+      frontend_fetch_op(proc_id, op);
+      op->op_num      = core->next_op_num;
+      op->off_path    = FALSE;
+      op->fetch_cycle = cycle_count;
+      STAT_EVENT(proc_id, FETCH_ALL_INST);
+      STAT_EVENT(proc_id, ORACLE_ON_PATH_INST);
+      op_count[proc_id]++;
+      unique_count_per_core[proc_id]++;
+      unique_count++;
+      if(op->table_info->cf_type) {
+        bp_predict_op(g_bp_data, op, cf_num++, op->inst_info->addr);
+        inc_bstat_fetched(op);
+      }
+      thread_map_op(op);
+      thread_map_mem_dep(op);
+    }
+    if(!interval_icache_access(core, op)) {
+      core->fetch_op = op;
+      break;
+    }
+    core->fetch_op = NULL;
+
+    if(prev)
+      op->fused = decode_stage_fusion_type(prev, op);
+    interval_dispatch_op(core, op);
+    if(!op->fused)
+      dispatched++;
+    prev = op;
+  }
+
+  STAT_EVENT(proc_id, dispatched ? INTERVAL_CYCLES_BASE :
+                                    interval_idle_stat(core));
+}
+
+/**************************************************************************************/
+/* interval_idle_stat: what a cycle in which the core dispatches nothing is
+   attributed to */
+
+static uns interval_idle_stat(Interval_Core* core) {
+  if(core->stall == INTERVAL_STALL_BR_RESOLVE ||
+     core->stall == INTERVAL_STALL_REFILL)
+    return INTERVAL_CYCLES_BR_MISPRED;
+  if(core->stall == INTERVAL_STALL_ICACHE)
+    return INTERVAL_CYCLES_ICACHE_MISS;
+  if(core->stall == INTERVAL_STALL_BAR_FETCH)
+    return INTERVAL_CYCLES_FETCH_BARRIER;
+  if(core->slots == NODE_TABLE_SIZE ||
+     core->next_op_num - core->head_op_num == NODE_TABLE_OPS)
+    return WINDOW_ENTRY(core, core->head_op_num)->state == IOS_WAIT_MEM ?
+             INTERVAL_CYCLES_WINDOW_FULL_MEM :
+             INTERVAL_CYCLES_WINDOW_FULL_OTHER;
+  if(core->fetch_op)
+    return INTERVAL_CYCLES_ICACHE_MISS;
+  return INTERVAL_CYCLES_FRONTEND;
+}
+
+/**************************************************************************************/
+/* interval_dispatch_op: put an op into the window, put it on its producers'
+   wake up lists and handle a branch misprediction or fetch barrier */
+
+static void interval_dispatch_op(Interval_Core* core, Op* op) {
+  Interval_Entry* entry = WINDOW_ENTRY(core, op->op_num);
+  Cf_Type         cf    = op->table_info->cf_type;
+
+  ASSERT(core->proc_id, op->op_num == core->next_op_num);
+  ASSERT(core->proc_id, entry->op == NULL);
+  DEBUG(core->proc_id, "Dispatching op_num:%s  %s\n", unsstr64(op->op_num),
+        disasm_op(op, FALSE));
+
+  entry->op       = op;
+  entry->state    = IOS_WAIT_SRC;
+  entry->src_rdy  = cycle_count + 1;  // scheduled the cycle after dispatch
+  op->issue_cycle = cycle_count;
+  core->next_op_num++;
+  if(!op->fused)
+    core->slots++;
+
+  // producers that have completed already wake the op right here
+  add_to_wake_up_lists(op, &op->oracle_info, interval_wake);
+  if(entry->state == IOS_WAIT_SRC && !op->srcs_not_rdy_vector)
+    interval_ready(core, entry);
+
+  if((op->table_info->bar_type & BAR_FETCH) || IS_CALLSYS(op->table_info)) {
+    op->oracle_info.recover_at_decode = FALSE;
+    op->oracle_info.recover_at_exec   = FALSE;
+    core->stall                       = INTERVAL_STALL_BAR_FETCH;
+    core->stall_op                    = op;
+    core->stall_unique                = op->unique_num;
+    return;
+  }
+  if(!cf)
+    return;
+
+  // it is a direct branch, so the target is known at decode
+  if(cf <= CF_CALL)
+    bp_target_known_op(g_bp_data, op);
+
+  if(op->oracle_info.recover_at_decode) {
+    bp_sched_recovery(bp_recovery_info, op, cycle_count,
+                      /*late_bp_recovery=*/FALSE, /*force_offpath=*/FALSE);
+    interval_recover();
+    op->oracle_info.misfetch = FALSE;
+    op->oracle_info.btb_miss = FALSE;
+    op->oracle_info.pred     = op->oracle_info.dir;
+    op->oracle_info.mispred  = FALSE;
+    // the branch reaches decode MAP_CYCLES before it would be dispatched
+    core->stall       = INTERVAL_STALL_REFILL;
+    core->stall_cycle = cycle_count + 1 + REFILL_CYCLES - MAP_CYCLES;
+  } else if(op->oracle_info.recover_at_exec) {
+    bp_sched_recovery(bp_recovery_info, op, cycle_count,
+                      /*late_bp_recovery=*/FALSE, /*force_offpath=*/FALSE);
+    interval_recover();
+    core->stall        = INTERVAL_STALL_BR_RESOLVE;
+    core->stall_op     = op;
+    core->stall_unique = op->unique_num;
+  }
+}
+
+/**************************************************************************************/
+/* interval_recover: what cmp_recover does to the branch predictor. The
+   recovery is not delayed until the branch executes because dispatch (and so
+   prediction) is stopped until then anyway. */
+
+static void interval_recover() {
+  bp_recovery_info->recovery_cycle = MAX_CTR;
+  bp_recovery_info->redirect_cycle = MAX_CTR;
+  bp_recover_op(g_bp_data, bp_recovery_info->recovery_cf_type,
+                &bp_recovery_info->recovery_info);
+}
+
+/**************************************************************************************/
+/* interval_stall_done: TRUE if dispatch may proceed this cycle */
+
+static Flag interval_stall_done(Interval_Core* core) {
+  Op*  op = core->stall_op;
+  Flag op_valid;
+  Addr line_addr;
+
+  switch(core->stall) {
+    case INTERVAL_STALL_NONE:
+      return TRUE;
+    case INTERVAL_STALL_BR_RESOLVE:
+      op_valid = op->op_pool_valid && op->unique_num == core->stall_unique;
+      if(op_valid && op->done_cycle == MAX_CTR)
+        return FALSE;
+      core->stall       = INTERVAL_STALL_REFILL;
+      core->stall_cycle = (op_valid ? op->done_cycle : cycle_count) + 1 +
+                          REFILL_CYCLES;
+      // fall through
+    case INTERVAL_STALL_REFILL:
+      if(cycle_count < core->stall_cycle)
+        return FALSE;
+      break;
+    case INTERVAL_STALL_ICACHE:
+      if(!cache_access(&ic->icache, core->stall_line_addr, &line_addr, FALSE))
+        return FALSE;
+      break;
+    case INTERVAL_STALL_BAR_FETCH:
+      if(op->op_pool_valid && op->unique_num == core->stall_unique)
+        return FALSE;
+      break;
+    default:
+      ASSERT(core->proc_id, FALSE);
+  }
+  core->stall = INTERVAL_STALL_NONE;
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* interval_icache_access: TRUE if the line holding op is in the icache. On a
+   miss the line is requested and dispatch waits for it. */
+
+static Flag interval_icache_access(Interval_Core* core, Op* op) {
+  Addr line_addr;
+
+  if(PERFECT_ICACHE)
+    return TRUE;
+  if(core->last_line_addr &&
+     core->last_line_addr ==
+       ROUND_DOWN(op->inst_info->addr, ICACHE_LINE_SIZE))
+    return TRUE;
+
+  STAT_EVENT(core->proc_id, INTERVAL_ICACHE_ACCESS);
+  if(cache_access(&ic->icache, op->inst_info->addr, &line_addr, TRUE)) {
+    core->last_line_addr = line_addr;
+    return TRUE;
+  }
+  if(!new_mem_req(MRT_IFETCH, core->proc_id, line_addr, ICACHE_LINE_SIZE, 0,
+                  NULL, interval_icache_fill, unique_count, 0))
+    return FALSE;
+
+  DEBUG(core->proc_id, "Icache miss line_addr:%s\n", hexstr64s(line_addr));
+  STAT_EVENT(core->proc_id, INTERVAL_ICACHE_MISS);
+  core->stall           = INTERVAL_STALL_ICACHE;
+  core->stall_line_addr = line_addr;
+  return FALSE;
+}
+
+/**************************************************************************************/
+/* interval_icache_fill */
+
+static Flag interval_icache_fill(Mem_Req* req) {
+  Cache* icache = &cmp_model.icache_stage[req->proc_id].icache;
+  Addr   line_addr, repl_line_addr;
+
+  if(!cache_access(icache, req->addr, &line_addr, FALSE))
+    cache_insert(icache, req->proc_id, req->addr, &line_addr, &repl_line_addr);
+  return SUCCESS;
+}
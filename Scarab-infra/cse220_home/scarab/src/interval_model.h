@@ -0,0 +1,113 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : interval_model.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Interval core model. Ops are dispatched in order at
+ *                ISSUE_WIDTH per cycle into a NODE_TABLE_SIZE window and
+ *                retired in order; the gaps between dispatch bursts come from
+ *                miss events (branch mispredictions, icache misses, a window
+ *                filled behind a long-latency load) resolved by the real
+ *                branch predictor and memory system. There is no scheduler
+ *                or register file model, and of the functional units only
+ *                the ones that are not fully pipelined are modeled.
+ ***************************************************************************************/
+
+#ifndef __INTERVAL_MODEL_H__
+#define __INTERVAL_MODEL_H__
+
+#include "globals/global_types.h"
+#include "inst_info.h"
+#include "isa/isa_macros.h"
+#include "op.h"
+#include "table_info.h"
+
+/**************************************************************************************/
+/* Types */
+
+typedef enum Interval_Op_State_enum {
+  IOS_WAIT_SRC,   // a producer's completion time is not known yet
+  IOS_WAIT_EXEC,  // memory op waiting to access the dcache at its exec_cycle
+  IOS_WAIT_MEM,   // memory op waiting for a dcache fill
+  IOS_DONE,       // done_cycle is known
+} Interval_Op_State;
+
+typedef enum Interval_Stall_enum {
+  INTERVAL_STALL_NONE,
+  INTERVAL_STALL_BR_RESOLVE,  // mispredicted branch not executed yet
+  INTERVAL_STALL_REFILL,      // frontend refilling after a redirect
+  INTERVAL_STALL_ICACHE,      // waiting for an icache fill
+  INTERVAL_STALL_BAR_FETCH,   // waiting for a fetch barrier to retire
+} Interval_Stall;
+
+typedef struct Interval_Entry_struct {
+  Op*               op;
+  Interval_Op_State state;
+  Counter           src_rdy;  // cycle the sources woken so far are ready
+} Interval_Entry;
+
+typedef struct Interval_Core_struct {
+  uns8 proc_id;
+
+  /* window: ops indexed by op_num modulo NODE_TABLE_OPS */
+  Interval_Entry* window;
+  Counter         head_op_num;  // oldest op in the window
+  Counter         next_op_num;  // op_num of the next op dispatched
+  uns             slots;        // window entries in use (a fused pair is one)
+
+  /* memory ops in IOS_WAIT_EXEC, by op_num, oldest first */
+  Counter* exec_op_nums;
+  uns      num_exec_ops;
+  Counter  next_exec_cycle;  // earliest exec_cycle among them
+
+  /* an op type that is not fully pipelined (exec_occupancy above 1)
+     executes on one unit, free again at this cycle */
+  Counter unpipelined_free_cycle[NUM_OP_TYPES];
+
+  /* dispatch */
+  Op*            fetch_op;  // fetched op held back by an icache miss
+  Interval_Stall stall;
+  Counter        stall_cycle;   // INTERVAL_STALL_REFILL ends here
+  Op*            stall_op;      // op the stall waits for
+  Counter        stall_unique;  // its unique_num
+  Addr           stall_line_addr;
+  Addr           last_line_addr;  // icache line the last op came from
+
+  /* event skipping: the core is not stepped before next_cycle unless an op
+     it waits on completes (see interval_core_due) */
+  Counter next_cycle;
+  Counter last_cycle;  // last cycle the core was stepped
+} Interval_Core;
+
+/**************************************************************************************/
+/* Prototypes */
+
+void interval_init(uns mode);
+void interval_reset(void);
+void interval_cycle(void);
+void interval_debug(void);
+void interval_wake(Op*, Op*, uns8);
+
+/**************************************************************************************/
+
+#endif /* #ifndef __INTERVAL_MODEL_H__ */
@@ -27,6 +27,9 @@
  ***************************************************************************************/
 
 #include <stdlib.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 #include "debug/debug_macros.h"
 #include "globals/assert.h"
 #include "globals/global_defs.h"
@@ -55,8 +58,18 @@
 
 static inline uns  cache_index(Cache* cache, Addr addr, Addr* tag,
                                Addr* line_addr);
+static inline void init_tag_store(Cache*);
+static inline void cache_sync_tag(Cache*, uns, uns);
+static inline int  cache_find_way(Cache*, uns, Addr);
 static inline void update_repl_policy(Cache*, Cache_Entry*, uns, uns, Flag);
 static inline Cache_Entry* find_repl_entry(Cache*, uns8, uns, uns*);
+static inline Cache_Entry* find_valid_repl_entry(Cache*, uns8, uns, uns*);
+static Cache_Entry* cache_evict_valid_strategy(Cache*, uns8, uns, uns*);
+static inline uns8* cache_repl_row(Cache*, uns);
+static inline int   repl_row_find(const uns8*, uns, uns8, uns8);
+static inline uns8  repl_row_max(const uns8*, uns);
+static inline void  lru_stack_remove(Cache*, uns, uns);
+static inline void  lru_stack_place(Cache*, uns, uns);
 
 /* for ideal replacement */
 static inline void*        access_unsure_lines(Cache*, uns, Addr, Flag);
@@ -68,6 +81,11 @@ static inline void         invalidate_unsure_line(Cache*, uns, Addr);
 
 char rand_repl_state[31];
 
+/* update_evict arg asking for the policy's victim among the valid ways only,
+   for evictions that are not triggered by a missing tag */
+static char evict_valid_only;
+#define EVICT_VALID_ONLY ((void*)&evict_valid_only)
+
 
 /**************************************************************************************/
 
@@ -88,6 +106,92 @@ uns ext_cache_index(Cache* cache, Addr addr, Addr* tag, Addr* line_addr) {
 }
 
 
+/**************************************************************************************/
+/* Packed tag store: lookups compare against the set's row of tag_store
+ * instead of walking the Cache_Entry records. Whatever changes the valid bit
+ * or the tag of an entry must call cache_sync_tag afterwards. */
+
+static inline void init_tag_store(Cache* cache) {
+  uns ii;
+
+  cache->tag_store = (Addr*)malloc(sizeof(Addr) * cache->num_sets *
+                                   cache->assoc);
+  for(ii = 0; ii < cache->num_sets * cache->assoc; ii++)
+    cache->tag_store[ii] = INVALID_TAG_STORE;
+  cache->comp_size      = NULL;
+  cache->comp_set_bytes = NULL;
+}
+
+static inline void cache_sync_tag(Cache* cache, uns set, uns way) {
+  Cache_Entry* line = &cache->entries[set][way];
+  cache->tag_store[set * cache->assoc + way] = line->valid ? line->tag :
+                                                             INVALID_TAG_STORE;
+  /* a way becoming valid gets its state from the policy's update_insert */
+  if(cache->repl_state && !line->valid) {
+    if(cache->repl_policy < REPL_VOID)
+      lru_stack_remove(cache, set, way);
+    cache->repl_state[set * cache->assoc + way] = REPL_STATE_INVALID;
+  }
+  /* a newly inserted line is uncompressed until cache_set_comp_size */
+  if(cache->comp_size) {
+    uns16* size = &cache->comp_size[set * cache->assoc + way];
+    cache->comp_set_bytes[set] -= *size;
+    *size = line->valid ? cache->line_size : 0;
+    cache->comp_set_bytes[set] += *size;
+  }
+}
+
+/* A valid line may legitimately carry the INVALID_TAG_STORE value as its tag,
+   so a matching way is only a hit once its valid bit is confirmed. */
+static inline int cache_first_valid_way(Cache* cache, uns set, uns base,
+                                        uns match_mask) {
+  for(; match_mask; match_mask &= match_mask - 1) {
+    uns way = base + __builtin_ctz(match_mask);
+    if(cache->entries[set][way].valid)
+      return way;
+  }
+  return -1;
+}
+
+/* cache_find_way: returns the way holding a valid line with this tag, -1 if
+ * there is none */
+static inline int cache_find_way(Cache* cache, uns set, Addr tag) {
+  const Addr* tags = &cache->tag_store[set * cache->assoc];
+  uns         ii   = 0;
+  int         way;
+
+#if defined(__AVX2__)
+  const __m256i key = _mm256_set1_epi64x((long long)tag);
+  for(; ii + 4 <= cache->assoc; ii += 4) {
+    __m256i eq = _mm256_cmpeq_epi64(
+      _mm256_loadu_si256((const __m256i*)(tags + ii)), key);
+    way = cache_first_valid_way(cache, set, ii,
+                                _mm256_movemask_pd(_mm256_castsi256_pd(eq)));
+    if(way >= 0)
+      return way;
+  }
+#elif defined(__SSE2__)
+  /* SSE2 has no 64-bit compare: AND each 32-bit half with its neighbor */
+  const __m128i key = _mm_set1_epi64x((long long)tag);
+  for(; ii + 2 <= cache->assoc; ii += 2) {
+    __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(tags + ii)),
+                                 key);
+    eq  = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    way = cache_first_valid_way(cache, set, ii,
+                                _mm_movemask_pd(_mm_castsi128_pd(eq)));
+    if(way >= 0)
+      return way;
+  }
+#endif
+
+  for(; ii < cache->assoc; ii++) {
+    if(tags[ii] == tag && cache->entries[set][ii].valid)
+      return ii;
+  }
+  return -1;
+}
+
+
 /**************************************************************************************/
 /* init_cache: */
 
@@ -122,9 +226,22 @@ void init_cache(Cache* cache, const char* name, uns cache_size, uns assoc,
 
   /* allocate memory for NMRU replacement counters  */
   cache->repl_ctrs = (uns*)calloc(num_sets, sizeof(uns));
+  cache->repl_state = NULL;
+  cache->plru_tree  = NULL;
+
+  /* LRU stack ranks (see lru_stack_place); partitioned caches keep them too
+     since they run as TRUE_LRU during warmup */
+  if(repl_policy == REPL_TRUE_LRU || repl_policy == REPL_PARTITION) {
+    ASSERTM(0, assoc < REPL_STATE_INVALID, "Cache '%s': assoc %u too large\n",
+            name, assoc);
+    cache->repl_state = (uns8*)malloc(sizeof(uns8) * num_sets * assoc);
+    memset(cache->repl_state, REPL_STATE_INVALID,
+           sizeof(uns8) * num_sets * assoc);
+  }
 
   /* allocate memory for all the sets (pointers to line arrays)  */
   cache->entries = (Cache_Entry**)malloc(sizeof(Cache_Entry*) * num_sets);
+  init_tag_store(cache);
 
   /* allocate memory for the unsure lists (if necessary) */
   if(cache->repl_policy == REPL_IDEAL)
@@ -217,8 +334,7 @@ void init_cache(Cache* cache, const char* name, uns cache_size, uns assoc,
 void* cache_access(Cache* cache, Addr addr, Addr* line_addr, Flag update_repl) {
   Addr tag;
   uns  set = cache_index(cache, addr, &tag, line_addr);
-  uns  ii;
-  void* line_data = NULL;
+  int  way;
 
   if (cache->repl_policy >= REPL_VOID)
     return cache_access_strategy(cache, addr, line_addr, update_repl);
@@ -227,30 +343,26 @@ void* cache_access(Cache* cache, Addr addr, Addr* line_addr, Flag update_repl) {
     return access_ideal_storage(cache, set, tag, addr);
   }
 
-  for(ii = 0; ii < cache->assoc; ii++) {
-    Cache_Entry* line = &cache->entries[set][ii];
+  way = cache_find_way(cache, set, tag);
+  if(way >= 0) {
+    Cache_Entry* line = &cache->entries[set][way];
 
-    if(line->valid && line->tag == tag) {
-      /* update replacement state if necessary */
-      ASSERT(0, line->data);
-      DEBUG(0, "Found line in cache '%s' at (set %u, way %u, base 0x%s)\n",
-            cache->name, set, ii, hexstr64s(line->base));
+    /* update replacement state if necessary */
+    ASSERT(0, line->data);
+    DEBUG(0, "Found line in cache '%s' at (set %u, way %u, base 0x%s)\n",
+          cache->name, set, way, hexstr64s(line->base));
 
-      if(update_repl) {
-        if(line->pref) {
-          line->pref = FALSE;
-        }
-        cache->num_demand_access++;
-        update_repl_policy(cache, line, set, ii, FALSE);
-        DEBUG(0, "(%s, %d) [0x%x, 0x%x]: in access\n\n", cache->name, cache->repl_policy, cache->num_sets, cache->assoc);
+    if(update_repl) {
+      if(line->pref) {
+        line->pref = FALSE;
       }
-
-      line_data = line->data;
+      cache->num_demand_access++;
+      update_repl_policy(cache, line, set, way, FALSE);
+      DEBUG(0, "(%s, %d) [0x%x, 0x%x]: in access\n\n", cache->name, cache->repl_policy, cache->num_sets, cache->assoc);
     }
-  }
 
-  if (line_data)
-    return line_data;
+    return line->data;
+  }
 
   /* if it's a miss and we're doing ideal replacement, look in the unsure list
    */
@@ -341,6 +453,7 @@ void* cache_insert_replpos(Cache* cache, uns8 proc_id, Addr addr,
   new_line->last_access_time = sim_time;  // FIXME: this fixes valgrind warnings
                                           // in update_prf_
   new_line->pref = isPrefetch;
+  cache_sync_tag(cache, set, new_line - cache->entries[set]);
 
   new_line->pw_start_addr = addr; // only means anything for uop cache
 
@@ -392,6 +505,8 @@ void* cache_insert_replpos(Cache* cache, uns8 proc_id, Addr addr,
     default:
       ASSERT(0, FALSE);  // should never come here
   }
+  if(cache->repl_state && insert_repl_policy != INSERT_REPL_DEFAULT)
+    lru_stack_place(cache, set, repl_index);
   if(cache->repl_policy == REPL_IDEAL_STORAGE) {
     new_line->last_access_time = cache->assoc;
     /* debug */
@@ -430,6 +545,7 @@ void* cache_insert_replpos(Cache* cache, uns8 proc_id, Addr addr,
       main_line->tag              = tag;
       main_line->base             = *line_addr;
       main_line->last_access_time = sim_time;
+      cache_sync_tag(cache, set, lru_ind);
     }
   }
   return new_line->data;
@@ -442,15 +558,14 @@ void* cache_insert_replpos(Cache* cache, uns8 proc_id, Addr addr,
 void cache_invalidate(Cache* cache, Addr addr, Addr* line_addr) {
   Addr tag;
   uns  set = cache_index(cache, addr, &tag, line_addr);
-  uns  ii;
-
-  for(ii = 0; ii < cache->assoc; ii++) {
-    Cache_Entry* line = &cache->entries[set][ii];
-    if(line->tag == tag && line->valid) {
-      line->tag   = 0;
-      line->valid = FALSE;
-      line->base  = 0;
-    }
+  int  way;
+
+  while((way = cache_find_way(cache, set, tag)) >= 0) {
+    Cache_Entry* line = &cache->entries[set][way];
+    line->tag   = 0;
+    line->valid = FALSE;
+    line->base  = 0;
+    cache_sync_tag(cache, set, way);
   }
 
   if(cache->repl_policy == REPL_IDEAL)
@@ -499,9 +614,20 @@ Cache_Entry* find_repl_entry(Cache* cache, uns8 proc_id, uns set, uns* way) {
     return cache_evict_strategy(cache, proc_id, set, way);
 
   switch(cache->repl_policy) {
-    case REPL_RESTEER:
-    case REPL_SHADOW_IDEAL:
     case REPL_TRUE_LRU: {
+      /* the first invalid way, otherwise the first at the bottom */
+      uns8* row     = cache_repl_row(cache, set);
+      int   lru_ind = repl_row_find(row, cache->assoc, REPL_STATE_INVALID,
+                                    REPL_STATE_INVALID);
+      if(lru_ind < 0) {
+        uns8 bottom = repl_row_max(row, cache->assoc);
+        lru_ind     = repl_row_find(row, cache->assoc, bottom, bottom);
+      }
+      *way = lru_ind;
+      return &cache->entries[set][lru_ind];
+    } break;
+    case REPL_RESTEER:
+    case REPL_SHADOW_IDEAL: {
       uns     lru_ind  = 0;
       Counter lru_time = MAX_CTR;
       for(ii = 0; ii < cache->assoc; ii++) {
@@ -625,6 +751,59 @@ Cache_Entry* find_repl_entry(Cache* cache, uns8 proc_id, uns set, uns* way) {
 }
 
 
+/**************************************************************************************/
+/* find_valid_repl_entry: like find_repl_entry, but the victim is chosen among
+   the valid ways only, in the policy's own order. */
+
+static inline Cache_Entry* find_valid_repl_entry(Cache* cache, uns8 proc_id,
+                                                 uns set, uns* way) {
+  uns ii;
+
+  if(cache->repl_policy >= REPL_VOID)
+    return cache_evict_valid_strategy(cache, proc_id, set, way);
+
+  switch(cache->repl_policy) {
+    case REPL_TRUE_LRU: {
+      uns8* row     = cache_repl_row(cache, set);
+      uns8  bottom  = repl_row_max(row, cache->assoc);
+      int   lru_ind = repl_row_find(row, cache->assoc, bottom, bottom);
+      ASSERT(proc_id, lru_ind >= 0 && cache->entries[set][lru_ind].valid);
+      *way = lru_ind;
+    } break;
+    case REPL_RESTEER:
+    case REPL_SHADOW_IDEAL: {
+      int     lru_ind  = -1;
+      Counter lru_time = MAX_CTR;
+      for(ii = 0; ii < cache->assoc; ii++) {
+        Cache_Entry* entry = &cache->entries[set][ii];
+        if(entry->valid && (lru_ind < 0 || entry->last_access_time < lru_time)) {
+          lru_ind  = ii;
+          lru_time = entry->last_access_time;
+        }
+      }
+      ASSERT(proc_id, lru_ind >= 0);
+      *way = lru_ind;
+    } break;
+    case REPL_RANDOM:
+    case REPL_NOT_MRU:
+    case REPL_ROUND_ROBIN:
+    case REPL_LOW_PREF: {
+      /* the way the counter points to, or the next valid one after it */
+      for(ii = 0; ii < cache->assoc; ii++) {
+        *way = (cache->repl_ctrs[set] + ii) % cache->assoc;
+        if(cache->entries[set][*way].valid)
+          break;
+      }
+      ASSERT(proc_id, ii < cache->assoc);
+    } break;
+    default:
+      ASSERTM(proc_id, FALSE, "Cache '%s': policy %u cannot pick a valid victim\n",
+              cache->name, cache->repl_policy);
+  }
+  return &cache->entries[set][*way];
+}
+
+
 /**************************************************************************************/
 /* get_next_valid_repl_line: Returns the valid cache lib entry that will be replaced the
    soonest. This call should not change any of the state information. */
@@ -635,9 +814,15 @@ void* get_next_valid_repl_line(Cache* cache, uns8 proc_id, Addr addr) {
   uns set = cache_index(cache, addr, &line_tag, &line_addr);
 
   switch(cache->repl_policy) {
-    case REPL_RESTEER:
-    case REPL_SHADOW_IDEAL:
     case REPL_TRUE_LRU: {
+      uns8* row    = cache_repl_row(cache, set);
+      uns8  bottom = repl_row_max(row, cache->assoc);
+      ii           = repl_row_find(row, cache->assoc, bottom, bottom);
+      if(ii >= 0 && cache->entries[set][ii].valid)
+        entry = &cache->entries[set][ii];
+    } break;
+    case REPL_RESTEER:
+    case REPL_SHADOW_IDEAL: {
       uns     lru_ind  = 0;
       Counter lru_time = MAX_CTR;
       for(ii = 0; ii < cache->assoc; ii++) {
@@ -669,10 +854,13 @@ void* get_next_valid_repl_line(Cache* cache, uns8 proc_id, Addr addr) {
 static inline void update_repl_policy(Cache* cache, Cache_Entry* cur_entry,
                                       uns set, uns way, Flag repl) {
   switch(cache->repl_policy) {
-    case REPL_IDEAL_STORAGE:
-    case REPL_SHADOW_IDEAL:
     case REPL_TRUE_LRU:
     case REPL_PARTITION:
+      cur_entry->last_access_time = sim_time;
+      lru_stack_place(cache, set, way);
+      break;
+    case REPL_IDEAL_STORAGE:
+    case REPL_SHADOW_IDEAL:
       cur_entry->last_access_time = sim_time;
       break;
     case REPL_RANDOM: {
@@ -790,6 +978,7 @@ static inline void* access_unsure_lines(Cache* cache, uns set, Addr tag,
         if(!cache->entries[set][ii].valid) {
           void* data = cache->entries[set][ii].data;
           memcpy(&cache->entries[set][ii], temp, sizeof(Cache_Entry));
+          cache_sync_tag(cache, set, ii);
           temp->data = data;
           ASSERT(0, dl_list_remove_current(list) == temp);
           ASSERT(0, ++cache->repl_ctrs[set] <=
@@ -827,6 +1016,7 @@ static inline Cache_Entry* insert_sure_line(Cache* cache, uns set, Addr tag) {
         temp->data = malloc(sizeof(cache->data_size));
         memcpy(entry->data, temp->data, sizeof(cache->data_size));
         entry->valid = FALSE;
+        cache_sync_tag(cache, set, ii);
         count++;
       }
     }
@@ -909,6 +1099,7 @@ void* access_shadow_lines(Cache* cache, uns set, Addr tag) {
         tmp_line                       = (cache->entries[set][lru_ind]);
         (cache->entries[set][lru_ind]) = *line;
         *line                          = tmp_line;
+        cache_sync_tag(cache, set, lru_ind);
         line->last_access_time =
           (cache->entries[set][lru_ind]).last_access_time;
         (cache->entries[set][lru_ind]).last_access_time = sim_time;
@@ -1100,9 +1291,12 @@ void* cache_insert_lru(Cache* cache, uns8 proc_id, Addr addr, Addr* line_addr,
   new_line->valid   = TRUE;
   new_line->tag     = tag;
   new_line->base    = *line_addr;
+  cache_sync_tag(cache, set, new_line - cache->entries[set]);
   update_repl_policy(cache, new_line, set, repl_index, TRUE);
-  if(cache->repl_policy == REPL_TRUE_LRU)
+  if(cache->repl_policy == REPL_TRUE_LRU) {
     new_line->last_access_time = 137;
+    lru_stack_place(cache, set, repl_index);
+  }
 
   if(cache->repl_policy == REPL_IDEAL_STORAGE) {
     new_line->last_access_time = cache->assoc;
@@ -1142,6 +1336,7 @@ void* cache_insert_lru(Cache* cache, uns8 proc_id, Addr addr, Addr* line_addr,
       main_line->tag              = tag;
       main_line->base             = *line_addr;
       main_line->last_access_time = sim_time;
+      cache_sync_tag(cache, set, lru_ind);
     }
   }
   return new_line->data;
@@ -1156,6 +1351,7 @@ void reset_cache(Cache* cache) {
   for(ii = 0; ii < cache->num_sets; ii++) {
     for(jj = 0; jj < cache->assoc; jj++) {
       cache->entries[ii][jj].valid = FALSE;
+      cache_sync_tag(cache, ii, jj);
     }
   }
 }
@@ -1173,24 +1369,23 @@ int cache_find_pos_in_lru_stack(Cache* cache, uns8 proc_id, Addr addr,
   uns          set = cache_index(cache, addr, &tag, line_addr);
   uns          ii;
   int          position;
-  Cache_Entry* hit_line = NULL;
-  Flag         hit      = FALSE;
+  int          way = cache_find_way(cache, set, tag);
+  Cache_Entry* hit_line;
 
-  for(ii = 0; ii < cache->assoc; ii++) {
-    hit_line = &cache->entries[set][ii];
-
-    if(hit_line->valid && hit_line->tag == tag) {
-      hit = TRUE;
-      break;
-    }
-  }
-
-  if(!hit)
+  if(way < 0)
     return -1;
 
-  ASSERT(0, hit_line);
+  hit_line = &cache->entries[set][way];
   ASSERT(0, hit_line->proc_id == proc_id);
   position = 0;
+  if(cache->repl_policy == REPL_TRUE_LRU) {
+    /* the same core's lines above it on the stack */
+    const uns8* row = cache_repl_row(cache, set);
+    for(ii = 0; ii < cache->assoc; ii++)
+      position += row[ii] < row[way] &&
+                  cache->entries[set][ii].proc_id == hit_line->proc_id;
+    return position;
+  }
   for(ii = 0; ii < cache->assoc; ii++) {
     Cache_Entry* line = &cache->entries[set][ii];
     if(hit_line->proc_id == line->proc_id &&
@@ -1216,6 +1411,82 @@ uns get_partition_allocated(Cache* cache, uns8 proc_id) {
   return cache->num_ways_allocted_core[proc_id];
 }
 
+/**************************************************************************************/
+/* cache_init_compression: the cache was initialized with more tags than its
+   data array holds uncompressed lines; data_assoc is the data array's
+   associativity. Lines take line_size bytes until cache_set_comp_size. */
+
+void cache_init_compression(Cache* cache, uns data_assoc) {
+  ASSERTM(0, data_assoc && data_assoc <= cache->assoc,
+          "Cache '%s': data associativity %u must be in [1, %u]\n",
+          cache->name, data_assoc, cache->assoc);
+  ASSERTM(0, cache->line_size <= 0xFFFF,
+          "Cache '%s': line size too large for compression\n", cache->name);
+  cache->comp_size = (uns16*)calloc(cache->num_sets * cache->assoc,
+                                    sizeof(uns16));
+  cache->comp_set_bytes  = (uns*)calloc(cache->num_sets, sizeof(uns));
+  cache->comp_set_budget = data_assoc * cache->line_size;
+
+  for(uns ii = 0; ii < cache->num_sets; ii++)
+    for(uns jj = 0; jj < cache->assoc; jj++)
+      cache_sync_tag(cache, ii, jj);
+}
+
+/**************************************************************************************/
+/* cache_set_comp_size: set the compressed size of a resident line */
+
+void cache_set_comp_size(Cache* cache, Addr addr, uns size) {
+  Addr tag, line_addr;
+  uns  set = cache_index(cache, addr, &tag, &line_addr);
+  int  way = cache_find_way(cache, set, tag);
+
+  ASSERT(0, cache->comp_size);
+  ASSERT(0, way >= 0);
+  ASSERT(0, size && size <= cache->line_size);
+  uns16* cur = &cache->comp_size[set * cache->assoc + way];
+  cache->comp_set_bytes[set] = cache->comp_set_bytes[set] - *cur + size;
+  *cur = size;
+}
+
+/**************************************************************************************/
+/* cache_get_comp_size: compressed size of a resident line, line_size if the
+   line is not resident or the cache is not compressed */
+
+uns cache_get_comp_size(Cache* cache, Addr addr) {
+  Addr tag, line_addr;
+  uns  set = cache_index(cache, addr, &tag, &line_addr);
+  int  way;
+
+  if(!cache->comp_size || (way = cache_find_way(cache, set, tag)) < 0)
+    return cache->line_size;
+  return cache->comp_size[set * cache->assoc + way];
+}
+
+/**************************************************************************************/
+/* cache_next_comp_victim: returns the data of the line to evict before a line
+   of size bytes can be inserted at addr, or NULL if the set's data array
+   already has room. The victim is the valid line the set's replacement policy
+   would evict next, so free tags do not shield the lines behind them. Like
+   get_next_repl_line, this changes no line: the caller invalidates the victim
+   and calls again until it returns NULL. */
+
+void* cache_next_comp_victim(Cache* cache, uns8 proc_id, Addr addr, uns size,
+                             Addr* repl_line_addr) {
+  Addr         tag, line_addr;
+  uns          set = cache_index(cache, addr, &tag, &line_addr);
+  uns          way;
+  Cache_Entry* victim;
+
+  ASSERT(proc_id, cache->comp_size);
+  if(cache->comp_set_bytes[set] + size <= cache->comp_set_budget)
+    return NULL;
+
+  victim = find_valid_repl_entry(cache, proc_id, set, &way);
+  ASSERT(proc_id, victim->valid);
+  *repl_line_addr = victim->base;
+  return victim->data;
+}
+
 /***************************************************************************************
  * Driven Table:
  *  Cache Replacement Policy Strategy
@@ -1239,6 +1510,121 @@ uns get_partition_allocated(Cache* cache, uns8 proc_id) {
  * ----- do prediction revise   [prediction value]
 ***************************************************************************************/
 
+/**************************************************************************************/
+/* Packed replacement state: each set's row of repl_state holds one byte per
+ * way, so victim selection and aging scan assoc bytes instead of assoc
+ * Cache_Entry records. */
+
+static inline uns8* cache_repl_row(Cache* cache, uns set) {
+  return &cache->repl_state[set * cache->assoc];
+}
+
+/* repl_row_find: returns the first way whose state is val0 or val1, -1 if
+ * there is none */
+static inline int repl_row_find(const uns8* row, uns assoc, uns8 val0,
+                                uns8 val1) {
+  uns ii = 0;
+
+#if defined(__SSE2__)
+  const __m128i key0 = _mm_set1_epi8((char)val0);
+  const __m128i key1 = _mm_set1_epi8((char)val1);
+  for(; ii + 16 <= assoc; ii += 16) {
+    __m128i v    = _mm_loadu_si128((const __m128i*)(row + ii));
+    uns     mask = _mm_movemask_epi8(
+      _mm_or_si128(_mm_cmpeq_epi8(v, key0), _mm_cmpeq_epi8(v, key1)));
+    if(mask)
+      return ii + __builtin_ctz(mask);
+  }
+#endif
+
+  for(; ii < assoc; ii++) {
+    if(row[ii] == val0 || row[ii] == val1)
+      return ii;
+  }
+  return -1;
+}
+
+/* repl_row_max: the largest state of the valid ways */
+static inline uns8 repl_row_max(const uns8* row, uns assoc) {
+  uns8 max = 0;
+  uns  ii;
+  for(ii = 0; ii < assoc; ii++) {
+    if(row[ii] != REPL_STATE_INVALID && row[ii] > max)
+      max = row[ii];
+  }
+  return max;
+}
+
+/* LRU stack of the TRUE_LRU (and PARTITION) caches: a valid way's rank is
+ * the number of distinct access times younger than its own in the set, so
+ * ways touched in the same cycle share a rank and the first of them is the
+ * victim, as with comparing time stamps. The ranks of a set have no gaps. */
+
+/* lru_stack_remove: takes the way off its set's stack; if no other way
+ * shares its rank, the ways below it move up one */
+static inline void lru_stack_remove(Cache* cache, uns set, uns way) {
+  uns8* row  = cache_repl_row(cache, set);
+  uns8  rank = row[way];
+  uns   ii;
+
+  if(rank == REPL_STATE_INVALID)
+    return;
+  row[way] = REPL_STATE_INVALID;
+  if(repl_row_find(row, cache->assoc, rank, rank) >= 0)
+    return;
+  for(ii = 0; ii < cache->assoc; ii++) {
+    if(row[ii] != REPL_STATE_INVALID && row[ii] > rank)
+      row[ii]--;
+  }
+}
+
+/* lru_stack_place: ranks the way by its last_access_time. A touch is at least
+ * as young as everything in the set and only looks at the top of the stack;
+ * the positional inserts search the set for their place. */
+static inline void lru_stack_place(Cache* cache, uns set, uns way) {
+  uns8*   row  = cache_repl_row(cache, set);
+  Counter time = cache->entries[set][way].last_access_time;
+  int     top;
+  uns8    pos;
+  uns     ii;
+
+  lru_stack_remove(cache, set, way);
+  top = repl_row_find(row, cache->assoc, 0, 0);
+  if(top < 0) {
+    row[way] = 0;
+    return;
+  }
+  if(cache->entries[set][top].last_access_time == time) {
+    row[way] = 0;
+    return;
+  }
+  pos = 0;
+  if(cache->entries[set][top].last_access_time > time) {
+    /* below the youngest way older than it, or sharing a rank */
+    pos = REPL_STATE_INVALID;
+    for(ii = 0; ii < cache->assoc; ii++) {
+      Counter other = cache->entries[set][ii].last_access_time;
+      if(row[ii] == REPL_STATE_INVALID)
+        continue;
+      if(other == time) {
+        row[way] = row[ii];
+        return;
+      }
+      if(other < time && row[ii] < pos)
+        pos = row[ii];
+    }
+    if(pos == REPL_STATE_INVALID) {
+      row[way] = repl_row_max(row, cache->assoc) + 1;
+      return;
+    }
+  }
+  for(ii = 0; ii < cache->assoc; ii++) {
+    if(row[ii] != REPL_STATE_INVALID && row[ii] >= pos)
+      row[ii]++;
+  }
+  row[way] = pos;
+}
+
 /**************************************************************************************/
 /* Common Func */
 static inline int cache_get_policy_index(Repl_Policy repl_policy)
@@ -1293,7 +1679,7 @@ static inline void cache_debug_print_set(Cache* cache, uns set, uns way, int eve
     if (line == NULL)
       continue;
     DEBUG(0, "(%d <- 0x%x) [0x%x, 0x%x] : {0x%llx, 0x%x, 0x%llx, 0x%x, 0x%x}\n",
-      event, way, set, ii, line->tag, line->valid, line->last_access_time, line->reference_val, line->outcome);
+      event, way, set, ii, line->tag, line->valid, line->last_access_time, cache_repl_row(cache, set)[ii], line->outcome);
   }
 
   DEBUG(0, "\n");
@@ -1344,6 +1730,7 @@ void *cache_insert_strategy(Cache* cache, uns8 proc_id, Addr addr, Addr* line_ad
   else
     *repl_line_addr = 0;
   repl_policy_func_table[policy].action_repl(cache, new_line, proc_id, tag, line_addr, repl_line_addr);
+  cache_sync_tag(cache, set, new_line - cache->entries[set]);
   repl_policy_func_table[policy].update_insert(cache, proc_id, set, repl_index, NULL);
 
   return new_line->data;
@@ -1357,7 +1744,7 @@ void *cache_insert_strategy(Cache* cache, uns8 proc_id, Addr addr, Addr* line_ad
 void *cache_access_strategy(Cache* cache, Addr addr, Addr* line_addr, Flag update_repl) {
   Addr tag;
   uns  set = cache_index(cache, addr, &tag, line_addr);
-  uns  ii;
+  int  way;
   int policy;
 
   // Get the selected strategy (policy)
@@ -1367,18 +1754,14 @@ void *cache_access_strategy(Cache* cache, Addr addr, Addr* line_addr, Flag updat
 
   DEBUG(0, "%s, %d: Access Strategy\n", cache->name, cache->repl_policy);
 
-  for(ii = 0; ii < cache->assoc; ii++) {
-    Cache_Entry* line = &cache->entries[set][ii];
+  way = cache_find_way(cache, set, tag);
+  if(way < 0)
+    return NULL;
 
-    if(line->valid && line->tag == tag) {
-      if(update_repl)
-        repl_policy_func_table[policy].update_hit(cache, set, ii, NULL);
+  if(update_repl)
+    repl_policy_func_table[policy].update_hit(cache, set, way, NULL);
 
-      return line->data;
-    }
-  }
-
-  return NULL;
+  return cache->entries[set][way].data;
 }
 
 /*
@@ -1401,6 +1784,19 @@ Cache_Entry* cache_evict_strategy(Cache* cache, uns8 proc_id, uns set, uns* way)
   return new_line;
 }
 
+/*
+  cache_evict_valid_strategy
+  -- like cache_evict_strategy, but the victim is never an invalid way
+  -- called by internal func: find_valid_repl_entry
+*/
+static Cache_Entry* cache_evict_valid_strategy(Cache* cache, uns8 proc_id, uns set, uns* way) {
+  int policy = cache_get_policy_index(cache->repl_policy);
+
+  ASSERT(proc_id, policy != -1);
+  return repl_policy_func_table[policy].update_evict(cache, proc_id, set, way,
+                                                     EVICT_VALID_ONLY, TRUE);
+}
+
 /**************************************************************************************/
 /* General */
 
@@ -1432,8 +1828,17 @@ void general_action_init(Cache* cache, const char* name, uns cache_size, uns ass
   cache->tag_mask    = ~cache->set_mask;              /* use after shifting */
   cache->offset_mask = N_BIT_MASK(cache->shift_bits); /* use before shifting */
 
+  /* every valid state must stay distinguishable from REPL_STATE_INVALID */
+  ASSERTM(0, assoc < REPL_STATE_INVALID,
+          "Cache '%s': associativity %u too large for replacement policy %u\n",
+          name, assoc, repl_policy);
+  cache->repl_state = (uns8*)malloc(sizeof(uns8) * num_sets * assoc);
+  memset(cache->repl_state, REPL_STATE_INVALID, sizeof(uns8) * num_sets * assoc);
+  cache->plru_tree = NULL;
+
   /* allocate memory for all the sets (pointers to line arrays)  */
   cache->entries = (Cache_Entry**)malloc(sizeof(Cache_Entry*) * num_sets);
+  init_tag_store(cache);
 
   /* allocate memory for all of the lines in each set */
   for(ii = 0; ii < num_sets; ii++) {
@@ -1468,68 +1873,50 @@ Cache_Entry* lru_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, voi
 void lru_update_hit(Cache* cache, uns set, uns way, void* arg)
 {
   int ii;
-  uns8 ref_orig = cache->entries[set][way].reference_val;
-
-  // promotion
-  cache->entries[set][way].reference_val = 0;
+  uns8* row = cache_repl_row(cache, set);
+  uns8 ref_orig = row[way];
 
-  // aging
+  // aging (invalid ways hold REPL_STATE_INVALID, which is never younger)
   for (ii = 0; ii < cache->assoc; ii++) {
-    Cache_Entry* entry = &cache->entries[set][ii];
-
-    if (ii == way)
-      continue;
-
-    if (!entry->valid)
-      continue;
-
-    if (entry->reference_val < ref_orig)
-      entry->reference_val++;
+    if (row[ii] < ref_orig)
+      row[ii]++;
   }
 
+  // promotion
+  row[way] = 0;
+
   cache_debug_print_set(cache, set, way, CACHE_EVENT_HIT);
 }
 
 void lru_update_insert(Cache* cache, uns8 proc_id, uns set, uns way, void* arg)
 {
   int ii;
-
-  // insertion
-  cache->entries[set][way].reference_val = 0;
+  uns8* row = cache_repl_row(cache, set);
 
   // aging
   for (ii = 0; ii < cache->assoc; ii++) {
-    Cache_Entry* entry = &cache->entries[set][ii];
-
-    if (ii == way)
-      continue;
-
-    if (!entry->valid)
-      continue;
-
-    entry->reference_val++;
+    if (row[ii] != REPL_STATE_INVALID)
+      row[ii]++;
   }
 
+  // insertion
+  row[way] = 0;
+
   cache_debug_print_set(cache, set, way, CACHE_EVENT_INSERT);
 }
 
 Cache_Entry* lru_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, void* arg, Flag if_external)
 {
-  int ii;
-  uns8 oldest_ref = 0;
-
-  // search the oldest line
-  for (ii = 0; ii < cache->assoc; ii++) {
-    Cache_Entry* entry = &cache->entries[set][ii];
-
-    if (!entry->valid) {
-      *way = ii;
-      break;
-    }
-    if (entry->reference_val > oldest_ref) {
-      *way  = ii;
-      oldest_ref = entry->reference_val;
-    }
+  uns8* row = cache_repl_row(cache, set);
+  int invalid = arg == EVICT_VALID_ONLY ? -1 :
+                repl_row_find(row, cache->assoc, REPL_STATE_INVALID, REPL_STATE_INVALID);
+
+  // an invalid line first, otherwise the oldest line
+  if (invalid >= 0)
+    *way = invalid;
+  else {
+    uns8 max = repl_row_max(row, cache->assoc);
+    *way = repl_row_find(row, cache->assoc, max, max);
   }
 
   cache_debug_print_set(cache, set, *way, CACHE_EVENT_EVICT);
@@ -1544,10 +1931,34 @@ Cache_Entry* nru_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, voi
 
 const static uns8 NRU_DISTANT_VAL = 1;
 
+/* rrpv_find_victim: returns the first way that is invalid (unless valid_only)
+ * or whose RRPV is distant_val. If there is none, ages every valid way just
+ * far enough for the oldest to become distant (the same as aging one step at
+ * a time). */
+static inline uns rrpv_find_victim(Cache* cache, uns set, uns8 distant_val,
+                                   Flag valid_only) {
+  uns8* row = cache_repl_row(cache, set);
+  int   way = repl_row_find(row, cache->assoc,
+                            valid_only ? distant_val : REPL_STATE_INVALID,
+                            distant_val);
+  uns8  age;
+  uns   ii;
+
+  if (way >= 0)
+    return way;
+
+  age = distant_val - repl_row_max(row, cache->assoc);
+  for (ii = 0; ii < cache->assoc; ii++) {
+    if (row[ii] != REPL_STATE_INVALID)
+      row[ii] += age;
+  }
+  return repl_row_find(row, cache->assoc, distant_val, distant_val);
+}
+
 void nru_update_hit(Cache* cache, uns set, uns way, void* arg)
 {
   // promotion: near immediate -> RRPV = 0
-  cache->entries[set][way].reference_val = 0;
+  cache_repl_row(cache, set)[way] = 0;
 
   cache_debug_print_set(cache, set, way, CACHE_EVENT_HIT);
 }
@@ -1555,38 +1966,14 @@ void nru_update_hit(Cache* cache, uns set, uns way, void* arg)
 void nru_update_insert(Cache* cache, uns8 proc_id, uns set, uns way, void* arg)
 {
   // insertion: near immediate -> RRPV = 0
-  cache->entries[set][way].reference_val = NRU_DISTANT_VAL;
+  cache_repl_row(cache, set)[way] = NRU_DISTANT_VAL;
 
   cache_debug_print_set(cache, set, way, CACHE_EVENT_INSERT);
 }
 
 Cache_Entry* nru_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, void* arg, Flag if_external)
 {
-  int ii;
-  Flag found = FALSE;
-
-  while (!found) {
-    // eviction: search the distant line whose RRPV == 1
-    for (ii = 0; ii < cache->assoc; ii++) {
-      Cache_Entry* entry = &cache->entries[set][ii];
-      if (!entry->valid) {
-        *way = ii;
-        found = TRUE;
-        break;
-      }
-      if (entry->reference_val == NRU_DISTANT_VAL) {
-        *way  = ii;
-        found = TRUE;
-        break;
-      }
-    }
-
-    // aging: increment until there is a RRPV == 1
-    if (found)
-      break;
-    for (ii = 0; ii < cache->assoc; ii++)
-      cache->entries[set][ii].reference_val++;
-  }
+  *way = rrpv_find_victim(cache, set, NRU_DISTANT_VAL, arg == EVICT_VALID_ONLY);
 
   cache_debug_print_set(cache, set, *way, CACHE_EVENT_EVICT);
   return &cache->entries[set][*way];
@@ -1605,38 +1992,14 @@ Cache_Entry* srrip_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, v
 void srrip_update_insert(Cache* cache, uns8 proc_id, uns set, uns way, void* arg)
 {
   // insertion: long interval -> RRPV = 2^M - 2
-  cache->entries[set][way].reference_val = RRIP_DISTANT_VAL - 1;
+  cache_repl_row(cache, set)[way] = RRIP_DISTANT_VAL - 1;
 
   cache_debug_print_set(cache, set, way, CACHE_EVENT_INSERT);
 }
 
 Cache_Entry* srrip_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, void* arg, Flag if_external)
 {
-  int ii;
-  Flag found = FALSE;
-
-  while (!found) {
-    // eviction: search the distant line whose RRPV == 2^M - 1
-    for (ii = 0; ii < cache->assoc; ii++) {
-      Cache_Entry* entry = &cache->entries[set][ii];
-      if (!entry->valid) {
-        *way = ii;
-        found = TRUE;
-        break;
-      }
-      if (entry->reference_val == RRIP_DISTANT_VAL) {
-        *way  = ii;
-        found = TRUE;
-        break;
-      }
-    }
-
-    // aging: increment until there is a RRPV == 2^M-1
-    if (found)
-      break;
-    for (ii = 0; ii < cache->assoc; ii++)
-      cache->entries[set][ii].reference_val++;
-  }
+  *way = rrpv_find_victim(cache, set, RRIP_DISTANT_VAL, arg == EVICT_VALID_ONLY);
 
   cache_debug_print_set(cache, set, *way, CACHE_EVENT_EVICT);
   return &cache->entries[set][*way];
@@ -1678,12 +2041,12 @@ void brrip_update_insert(Cache* cache, uns8 proc_id, uns set, uns way, void* arg
 
   if (bimodal_para) {
     // insertion in distant future
-    cache->entries[set][way].reference_val = RRIP_DISTANT_VAL;
-    DEBUG(0, "BRRIP insert in distant: %d, %d\n", bimodal_para, cache->entries[set][way].reference_val);
+    cache_repl_row(cache, set)[way] = RRIP_DISTANT_VAL;
+    DEBUG(0, "BRRIP insert in distant: %d, %d\n", bimodal_para, cache_repl_row(cache, set)[way]);
   } else {
     // insertion in long-interval future
-    cache->entries[set][way].reference_val = RRIP_DISTANT_VAL - 1;
-    DEBUG(0, "BRRIP insert in long-interval: %d, %d\n", bimodal_para, cache->entries[set][way].reference_val);
+    cache_repl_row(cache, set)[way] = RRIP_DISTANT_VAL - 1;
+    DEBUG(0, "BRRIP insert in long-interval: %d, %d\n", bimodal_para, cache_repl_row(cache, set)[way]);
   }
 
   cache_debug_print_set(cache, set, way, CACHE_EVENT_INSERT);
@@ -1766,7 +2129,9 @@ void drrip_update_insert(Cache* cache, uns8 proc_id, uns set, uns way, void* arg
 
 Cache_Entry* drrip_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, void* arg, Flag if_external)
 {
-  cache->miss_count[set]++;
+  // a valid-only eviction makes room in the set, it does not follow a miss
+  if (arg != EVICT_VALID_ONLY)
+    cache->miss_count[set]++;
   DEBUG(0, "DRRIP evict count: 0x%x, 0x%llx\n", set, cache->miss_count[set]);
   return srrip_update_evict(cache, proc_id, set, way, arg, if_external);
 }
@@ -1810,7 +2175,7 @@ void ship_action_init(Cache* cache, const char* name, uns cache_size, uns assoc,
 void ship_update_hit(Cache* cache, uns set, uns way, void* arg)
 {
   // promotion: near future -> RRPV = 0
-  cache->entries[set][way].reference_val = 0;
+  cache_repl_row(cache, set)[way] = 0;
 
   // prediction update
   cache->entries[set][way].outcome = TRUE;
@@ -1838,10 +2203,10 @@ void ship_update_insert(Cache* cache, uns8 proc_id, uns set, uns way, void* arg)
 
   if (*cache_shct_entry == 0) {
     // insertion in distant future
-    cache->entries[set][way].reference_val = RRIP_DISTANT_VAL;
+    cache_repl_row(cache, set)[way] = RRIP_DISTANT_VAL;
   } else {
     // insertion in long-interval future
-    cache->entries[set][way].reference_val = RRIP_DISTANT_VAL - 1;
+    cache_repl_row(cache, set)[way] = RRIP_DISTANT_VAL - 1;
   }
 
   cache_debug_print_set(cache, set, way, CACHE_EVENT_INSERT);
@@ -1873,6 +2238,97 @@ Cache_Entry* ship_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, vo
   return line;
 }
 
+/**************************************************************************************/
+/* PLRU */
+void plru_action_init(Cache* cache, const char* name, uns cache_size, uns assoc,
+  uns line_size, uns data_size, Repl_Policy repl_policy);
+void plru_update_hit(Cache* cache, uns set, uns way, void* arg);
+void plru_update_insert(Cache* cache, uns8 proc_id, uns set, uns way, void* arg);
+Cache_Entry* plru_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, void* arg, Flag if_external);
+
+/* The tree of each set is a heap of assoc - 1 bits in one word: node n has
+   children 2n and 2n+1, the root is bit 1 and a set bit points to the right
+   subtree. */
+void plru_action_init(Cache* cache, const char* name, uns cache_size, uns assoc,
+  uns line_size, uns data_size, Repl_Policy repl_policy)
+{
+  uns num_sets  = cache_size / line_size / assoc;
+
+  ASSERTM(0, assoc <= 64 && (assoc & (assoc - 1)) == 0,
+          "Cache '%s': PLRU needs a power-of-two associativity up to 64\n", name);
+  general_action_init(cache, name, cache_size, assoc, line_size, data_size, repl_policy);
+  cache->plru_tree = (uns64*)calloc(num_sets, sizeof(uns64));
+}
+
+/* plru_subtree_valid: whether any way under the given node is valid */
+static inline Flag plru_subtree_valid(Cache* cache, const uns8* row, uns node)
+{
+  uns first = node, last = node;
+
+  // descend to the leftmost and rightmost leaves of the subtree
+  while (first < cache->assoc) {
+    first = 2 * first;
+    last  = 2 * last + 1;
+  }
+  for (; first <= last; first++) {
+    if (row[first - cache->assoc] != REPL_STATE_INVALID)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+void plru_update_hit(Cache* cache, uns set, uns way, void* arg)
+{
+  uns64* tree = &cache->plru_tree[set];
+  uns    node = 1;
+  int    level;
+
+  // point every node on the path away from this way
+  for (level = LOG2(cache->assoc) - 1; level >= 0; level--) {
+    uns right = (way >> level) & 1;
+    if (right)
+      *tree &= ~(1ULL << node);
+    else
+      *tree |= 1ULL << node;
+    node = 2 * node + right;
+  }
+
+  cache_debug_print_set(cache, set, way, CACHE_EVENT_HIT);
+}
+
+void plru_update_insert(Cache* cache, uns8 proc_id, uns set, uns way, void* arg)
+{
+  // the state byte only marks the way valid
+  cache_repl_row(cache, set)[way] = 0;
+  plru_update_hit(cache, set, way, arg);
+}
+
+Cache_Entry* plru_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, void* arg, Flag if_external)
+{
+  uns8* row     = cache_repl_row(cache, set);
+  int   invalid = arg == EVICT_VALID_ONLY ? -1 :
+                  repl_row_find(row, cache->assoc, REPL_STATE_INVALID, REPL_STATE_INVALID);
+  uns64 tree    = cache->plru_tree[set];
+  uns   node    = 1;
+
+  if (invalid >= 0) {
+    *way = invalid;
+  } else {
+    // follow the tree bits down to a leaf, turning away from subtrees that
+    // hold no valid way (only possible with EVICT_VALID_ONLY)
+    while (node < cache->assoc) {
+      uns child = 2 * node + ((tree >> node) & 1);
+      if (!plru_subtree_valid(cache, row, child))
+        child ^= 1;
+      node = child;
+    }
+    *way = node - cache->assoc;
+  }
+
+  cache_debug_print_set(cache, set, *way, CACHE_EVENT_EVICT);
+  return &cache->entries[set][*way];
+}
+
 /**************************************************************************************/
 /* Driven Table */
 struct repl_policy_func repl_policy_func_table[NUM_REPL] = {
@@ -1882,6 +2338,7 @@ struct repl_policy_func repl_policy_func_table[NUM_REPL] = {
   { REPL_BRRIP,   brrip_action_init,    general_action_repl,  nru_update_hit,     brrip_update_insert,  srrip_update_evict  },
   { REPL_DRRIP,   drrip_action_init,    general_action_repl,  nru_update_hit,     drrip_update_insert,  drrip_update_evict  },
   { REPL_SHIP,    ship_action_init,     general_action_repl,  ship_update_hit,    ship_update_insert,   ship_update_evict   },
+  { REPL_PLRU,    plru_action_init,     general_action_repl,  plru_update_hit,    plru_update_insert,   plru_update_evict   },
   { REPL_VOID,    NULL,                 NULL,                 NULL,               NULL,                 NULL                },
 };
 /**************************************************************************************/
\ No newline at end of file
@@ -37,6 +37,10 @@
 
 #define INIT_CACHE_DATA_VALUE \
   ((void*)0x8badbeef) /* set data pointers to this initially */
+#define INVALID_TAG_STORE \
+  ((Addr)-1) /* tag_store value of an invalid way */
+#define REPL_STATE_INVALID \
+  ((uns8)0xff) /* repl_state value of an invalid way */
 
 
 /**************************************************************************************/
@@ -64,6 +68,7 @@ typedef enum Repl_Policy_enum {
   REPL_BRRIP,           /* bimodal re-reference interval prediction */
   REPL_DRRIP,           /* dynamic re-reference interval prediction */
   REPL_SHIP,            /* signature-based hit predictor */
+  REPL_PLRU,            /* tree pseudo-LRU (power-of-two assoc up to 64) */
 
   NUM_REPL
 } Repl_Policy;
@@ -74,20 +79,21 @@ typedef enum Cache_Repl_Signiture_enum {
   CACHE_REPL_SIGH_NUM
 } Cache_Repl_Signiture;
 
+/* Wide fields come first so the record packs without padding holes. Lookups
+   do not read these records; see tag_store in Cache. */
 typedef struct Cache_Entry_struct {
-  uns8    proc_id;
-  Flag    valid;            /* valid bit for the line */
   Addr    tag;              /* tag for the line */
   Addr    base;             /* address of first element */
   Counter last_access_time; /* for replacement policy */
   Counter insertion_time;   /* for replacement policy */
   void*   data;             /* pointer to arbitrary data */
+  Addr pw_start_addr; /* for uop cache: start addr of prediction window */
+
+  uns8    proc_id;
+  Flag    valid;            /* valid bit for the line */
   Flag    pref;             /* extra replacement info */
   Flag    dirty; /* Dirty bit should have been here, however this is used only in
                  warmup now */
-  Addr pw_start_addr; /* for uop cache: start addr of prediction window */
-
-  uns8    reference_val;    /* for re-reference replacement policy */
   Flag    outcome;          /* for replacement policy */
 } Cache_Entry;
 
@@ -125,6 +131,9 @@ typedef struct Cache_struct {
   Cache_Entry** entries;   /* A dynamically allocated array of all
                               of the cache entries. The array is
                               two-dimensional, sets are row major. */
+  Addr* tag_store;         /* Packed copy of every way's tag, sets are row
+                              major. An invalid way holds INVALID_TAG_STORE
+                              so lookups only scan this array. */
   List* unsure_lists;      /* A linked list for each set in the cache that
                               is used when simulating ideal replacement policies */
   Flag perfect;            /* is the cache perfect (for henry mem system) */
@@ -143,6 +152,12 @@ typedef struct Cache_struct {
 
   Flag     tag_incl_offset;        /* The uop cache is byte-addressable, so the tag includes offset bits as well */
 
+  /* For strategy, TRUE_LRU and PARTITION repl: one byte per way, sets are
+     row major. Holds the LRU rank or the RRPV of each valid way and
+     REPL_STATE_INVALID otherwise */
+  uns8*    repl_state;
+  uns64*   plru_tree;               /* For PLRU repl: tree bits of each set */
+
   /* For DRRIP repl */
   uns*     dedicated_policy_set;    /* For dedicated set map */
   Counter* miss_count;              /* For sampling */
@@ -150,6 +165,13 @@ typedef struct Cache_struct {
 
   /* For repl with predictor */
   void* predictor;
+
+  /* For compressed caches: the tag array has more ways than the data array
+     can hold uncompressed, and a set is full once its lines' compressed
+     sizes reach comp_set_budget. NULL unless cache_init_compression ran */
+  uns16*   comp_size;               /* bytes held by each way, sets are row major */
+  uns*     comp_set_bytes;          /* bytes held by each set */
+  uns      comp_set_budget;         /* data array bytes per set */
 } Cache;
 
 /**************************************************************************************/
@@ -204,6 +226,11 @@ int   cache_find_pos_in_lru_stack(Cache* cache, uns8 proc_id, Addr addr,
                                   Addr* line_addr);
 void  set_partition_allocate(Cache* cache, uns8 proc_id, uns num_ways);
 uns   get_partition_allocated(Cache* cache, uns8 proc_id);
+void  cache_init_compression(Cache* cache, uns data_assoc);
+void  cache_set_comp_size(Cache* cache, Addr addr, uns size);
+uns   cache_get_comp_size(Cache* cache, Addr addr);
+void* cache_next_comp_victim(Cache* cache, uns8 proc_id, Addr addr, uns size,
+                             Addr* repl_line_addr);
 /**************************************************************************************/
 
 
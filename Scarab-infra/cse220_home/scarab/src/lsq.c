@@ -0,0 +1,508 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : lsq.c
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Bounded load/store queues and memory dependence prediction.
+ *
+ * Queues: loads and stores take an LQ/SQ entry when they issue into the node
+ * table and give it back at retire. A full queue stalls issue (LQ_SIZE and
+ * SQ_SIZE, 0 = only bounded by the node table).
+ *
+ * Prediction: with MEM_DEP_PRED other than oracle, a load is no longer made
+ * to wait for the store it reads from. It waits for the stores the predictor
+ * names and otherwise issues speculatively:
+ *   store sets   - the SSIT maps a load/store pc to a store set, the LFST
+ *                  holds the last fetched store of each set. A load waits for
+ *                  the last fetched store of its set.
+ *   store vector - per load pc, a bit vector over the distance (in stores)
+ *                  back to the stores the load has to wait for.
+ * Both are trained by ordering violations and cleared every
+ * MEM_DEP_PRED_CLEAR_INTERVAL cycles.
+ *
+ * Violations: when a store executes, a younger load that reads from it and
+ * has already read the cache got stale data. With a frontend that can
+ * refetch on-path instructions (PIN exec-driven, and the trace frontend from
+ * its history of unretired instructions), the load's instruction and
+ * everything younger are flushed through bp_sched_load_recovery. Predictor
+ * state is restored from the youngest branch older than the load. Without
+ * such a branch in the node table, or with the memtrace frontend, the load
+ * re-executes in place: its result arrives MEM_DEP_VIOLATION_PENALTY cycles
+ * after the store executes, and the ops that already consumed the stale value
+ * are re-timed from it. None of them retires before its re-executed result
+ * is ready.
+ ***************************************************************************************/
+
+#include "debug/debug_macros.h"
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "bp/bp.h"
+#include "exec_stage.h"
+#include "frontend/frontend_intf.h"
+#include "lsq.h"
+#include "map.h"
+#include "node_stage.h"
+#include "op.h"
+
+#include "core.param.h"
+#include "debug/debug.param.h"
+#include "general.param.h"
+#include "memory/memory.param.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_LSQ, ##args)
+
+#define LSQ_PC_INDEX(pc, size) ((uns)(((pc) ^ ((pc) >> 12)) % (size)))
+#define STORE_HISTORY_SIZE 64  // longest store vector
+
+DEFINE_ENUM(Mem_Dep_Pred, MEM_DEP_PRED_LIST);
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct Lsq_Entry_struct {
+  Op*     op;
+  Counter unique_num;  // tells whether op has been freed and reused
+} Lsq_Entry;
+
+typedef struct Lsq_Queue_struct {
+  Op** ops;    // ring of ops in program order
+  uns  cap;    // entries
+  uns  head;   // oldest op
+  uns  count;  // ops in the queue
+} Lsq_Queue;
+
+typedef struct Lsq_struct {
+  Lsq_Queue lq;
+  Lsq_Queue sq;
+
+  Counter store_seq;  // stores mapped so far
+
+  uns*       ssit;  // store set of each load/store pc, LFST_SIZE if none
+  Lsq_Entry* lfst;  // last fetched store of each store set
+
+  uns64*     store_vectors;  // per load pc, distances of the stores to wait for
+  Lsq_Entry* store_history;  // last mapped stores, by store_seq
+
+  Counter next_clear_cycle;
+} Lsq;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Lsq* lsq_data = NULL;
+Flag        lsq_on   = FALSE;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static void       queue_init(Lsq_Queue* q, uns size);
+static Lsq_Queue* op_queue(Lsq* lsq, Op* op);
+static Op*        entry_op(Lsq_Entry* entry);
+static void       clear_predictor(Lsq* lsq);
+static void       add_pred_dep(Op* op, Op* store);
+static void       violation(Lsq* lsq, Op* load, Op* store);
+static Flag       flush_load(Op* load, Op* store);
+static void       retime_deps(Op* op);
+
+/**************************************************************************************/
+/* alloc_mem_lsq */
+
+void alloc_mem_lsq(uns num_cores) {
+  lsq_on = LQ_SIZE || SQ_SIZE || MEM_DEP_PRED != MEM_DEP_PRED_ORACLE;
+  if(!lsq_on)
+    return;
+  ASSERTM(0, STORE_VECTOR_LENGTH <= STORE_HISTORY_SIZE,
+          "STORE_VECTOR_LENGTH must be at most %u\n", STORE_HISTORY_SIZE);
+  lsq_data = (Lsq*)calloc(num_cores, sizeof(Lsq));
+}
+
+/**************************************************************************************/
+/* init_lsq */
+
+void init_lsq(uns8 proc_id) {
+  if(!lsq_on)
+    return;
+  Lsq* lsq = &lsq_data[proc_id];
+
+  queue_init(&lsq->lq, LQ_SIZE);
+  queue_init(&lsq->sq, SQ_SIZE);
+
+  if(MEM_DEP_PRED == MEM_DEP_PRED_STORE_SETS) {
+    lsq->ssit = (uns*)malloc(sizeof(uns) * SSIT_SIZE);
+    lsq->lfst = (Lsq_Entry*)calloc(LFST_SIZE, sizeof(Lsq_Entry));
+  } else if(MEM_DEP_PRED == MEM_DEP_PRED_STORE_VECTOR) {
+    lsq->store_vectors = (uns64*)malloc(sizeof(uns64) *
+                                        STORE_VECTOR_TABLE_SIZE);
+    lsq->store_history = (Lsq_Entry*)calloc(STORE_HISTORY_SIZE,
+                                            sizeof(Lsq_Entry));
+  }
+  clear_predictor(lsq);
+}
+
+/**************************************************************************************/
+/* reset_lsq: empty the queues (the predictor keeps its training) */
+
+void reset_lsq(uns8 proc_id) {
+  if(!lsq_on)
+    return;
+  Lsq* lsq = &lsq_data[proc_id];
+  memset(lsq->lq.ops, 0, sizeof(Op*) * lsq->lq.cap);
+  memset(lsq->sq.ops, 0, sizeof(Op*) * lsq->sq.cap);
+  lsq->lq.head = lsq->lq.count = 0;
+  lsq->sq.head = lsq->sq.count = 0;
+}
+
+/**************************************************************************************/
+/* recover_lsq: flushed ops are the youngest, so pop them off the tail */
+
+void recover_lsq(uns8 proc_id) {
+  if(!lsq_on)
+    return;
+  Lsq*       lsq      = &lsq_data[proc_id];
+  Lsq_Queue* queues[] = {&lsq->lq, &lsq->sq};
+
+  for(uns ii = 0; ii < 2; ii++) {
+    Lsq_Queue* q = queues[ii];
+    while(q->count) {
+      uns tail = (q->head + q->count - 1) % q->cap;
+      if(!FLUSH_OP(q->ops[tail]))
+        break;
+      q->ops[tail] = NULL;
+      q->count--;
+    }
+  }
+}
+
+/**************************************************************************************/
+/* lsq_can_issue */
+
+Flag lsq_can_issue(Op* op) {
+  if(!lsq_on)
+    return TRUE;
+  Lsq_Queue* q = op_queue(&lsq_data[op->proc_id], op);
+  if(!q || q->count < q->cap)
+    return TRUE;
+  STAT_EVENT(op->proc_id, q == &lsq_data[op->proc_id].lq ? LQ_FULL_STALL :
+                                                            SQ_FULL_STALL);
+  return FALSE;
+}
+
+/**************************************************************************************/
+/* lsq_issue */
+
+void lsq_issue(Op* op) {
+  if(!lsq_on)
+    return;
+  Lsq_Queue* q = op_queue(&lsq_data[op->proc_id], op);
+  if(!q)
+    return;
+  ASSERT(op->proc_id, q->count < q->cap);
+  q->ops[(q->head + q->count) % q->cap] = op;
+  q->count++;
+}
+
+/**************************************************************************************/
+/* lsq_retire */
+
+void lsq_retire(Op* op) {
+  if(!lsq_on)
+    return;
+  Lsq_Queue* q = op_queue(&lsq_data[op->proc_id], op);
+  if(!q)
+    return;
+  ASSERT(op->proc_id, q->count && q->ops[q->head] == op);
+  q->ops[q->head] = NULL;
+  q->head         = (q->head + 1) % q->cap;
+  q->count--;
+}
+
+/**************************************************************************************/
+/* lsq_map_store */
+
+void lsq_map_store(Op* op) {
+  if(MEM_DEP_PRED != MEM_DEP_PRED_STORE_SETS &&
+     MEM_DEP_PRED != MEM_DEP_PRED_STORE_VECTOR)
+    return;
+  Lsq* lsq      = &lsq_data[op->proc_id];
+  op->store_seq = lsq->store_seq++;
+
+  if(MEM_DEP_PRED == MEM_DEP_PRED_STORE_SETS) {
+    uns ssid = lsq->ssit[LSQ_PC_INDEX(op->inst_info->addr, SSIT_SIZE)];
+    if(ssid < LFST_SIZE) {
+      lsq->lfst[ssid].op         = op;
+      lsq->lfst[ssid].unique_num = op->unique_num;
+    }
+  } else {
+    Lsq_Entry* entry = &lsq->store_history[op->store_seq % STORE_HISTORY_SIZE];
+    entry->op         = op;
+    entry->unique_num = op->unique_num;
+  }
+}
+
+/**************************************************************************************/
+/* lsq_map_load */
+
+void lsq_map_load(Op* op, Op* oracle_store) {
+  Lsq* lsq                 = &lsq_data[op->proc_id];
+  uns  orig_num_srcs       = op->oracle_info.num_srcs;
+  op->mem_dep_store        = oracle_store;
+  op->mem_dep_store_unique = oracle_store ? oracle_store->unique_num : 0;
+  op->store_seq            = lsq->store_seq;
+
+  if(MEM_DEP_PRED_CLEAR_INTERVAL && cycle_count >= lsq->next_clear_cycle)
+    clear_predictor(lsq);
+
+  if(MEM_DEP_PRED == MEM_DEP_PRED_STORE_SETS) {
+    uns ssid = lsq->ssit[LSQ_PC_INDEX(op->inst_info->addr, SSIT_SIZE)];
+    Op* store = ssid < LFST_SIZE ? entry_op(&lsq->lfst[ssid]) : NULL;
+    if(store)
+      add_pred_dep(op, store);
+  } else if(MEM_DEP_PRED == MEM_DEP_PRED_STORE_VECTOR) {
+    uns64 vector = lsq->store_vectors[LSQ_PC_INDEX(op->inst_info->addr,
+                                                   STORE_VECTOR_TABLE_SIZE)];
+    for(; vector && op->oracle_info.num_srcs < MAX_DEPS;
+        vector &= vector - 1) {
+      uns dist = __builtin_ctzll(vector);
+      if(dist >= op->store_seq)
+        break;
+      Counter seq   = op->store_seq - 1 - dist;
+      Op*     store = entry_op(&lsq->store_history[seq % STORE_HISTORY_SIZE]);
+      if(store && store->store_seq == seq)
+        add_pred_dep(op, store);
+    }
+  }
+
+  if(op->oracle_info.num_srcs == orig_num_srcs)
+    STAT_EVENT(op->proc_id, MEM_DEP_LD_SPECULATIVE);
+  else
+    STAT_EVENT(op->proc_id, MEM_DEP_LD_WAIT);
+}
+
+/**************************************************************************************/
+/* lsq_store_exec */
+
+void lsq_store_exec(Op* op) {
+  if(MEM_DEP_PRED == MEM_DEP_PRED_ORACLE || op->off_path)
+    return;
+  Lsq*       lsq = &lsq_data[op->proc_id];
+  Lsq_Queue* q   = &lsq->lq;
+
+  if(MEM_DEP_PRED == MEM_DEP_PRED_STORE_SETS) {
+    uns ssid = lsq->ssit[LSQ_PC_INDEX(op->inst_info->addr, SSIT_SIZE)];
+    if(ssid < LFST_SIZE && entry_op(&lsq->lfst[ssid]) == op)
+      lsq->lfst[ssid].op = NULL;
+  }
+
+  /* younger loads that read from this store and already read the cache */
+  for(uns ii = q->count; ii-- > 0;) {
+    Op* load = q->ops[(q->head + ii) % q->cap];
+    if(load->op_num < op->op_num)
+      break;
+    if(load->off_path || load->mem_dep_store != op ||
+       load->mem_dep_store_unique != op->unique_num)
+      continue;
+    if(load->dcache_cycle != MAX_CTR && !load->mem_viol_cycle)
+      violation(lsq, load, op);
+  }
+}
+
+/**************************************************************************************/
+/* queue_init */
+
+static void queue_init(Lsq_Queue* q, uns size) {
+  q->cap   = size ? MIN2(size, NODE_TABLE_OPS) : NODE_TABLE_OPS;
+  q->ops   = (Op**)calloc(q->cap, sizeof(Op*));
+  q->head  = 0;
+  q->count = 0;
+}
+
+/**************************************************************************************/
+/* op_queue: the queue the op takes an entry in, NULL if none */
+
+static Lsq_Queue* op_queue(Lsq* lsq, Op* op) {
+  if(op->table_info->mem_type == MEM_LD)
+    return &lsq->lq;
+  if(op->table_info->mem_type == MEM_ST)
+    return &lsq->sq;
+  return NULL;
+}
+
+/**************************************************************************************/
+/* entry_op: the store in the entry if it is still in flight and has not
+ * executed yet */
+
+static Op* entry_op(Lsq_Entry* entry) {
+  Op* op = entry->op;
+  if(!op || !op->op_pool_valid || op->unique_num != entry->unique_num ||
+     op->wake_up_signaled[MEM_DATA_DEP])
+    return NULL;
+  return op;
+}
+
+/**************************************************************************************/
+/* clear_predictor */
+
+static void clear_predictor(Lsq* lsq) {
+  if(lsq->ssit) {
+    for(uns ii = 0; ii < SSIT_SIZE; ii++)
+      lsq->ssit[ii] = LFST_SIZE;
+    memset(lsq->lfst, 0, sizeof(Lsq_Entry) * LFST_SIZE);
+  }
+  if(lsq->store_vectors)
+    memset(lsq->store_vectors, 0, sizeof(uns64) * STORE_VECTOR_TABLE_SIZE);
+  lsq->next_clear_cycle = cycle_count + MEM_DEP_PRED_CLEAR_INTERVAL;
+}
+
+/**************************************************************************************/
+/* add_pred_dep: make the load wait for a predicted store */
+
+static void add_pred_dep(Op* op, Op* store) {
+  DEBUG(op->proc_id, "Load op_num:%s predicted to wait for store op_num:%s\n",
+        unsstr64(op->op_num), unsstr64(store->op_num));
+  add_src_from_op(op, store, MEM_DATA_DEP);
+  if(BYTE_OVERLAP(store->oracle_info.va, store->oracle_info.mem_size,
+                  op->oracle_info.va, op->oracle_info.mem_size))
+    STAT_EVENT(op->proc_id, MEM_DEP_TRUE_DEP);
+  else
+    STAT_EVENT(op->proc_id, MEM_DEP_FALSE_DEP);
+}
+
+/**************************************************************************************/
+/* violation: squash or re-execute the load and train the predictor */
+
+static void violation(Lsq* lsq, Op* load, Op* store) {
+  DEBUG(load->proc_id, "Load op_num:%s executed before store op_num:%s\n",
+        unsstr64(load->op_num), unsstr64(store->op_num));
+  STAT_EVENT(load->proc_id, MEM_DEP_VIOLATION);
+
+  if(flush_load(load, store)) {
+    STAT_EVENT(load->proc_id, MEM_DEP_VIOLATION_FLUSH);
+  } else {
+    load->mem_viol_cycle = store->wake_cycle + MEM_DEP_VIOLATION_PENALTY;
+    /* a load still waiting for its miss wakes up at mem_viol_cycle at the
+       earliest (see wake_up_ops), so only an early wake up is undone */
+    if(load->wake_up_signaled[REG_DATA_DEP] &&
+       load->wake_cycle < load->mem_viol_cycle) {
+      load->wake_cycle = load->mem_viol_cycle;
+      retime_deps(load);
+    }
+  }
+
+  if(MEM_DEP_PRED == MEM_DEP_PRED_STORE_SETS) {
+    uns* ld_ssid = &lsq->ssit[LSQ_PC_INDEX(load->inst_info->addr, SSIT_SIZE)];
+    uns* st_ssid = &lsq->ssit[LSQ_PC_INDEX(store->inst_info->addr, SSIT_SIZE)];
+    if(*ld_ssid == LFST_SIZE && *st_ssid == LFST_SIZE)
+      *ld_ssid = LSQ_PC_INDEX(load->inst_info->addr, LFST_SIZE);
+    /* merge into the smaller store set id */
+    *ld_ssid = *st_ssid = MIN2(*ld_ssid, *st_ssid);
+  } else if(MEM_DEP_PRED == MEM_DEP_PRED_STORE_VECTOR) {
+    Counter dist = load->store_seq - 1 - store->store_seq;
+    if(dist < STORE_VECTOR_LENGTH)
+      lsq->store_vectors[LSQ_PC_INDEX(load->inst_info->addr,
+                                      STORE_VECTOR_TABLE_SIZE)] |= 1ull << dist;
+  }
+}
+
+/**************************************************************************************/
+/* flush_load: squash the load and everything younger if the frontend can
+ * refetch them. Returns FALSE if the load has to re-execute in place. */
+
+static Flag flush_load(Op* load, Op* store) {
+  if(FRONTEND != FE_PIN_EXEC_DRIVEN && FRONTEND != FE_TRACE)
+    return FALSE;
+  ASSERT(load->proc_id, bp_recovery_info->proc_id == load->proc_id);
+  ASSERT(load->proc_id, node->proc_id == load->proc_id);
+
+  /* a pending recovery at an older op squashes the load already */
+  if(bp_recovery_info->recovery_cycle != MAX_CTR &&
+     bp_recovery_info->recovery_op_num < load->op_num)
+    return TRUE;
+
+  /* fetch restarts at the load's instruction */
+  Op* first = load;
+  while(!first->bom) {
+    if(first->op_num == node->node_head->op_num)
+      return FALSE;  // the instruction's first ops retired already
+    first = node->node_ops[NODE_SLOT(first->op_num - 1)];
+  }
+  if(first->older_cf_op_num < node->node_head->op_num)
+    return FALSE;  // no branch to restore the predictor from
+
+  Op* cf_op   = node->node_ops[NODE_SLOT(first->older_cf_op_num)];
+  Op* keep_op = node->node_ops[NODE_SLOT(first->op_num - 1)];
+  ASSERT(load->proc_id, cf_op->op_num == first->older_cf_op_num);
+  bp_sched_load_recovery(bp_recovery_info, load, keep_op, cf_op,
+                         store->wake_cycle);
+  keep_op->recovery_scheduled = TRUE;
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* retime_deps: op's result arrives at op->wake_cycle, later than it first
+ * signaled. Ops that have not issued yet wait for the new time, ops that
+ * already executed on the stale value re-execute once it arrives. */
+
+static void retime_deps(Op* op) {
+  Wake_Up_Slab* slab = op->wake_up_slab_head;
+  for(uns ii = 0; ii < op->wake_up_count; ii++) {
+    Wake_Up_Entry* entry = get_wake_up_entry(op, ii, &slab);
+    Op*            dep   = entry->op;
+    /* deps not woken by op yet will see the new wake_cycle */
+    if(dep->unique_num != entry->unique_num || !dep->op_pool_valid ||
+       dep->off_path || test_not_rdy_bit(dep, entry->rdy_bit))
+      continue;
+
+    /* ops the scheduler already handed to the functional units this cycle
+       cannot be held back any more */
+    Flag selected = dep->fu_num < node->sd.max_op_count &&
+                    node->sd.ops[dep->fu_num] == dep;
+    if(dep->sched_cycle == MAX_CTR && !selected) {
+      simple_wake(op, dep, entry->rdy_bit);
+      continue;
+    }
+
+    Flag signaled = dep->wake_up_signaled[REG_DATA_DEP] ||
+                    dep->wake_up_signaled[MEM_DATA_DEP];
+    Counter latency = signaled ? dep->wake_cycle - dep->sched_cycle :
+                                 exec_latency(dep);
+    Counter redo_cycle = op->wake_cycle + latency;
+    if(redo_cycle <= dep->mem_viol_cycle)
+      continue;
+
+    DEBUG(op->proc_id, "Re-timing op_num:%s to cycle %s\n",
+          unsstr64(dep->op_num), unsstr64(redo_cycle));
+    dep->mem_viol_cycle = redo_cycle;
+    if(signaled && dep->wake_cycle < redo_cycle) {
+      dep->wake_cycle = redo_cycle;
+      retime_deps(dep);
+    }
+  }
+}
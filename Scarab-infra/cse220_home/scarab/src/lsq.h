@@ -0,0 +1,77 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : lsq.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Bounded load/store queues and memory dependence prediction.
+ ***************************************************************************************/
+
+#ifndef __LSQ_H__
+#define __LSQ_H__
+
+#include "globals/enum.h"
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Enums */
+
+/* ORACLE:       loads wait for the store they read from
+   STORE_SETS:   store set id table + last fetched store table
+   STORE_VECTOR: per load pc, the older stores to wait for
+   NONE:         loads never wait for older stores */
+#define MEM_DEP_PRED_LIST(elem) \
+  elem(ORACLE) elem(STORE_SETS) elem(STORE_VECTOR) elem(NONE)
+
+DECLARE_ENUM(Mem_Dep_Pred, MEM_DEP_PRED_LIST, MEM_DEP_PRED_);
+
+/**************************************************************************************/
+/* Global Variables */
+
+/* TRUE if LQ_SIZE, SQ_SIZE or a non-oracle MEM_DEP_PRED is set */
+extern Flag lsq_on;
+
+/**************************************************************************************/
+/* Prototypes */
+
+void alloc_mem_lsq(uns num_cores);
+void init_lsq(uns8 proc_id);
+void reset_lsq(uns8 proc_id);
+/* Drop the ops flushed by the current bp recovery from the queues */
+void recover_lsq(uns8 proc_id);
+
+/* Node stage: queue entries live from issue to retire */
+Flag lsq_can_issue(Op*);
+void lsq_issue(Op*);
+void lsq_retire(Op*);
+
+/* Map: predict the stores a load waits for. oracle_store is the youngest
+ * older store the load actually reads from (NULL if none) */
+void lsq_map_store(Op*);
+void lsq_map_load(Op*, Op* oracle_store);
+
+/* Exec: look for younger loads that already executed with stale data */
+void lsq_store_exec(Op*);
+
+/**************************************************************************************/
+
+#endif /* #ifndef __LSQ_H__ */
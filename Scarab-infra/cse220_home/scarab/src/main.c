@@ -94,6 +94,7 @@ Scarab's source code is organized as follows:
     + cmp_model.h
     + cmp_model_support.h
     + dumb_model.h
+    + interval_model.h
 
   + Cores
 
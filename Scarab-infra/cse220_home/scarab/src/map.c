@@ -34,6 +34,8 @@
 #include "globals/global_vars.h"
 #include "globals/utils.h"
 
+#include "bp/bp.h"
+#include "lsq.h"
 #include "map.h"
 #include "model.h"
 #include "thread.h"
@@ -54,28 +56,30 @@
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_MAP, ##args)
 #define DEBUGU(proc_id, args...) _DEBUGU(proc_id, DEBUG_MAP, ##args)
 
-#define WAKE_UP_ENTRIES_INC 256 /* default 256 */
+#define WAKE_UP_SLABS_INC 64 /* default 64 */
 #define MEM_ADDR_SRC \
   0 /* address for memory instructions calculated off source 0 */
 
-#define MEM_MAP_ENTRY_SIZE_LOG 3
+/* one memory map entry covers a 64-byte chunk, so that even the widest
+   vector access touches at most two entries */
+#define MEM_MAP_ENTRY_SIZE_LOG 6
 #define MEM_MAP_ENTRY_SIZE (1 << MEM_MAP_ENTRY_SIZE_LOG)
 #define MEM_MAP_BYTE_IN_ENTRY(va) ((va) & (MEM_MAP_ENTRY_SIZE - 1))
 #define MEM_MAP_ENTRY_ADDR(va) ((va) & ~(Addr)(MEM_MAP_ENTRY_SIZE - 1))
 
 #define MEM_MAP_KEY(va) ((va) >> MEM_MAP_ENTRY_SIZE_LOG)
-#define MEM_MAP_BYTE_INDEX(byte, off_path) \
-  ((byte) + ((off_path) ? MEM_MAP_ENTRY_SIZE : 0))
 
 /**************************************************************************************/
 /* Types */
 
 typedef struct Mem_Map_Entry_struct {
-  Op* op[2 * MEM_MAP_ENTRY_SIZE]; /* last op to write (invalid when committed),
-                                   * first half onpath, second half offpath*/
-  uns flag_mask;                  /* offpath flags, one per byte */
-  uns store_mask;                 /* shows position of all distinct stores
-                                   * supplying a partial value to this map entry */
+  Op* op[2][MEM_MAP_ENTRY_SIZE]; /* last op to write (invalid when committed),
+                                  * [0] onpath, [1] offpath */
+  uns64   flag_mask;     /* offpath flags, one per byte */
+  Counter flag_epoch;    /* flag_mask is stale unless this matches
+                          * map_data->mem_map_epoch */
+  uns64   store_mask[2]; /* bytes of op[] that hold a valid store (onpath,
+                          * offpath) */
 } Mem_Map_Entry;
 
 /* Data structure for easy traversal of memory map hash given an
@@ -84,8 +88,6 @@ typedef struct Mem_Map_Traversal_struct {
   Addr entry_addr; /* Entry address, can be used by caller */
   Addr first_entry_addr;
   Addr last_entry_addr;
-  uns  byte; /* Byte within entry, can be used by caller */
-  uns  last_byte;
   uns  first_entry_first_byte;
   uns  last_entry_last_byte;
 } Mem_Map_Traversal;
@@ -113,21 +115,20 @@ const char* const dep_type_names[NUM_DEP_TYPES] = {
 static inline void read_reg_map(Op*);
 static inline void read_store_map(Op*);
 static inline void update_map(Op*);
+static void        recover_onpath_map(Counter recovery_op_num);
 
-static inline void expand_wake_up_entries(void);
+static inline void expand_wake_up_slabs(void);
 static inline void update_store_hash(Op* op);
-static inline Op*  add_store_deps(Op* op);
+static inline Op*  add_store_deps(Op* op, Flag add_srcs);
 static inline void update_map_entry(Op* op, Map_Entry* map_entry);
-static inline void recover_mem_map_entry(void* hash_entry, void* arg);
+static inline uns64 mem_map_flags(Mem_Map_Entry* entry);
 
 /* memory map hash traversal */
 static inline void mem_map_entry_traversal_init(Mem_Map_Traversal* traversal,
                                                 Addr va, uns size);
 static inline Flag mem_map_entry_traversal_done(Mem_Map_Traversal* traversal);
 static inline void mem_map_entry_traversal_next(Mem_Map_Traversal* traversal);
-static inline void mem_map_byte_traversal_init(Mem_Map_Traversal* traversal);
-static inline Flag mem_map_byte_traversal_done(Mem_Map_Traversal* traversal);
-static inline void mem_map_byte_traversal_next(Mem_Map_Traversal* traversal);
+static inline uns64 mem_map_byte_mask(Mem_Map_Traversal* traversal);
 
 /**************************************************************************************/
 /* set_map_data: */
@@ -162,18 +163,16 @@ void init_map(uns8 proc_id) {
   map_data->last_store[1].op     = &invalid_op;
   map_data->last_store[1].op_num = 0;
 
-  /* Allocate the wake_up_entry pool. */
-  expand_wake_up_entries();
+  /* Allocate the wake up overflow slab pool. */
+  expand_wake_up_slabs();
 
-  /* Initialize the memory dependence hash table. The number of
-     buckets matters since we scan all entries (and all buckets) on
-     branch misprediction recovery, so we want to keep the number of
-     buckets large enough to avoid collisions but small enough to
-     keep the scan fast. Since the number of entries is roughly at
-     most the number of in-flight stores, we set the number of
-     buckets to the size of instruction window. */
+  /* Initialize the memory dependence hash table. Since the number of
+     entries is roughly at most the number of in-flight stores, we set
+     the number of buckets to the size of instruction window. Recovery
+     does not scan the table; it bumps mem_map_epoch instead. */
   init_hash_table(&map_data->oracle_mem_hash, "oracle mem dependence map",
                   NODE_TABLE_SIZE, sizeof(Mem_Map_Entry));
+  map_data->mem_map_epoch = 0;
 
   /* Init the register renaming table */
   map_data->rename_table = NULL;
@@ -184,22 +183,64 @@ void init_map(uns8 proc_id) {
 /**************************************************************************************/
 /* recover_map: quick recover back to on path state */
 
-void recover_map() {
+void recover_map(Counter recovery_op_num) {
   uns ii;
   DEBUG(map_data->proc_id, "Recovering register map\n");
+  if(bp_recovery_info->load_recovery)
+    recover_onpath_map(recovery_op_num);
   for(ii = 0; ii < NUM_REG_IDS; ii++)
     map_data->map_flags[ii] = FALSE;
   map_data->last_store_flag = FALSE;
-  hash_table_scan(&map_data->oracle_mem_hash, recover_mem_map_entry, NULL);
+  /* clear the offpath flags of all memory map entries lazily */
+  map_data->mem_map_epoch++;
   rebuild_offpath_map();
 }
 
 /**************************************************************************************/
-/* recover_mem_map_entry: */
+/* recover_onpath_map: a memory ordering flush squashes on-path ops too. Map
+ * entries they wrote fall back to the youngest surviving writer, found by
+ * replaying the on-path ops still in flight (the seq_op_list is recovered
+ * already); with none, the value is committed. */
+
+static void recover_onpath_map(Counter recovery_op_num) {
+  Flag stale_regs  = FALSE;
+  Flag stale_store = map_data->last_store[0].op_num > recovery_op_num;
+
+  for(uns ii = 0; ii < NUM_REG_IDS; ii++) {
+    Map_Entry* map_entry = &map_data->reg_map[ii << 1];
+    if(map_entry->op_num > recovery_op_num) {
+      map_entry->op     = &invalid_op;
+      map_entry->op_num = 0;
+      stale_regs        = TRUE;
+    }
+  }
+  if(stale_store) {
+    map_data->last_store[0].op     = &invalid_op;
+    map_data->last_store[0].op_num = 0;
+  }
+  if(!stale_regs && !stale_store)
+    return;
 
-void recover_mem_map_entry(void* hash_entry, void* arg) {
-  Mem_Map_Entry* entry = (Mem_Map_Entry*)hash_entry;
-  entry->flag_mask     = 0;
+  /* the squashed stores leave the memory map when they are freed */
+  for(Op** op_p = (Op**)list_start_head_traversal(&td->seq_op_list);
+      op_p && !(*op_p)->off_path;
+      op_p = (Op**)list_next_element(&td->seq_op_list)) {
+    update_map(*op_p);
+    if(stale_store && (*op_p)->table_info->mem_type == MEM_ST)
+      update_store_hash(*op_p);
+  }
+}
+
+/**************************************************************************************/
+/* mem_map_flags: offpath flags of a memory map entry, cleared if a recovery
+ * happened since they were last written */
+
+static inline uns64 mem_map_flags(Mem_Map_Entry* entry) {
+  if(entry->flag_epoch != map_data->mem_map_epoch) {
+    entry->flag_mask  = 0;
+    entry->flag_epoch = map_data->mem_map_epoch;
+  }
+  return entry->flag_mask;
 }
 
 /**************************************************************************************/
@@ -229,22 +270,55 @@ void rebuild_offpath_map() {
 
 
 /**************************************************************************************/
-/* expand_wake_up_pool: */
+/* expand_wake_up_slabs: */
 
-static inline void expand_wake_up_entries() {
-  Wake_Up_Entry* new_pool = (Wake_Up_Entry*)calloc(WAKE_UP_ENTRIES_INC,
-                                                   sizeof(Wake_Up_Entry));
-  uns            ii;
+static inline void expand_wake_up_slabs() {
+  Wake_Up_Slab* new_pool = (Wake_Up_Slab*)calloc(WAKE_UP_SLABS_INC,
+                                                 sizeof(Wake_Up_Slab));
+  uns           ii;
 
-  DEBUGU(map_data->proc_id, "Expanding wake up pool to size %d\n",
-         (map_data->wake_up_entries + WAKE_UP_ENTRIES_INC));
-  for(ii = 0; ii < WAKE_UP_ENTRIES_INC - 1; ii++)
+  DEBUGU(map_data->proc_id, "Expanding wake up slab pool to size %d\n",
+         (map_data->wake_up_slabs + WAKE_UP_SLABS_INC));
+  for(ii = 0; ii < WAKE_UP_SLABS_INC - 1; ii++)
     new_pool[ii].next = &new_pool[ii + 1];
-  new_pool[ii].next        = map_data->free_list_head;
-  map_data->free_list_head = &new_pool[0];
-  map_data->wake_up_entries += WAKE_UP_ENTRIES_INC;
-  ASSERT(map_data->proc_id,
-         map_data->wake_up_entries <= WAKE_UP_ENTRIES_INC * 128);
+  new_pool[ii].next        = map_data->free_slab_head;
+  map_data->free_slab_head = &new_pool[0];
+  map_data->wake_up_slabs += WAKE_UP_SLABS_INC;
+  ASSERT(map_data->proc_id, map_data->wake_up_slabs <= WAKE_UP_SLABS_INC * 128);
+}
+
+
+/**************************************************************************************/
+/* alloc_wake_up_entry: returns the next free entry in the wake up list of
+ * src_op. The first entries live in the op itself, the rest in slabs taken
+ * from the pool. */
+
+static inline Wake_Up_Entry* alloc_wake_up_entry(Op* src_op) {
+  uns idx = src_op->wake_up_count++;
+
+  if(idx < WAKE_UP_INLINE_ENTRIES)
+    return &src_op->wake_up_inline[idx];
+
+  idx -= WAKE_UP_INLINE_ENTRIES;
+  if(idx % WAKE_UP_SLAB_ENTRIES == 0) {
+    Wake_Up_Slab* slab;
+    if(map_data->free_slab_head == NULL) {
+      ASSERT(map_data->proc_id,
+             map_data->active_wake_up_slabs == map_data->wake_up_slabs);
+      expand_wake_up_slabs();
+    }
+    slab                     = map_data->free_slab_head;
+    map_data->free_slab_head = slab->next;
+    map_data->active_wake_up_slabs++;
+    slab->next = NULL;
+
+    if(src_op->wake_up_slab_tail)
+      src_op->wake_up_slab_tail->next = slab;
+    else
+      src_op->wake_up_slab_head = slab;
+    src_op->wake_up_slab_tail = slab;
+  }
+  return &src_op->wake_up_slab_tail->entries[idx % WAKE_UP_SLAB_ENTRIES];
 }
 
 
@@ -369,10 +443,16 @@ inline void update_map_entry(Op* op, Map_Entry* map_entry) {
 void map_mem_dep(Op* op) {
   if(!MEM_OBEY_STORE_DEP)
     return;
-  if(op->table_info->mem_type == MEM_ST)
+  if(op->table_info->mem_type == MEM_ST) {
     update_store_hash(op);
-  if(op->table_info->mem_type == MEM_LD)
-    add_store_deps(op);
+    lsq_map_store(op);
+  }
+  if(op->table_info->mem_type == MEM_LD) {
+    if(MEM_DEP_PRED == MEM_DEP_PRED_ORACLE)
+      add_store_deps(op, TRUE);
+    else
+      lsq_map_load(op, add_store_deps(op, FALSE));
+  }
 }
 
 /**************************************************************************************/
@@ -409,22 +489,17 @@ static inline void mem_map_entry_traversal_next(Mem_Map_Traversal* traversal) {
                                            MEM_MAP_ENTRY_SIZE);
 }
 
-static inline void mem_map_byte_traversal_init(Mem_Map_Traversal* traversal) {
-  traversal->byte = traversal->entry_addr == traversal->first_entry_addr ?
-                      traversal->first_entry_first_byte :
-                      0;
-  traversal->last_byte = traversal->entry_addr == traversal->last_entry_addr ?
-                           traversal->last_entry_last_byte :
-                           MEM_MAP_ENTRY_SIZE - 1;
-  ASSERT(0, traversal->byte <= traversal->last_byte);
-}
-
-static inline Flag mem_map_byte_traversal_done(Mem_Map_Traversal* traversal) {
-  return traversal->byte > traversal->last_byte;
-}
-
-static inline void mem_map_byte_traversal_next(Mem_Map_Traversal* traversal) {
-  traversal->byte++;
+/* mem_map_byte_mask: bytes of the current entry covered by the access */
+static inline uns64 mem_map_byte_mask(Mem_Map_Traversal* traversal) {
+  uns first = traversal->entry_addr == traversal->first_entry_addr ?
+                traversal->first_entry_first_byte :
+                0;
+  uns last  = traversal->entry_addr == traversal->last_entry_addr ?
+                traversal->last_entry_last_byte :
+                MEM_MAP_ENTRY_SIZE - 1;
+  ASSERT(0, first <= last);
+  return (N_BIT_MASK_64 >> (MEM_MAP_ENTRY_SIZE - 1 - last)) &
+         (N_BIT_MASK_64 << first);
 }
 
 /**************************************************************************************/
@@ -447,15 +522,14 @@ void delete_store_hash_entry(Op* op) {
       continue;
 
     /* Iterate through each byte written to by the op (within this entry) */
-    for(mem_map_byte_traversal_init(&traversal);
-        !mem_map_byte_traversal_done(&traversal);
-        mem_map_byte_traversal_next(&traversal)) {
-      uns ind = MEM_MAP_BYTE_INDEX(traversal.byte, op->off_path);
-      if(TESTBIT(mem_map_p->store_mask, ind) && mem_map_p->op[ind] == op) {
-        CLRBIT(mem_map_p->store_mask, ind);
-      }
+    uns   half  = op->off_path ? 1 : 0;
+    uns64 bytes = mem_map_byte_mask(&traversal) & mem_map_p->store_mask[half];
+    for(; bytes; bytes &= bytes - 1) {
+      uns byte = __builtin_ctzll(bytes);
+      if(mem_map_p->op[half][byte] == op)
+        mem_map_p->store_mask[half] &= ~(1ULL << byte);
     }
-    if(!mem_map_p->store_mask) {
+    if(!mem_map_p->store_mask[0] && !mem_map_p->store_mask[1]) {
       hash_table_access_delete(&map_data->oracle_mem_hash,
                                MEM_MAP_KEY(traversal.entry_addr));
     }
@@ -463,9 +537,11 @@ void delete_store_hash_entry(Op* op) {
 }
 
 /**************************************************************************************/
-/* add_store_deps: */
+/* add_store_deps: finds the youngest older store the load reads from. The
+   store(s) become sources of the load only if add_srcs is set, otherwise the
+   memory dependence predictor decides what the load waits for. */
 
-static inline Op* add_store_deps(Op* op) {
+static inline Op* add_store_deps(Op* op, Flag add_srcs) {
   Addr              va            = op->oracle_info.va;
   Op*               last_src_op   = NULL;
   uns               orig_num_srcs = op->oracle_info.num_srcs;
@@ -483,22 +559,22 @@ static inline Op* add_store_deps(Op* op) {
     if(!mem_map_p)
       continue;
 
-    /* Iterate through each byte read by the op (within this entry) */
-    for(mem_map_byte_traversal_init(&traversal);
-        !mem_map_byte_traversal_done(&traversal);
-        mem_map_byte_traversal_next(&traversal)) {
-      uns ind = MEM_MAP_BYTE_INDEX(
-        traversal.byte, TESTBIT(mem_map_p->flag_mask, traversal.byte));
-      if(!TESTBIT(mem_map_p->store_mask, ind))
-        continue; /* ensure mem_map_p info is valid */
-      Op* src_op = mem_map_p->op[ind];
+    /* Iterate through each byte read by the op (within this entry) that
+       holds a valid store on the path given by its offpath flag */
+    uns64 mask  = mem_map_byte_mask(&traversal);
+    uns64 flags = mem_map_flags(mem_map_p);
+    uns64 bytes = (mask & ~flags & mem_map_p->store_mask[0]) |
+                  (mask & flags & mem_map_p->store_mask[1]);
+    for(; bytes; bytes &= bytes - 1) {
+      uns byte   = __builtin_ctzll(bytes);
+      Op* src_op = mem_map_p->op[(flags >> byte) & 1][byte];
       ASSERTM(op->proc_id,
               BYTE_OVERLAP(src_op->oracle_info.va, src_op->oracle_info.mem_size,
                            va, op->oracle_info.mem_size),
               "%d@0x%08x and %d@0x%08x\n", src_op->oracle_info.mem_size,
               (uns32)src_op->oracle_info.va, op->oracle_info.mem_size,
               (uns32)va);
-      if(MEM_OOO_STORES && !src_op->marked) {
+      if(add_srcs && MEM_OOO_STORES && !src_op->marked) {
         add_src_from_op(op, src_op, MEM_DATA_DEP);
         src_op->marked = TRUE;  // mark op to avoid adding duplicate sources
         STAT_EVENT(op->proc_id, FORWARDED_LD);
@@ -517,7 +593,9 @@ static inline Op* add_store_deps(Op* op) {
   }
 
   ASSERT(op->proc_id, last_src_op->op_num < op->op_num || op->off_path);
-  if(MEM_OOO_STORES) {
+  if(!add_srcs) {
+    STAT_EVENT(op->proc_id, FORWARDED_LD);
+  } else if(MEM_OOO_STORES) {
     /* unmark all ops we marked earlier */
     for(uns ii = orig_num_srcs; ii < op->oracle_info.num_srcs; ii++) {
       ASSERT(op->proc_id, op->oracle_info.src_info[ii].op->marked);
@@ -551,27 +629,45 @@ static inline void update_store_hash(Op* op) {
       &new_entry);
 
     if(new_entry) {
-      mem_map_p->flag_mask  = 0;
-      mem_map_p->store_mask = 0;
+      mem_map_p->flag_mask     = 0;
+      mem_map_p->flag_epoch    = map_data->mem_map_epoch;
+      mem_map_p->store_mask[0] = 0;
+      mem_map_p->store_mask[1] = 0;
     }
 
-    /* Iterate through each byte written to by the op (within this entry) */
-    for(mem_map_byte_traversal_init(&traversal);
-        !mem_map_byte_traversal_done(&traversal);
-        mem_map_byte_traversal_next(&traversal)) {
-      DEFBIT(mem_map_p->flag_mask, traversal.byte, op->off_path);
-      uns ind = MEM_MAP_BYTE_INDEX(traversal.byte, op->off_path);
-      SETBIT(mem_map_p->store_mask, ind);
-      mem_map_p->op[ind] = op;
-    }
+    /* Mark each byte written to by the op (within this entry) */
+    uns   half  = op->off_path ? 1 : 0;
+    uns64 mask  = mem_map_byte_mask(&traversal);
+    uns64 flags = mem_map_flags(mem_map_p);
+    mem_map_p->flag_mask = op->off_path ? flags | mask : flags & ~mask;
+    mem_map_p->store_mask[half] |= mask;
+    for(uns64 bytes = mask; bytes; bytes &= bytes - 1)
+      mem_map_p->op[half][__builtin_ctzll(bytes)] = op;
   }
 }
 
+/**************************************************************************************/
+/* get_wake_up_entry: returns entry idx of the op's wake up list. Walk the list
+ * in order starting with *slab = op->wake_up_slab_head; *slab tracks the
+ * current overflow slab. */
+
+Wake_Up_Entry* get_wake_up_entry(Op* op, uns idx, Wake_Up_Slab** slab) {
+  ASSERT(op->proc_id, idx < op->wake_up_count);
+  if(idx < WAKE_UP_INLINE_ENTRIES)
+    return &op->wake_up_inline[idx];
+
+  idx -= WAKE_UP_INLINE_ENTRIES;
+  if(idx && idx % WAKE_UP_SLAB_ENTRIES == 0)
+    *slab = (*slab)->next;
+  return &(*slab)->entries[idx % WAKE_UP_SLAB_ENTRIES];
+}
+
 /**************************************************************************************/
 /* wake_up_ops: */
 
 void wake_up_ops(Op* op, Dep_Type type, void (*wake_action)(Op*, Op*, uns8)) {
-  Wake_Up_Entry* temp;
+  Wake_Up_Slab* slab = op->wake_up_slab_head;
+  uns           ii;
 
 
   _DEBUG(op->proc_id, DEBUG_REPLAY,
@@ -582,9 +678,14 @@ void wake_up_ops(Op* op, Dep_Type type, void (*wake_action)(Op*, Op*, uns8)) {
           op->off_path);
 
   ASSERT(op->proc_id, wake_action);
-  for(temp = op->wake_up_head; temp; temp = temp->next) {
-    Op*     dep_op         = temp->op;
-    Counter dep_unique_num = temp->unique_num;
+  /* an op re-executing after a memory ordering violation has its real result
+     no earlier than mem_viol_cycle */
+  if(lsq_on)
+    op->wake_cycle = MAX2(op->wake_cycle, op->mem_viol_cycle);
+  for(ii = 0; ii < op->wake_up_count; ii++) {
+    Wake_Up_Entry* temp           = get_wake_up_entry(op, ii, &slab);
+    Op*            dep_op         = temp->op;
+    Counter        dep_unique_num = temp->unique_num;
 
     ASSERT(op->proc_id, dep_op);
 
@@ -656,35 +757,14 @@ void add_to_wake_up_lists(Op* op, Op_Info* op_info,
         op->op_num, op->fetch_cycle, src_op->op_num, src_op->unique_num,
         src_op->fetch_cycle);
 
-      if(map_data->free_list_head == NULL) {
-        ASSERT(map_data->proc_id,
-               map_data->active_wake_up_entries == map_data->wake_up_entries);
-        expand_wake_up_entries();
-      }
-
       if(src_info->type == MEM_DATA_DEP)
         dep_on_in_window_store = TRUE;
 
-      wake = map_data->free_list_head;
-      map_data->active_wake_up_entries++;
-      map_data->free_list_head = wake->next;
-
+      wake             = alloc_wake_up_entry(src_op);
       wake->op         = op;
       wake->unique_num = op->unique_num;
       wake->dep_type   = src_info->type;
       wake->rdy_bit    = ii;
-      wake->next       = NULL;
-
-      if(src_op->wake_up_tail == NULL) {
-        src_op->wake_up_head  = wake;
-        src_op->wake_up_tail  = wake;
-        src_op->wake_up_count = 1;
-      } else {
-        ASSERT(map_data->proc_id, src_op->wake_up_head);
-        src_op->wake_up_tail->next = wake;
-        src_op->wake_up_tail       = wake;
-        src_op->wake_up_count++;
-      }
 
       if(TRACK_L1_MISS_DEPS) {
         // An op can occupy multiple entries in the wakeup list of another op
@@ -721,16 +801,26 @@ void free_wake_up_list(Op* op) {
   ASSERT(map_data->proc_id, op);
   ASSERT(map_data->proc_id, op->proc_id == map_data->proc_id);
 
-  if(op->wake_up_tail) {
-    ASSERT(map_data->proc_id, op->wake_up_head);
+  /* Entries pointing at ops that have since been freed are never walked
+     here; wake_up_ops skips them because their unique_num no longer
+     matches. Only the overflow slabs have to be returned to the pool. */
+  if(op->wake_up_count) {
     DEBUG(map_data->proc_id, "Freeing wake up list for op_num:%s\n",
           unsstr64(op->op_num));
-    op->wake_up_tail->next   = map_data->free_list_head;
-    map_data->free_list_head = op->wake_up_head;
-    map_data->active_wake_up_entries -= op->wake_up_count;
-    ASSERT(map_data->proc_id, map_data->active_wake_up_entries >= 0);
-    op->wake_up_head = NULL;
-    op->wake_up_tail = NULL;
+    if(op->wake_up_slab_head) {
+      uns num_slabs = (op->wake_up_count - WAKE_UP_INLINE_ENTRIES +
+                       WAKE_UP_SLAB_ENTRIES - 1) /
+                      WAKE_UP_SLAB_ENTRIES;
+      ASSERT(map_data->proc_id, op->wake_up_slab_tail);
+      ASSERT(map_data->proc_id,
+             map_data->active_wake_up_slabs >= num_slabs);
+      op->wake_up_slab_tail->next = map_data->free_slab_head;
+      map_data->free_slab_head    = op->wake_up_slab_head;
+      map_data->active_wake_up_slabs -= num_slabs;
+      op->wake_up_slab_head = NULL;
+      op->wake_up_slab_tail = NULL;
+    }
+    op->wake_up_count = 0;
   } else {
     DEBUG(map_data->proc_id, "No wake up list for op_num:%s\n",
           unsstr64(op->op_num));
@@ -1172,7 +1262,7 @@ void merged_reg_file_flush_mispredict(int ptag) {
 
   ASSERT(map_data->proc_id, entry != NULL);
   ASSERT(map_data->proc_id, entry->reg_state == REG_FILE_ENTRY_STATE_ALLOC || entry->reg_state == REG_FILE_ENTRY_STATE_PRODUCED);
-  ASSERT(map_data->proc_id, entry->off_path);
+  ASSERT(map_data->proc_id, entry->off_path || bp_recovery_info->load_recovery);
 
   // update register map table by prev
   ASSERT(map_data->proc_id, map_data->rename_table->merged_rf->reg_map_table[entry->reg_arch_id] == ptag);
@@ -1256,7 +1346,8 @@ void rename_table_recover(Counter recovery_op_num) {
 
   // release the register from the youngest to the oldest
   while (op_p && (*op_p)->op_num > recovery_op_num) {
-    ASSERT(map_data->proc_id, (*op_p)->off_path);
+    ASSERT(map_data->proc_id,
+           (*op_p)->off_path || bp_recovery_info->load_recovery);
     for (uns ii = 0; ii < (*op_p)->table_info->num_dest_regs; ii++)
       merged_reg_file_flush_mispredict((*op_p)->dst_reg_file_ptag[ii]);
 
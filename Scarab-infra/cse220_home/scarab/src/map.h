@@ -110,10 +110,12 @@ typedef struct Map_Data_struct {
   Flag      last_store_flag;
 
   Hash_Table oracle_mem_hash;
+  Counter    mem_map_epoch; /* bumped on recovery, invalidates the offpath
+                               flags of every memory map entry */
 
-  Wake_Up_Entry* free_list_head;
-  uns            wake_up_entries;
-  uns            active_wake_up_entries;
+  Wake_Up_Slab* free_slab_head;
+  uns           wake_up_slabs;
+  uns           active_wake_up_slabs;
 
   /* register renaming implementation based on the hardware scheme */
   Reg_Renaming_Table *rename_table;
@@ -131,13 +133,14 @@ extern Map_Data* map_data;
 
 Map_Data* set_map_data(Map_Data*);
 void      init_map(uns8);
-void      recover_map(void);
+void      recover_map(Counter);
 void      rebuild_offpath_map(void);
 void      reset_map(void);
 void      map_op(Op*);
 void      map_mem_dep(Op*);
 void      wake_up_ops(Op*, Dep_Type, void (*)(Op*, Op*, uns8));
 void      free_wake_up_list(Op*);
+Wake_Up_Entry* get_wake_up_entry(Op*, uns, Wake_Up_Slab**);
 void      add_to_wake_up_lists(Op*, Op_Info*, void (*)(Op*, Op*, uns8));
 
 void add_src_from_op(Op*, Op*, Dep_Type);
@@ -60,10 +60,6 @@
 /* Global Variables */
 
 Map_Stage* map = NULL;
-// The next op number is used when deciding whether to consume ops from the
-// uop cache: i.e. check if any preceding instructions are still in the decoder.
-Counter map_stage_next_op_num = 1;
-int map_off_path = 0;
 
 /**************************************************************************************/
 /* Local prototypes */
@@ -105,7 +101,9 @@ void init_map_stage(uns8 proc_id, const char* name) {
     cur->max_op_count = STAGE_MAX_OP_COUNT;
     cur->ops          = (Op**)malloc(sizeof(Op*) * STAGE_MAX_OP_COUNT);
   }
-  map->last_sd = &map->sds[0];
+  map->last_sd     = &map->sds[0];
+  map->next_op_num = 1;
+  map->off_path    = FALSE;
   reset_map_stage();
 }
 
@@ -130,7 +128,7 @@ void reset_map_stage() {
 
 void recover_map_stage() {
   uns ii, jj, kk;
-  map_off_path = 0;
+  map->off_path = FALSE;
   ASSERT(0, map);
   for(ii = 0; ii < STAGE_MAX_DEPTH; ii++) {
     Stage_Data* cur = &map->sds[ii];
@@ -151,9 +149,9 @@ void recover_map_stage() {
     }
   }
 
-  if (map_stage_next_op_num > bp_recovery_info->recovery_op_num) {
-    map_stage_next_op_num = bp_recovery_info->recovery_op_num + 1;
-    DEBUG(map->proc_id, "Recovering map_stage_next_op_num to %llu\n", map_stage_next_op_num);
+  if (map->next_op_num > bp_recovery_info->recovery_op_num) {
+    map->next_op_num = bp_recovery_info->recovery_op_num + 1;
+    DEBUG(map->proc_id, "Recovering map->next_op_num to %llu\n", map->next_op_num);
   }
 }
 
@@ -211,10 +209,10 @@ void update_map_stage(Stage_Data* dec_src_sd, Stage_Data* uopq_src_sd) {
     // The map stage may consume multiple ops in one cycle from both
     // the map stage and the uop cache source if allowed.
     ASSERT(map->proc_id, uopq_src_sd != NULL);
-    if (dec_src_sd->op_count && dec_src_sd->ops[0]->op_num == map_stage_next_op_num) {
+    if (dec_src_sd->op_count && dec_src_sd->ops[0]->op_num == map->next_op_num) {
       consume_from_sd = dec_src_sd;
       other_sd = uopq_src_sd;  //can only consume ALL ops from this stage if the other sd has them ready. Otherwise only the first few
-    } else if (uopq_src_sd->op_count && uopq_src_sd->ops[0]->op_num == map_stage_next_op_num) {
+    } else if (uopq_src_sd->op_count && uopq_src_sd->ops[0]->op_num == map->next_op_num) {
       consume_from_sd = uopq_src_sd;
       other_sd = dec_src_sd;
     }
@@ -224,12 +222,12 @@ void update_map_stage(Stage_Data* dec_src_sd, Stage_Data* uopq_src_sd) {
     // is from the decode stage.
     ASSERT(map->proc_id, uopq_src_sd == NULL);
     if (dec_src_sd->op_count) {
-      ASSERT(map->proc_id, dec_src_sd->ops[0]->op_num == map_stage_next_op_num);
+      ASSERT(map->proc_id, dec_src_sd->ops[0]->op_num == map->next_op_num);
       consume_from_sd = dec_src_sd;
     }
   }
 
-  if(!map_off_path) {
+  if(!map->off_path) {
     if(stall)
       STAT_EVENT(map->proc_id, MAP_STAGE_STALLED);
     else
@@ -259,11 +257,11 @@ void update_map_stage(Stage_Data* dec_src_sd, Stage_Data* uopq_src_sd) {
     for(int ii = 0; ii < cur->op_count; ii++) {
       Op* op = cur->ops[ii];
       if (op && op->off_path)
-        map_off_path = 1;
+        map->off_path = TRUE;
     }
     // Probably should count number of on-path ops. 
     // Any stage can receive a mix of on/off-path ops in a single cycle.
-    if (!map_off_path)
+    if (!map->off_path)
       STAT_EVENT(map->proc_id, MAP_STAGE_RECEIVED_OPS_0 + cur->op_count);
     ASSERT(map->proc_id, cur->op_count <= MAP_STAGE_RECEIVED_OPS_MAX);
   }
@@ -291,6 +289,9 @@ void update_map_stage(Stage_Data* dec_src_sd, Stage_Data* uopq_src_sd) {
 static inline void stage_process_op(Op* op) {
   /* the map stage is currently responsible only for setting wake up lists */
   add_to_wake_up_lists(op, &op->oracle_info, model->wake_hook);
+  if(op->fused_op)
+    add_to_wake_up_lists(op->fused_op, &op->fused_op->oracle_info,
+                         model->wake_hook);
 }
 
 
@@ -304,14 +305,19 @@ static inline Flag map_fetch_fill_op(Stage_Data* src_sd, int* fetch_idx) {
 
   Op* op = src_sd->ops[*fetch_idx];
 
-  if (op && op->op_num == map_stage_next_op_num) {
+  if (op && op->op_num == map->next_op_num) {
     DEBUG(map->proc_id, "Fetching opnum=%llu from %s at idx=%i\n", op->op_num, src_sd->name, *fetch_idx);
     if (!op->decode_cycle) decode_stage_process_op(op);
     op->map_cycle = cycle_count;
     dest_sd->ops[dest_sd->op_count++] = op;
     src_sd->ops[*fetch_idx] = NULL;
     src_sd->op_count--;
-    map_stage_next_op_num++;
+    map->next_op_num++;
+    if (op->fused_op) {
+      ASSERT(map->proc_id, op->fused_op->op_num == map->next_op_num);
+      op->fused_op->map_cycle = cycle_count;
+      map->next_op_num++;
+    }
     *fetch_idx = *fetch_idx + 1;
     return TRUE;
   }
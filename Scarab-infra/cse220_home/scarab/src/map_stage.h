@@ -41,6 +41,11 @@ typedef struct Map_Stage_struct {
                         * allocated number of pipe stages) */
   Stage_Data* last_sd; /* pointer to last decode pipeline stage
                         * (for passing ops to map) */
+  Counter next_op_num; /* next op to map; decides whether to consume ops from
+                        * the uop cache, i.e. whether any preceding
+                        * instructions are still in the decoder */
+  Flag off_path;       /* an off-path op has been mapped since the last
+                        * recovery */
 } Map_Stage;
 
 
@@ -24,6 +24,20 @@
  * Author       : HPS Research Group
  * Date         : 2/19/2014
  * Description  : Shared cache partitioning mechanisms
+ *
+ * Utility monitors (UMON-DSS): each core has a true-LRU shadow tag array that
+ * only covers every L1_SHADOW_TAGS_MODULO-th L1 set, so its size shrinks with
+ * the sampling ratio. Shadow hits are counted per LRU position as they happen
+ * and turned into a miss curve (misses vs. ways) at every repartition.
+ *
+ * Every metric is a per-core term combined by a sum or a product, so the
+ * searches only re-evaluate the core whose allocation changes:
+ * - GREEDY hands out one way at a time to the best marginal gain,
+ *   O(cores x ways) per repartition.
+ * - LOOKAHEAD (UCP Algorithm 2) caches each core's best marginal utility and
+ *   only recomputes it when that core's allocation changes or the remaining
+ *   balance drops below its best extra ways.
+ * - BRUTE_FORCE enumerates every partition (small configurations only).
  ***************************************************************************************/
 
 #include <math.h>
@@ -50,15 +64,21 @@
 /* Types */
 
 typedef struct Proc_Info_struct {
-  Cache   shadow_cache;
-  double* miss_rates;  // indexed by number of ways - 1
+  Cache    shadow_cache;
+  Counter  accesses;    // shadow accesses counted in this interval
+  Counter* hit_pos;     // shadow hits per LRU position in this interval
+  double*  miss_rates;  // indexed by number of ways (0 to L1_ASSOC)
+  double   best_mu;     // lookahead: best marginal utility of this core's term
+  uns      best_extra;  // lookahead: extra ways achieving best_mu
+  Flag     best_valid;  // lookahead: best_mu is up to date
 } Proc_Info;
 
 typedef struct Shadow_Cache_Data_struct {
-  Flag prefetched;
+  Flag    prefetched;
+  Counter fetch_cycle;
 } Shadow_Cache_Data;
 
-typedef double (*Metric_Func)(uns*);
+typedef double (*Term_Func)(uns proc_id, uns ways);
 typedef void (*Search_Func)(void);
 
 /**************************************************************************************/
@@ -69,12 +89,16 @@ Trigger* l1_part_start;  // indicates the L1 partition has been enabled
 Trigger* l1_part_trigger;  // external trigger for trigger repart (should not be
                            // set too often)
 Stat_Mon*   stat_mon;
-Metric_Func metric_func;
+Term_Func   term_func;
+Flag        term_product;  // metric is -(product of terms) instead of a sum
 Search_Func search_func;
 uns*        current_partition;  // actual enforced partition
 uns*        new_partition;      // pre-allocated structure for new partition
 uns* temp_partition;  // pre-allocated structure for partition exploration
-uns  tie_breaker_proc_id;
+double* term_weights;  // d(metric)/d(term) of each core for a given partition
+uns     tie_breaker_proc_id;
+uns     l1_set_bits;
+uns     shadow_set_bits;
 
 /**************************************************************************************/
 /* Enums */
@@ -86,12 +110,16 @@ DEFINE_ENUM(Cache_Part_Search, CACHE_PART_SEARCH_LIST);
 /* Local Prototypes */
 
 static Flag   in_shadow_cache(Addr addr);
-static double get_global_miss_rate(uns* partition);
-static double get_miss_rate_sum(uns* partition);
-static double get_gmean_perf(uns* partition);
-static double get_best_marginal_utility(uns* partition, uns proc_id,
-                                        uns balance, uns* extra_ways);
+static Addr   shadow_addr(Addr addr);
+static double get_metric(uns* partition);
+static void   get_term_weights(uns* partition);
+static double get_global_miss_rate(uns proc_id, uns ways);
+static double get_miss_rate_sum(uns proc_id, uns ways);
+static double get_gmean_perf(uns proc_id, uns ways);
+static void   get_best_marginal_utility(uns proc_id, uns ways, uns balance);
 static void   measure_miss_curves(void);
+static void   reset_miss_counters(void);
+static void   search_greedy(void);
 static void   search_lookahead(void);
 static void   search_bruteforce(void);
 static void   set_partition(void);
@@ -109,283 +137,38 @@ void cache_part_init(void) {
 
   ASSERTM(0, !PRIVATE_L1, "Cache partitioning works only on shared cache.\n");
   ASSERT(0, L1_CACHE_REPL_POLICY == REPL_PARTITION);
-  ASSERT(0, L1_ASSOC <= 128);
 
-  // create shadow cache for each core
+  uns l1_sets = L1_SIZE / (L1_LINE_SIZE * L1_ASSOC);
+  ASSERTM(0,
+          L1_SHADOW_TAGS_MODULO > 0 &&
+            !(L1_SHADOW_TAGS_MODULO & (L1_SHADOW_TAGS_MODULO - 1)) &&
+            L1_SHADOW_TAGS_MODULO <= l1_sets,
+          "L1_SHADOW_TAGS_MODULO must be a power of two no larger than the "
+          "number of L1 sets (%d)\n",
+          l1_sets);
+  l1_set_bits     = LOG2(l1_sets);
+  shadow_set_bits = l1_set_bits - LOG2(L1_SHADOW_TAGS_MODULO);
+
+  // create shadow cache for each core, covering only the sampled sets
   proc_infos = calloc(NUM_CORES, sizeof(Proc_Info));
   for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     Proc_Info* proc_info = &proc_infos[proc_id];
     char       buf[MAX_STR_LENGTH + 1];
     sprintf(buf, "SHADOW L1[%d]", proc_id);
-    init_cache(&proc_info->shadow_cache, buf, L1_SIZE, L1_ASSOC, L1_LINE_SIZE,
-               sizeof(Shadow_Cache_Data), REPL_TRUE_LRU);
-    proc_info->miss_rates = calloc(L1_ASSOC, sizeof(double));
+    init_cache(&proc_info->shadow_cache, buf, L1_SIZE / L1_SHADOW_TAGS_MODULO,
+               L1_ASSOC, L1_LINE_SIZE, sizeof(Shadow_Cache_Data),
+               REPL_TRUE_LRU);
+    proc_info->hit_pos    = calloc(L1_ASSOC, sizeof(Counter));
+    proc_info->miss_rates = calloc(L1_ASSOC + 1, sizeof(double));
   }
 
   l1_part_trigger = trigger_create("L1 PART TRIGGER", L1_PART_TRIGGER,
                                    TRIGGER_REPEAT);
   l1_part_start = trigger_create("L1 PART START", L1_PART_START, TRIGGER_ONCE);
-  Stat_Enum monitored_stats[] = {NODE_CYCLE,
-                                 RET_BLOCKED_L1_MISS,
-                                 CORE_MEM_BLOCKED,
-                                 L1_SHADOW_ACCESS_STALLING,
-                                 L1_SHADOW_ACCESS_DEMAND,
-                                 L1_SHADOW_STALLING_HIT_POS0,
-                                 L1_SHADOW_STALLING_HIT_POS1,
-                                 L1_SHADOW_STALLING_HIT_POS2,
-                                 L1_SHADOW_STALLING_HIT_POS3,
-                                 L1_SHADOW_STALLING_HIT_POS4,
-                                 L1_SHADOW_STALLING_HIT_POS5,
-                                 L1_SHADOW_STALLING_HIT_POS6,
-                                 L1_SHADOW_STALLING_HIT_POS7,
-                                 L1_SHADOW_STALLING_HIT_POS8,
-                                 L1_SHADOW_STALLING_HIT_POS9,
-                                 L1_SHADOW_STALLING_HIT_POS10,
-                                 L1_SHADOW_STALLING_HIT_POS11,
-                                 L1_SHADOW_STALLING_HIT_POS12,
-                                 L1_SHADOW_STALLING_HIT_POS13,
-                                 L1_SHADOW_STALLING_HIT_POS14,
-                                 L1_SHADOW_STALLING_HIT_POS15,
-                                 L1_SHADOW_STALLING_HIT_POS16,
-                                 L1_SHADOW_STALLING_HIT_POS17,
-                                 L1_SHADOW_STALLING_HIT_POS18,
-                                 L1_SHADOW_STALLING_HIT_POS19,
-                                 L1_SHADOW_STALLING_HIT_POS20,
-                                 L1_SHADOW_STALLING_HIT_POS21,
-                                 L1_SHADOW_STALLING_HIT_POS22,
-                                 L1_SHADOW_STALLING_HIT_POS23,
-                                 L1_SHADOW_STALLING_HIT_POS24,
-                                 L1_SHADOW_STALLING_HIT_POS25,
-                                 L1_SHADOW_STALLING_HIT_POS26,
-                                 L1_SHADOW_STALLING_HIT_POS27,
-                                 L1_SHADOW_STALLING_HIT_POS28,
-                                 L1_SHADOW_STALLING_HIT_POS29,
-                                 L1_SHADOW_STALLING_HIT_POS30,
-                                 L1_SHADOW_STALLING_HIT_POS31,
-                                 L1_SHADOW_STALLING_HIT_POS32,
-                                 L1_SHADOW_STALLING_HIT_POS33,
-                                 L1_SHADOW_STALLING_HIT_POS34,
-                                 L1_SHADOW_STALLING_HIT_POS35,
-                                 L1_SHADOW_STALLING_HIT_POS36,
-                                 L1_SHADOW_STALLING_HIT_POS37,
-                                 L1_SHADOW_STALLING_HIT_POS38,
-                                 L1_SHADOW_STALLING_HIT_POS39,
-                                 L1_SHADOW_STALLING_HIT_POS40,
-                                 L1_SHADOW_STALLING_HIT_POS41,
-                                 L1_SHADOW_STALLING_HIT_POS42,
-                                 L1_SHADOW_STALLING_HIT_POS43,
-                                 L1_SHADOW_STALLING_HIT_POS44,
-                                 L1_SHADOW_STALLING_HIT_POS45,
-                                 L1_SHADOW_STALLING_HIT_POS46,
-                                 L1_SHADOW_STALLING_HIT_POS47,
-                                 L1_SHADOW_STALLING_HIT_POS48,
-                                 L1_SHADOW_STALLING_HIT_POS49,
-                                 L1_SHADOW_STALLING_HIT_POS50,
-                                 L1_SHADOW_STALLING_HIT_POS51,
-                                 L1_SHADOW_STALLING_HIT_POS52,
-                                 L1_SHADOW_STALLING_HIT_POS53,
-                                 L1_SHADOW_STALLING_HIT_POS54,
-                                 L1_SHADOW_STALLING_HIT_POS55,
-                                 L1_SHADOW_STALLING_HIT_POS56,
-                                 L1_SHADOW_STALLING_HIT_POS57,
-                                 L1_SHADOW_STALLING_HIT_POS58,
-                                 L1_SHADOW_STALLING_HIT_POS59,
-                                 L1_SHADOW_STALLING_HIT_POS60,
-                                 L1_SHADOW_STALLING_HIT_POS61,
-                                 L1_SHADOW_STALLING_HIT_POS62,
-                                 L1_SHADOW_STALLING_HIT_POS63,
-                                 L1_SHADOW_STALLING_HIT_POS64,
-                                 L1_SHADOW_STALLING_HIT_POS65,
-                                 L1_SHADOW_STALLING_HIT_POS66,
-                                 L1_SHADOW_STALLING_HIT_POS67,
-                                 L1_SHADOW_STALLING_HIT_POS68,
-                                 L1_SHADOW_STALLING_HIT_POS69,
-                                 L1_SHADOW_STALLING_HIT_POS70,
-                                 L1_SHADOW_STALLING_HIT_POS71,
-                                 L1_SHADOW_STALLING_HIT_POS72,
-                                 L1_SHADOW_STALLING_HIT_POS73,
-                                 L1_SHADOW_STALLING_HIT_POS74,
-                                 L1_SHADOW_STALLING_HIT_POS75,
-                                 L1_SHADOW_STALLING_HIT_POS76,
-                                 L1_SHADOW_STALLING_HIT_POS77,
-                                 L1_SHADOW_STALLING_HIT_POS78,
-                                 L1_SHADOW_STALLING_HIT_POS79,
-                                 L1_SHADOW_STALLING_HIT_POS80,
-                                 L1_SHADOW_STALLING_HIT_POS81,
-                                 L1_SHADOW_STALLING_HIT_POS82,
-                                 L1_SHADOW_STALLING_HIT_POS83,
-                                 L1_SHADOW_STALLING_HIT_POS84,
-                                 L1_SHADOW_STALLING_HIT_POS85,
-                                 L1_SHADOW_STALLING_HIT_POS86,
-                                 L1_SHADOW_STALLING_HIT_POS87,
-                                 L1_SHADOW_STALLING_HIT_POS88,
-                                 L1_SHADOW_STALLING_HIT_POS89,
-                                 L1_SHADOW_STALLING_HIT_POS90,
-                                 L1_SHADOW_STALLING_HIT_POS91,
-                                 L1_SHADOW_STALLING_HIT_POS92,
-                                 L1_SHADOW_STALLING_HIT_POS93,
-                                 L1_SHADOW_STALLING_HIT_POS94,
-                                 L1_SHADOW_STALLING_HIT_POS95,
-                                 L1_SHADOW_STALLING_HIT_POS96,
-                                 L1_SHADOW_STALLING_HIT_POS97,
-                                 L1_SHADOW_STALLING_HIT_POS98,
-                                 L1_SHADOW_STALLING_HIT_POS99,
-                                 L1_SHADOW_STALLING_HIT_POS100,
-                                 L1_SHADOW_STALLING_HIT_POS101,
-                                 L1_SHADOW_STALLING_HIT_POS102,
-                                 L1_SHADOW_STALLING_HIT_POS103,
-                                 L1_SHADOW_STALLING_HIT_POS104,
-                                 L1_SHADOW_STALLING_HIT_POS105,
-                                 L1_SHADOW_STALLING_HIT_POS106,
-                                 L1_SHADOW_STALLING_HIT_POS107,
-                                 L1_SHADOW_STALLING_HIT_POS108,
-                                 L1_SHADOW_STALLING_HIT_POS109,
-                                 L1_SHADOW_STALLING_HIT_POS110,
-                                 L1_SHADOW_STALLING_HIT_POS111,
-                                 L1_SHADOW_STALLING_HIT_POS112,
-                                 L1_SHADOW_STALLING_HIT_POS113,
-                                 L1_SHADOW_STALLING_HIT_POS114,
-                                 L1_SHADOW_STALLING_HIT_POS115,
-                                 L1_SHADOW_STALLING_HIT_POS116,
-                                 L1_SHADOW_STALLING_HIT_POS117,
-                                 L1_SHADOW_STALLING_HIT_POS118,
-                                 L1_SHADOW_STALLING_HIT_POS119,
-                                 L1_SHADOW_STALLING_HIT_POS120,
-                                 L1_SHADOW_STALLING_HIT_POS121,
-                                 L1_SHADOW_STALLING_HIT_POS122,
-                                 L1_SHADOW_STALLING_HIT_POS123,
-                                 L1_SHADOW_STALLING_HIT_POS124,
-                                 L1_SHADOW_STALLING_HIT_POS125,
-                                 L1_SHADOW_STALLING_HIT_POS126,
-                                 L1_SHADOW_STALLING_HIT_POS127,
-                                 L1_SHADOW_DEMAND_HIT_POS0,
-                                 L1_SHADOW_DEMAND_HIT_POS1,
-                                 L1_SHADOW_DEMAND_HIT_POS2,
-                                 L1_SHADOW_DEMAND_HIT_POS3,
-                                 L1_SHADOW_DEMAND_HIT_POS4,
-                                 L1_SHADOW_DEMAND_HIT_POS5,
-                                 L1_SHADOW_DEMAND_HIT_POS6,
-                                 L1_SHADOW_DEMAND_HIT_POS7,
-                                 L1_SHADOW_DEMAND_HIT_POS8,
-                                 L1_SHADOW_DEMAND_HIT_POS9,
-                                 L1_SHADOW_DEMAND_HIT_POS10,
-                                 L1_SHADOW_DEMAND_HIT_POS11,
-                                 L1_SHADOW_DEMAND_HIT_POS12,
-                                 L1_SHADOW_DEMAND_HIT_POS13,
-                                 L1_SHADOW_DEMAND_HIT_POS14,
-                                 L1_SHADOW_DEMAND_HIT_POS15,
-                                 L1_SHADOW_DEMAND_HIT_POS16,
-                                 L1_SHADOW_DEMAND_HIT_POS17,
-                                 L1_SHADOW_DEMAND_HIT_POS18,
-                                 L1_SHADOW_DEMAND_HIT_POS19,
-                                 L1_SHADOW_DEMAND_HIT_POS20,
-                                 L1_SHADOW_DEMAND_HIT_POS21,
-                                 L1_SHADOW_DEMAND_HIT_POS22,
-                                 L1_SHADOW_DEMAND_HIT_POS23,
-                                 L1_SHADOW_DEMAND_HIT_POS24,
-                                 L1_SHADOW_DEMAND_HIT_POS25,
-                                 L1_SHADOW_DEMAND_HIT_POS26,
-                                 L1_SHADOW_DEMAND_HIT_POS27,
-                                 L1_SHADOW_DEMAND_HIT_POS28,
-                                 L1_SHADOW_DEMAND_HIT_POS29,
-                                 L1_SHADOW_DEMAND_HIT_POS30,
-                                 L1_SHADOW_DEMAND_HIT_POS31,
-                                 L1_SHADOW_DEMAND_HIT_POS32,
-                                 L1_SHADOW_DEMAND_HIT_POS33,
-                                 L1_SHADOW_DEMAND_HIT_POS34,
-                                 L1_SHADOW_DEMAND_HIT_POS35,
-                                 L1_SHADOW_DEMAND_HIT_POS36,
-                                 L1_SHADOW_DEMAND_HIT_POS37,
-                                 L1_SHADOW_DEMAND_HIT_POS38,
-                                 L1_SHADOW_DEMAND_HIT_POS39,
-                                 L1_SHADOW_DEMAND_HIT_POS40,
-                                 L1_SHADOW_DEMAND_HIT_POS41,
-                                 L1_SHADOW_DEMAND_HIT_POS42,
-                                 L1_SHADOW_DEMAND_HIT_POS43,
-                                 L1_SHADOW_DEMAND_HIT_POS44,
-                                 L1_SHADOW_DEMAND_HIT_POS45,
-                                 L1_SHADOW_DEMAND_HIT_POS46,
-                                 L1_SHADOW_DEMAND_HIT_POS47,
-                                 L1_SHADOW_DEMAND_HIT_POS48,
-                                 L1_SHADOW_DEMAND_HIT_POS49,
-                                 L1_SHADOW_DEMAND_HIT_POS50,
-                                 L1_SHADOW_DEMAND_HIT_POS51,
-                                 L1_SHADOW_DEMAND_HIT_POS52,
-                                 L1_SHADOW_DEMAND_HIT_POS53,
-                                 L1_SHADOW_DEMAND_HIT_POS54,
-                                 L1_SHADOW_DEMAND_HIT_POS55,
-                                 L1_SHADOW_DEMAND_HIT_POS56,
-                                 L1_SHADOW_DEMAND_HIT_POS57,
-                                 L1_SHADOW_DEMAND_HIT_POS58,
-                                 L1_SHADOW_DEMAND_HIT_POS59,
-                                 L1_SHADOW_DEMAND_HIT_POS60,
-                                 L1_SHADOW_DEMAND_HIT_POS61,
-                                 L1_SHADOW_DEMAND_HIT_POS62,
-                                 L1_SHADOW_DEMAND_HIT_POS63,
-                                 L1_SHADOW_DEMAND_HIT_POS64,
-                                 L1_SHADOW_DEMAND_HIT_POS65,
-                                 L1_SHADOW_DEMAND_HIT_POS66,
-                                 L1_SHADOW_DEMAND_HIT_POS67,
-                                 L1_SHADOW_DEMAND_HIT_POS68,
-                                 L1_SHADOW_DEMAND_HIT_POS69,
-                                 L1_SHADOW_DEMAND_HIT_POS70,
-                                 L1_SHADOW_DEMAND_HIT_POS71,
-                                 L1_SHADOW_DEMAND_HIT_POS72,
-                                 L1_SHADOW_DEMAND_HIT_POS73,
-                                 L1_SHADOW_DEMAND_HIT_POS74,
-                                 L1_SHADOW_DEMAND_HIT_POS75,
-                                 L1_SHADOW_DEMAND_HIT_POS76,
-                                 L1_SHADOW_DEMAND_HIT_POS77,
-                                 L1_SHADOW_DEMAND_HIT_POS78,
-                                 L1_SHADOW_DEMAND_HIT_POS79,
-                                 L1_SHADOW_DEMAND_HIT_POS80,
-                                 L1_SHADOW_DEMAND_HIT_POS81,
-                                 L1_SHADOW_DEMAND_HIT_POS82,
-                                 L1_SHADOW_DEMAND_HIT_POS83,
-                                 L1_SHADOW_DEMAND_HIT_POS84,
-                                 L1_SHADOW_DEMAND_HIT_POS85,
-                                 L1_SHADOW_DEMAND_HIT_POS86,
-                                 L1_SHADOW_DEMAND_HIT_POS87,
-                                 L1_SHADOW_DEMAND_HIT_POS88,
-                                 L1_SHADOW_DEMAND_HIT_POS89,
-                                 L1_SHADOW_DEMAND_HIT_POS90,
-                                 L1_SHADOW_DEMAND_HIT_POS91,
-                                 L1_SHADOW_DEMAND_HIT_POS92,
-                                 L1_SHADOW_DEMAND_HIT_POS93,
-                                 L1_SHADOW_DEMAND_HIT_POS94,
-                                 L1_SHADOW_DEMAND_HIT_POS95,
-                                 L1_SHADOW_DEMAND_HIT_POS96,
-                                 L1_SHADOW_DEMAND_HIT_POS97,
-                                 L1_SHADOW_DEMAND_HIT_POS98,
-                                 L1_SHADOW_DEMAND_HIT_POS99,
-                                 L1_SHADOW_DEMAND_HIT_POS100,
-                                 L1_SHADOW_DEMAND_HIT_POS101,
-                                 L1_SHADOW_DEMAND_HIT_POS102,
-                                 L1_SHADOW_DEMAND_HIT_POS103,
-                                 L1_SHADOW_DEMAND_HIT_POS104,
-                                 L1_SHADOW_DEMAND_HIT_POS105,
-                                 L1_SHADOW_DEMAND_HIT_POS106,
-                                 L1_SHADOW_DEMAND_HIT_POS107,
-                                 L1_SHADOW_DEMAND_HIT_POS108,
-                                 L1_SHADOW_DEMAND_HIT_POS109,
-                                 L1_SHADOW_DEMAND_HIT_POS110,
-                                 L1_SHADOW_DEMAND_HIT_POS111,
-                                 L1_SHADOW_DEMAND_HIT_POS112,
-                                 L1_SHADOW_DEMAND_HIT_POS113,
-                                 L1_SHADOW_DEMAND_HIT_POS114,
-                                 L1_SHADOW_DEMAND_HIT_POS115,
-                                 L1_SHADOW_DEMAND_HIT_POS116,
-                                 L1_SHADOW_DEMAND_HIT_POS117,
-                                 L1_SHADOW_DEMAND_HIT_POS118,
-                                 L1_SHADOW_DEMAND_HIT_POS119,
-                                 L1_SHADOW_DEMAND_HIT_POS120,
-                                 L1_SHADOW_DEMAND_HIT_POS121,
-                                 L1_SHADOW_DEMAND_HIT_POS122,
-                                 L1_SHADOW_DEMAND_HIT_POS123,
-                                 L1_SHADOW_DEMAND_HIT_POS124,
-                                 L1_SHADOW_DEMAND_HIT_POS125,
-                                 L1_SHADOW_DEMAND_HIT_POS126,
-                                 L1_SHADOW_DEMAND_HIT_POS127};
+  // the miss curves are counted locally; only the core stats used by the
+  // metrics are monitored
+  Stat_Enum monitored_stats[] = {NODE_CYCLE, RET_BLOCKED_L1_MISS,
+                                 CORE_MEM_BLOCKED};
 
 
   // monitor here observe various global stats, and reset its internal
@@ -393,15 +176,17 @@ void cache_part_init(void) {
   stat_mon = stat_mon_create_from_array(monitored_stats,
                                         NUM_ELEMENTS(monitored_stats));
 
+  term_product = FALSE;
   switch(L1_PART_METRIC) {
     case CACHE_PART_METRIC_GLOBAL_MISS_RATE:
-      metric_func = &get_global_miss_rate;
+      term_func = &get_global_miss_rate;
       break;
     case CACHE_PART_METRIC_MISS_RATE_SUM:
-      metric_func = &get_miss_rate_sum;
+      term_func = &get_miss_rate_sum;
       break;
     case CACHE_PART_METRIC_GMEAN_PERF:
-      metric_func = &get_gmean_perf;
+      term_func    = &get_gmean_perf;
+      term_product = TRUE;
       break;
     default:
       FATAL_ERROR(0, "Unknown metric %s\n",
@@ -416,6 +201,9 @@ void cache_part_init(void) {
     case CACHE_PART_SEARCH_BRUTE_FORCE:
       search_func = &search_bruteforce;
       break;
+    case CACHE_PART_SEARCH_GREEDY:
+      search_func = &search_greedy;
+      break;
     default:
       FATAL_ERROR(0, "Unknown search algorithm %s\n",
                   Cache_Part_Search_str(L1_PART_METRIC));
@@ -432,6 +220,7 @@ void cache_part_init(void) {
   }
   new_partition       = calloc(NUM_CORES, sizeof(uns));
   temp_partition      = calloc(NUM_CORES, sizeof(uns));
+  term_weights        = calloc(NUM_CORES, sizeof(double));
   tie_breaker_proc_id = 0;
 }
 
@@ -455,19 +244,25 @@ void cache_part_l1_access(Mem_Req* req) {
     return;
 
   Proc_Info* proc_info = &proc_infos[req->proc_id];
+  Addr       addr      = shadow_addr(req->addr);
   Addr       dummy_line_addr;
   int  pos = cache_find_pos_in_lru_stack(&proc_info->shadow_cache, req->proc_id,
-                                        req->addr, &dummy_line_addr);
+                                        addr, &dummy_line_addr);
   Flag miss         = (pos == -1);
   Flag untimely_hit = FALSE;
   Flag stalling     = mem_req_type_is_stalling(req->type);
   Flag demand       = mem_req_type_is_demand(req->type);
   if(!miss && L1_PART_FILL_DELAY) {
-    L1_Data* data = (L1_Data*)cache_access(&proc_info->shadow_cache, req->addr,
-                                           &dummy_line_addr, FALSE);
+    Shadow_Cache_Data* data = (Shadow_Cache_Data*)cache_access(
+      &proc_info->shadow_cache, addr, &dummy_line_addr, FALSE);
     ASSERT(req->proc_id, data);
     untimely_hit = data->fetch_cycle > freq_cycle_count(FREQ_DOMAIN_L1);
   }
+  if(L1_PART_USE_STALLING ? stalling : demand) {
+    proc_info->accesses++;
+    if(!miss && !untimely_hit)
+      proc_info->hit_pos[pos]++;
+  }
   STAT_EVENT(req->proc_id, L1_SHADOW_ACCESS);
   if(stalling)
     STAT_EVENT(req->proc_id, L1_SHADOW_ACCESS_STALLING);
@@ -492,13 +287,14 @@ void cache_part_l1_access(Mem_Req* req) {
 
   // update shadow tag
   if(miss) {
-    L1_Data* data     = cache_insert(&proc_info->shadow_cache, req->proc_id,
-                                 req->addr, &dummy_line_addr, &dummy_line_addr);
-    data->fetch_cycle = freq_cycle_count(FREQ_DOMAIN_L1) +
+    Shadow_Cache_Data* data = cache_insert(&proc_info->shadow_cache,
+                                           req->proc_id, addr, &dummy_line_addr,
+                                           &dummy_line_addr);
+    data->fetch_cycle       = freq_cycle_count(FREQ_DOMAIN_L1) +
                         (stalling || req->type == MRT_WB ? 0 :
                                                            L1_PART_FILL_DELAY);
   } else {
-    cache_access(&proc_info->shadow_cache, req->addr, &dummy_line_addr, TRUE);
+    cache_access(&proc_info->shadow_cache, addr, &dummy_line_addr, TRUE);
   }
 }
 
@@ -506,13 +302,16 @@ void cache_part_l1_access(Mem_Req* req) {
 /* cache_part_l1_warmup: */
 
 void cache_part_l1_warmup(uns proc_id, Addr addr) {
-  Proc_Info* proc_info = &proc_infos[proc_id];
-  Addr       dummy_line_addr;
-  L1_Data*   data = (L1_Data*)cache_access(&proc_info->shadow_cache, addr,
-                                         &dummy_line_addr, TRUE);
+  if(!in_shadow_cache(addr))
+    return;
+
+  Proc_Info*         proc_info = &proc_infos[proc_id];
+  Addr               dummy_line_addr;
+  Shadow_Cache_Data* data = cache_access(
+    &proc_info->shadow_cache, shadow_addr(addr), &dummy_line_addr, TRUE);
   if(!data) {
-    L1_Data* data     = cache_insert(&proc_info->shadow_cache, proc_id, addr,
-                                 &dummy_line_addr, &dummy_line_addr);
+    data              = cache_insert(&proc_info->shadow_cache, proc_id,
+                        shadow_addr(addr), &dummy_line_addr, &dummy_line_addr);
     data->fetch_cycle = 0;
   }
 }
@@ -544,74 +343,125 @@ void cache_part_update(void) {
     set_partition();
   }
 
-  // TODO: if this func is called too often (controlled by user through
-  // l1_part_trigger)  the misscurve calculated will be incorrect (no additional
-  // shadow access between two  triggers, thus divide by 0), corrently there is
-  // not check for this case
   stat_mon_reset(stat_mon);
+  reset_miss_counters();
 }
 
 /**************************************************************************************/
 /* Is the line with specified addr tracked in the shadow cache? */
 
 Flag in_shadow_cache(Addr addr) {
-  Addr dummy_addr;
-  uns  set = ext_cache_index(&proc_infos[0].shadow_cache, addr, &dummy_addr,
-                            &dummy_addr);
+  Addr set = (addr >> LOG2(L1_LINE_SIZE)) & N_BIT_MASK(l1_set_bits);
   return set % L1_SHADOW_TAGS_MODULO == 0;
 }
 
 /**************************************************************************************/
-/* Measure miss curves from monitored statistics */
+/* Address of a sampled line in the (smaller) shadow cache: the L1 set index
+   is compressed to the index among the sampled sets, the tag is kept */
+
+Addr shadow_addr(Addr addr) {
+  Addr line = addr >> LOG2(L1_LINE_SIZE);
+  Addr set  = line & N_BIT_MASK(l1_set_bits);
+  Addr tag  = line >> l1_set_bits;
+  return ((tag << shadow_set_bits) | (set / L1_SHADOW_TAGS_MODULO))
+         << LOG2(L1_LINE_SIZE);
+}
+
+/**************************************************************************************/
+/* Measure miss curves from the shadow hit position counters */
 
 void measure_miss_curves(void) {
   for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     Proc_Info* proc_info   = &proc_infos[proc_id];
-    uns        access_stat = L1_PART_USE_STALLING ? L1_SHADOW_ACCESS_STALLING :
-                                             L1_SHADOW_ACCESS_DEMAND;
-    uns pos0_hit_stat = L1_PART_USE_STALLING ? L1_SHADOW_STALLING_HIT_POS0 :
-                                               L1_SHADOW_DEMAND_HIT_POS0;
-    Counter shadow_accesses   = stat_mon_get_count(stat_mon, proc_id,
-                                                 access_stat);
-    Counter shadow_misses_sum = shadow_accesses;
-    for(uns ii = 0; ii < L1_ASSOC - 1; ii++) {
-      Counter way_hits = stat_mon_get_count(stat_mon, proc_id,
-                                            pos0_hit_stat + ii);
-      shadow_misses_sum -= way_hits;
-      proc_info->miss_rates[ii] = (double)shadow_misses_sum /
-                                  (double)shadow_accesses;
+    Counter    shadow_misses_sum = proc_info->accesses;
+    proc_info->miss_rates[0]     = proc_info->accesses ? 1.0 : 0.0;
+    for(uns ways = 1; ways <= L1_ASSOC; ways++) {
+      shadow_misses_sum -= proc_info->hit_pos[ways - 1];
+      proc_info->miss_rates[ways] = proc_info->accesses ?
+                                      (double)shadow_misses_sum /
+                                        (double)proc_info->accesses :
+                                      0.0;
     }
   }
 }
 
+/**************************************************************************************/
+/* Start a new miss curve measurement interval */
+
+void reset_miss_counters(void) {
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Proc_Info* proc_info = &proc_infos[proc_id];
+    proc_info->accesses  = 0;
+    memset(proc_info->hit_pos, 0, L1_ASSOC * sizeof(Counter));
+  }
+}
+
+/**************************************************************************************/
+/* Metric of a whole partition (lower is better) */
+
+double get_metric(uns* partition) {
+  double metric = term_product ? 1.0 : 0.0;
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    double term = term_func(proc_id, partition[proc_id]);
+    if(term_product)
+      metric *= term;
+    else
+      metric += term;
+  }
+  return term_product ? -metric : metric;
+}
+
+/**************************************************************************************/
+/* Change of the metric per unit change of each core's term around partition:
+   1 for sums, minus the product of the other cores' terms for products */
+
+void get_term_weights(uns* partition) {
+  if(!term_product) {
+    for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      term_weights[proc_id] = 1.0;
+    return;
+  }
+
+  double prefix = 1.0;
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    term_weights[proc_id] = prefix;
+    prefix *= term_func(proc_id, partition[proc_id]);
+  }
+  double suffix = 1.0;
+  for(uns proc_id = NUM_CORES; proc_id-- > 0;) {
+    term_weights[proc_id] = -term_weights[proc_id] * suffix;
+    suffix *= term_func(proc_id, partition[proc_id]);
+  }
+}
+
 /**************************************************************************************/
 /* Find best marginal utility using lookahead method (Algorithm 2) of Moin's
  * paper.
  * Qureshi, Moinuddin K., and Yale N. Patt. "Utility-based cache partitioning:
  * A low-overhead, high-performance, runtime mechanism to partition shared
  * caches." 2006 39th Annual IEEE/ACM International Symposium on
- * Microarchitecture (MICRO'06). IEEE, 2006.  */
-
-double get_best_marginal_utility(uns* partition, uns proc_id, uns balance,
-                                 uns* extra_ways) {
-  uns old_ways = partition[proc_id];
-  uns max_ways = old_ways + balance;
-  ASSERT(0, max_ways <= L1_ASSOC);
-  double cur_metric = metric_func(partition);
-  double best_mu    = 0.0;
-  uns    best_ways  = old_ways;
-  for(uns ways = old_ways + 1; ways <= max_ways; ways++) {
-    partition[proc_id] = ways;
-    double new_metric  = metric_func(partition);
-    double mu          = (new_metric - cur_metric) / (double)(ways - old_ways);
-    if(mu < best_mu) {
-      best_mu   = mu;
-      best_ways = ways;
+ * Microarchitecture (MICRO'06). IEEE, 2006.
+ *
+ * The utility is computed on the core's own term; its sign follows the term
+ * weight, which is negative for product metrics. Only the core's term changes,
+ * so the caller scales it by the weight magnitude. */
+
+void get_best_marginal_utility(uns proc_id, uns ways, uns balance) {
+  Proc_Info* proc_info = &proc_infos[proc_id];
+  ASSERT(0, ways + balance <= L1_ASSOC);
+  double cur_term       = term_func(proc_id, ways);
+  double sign           = term_product ? -1.0 : 1.0;
+  proc_info->best_mu    = 0.0;
+  proc_info->best_extra = 0;
+  for(uns extra = 1; extra <= balance; extra++) {
+    double mu = sign * (term_func(proc_id, ways + extra) - cur_term) /
+                (double)extra;
+    if(mu < proc_info->best_mu) {
+      proc_info->best_mu    = mu;
+      proc_info->best_extra = extra;
     }
   }
-  partition[proc_id] = old_ways;
-  *extra_ways        = best_ways - old_ways;
-  return best_mu;
+  proc_info->best_valid = TRUE;
 }
 
 /**************************************************************************************/
@@ -637,7 +487,7 @@ void search_bruteforce(void) {
     partition[NUM_CORES - 1] += L1_ASSOC - sum;
 
     /* check the metric for the partition */
-    double metric = metric_func(partition);
+    double metric = get_metric(partition);
     if(ENABLE_GLOBAL_DEBUG_PRINT && DEBUG_RANGE_COND(0)) {
       char  buf[MAX_STR_LENGTH + 1];
       char* ptr = buf;
@@ -677,7 +527,8 @@ void search_lookahead(void) {
   uns* partition            = new_partition;
   uns  total_ways_allocated = 0;
   for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    partition[proc_id] = 1;
+    partition[proc_id]              = 1;
+    proc_infos[proc_id].best_valid = FALSE;
     total_ways_allocated++;
   }
 
@@ -687,10 +538,14 @@ void search_lookahead(void) {
     uns    best_proc_id    = NUM_CORES;
     uns    best_extra_ways = 0;
     DEBUG(0, "Balance %d\n", balance);
+    get_term_weights(partition);
     for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-      uns    extra_ways;
-      double mu = get_best_marginal_utility(partition, proc_id, balance,
-                                            &extra_ways);
+      Proc_Info* proc_info = &proc_infos[proc_id];
+      // a smaller balance only matters if it cuts off the cached best
+      if(!proc_info->best_valid || proc_info->best_extra > balance)
+        get_best_marginal_utility(proc_id, partition[proc_id], balance);
+      double mu         = fabs(term_weights[proc_id]) * proc_info->best_mu;
+      uns    extra_ways = mu < 0.0 ? proc_info->best_extra : 0;
       DEBUG(0, "Marginal util of core %d: %.4f (%d ways)\n", proc_id, mu,
             extra_ways);
       if(mu < best_mu) {
@@ -708,11 +563,48 @@ void search_lookahead(void) {
     ASSERT(0, best_proc_id != NUM_CORES);
     partition[best_proc_id] += best_extra_ways;
     total_ways_allocated += best_extra_ways;
+    proc_infos[best_proc_id].best_valid = FALSE;
     DEBUG(0, "Gave %d ways to core %d, marginal util: %.4f\n", best_extra_ways,
           best_proc_id, best_mu);
   }
 }
 
+/**************************************************************************************/
+/* Give one way at a time to the core whose next way improves the metric
+   most */
+
+void search_greedy(void) {
+  uns* partition            = new_partition;
+  uns  total_ways_allocated = 0;
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    partition[proc_id] = 1;
+    total_ways_allocated++;
+  }
+
+  while(total_ways_allocated < L1_ASSOC) {
+    double best_gain    = 0.0;
+    uns    best_proc_id = NUM_CORES;
+    get_term_weights(partition);
+    for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+      uns    ways = partition[proc_id];
+      double gain = term_weights[proc_id] * (term_func(proc_id, ways + 1) -
+                                             term_func(proc_id, ways));
+      if(gain < best_gain) {
+        best_gain    = gain;
+        best_proc_id = proc_id;
+      }
+    }
+    if(best_proc_id == NUM_CORES) {
+      best_proc_id        = tie_breaker_proc_id;
+      tie_breaker_proc_id = (tie_breaker_proc_id + 1) % NUM_CORES;
+    }
+    partition[best_proc_id]++;
+    total_ways_allocated++;
+    DEBUG(0, "Gave a way to core %d, metric change: %.4f\n", best_proc_id,
+          best_gain);
+  }
+}
+
 /**************************************************************************************/
 /* Set target partition */
 
@@ -746,89 +638,71 @@ void debug_cache_part(uns* old_partition, uns* new_partition) {
   for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     ptr += sprintf(ptr, "%d,", new_partition[proc_id]);
     DPRINTF("Miss curve[%d]:", proc_id);
-    for(uns ii = 0; ii < L1_ASSOC - 1; ii++) {
-      DPRINTF(" %.4f", proc_infos[proc_id].miss_rates[ii]);
+    for(uns ways = 1; ways <= L1_ASSOC; ways++) {
+      DPRINTF(" %.4f", proc_infos[proc_id].miss_rates[ways]);
     }
     DPRINTF("\n");
   }
   DPRINTF("New partition {%s}, metric %.4f -> %.4f\n", buf,
-          metric_func(old_partition), metric_func(new_partition));
+          get_metric(old_partition), get_metric(new_partition));
 }
 
 /**************************************************************************************/
-/* get global miss rate */
+/* get global miss rate: misses of one core given ways */
 
-double get_global_miss_rate(uns* partition) {
-  double sum = 0.0;
-  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    Proc_Info* proc_info = &proc_infos[proc_id];
-    Counter    accesses  = stat_mon_get_count(stat_mon, proc_id,
-                                          L1_PART_USE_STALLING ?
-                                            L1_SHADOW_ACCESS_STALLING :
-                                            L1_SHADOW_ACCESS_DEMAND);
-    sum += proc_info->miss_rates[partition[proc_id]] * (double)accesses;
-  }
-  return sum;
+double get_global_miss_rate(uns proc_id, uns ways) {
+  Proc_Info* proc_info = &proc_infos[proc_id];
+  return proc_info->miss_rates[ways] * (double)proc_info->accesses;
 }
 
 /**************************************************************************************/
-/* get miss rate sum */
+/* get miss rate sum: miss rate of one core given ways */
 
-double get_miss_rate_sum(uns* partition) {
-  double sum = 0.0;
-  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    Proc_Info* proc_info = &proc_infos[proc_id];
-    sum += proc_info->miss_rates[partition[proc_id]];
-  }
-  return sum;
+double get_miss_rate_sum(uns proc_id, uns ways) {
+  return proc_infos[proc_id].miss_rates[ways];
 }
 
 /**************************************************************************************/
-/* get negative gmean of core performance (negative because we minimize the
- * metric) */
+/* get gmean of core performance: predicted performance of one core given ways
+ * (the metric is the negative product, because we minimize the metric) */
 
-double get_gmean_perf(uns* partition) {
-  double product = 1.0;
-  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    /* Assuming constant stall time per miss and constant compute time per
-       access:
-
-          stall time    misses      compute time       time
-          ---------- x --------  +  ------------  =  --------
-            misses     accesses       accesses       accesses
-
-          stall time   miss rate    compute time       time
-           per miss                   per miss      per access
-
-           CONSTANT    VARIABLE       CONSTANT       VARIABLE
-
-       From this model, we can derive that normalized performance
-       given a new vs old miss rate is the *reciprocal* of:
-
-               / new miss rate     \
-           1 + | ------------- - 1 | x stall frac
-               \ old miss rate     /
-    */
-    Proc_Info* proc_info  = &proc_infos[proc_id];
-    double     stall_frac = (double)stat_mon_get_count(stat_mon, proc_id,
-                                                   RET_BLOCKED_L1_MISS) /
-                        (double)stat_mon_get_count(stat_mon, proc_id,
-                                                   NODE_CYCLE);
-    double miss_rate0 = proc_info->miss_rates[current_partition[proc_id]];
-    double miss_rate  = proc_info->miss_rates[partition[proc_id]];
-    double pred_perf;
-    if(miss_rate0 == 0.0 || stall_frac == 0.0) {
-      // in case of zero misses or stall time make the smallest
-      // partition most attractive
-      if(partition[proc_id] == 1) {
-        pred_perf = 1.0;
-      } else {
-        pred_perf = 0.0;
-      }
+double get_gmean_perf(uns proc_id, uns ways) {
+  /* Assuming constant stall time per miss and constant compute time per
+     access:
+
+        stall time    misses      compute time       time
+        ---------- x --------  +  ------------  =  --------
+          misses     accesses       accesses       accesses
+
+        stall time   miss rate    compute time       time
+         per miss                   per miss      per access
+
+         CONSTANT    VARIABLE       CONSTANT       VARIABLE
+
+     From this model, we can derive that normalized performance
+     given a new vs old miss rate is the *reciprocal* of:
+
+             / new miss rate     \
+         1 + | ------------- - 1 | x stall frac
+             \ old miss rate     /
+  */
+  Proc_Info* proc_info = &proc_infos[proc_id];
+  double     stall_frac =
+    (double)stat_mon_get_count(stat_mon, proc_id, RET_BLOCKED_L1_MISS) /
+    (double)stat_mon_get_count(stat_mon, proc_id, NODE_CYCLE);
+  double miss_rate0 = proc_info->miss_rates[current_partition[proc_id]];
+  double miss_rate  = proc_info->miss_rates[ways];
+  double pred_perf;
+  if(miss_rate0 == 0.0 || stall_frac == 0.0) {
+    // in case of zero misses or stall time make the smallest
+    // partition most attractive
+    if(ways == 1) {
+      pred_perf = 1.0;
     } else {
-      pred_perf = 1.0 / (1.0 + (miss_rate / miss_rate0 - 1) * stall_frac);
+      pred_perf = 0.0;
     }
-    product *= pred_perf;
+  } else {
+    pred_perf = 1.0 / (1.0 + (miss_rate / miss_rate0 - 1) * stall_frac);
   }
-  return -product;
+  return pred_perf;
 }
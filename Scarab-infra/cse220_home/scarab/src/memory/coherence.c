@@ -0,0 +1,394 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/coherence.c
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Directory-based MESI coherence between the private dcaches
+ *                (and MLCs) of the cores.
+ *
+ * The cores are treated as threads of one address space: the directory is
+ * indexed by the line address with the proc_id bits removed, and core q's copy
+ * of a line lives at convert_to_cmp_addr(q, addr) in its private caches.
+ *
+ * The directory is a sparse hash table holding, per line, the cores that may
+ * have a copy (evictions are silent, so the vector is conservative), the
+ * exclusive owner, if any, and the number of coherence messages in flight.
+ * Each dcache line carries its MESI state.
+ *
+ * Invalidations and downgrades are MRT_COH requests in the memory system's
+ * coherence queue; they act on the remote core COH_MSG_LATENCY cycles after
+ * they are sent, which is when their ack is counted back at the directory.
+ * - A fill for a read waits until a remote M/E owner has been downgraded to
+ *   S; a dirty owner writes the line back to the L1.
+ * - A fill for an on-path write waits until every other copy (dcache,
+ *   pref dcache and MLC) has been invalidated; a dirty copy is forwarded to
+ *   the writer with the ack.
+ * - A store hit on an S line sends the invalidations and becomes M at once;
+ *   the store drains from the store buffer while they are in flight.
+ * - Warmup and the prefetchers that insert straight into the dcache use
+ *   coh_fill_now, which applies the same transitions without latency.
+ * - A miss on a line that was invalidated by another core's write is counted
+ *   as a coherence miss.
+ ***************************************************************************************/
+
+#include "debug/debug_macros.h"
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "cmp_model.h"
+#include "core.param.h"
+#include "dcache_stage.h"
+#include "debug/debug.param.h"
+#include "libs/cache_lib.h"
+#include "libs/hash_lib.h"
+#include "memory/coherence.h"
+#include "memory/memory.h"
+#include "memory/memory.param.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_COHERENCE, ##args)
+
+#define NO_OWNER -1
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct Dir_Entry_struct {
+  uns64 sharers;      // cores that may hold the line
+  uns64 invalidated;  // cores whose copy was invalidated by a remote write
+  int   owner;        // core holding the line in E or M, or NO_OWNER
+  uns   pending;      // invalidations and downgrades in flight
+} Dir_Entry;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Hash_Table directory;
+
+/**************************************************************************************/
+/* Static Prototypes */
+
+static Dir_Entry* coh_dir_entry(Addr line_addr);
+static void       coh_invalidate_copy(uns q, Addr line_addr, Dir_Entry* entry);
+static Flag       coh_downgrade_copy(uns q, Addr line_addr, Dir_Entry* entry,
+                                     Flag writeback);
+static Flag       coh_inv_done(Mem_Req* req);
+static Flag       coh_downgrade_done(Mem_Req* req);
+static Flag       coh_send_invalidations(uns proc_id, Addr line_addr,
+                                         Dir_Entry* entry);
+static Flag       coh_ready(uns proc_id, Addr line_addr, Dir_Entry* entry,
+                            Flag write);
+static Coh_State  coh_grant(uns proc_id, Dir_Entry* entry, Flag write);
+
+/**************************************************************************************/
+/* init_coherence */
+
+void init_coherence(void) {
+  if(!COHERENCE_ON)
+    return;
+  ASSERTM(0, NUM_CORES <= 64, "The directory supports up to 64 cores\n");
+  init_hash_table(&directory, "coherence directory", 1 << 16,
+                  sizeof(Dir_Entry));
+}
+
+/**************************************************************************************/
+/* coh_dir_entry: directory entry of a line, created on first use */
+
+static Dir_Entry* coh_dir_entry(Addr line_addr) {
+  Flag       new_entry;
+  Addr       shared_addr = convert_to_cmp_addr(0, line_addr);
+  Dir_Entry* entry       = (Dir_Entry*)hash_table_access_create(
+    &directory, shared_addr >> LOG2(DCACHE_LINE_SIZE), &new_entry);
+  if(new_entry) {
+    entry->sharers     = 0;
+    entry->invalidated = 0;
+    entry->owner       = NO_OWNER;
+    entry->pending     = 0;
+  }
+  return entry;
+}
+
+/**************************************************************************************/
+/* coh_invalidate_copy: drop core q's copies of a line. A dirty copy, in the
+   dcache or only in the MLC, is forwarded to the writer with the ack. */
+
+static void coh_invalidate_copy(uns q, Addr line_addr, Dir_Entry* entry) {
+  Addr          q_addr = convert_to_cmp_addr(q, line_addr);
+  Addr          dummy_line_addr;
+  Dcache_Stage* q_dc = &cmp_model.dcache_stage[q];
+  Dcache_Data*  data = (Dcache_Data*)cache_access(&q_dc->dcache, q_addr,
+                                                 &dummy_line_addr, FALSE);
+  Dcache_Data*  pref = (Dcache_Data*)cache_access(&q_dc->pref_dcache, q_addr,
+                                                 &dummy_line_addr, FALSE);
+  Cache*        mlc  = MLC_PRESENT ? &cmp_model.memory.uncores[q].mlc->cache :
+                                     NULL;
+  MLC_Data*     mlc_data = NULL;
+
+  if(mlc)
+    mlc_data = (MLC_Data*)cache_access(mlc, q_addr, &dummy_line_addr, FALSE);
+
+  if((data && data->dirty) || (pref && pref->dirty))
+    STAT_EVENT(q, COH_INV_DIRTY);
+  else if(mlc_data && mlc_data->dirty)
+    STAT_EVENT(q, COH_INV_FORWARD_MLC);
+
+  if(data || pref) {
+    STAT_EVENT(q, COH_INV_RECEIVED);
+    entry->invalidated |= 1ULL << q;
+  }
+  // the dirty data went with the ack; the invalid ways must not be written
+  // back when they are reused
+  if(data) {
+    data->dirty = FALSE;
+    cache_invalidate(&q_dc->dcache, q_addr, &dummy_line_addr);
+  }
+  if(pref) {
+    pref->dirty = FALSE;
+    cache_invalidate(&q_dc->pref_dcache, q_addr, &dummy_line_addr);
+  }
+  if(mlc_data) {
+    mlc_data->dirty = FALSE;
+    cache_invalidate(mlc, q_addr, &dummy_line_addr);
+  }
+
+  entry->sharers &= ~(1ULL << q);
+  if(entry->owner == (int)q)
+    entry->owner = NO_OWNER;
+  DEBUG(q, "invalidate %llx (present:%d)\n", line_addr, data != NULL);
+}
+
+/**************************************************************************************/
+/* coh_downgrade_copy: take core q's copy from E/M down to S. A dirty copy
+   (dcache or MLC) is written back to the L1 unless writeback is FALSE, in
+   which case the dirty data is dropped. Returns FAILURE if the writeback
+   could not be queued; nothing has changed then. */
+
+static Flag coh_downgrade_copy(uns q, Addr line_addr, Dir_Entry* entry,
+                               Flag writeback) {
+  Addr         q_addr = convert_to_cmp_addr(q, line_addr);
+  Addr         dummy_line_addr;
+  Dcache_Data* data   = (Dcache_Data*)cache_access(
+    &cmp_model.dcache_stage[q].dcache, q_addr, &dummy_line_addr, FALSE);
+  MLC_Data* mlc_data = MLC_PRESENT ?
+                         (MLC_Data*)cache_access(
+                           &cmp_model.memory.uncores[q].mlc->cache, q_addr,
+                           &dummy_line_addr, FALSE) :
+                         NULL;
+
+  if(writeback && ((data && data->dirty) || (mlc_data && mlc_data->dirty))) {
+    // M -> S: one writeback to the shared L1 cleans both private copies
+    if(!new_mem_mlc_wb_req(MRT_WB, q, q_addr, L1_LINE_SIZE, 1, NULL, NULL,
+                           unique_count)) {
+      STAT_EVENT(q, COH_DOWNGRADE_WB_FAILED);
+      return FAILURE;
+    }
+    STAT_EVENT(q, COH_DOWNGRADE_WB);
+  }
+  if(data) {
+    data->coh_state = COH_S;
+    data->dirty     = FALSE;
+  }
+  if(mlc_data)
+    mlc_data->dirty = FALSE;
+
+  if(entry->owner == (int)q)
+    entry->owner = NO_OWNER;
+  DEBUG(q, "downgrade %llx\n", line_addr);
+  return SUCCESS;
+}
+
+/**************************************************************************************/
+/* coh_inv_done: an invalidation reaches core req->proc_id */
+
+static Flag coh_inv_done(Mem_Req* req) {
+  Dir_Entry* entry = coh_dir_entry(req->addr);
+
+  coh_invalidate_copy(req->proc_id, req->addr, entry);
+  ASSERT(req->proc_id, entry->pending > 0);
+  entry->pending--;
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* coh_downgrade_done: a downgrade reaches core req->proc_id; retried while
+   its writeback cannot be queued */
+
+static Flag coh_downgrade_done(Mem_Req* req) {
+  Dir_Entry* entry = coh_dir_entry(req->addr);
+
+  if(!coh_downgrade_copy(req->proc_id, req->addr, entry, TRUE))
+    return FALSE;
+  ASSERT(req->proc_id, entry->pending > 0);
+  entry->pending--;
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* coh_send_invalidations: send an invalidation to every other sharer.
+   Returns FAILURE if some could not be queued; those sharers keep their bit
+   and are sent to again on the next attempt. */
+
+static Flag coh_send_invalidations(uns proc_id, Addr line_addr,
+                                   Dir_Entry* entry) {
+  Flag all_sent = SUCCESS;
+
+  for(uns q = 0; q < NUM_CORES; q++) {
+    if(q == proc_id || !(entry->sharers & (1ULL << q)))
+      continue;
+    if(!new_mem_coh_req(q, convert_to_cmp_addr(q, line_addr), COH_MSG_LATENCY,
+                        coh_inv_done)) {
+      STAT_EVENT(proc_id, COH_MSG_FAILED);
+      all_sent = FAILURE;
+      continue;
+    }
+    STAT_EVENT(proc_id, COH_INV_MSG);
+    entry->pending++;
+  }
+  return all_sent;
+}
+
+/**************************************************************************************/
+/* coh_ready: whether proc_id can be granted the line now. If not, sends the
+   messages that will make it so (unless some are already in flight). */
+
+static Flag coh_ready(uns proc_id, Addr line_addr, Dir_Entry* entry,
+                      Flag write) {
+  if(entry->pending)
+    return FALSE;
+
+  if(write) {
+    if(!(entry->sharers & ~(1ULL << proc_id)))
+      return TRUE;
+    coh_send_invalidations(proc_id, line_addr, entry);
+    return FALSE;
+  }
+
+  if(entry->owner == NO_OWNER || entry->owner == (int)proc_id)
+    return TRUE;
+  uns q = entry->owner;
+  if(!new_mem_coh_req(q, convert_to_cmp_addr(q, line_addr), COH_MSG_LATENCY,
+                      coh_downgrade_done)) {
+    STAT_EVENT(proc_id, COH_MSG_FAILED);
+    return FALSE;
+  }
+  STAT_EVENT(proc_id, COH_DOWNGRADE_MSG);
+  entry->pending++;
+  return FALSE;
+}
+
+/**************************************************************************************/
+/* coh_grant: record proc_id's new copy once coh_ready holds */
+
+static Coh_State coh_grant(uns proc_id, Dir_Entry* entry, Flag write) {
+  if(entry->invalidated & (1ULL << proc_id)) {
+    STAT_EVENT(proc_id, COH_MISS);
+    entry->invalidated &= ~(1ULL << proc_id);
+  }
+
+  if(write) {
+    STAT_EVENT(proc_id, COH_GETM);
+    entry->sharers = 1ULL << proc_id;
+    entry->owner   = proc_id;
+    return COH_M;
+  }
+
+  STAT_EVENT(proc_id, COH_GETS);
+  ASSERT(proc_id, entry->owner == NO_OWNER || entry->owner == (int)proc_id);
+  entry->sharers |= 1ULL << proc_id;
+  if(entry->sharers == (1ULL << proc_id)) {
+    entry->owner = proc_id;
+    return COH_E;
+  }
+  return COH_S;
+}
+
+/**************************************************************************************/
+/* coh_fill_ready: */
+
+Flag coh_fill_ready(uns proc_id, Addr line_addr, Flag write) {
+  Dir_Entry* entry = coh_dir_entry(line_addr);
+  if(coh_ready(proc_id, line_addr, entry, write))
+    return TRUE;
+  STAT_EVENT(proc_id, COH_FILL_WAIT);
+  return FALSE;
+}
+
+/**************************************************************************************/
+/* coh_fill: */
+
+Coh_State coh_fill(uns proc_id, Addr line_addr, Flag write) {
+  Dir_Entry* entry = coh_dir_entry(line_addr);
+  ASSERTM(proc_id, !entry->pending && (write ?
+                     !(entry->sharers & ~(1ULL << proc_id)) :
+                     entry->owner == NO_OWNER || entry->owner == (int)proc_id),
+          "coh_fill of %llx without coh_fill_ready\n", line_addr);
+  return coh_grant(proc_id, entry, write);
+}
+
+/**************************************************************************************/
+/* coh_fill_now: */
+
+Coh_State coh_fill_now(uns proc_id, Addr line_addr, Flag write) {
+  Dir_Entry* entry = coh_dir_entry(line_addr);
+
+  STAT_EVENT(proc_id, COH_FUNCTIONAL_FILL);
+  for(uns q = 0; q < NUM_CORES; q++) {
+    if(q == proc_id || !(entry->sharers & (1ULL << q)))
+      continue;
+    if(write)
+      coh_invalidate_copy(q, line_addr, entry);
+    else if(entry->owner == (int)q)
+      coh_downgrade_copy(q, line_addr, entry, FALSE);
+  }
+  return coh_grant(proc_id, entry, write);
+}
+
+/**************************************************************************************/
+/* coh_upgrade: */
+
+Coh_State coh_upgrade(uns proc_id, Addr line_addr, Coh_State state) {
+  Dir_Entry* entry = coh_dir_entry(line_addr);
+
+  if(entry->owner == (int)proc_id) {
+    // E -> M is silent
+    return COH_M;
+  }
+  if(entry->pending) {
+    // a previous upgrade or another core's request is still in flight
+    STAT_EVENT(proc_id, COH_UPGRADE_WAIT);
+    return state;
+  }
+  STAT_EVENT(proc_id, COH_UPGRADE);
+  if(!coh_send_invalidations(proc_id, line_addr, entry))
+    return state;  // the next store retries the sharers that were missed
+  // the other copies stay readable until their invalidations land; requests
+  // from other cores wait for them
+  entry->owner = proc_id;
+  return COH_M;
+}
@@ -0,0 +1,71 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/coherence.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Directory-based MESI coherence between the private dcaches
+ *                (and MLCs) of the cores.
+ ***************************************************************************************/
+
+#ifndef __COHERENCE_H__
+#define __COHERENCE_H__
+
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Types */
+
+/* MESI state kept in each Dcache_Data */
+typedef enum Coh_State_enum {
+  COH_I,
+  COH_S,
+  COH_E,
+  COH_M,
+} Coh_State;
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Initialize (no-op unless COHERENCE_ON) */
+void init_coherence(void);
+
+/* A line is about to be filled into proc_id's dcache or pref dcache; write
+   is TRUE for an on-path store miss. Returns FALSE while other cores' copies
+   must first be invalidated or downgraded: the messages are sent and the
+   fill must be retried. */
+Flag coh_fill_ready(uns proc_id, Addr line_addr, Flag write);
+
+/* The fill after coh_fill_ready returned TRUE. Returns the MESI state of the
+   new line. */
+Coh_State coh_fill(uns proc_id, Addr line_addr, Flag write);
+
+/* A fill without latency (warmup, prefetchers that insert into the dcache at
+   once): other copies are invalidated or downgraded immediately and dirty
+   data is dropped. Returns the MESI state of the new line. */
+Coh_State coh_fill_now(uns proc_id, Addr line_addr, Flag write);
+
+/* An on-path store hits a line in state S or E. Sends the invalidations and
+   returns M, or returns state unchanged if they cannot be sent yet. */
+Coh_State coh_upgrade(uns proc_id, Addr line_addr, Coh_State state);
+
+#endif /* #ifndef __COHERENCE_H__ */
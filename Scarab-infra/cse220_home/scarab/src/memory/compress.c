@@ -0,0 +1,198 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/compress.c
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Compressed L1 (LLC) model driven by a per-line value profile.
+ *
+ * Traces carry addresses but no data values, so the compressibility of each
+ * line comes from COMPRESS_PROFILE_FILE. Every line of the file is
+ *
+ *     <line address in hex> <size>
+ *
+ * where size is either a BDI class (see Comp_Class) or the compressed size in
+ * bytes, e.g. from an FPC encoder. Lines missing from the profile are
+ * uncompressed. BDI sizes are for 64-byte lines and scale with L1_LINE_SIZE.
+ * All sizes are rounded up to L1_COMPRESS_SEGMENT bytes.
+ *
+ * The compressed L1 has L1_COMPRESS_TAG_FACTOR times as many tags as ways of
+ * data. A fill first evicts the oldest lines of the set until the new line's
+ * compressed size fits in the data array (see l1_fill_line), so a set holds
+ * between L1_ASSOC and L1_ASSOC * L1_COMPRESS_TAG_FACTOR lines. Hits on
+ * compressed lines pay L1_DECOMPRESS_CYCLES.
+ ***************************************************************************************/
+
+#include "debug/debug_macros.h"
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+#include "libs/cache_lib.h"
+#include "libs/hash_lib.h"
+#include "memory/compress.h"
+#include "memory/memory.h"
+#include "memory/memory.param.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Global Variables */
+
+DEFINE_ENUM(Comp_Class, COMP_CLASS_LIST);
+
+/* compressed size of a 64-byte line in each class */
+static const uns comp_class_size[COMP_CLASS_NUM_ELEMS] = {
+  1,   // ZERO
+  8,   // REP
+  16,  // B8D1: 8-byte base + 8 1-byte deltas
+  20,  // B4D1: 4-byte base + 16 1-byte deltas
+  24,  // B8D2
+  34,  // B2D1
+  36,  // B4D2
+  40,  // B8D4
+  64,  // UNCOMP
+};
+
+static Hash_Table comp_profile;  // line -> uns16 compressed size
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static uns   compress_round(uns size);
+static Addr  compress_key(Addr addr);
+static Cache* compress_l1(uns8 proc_id);
+
+/**************************************************************************************/
+/* init_compress */
+
+void init_compress(void) {
+  if(!L1_COMPRESS)
+    return;
+  ASSERTM(0, L1_COMPRESS_TAG_FACTOR >= 1, "L1_COMPRESS_TAG_FACTOR must be >= 1\n");
+  ASSERTM(0, L1_COMPRESS_SEGMENT > 0 && L1_COMPRESS_SEGMENT <= L1_LINE_SIZE,
+          "L1_COMPRESS_SEGMENT must be in [1, L1_LINE_SIZE]\n");
+  ASSERTM(0, L1_CACHE_REPL_POLICY != REPL_PARTITION,
+          "L1_COMPRESS does not support way partitioning\n");
+
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Cache* l1 = compress_l1(proc_id);
+    if(!l1->comp_size)  // a shared L1 appears once per core
+      cache_init_compression(l1, L1_ASSOC);
+  }
+
+  init_hash_table(&comp_profile, "compression profile", 1 << 16,
+                  sizeof(uns16));
+  if(!COMPRESS_PROFILE_FILE)
+    return;
+
+  FILE* file = fopen(COMPRESS_PROFILE_FILE, "r");
+  ASSERTM(0, file, "Could not open %s\n", COMPRESS_PROFILE_FILE);
+
+  char line[MAX_STR_LENGTH + 1];
+  char size_str[MAX_STR_LENGTH + 1];
+  Addr addr;
+  while(fgets(line, MAX_STR_LENGTH, file)) {
+    if(line[0] == '#' || line[0] == '\n')
+      continue;
+    uns num_matches = sscanf(line, "%llx %s", &addr, size_str);
+    ASSERTM(0, num_matches == 2, "Bad line in %s: %s", COMPRESS_PROFILE_FILE,
+            line);
+
+    uns size;
+    if(size_str[0] >= '0' && size_str[0] <= '9')
+      size = atoi(size_str);
+    else
+      size = comp_class_size[Comp_Class_parse(size_str)] * L1_LINE_SIZE / 64;
+    ASSERTM(0, size > 0 && size <= L1_LINE_SIZE,
+            "Compressed size %u of line 0x%llx out of range\n", size, addr);
+
+    Flag   new_entry;
+    uns16* entry = (uns16*)hash_table_access_create(
+      &comp_profile, compress_key(addr), &new_entry);
+    *entry = compress_round(size);
+  }
+
+  ASSERTM(0, feof(file) && !ferror(file), "Error reading %s\n",
+          COMPRESS_PROFILE_FILE);
+  fclose(file);
+}
+
+/**************************************************************************************/
+/* compress_line_size */
+
+uns compress_line_size(Addr addr) {
+  uns16* entry = (uns16*)hash_table_access(&comp_profile, compress_key(addr));
+  return entry ? *entry : L1_LINE_SIZE;
+}
+
+/**************************************************************************************/
+/* compress_fill */
+
+void compress_fill(uns8 proc_id, Addr addr) {
+  Cache* l1   = compress_l1(proc_id);
+  uns    size = compress_line_size(addr);
+
+  cache_set_comp_size(l1, addr, size);
+
+  STAT_EVENT(proc_id, L1_COMPRESS_FILL);
+  INC_STAT_EVENT(proc_id, L1_COMPRESS_FILL_BYTES, size);
+  if(size < L1_LINE_SIZE)
+    STAT_EVENT(proc_id, L1_COMPRESS_FILL_COMPRESSED);
+  /* lines resident in the set after the fill, over the data ways, is the
+     effective capacity of the set */
+  INC_STAT_EVENT(proc_id, L1_COMPRESS_SET_LINES,
+                 l1->assoc - cache_get_invalid_line_count(l1, addr));
+}
+
+/**************************************************************************************/
+/* compress_hit_latency */
+
+uns compress_hit_latency(uns8 proc_id, Addr addr) {
+  if(!L1_COMPRESS ||
+     cache_get_comp_size(compress_l1(proc_id), addr) >= L1_LINE_SIZE)
+    return 0;
+  STAT_EVENT(proc_id, L1_COMPRESS_DECOMP_HIT);
+  return L1_DECOMPRESS_CYCLES;
+}
+
+/**************************************************************************************/
+/* compress_round: whole segments, never more than a line */
+
+static uns compress_round(uns size) {
+  uns rounded = (size + L1_COMPRESS_SEGMENT - 1) / L1_COMPRESS_SEGMENT *
+                L1_COMPRESS_SEGMENT;
+  return MIN2(rounded, L1_LINE_SIZE);
+}
+
+/**************************************************************************************/
+/* compress_key: the profile is per address space, so drop the core bits */
+
+static Addr compress_key(Addr addr) {
+  return convert_to_cmp_addr(0, addr) >> LOG2(L1_LINE_SIZE);
+}
+
+static Cache* compress_l1(uns8 proc_id) {
+  return &mem->uncores[proc_id].l1->cache;
+}
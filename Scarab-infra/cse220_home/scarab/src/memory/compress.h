@@ -0,0 +1,63 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/compress.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Compressed L1 (LLC) model driven by a per-line value profile.
+ ***************************************************************************************/
+
+#ifndef __COMPRESS_H__
+#define __COMPRESS_H__
+
+#include "globals/enum.h"
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Types */
+
+/* Base-Delta-Immediate encodings (Pekhimenko et al., PACT 2012), smallest
+   first: all zeros, one repeated 8-byte value, and base size / delta size in
+   bytes. UNCOMP lines are stored as is. */
+#define COMP_CLASS_LIST(elem)                                            \
+  elem(ZERO) elem(REP) elem(B8D1) elem(B4D1) elem(B8D2) elem(B2D1)       \
+    elem(B4D2) elem(B8D4) elem(UNCOMP)
+
+DECLARE_ENUM(Comp_Class, COMP_CLASS_LIST, COMP_CLASS_);
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Load the value profile and turn on compression in the L1 caches (no-op
+   unless L1_COMPRESS) */
+void init_compress(void);
+
+/* Stored size in bytes of the line holding addr */
+uns compress_line_size(Addr addr);
+
+/* The line holding addr was just filled into proc_id's L1: record its size */
+void compress_fill(uns8 proc_id, Addr addr);
+
+/* Extra cycles to read the line holding addr on an L1 hit */
+uns compress_hit_latency(uns8 proc_id, Addr addr);
+
+#endif /* #ifndef __COMPRESS_H__ */
@@ -0,0 +1,309 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/mem_latency.c
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Per-request end-to-end latency breakdown of the memory
+ *                hierarchy.
+ *
+ * Each Mem_Req carries the phase it is in, the cycle that phase began and the
+ * cycles spent so far in every phase (see MEM_LAT_PHASE_LIST). memory.c moves
+ * a request between phases as it changes state; ramulator.cc splits the time
+ * spent in DRAM into queueing and service when the data comes back.
+ *
+ * When a request completes, every phase it went through (and its total) is
+ * added to a histogram selected by the level that satisfied the request (MLC,
+ * L1 or memory) and the request type. Histograms use log2 buckets with four
+ * linear sub-buckets each, so percentiles are exact up to 4 cycles and within
+ * 25% of a bucket above that. All times are in L1 cycles.
+ ***************************************************************************************/
+
+#include "debug/debug_macros.h"
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "freq.h"
+#include "general.param.h"
+#include "memory/mem_latency.h"
+#include "memory/memory.param.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define MEM_LAT_SUB_BITS 2
+#define MEM_LAT_SUBS (1 << MEM_LAT_SUB_BITS)
+#define MEM_LAT_BUCKETS 96 /* values up to 2^25 cycles */
+#define MEM_LAT_TOTAL MEM_LAT_NUM_ELEMS
+#define MEM_LAT_COLUMNS (MEM_LAT_NUM_ELEMS + 1)
+
+/**************************************************************************************/
+/* Types */
+
+typedef enum Mem_Lat_Level_enum {
+  MEM_LAT_LEVEL_MLC,
+  MEM_LAT_LEVEL_L1,
+  MEM_LAT_LEVEL_MEM,
+  MEM_LAT_NUM_LEVELS,
+} Mem_Lat_Level;
+
+typedef struct Lat_Hist_struct {
+  Counter count;
+  Counter sum;
+  Counter min;
+  Counter max;
+  Counter buckets[MEM_LAT_BUCKETS];
+} Lat_Hist;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static const char* const mem_lat_level_names[MEM_LAT_NUM_LEVELS] = {"MLC", "L1",
+                                                                   "MEM"};
+
+/* [level][request type][phase or total] */
+static Lat_Hist* mem_lat_hists = NULL;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static inline Counter mem_lat_now(void);
+static uns            mem_lat_bucket(Counter value);
+static Counter        mem_lat_bucket_low(uns bucket);
+static void     mem_lat_record(Lat_Hist* hist, Counter value);
+static Counter  mem_lat_percentile(Lat_Hist* hist, double fraction);
+static Lat_Hist* mem_lat_hist(Mem_Lat_Level level, Mem_Req_Type type, uns col);
+
+/**************************************************************************************/
+/* init_mem_latency: */
+
+void init_mem_latency(void) {
+  if(!MEM_LATENCY_HIST)
+    return;
+
+  mem_lat_hists = (Lat_Hist*)calloc(
+    MEM_LAT_NUM_LEVELS * MRT_NUM_ELEMS * MEM_LAT_COLUMNS, sizeof(Lat_Hist));
+}
+
+/**************************************************************************************/
+/* mem_lat_start: */
+
+void mem_lat_start(Mem_Req* req, Mem_Lat_Phase phase) {
+  if(!MEM_LATENCY_HIST)
+    return;
+
+  memset(req->lat_cycles, 0, sizeof(req->lat_cycles));
+  req->lat_stamp   = mem_lat_now();
+  req->lat_phase   = phase;
+  req->lat_visited = 1 << phase;
+}
+
+/**************************************************************************************/
+/* mem_lat_phase: */
+
+void mem_lat_phase(Mem_Req* req, Mem_Lat_Phase phase) {
+  if(!MEM_LATENCY_HIST)
+    return;
+
+  Counter now     = mem_lat_now();
+  Counter elapsed = now - req->lat_stamp;
+
+  req->lat_cycles[req->lat_phase] = MIN2(
+    (Counter)req->lat_cycles[req->lat_phase] + elapsed, MAX_UNS);
+  req->lat_stamp = now;
+  req->lat_phase = phase;
+  req->lat_visited |= 1 << phase;
+}
+
+/**************************************************************************************/
+/* mem_lat_dram_done: */
+
+void mem_lat_dram_done(Mem_Req* req, Counter service_cycles) {
+  if(!MEM_LATENCY_HIST)
+    return;
+
+  Counter now     = mem_lat_now();
+  Counter elapsed = now - req->lat_stamp;
+  Counter service = MIN2(
+    freq_convert(FREQ_DOMAIN_MEMORY, service_cycles, FREQ_DOMAIN_L1), elapsed);
+
+  /* everything before the first DRAM command stays with the current phase
+     (normally DRAM_QUEUE) */
+  req->lat_cycles[req->lat_phase] = MIN2(
+    (Counter)req->lat_cycles[req->lat_phase] + elapsed - service, MAX_UNS);
+  req->lat_cycles[MEM_LAT_DRAM_SERVICE] = MIN2(
+    (Counter)req->lat_cycles[MEM_LAT_DRAM_SERVICE] + service, MAX_UNS);
+  req->lat_visited |= 1 << MEM_LAT_DRAM_SERVICE;
+  req->lat_stamp = now;
+  req->lat_phase = MEM_LAT_FILL;
+  req->lat_visited |= 1 << MEM_LAT_FILL;
+}
+
+/**************************************************************************************/
+/* mem_lat_done: */
+
+void mem_lat_done(Mem_Req* req) {
+  Mem_Lat_Level level;
+  Counter       total = 0;
+  uns           ii;
+
+  if(!MEM_LATENCY_HIST)
+    return;
+
+  /* L1 hits that fill the MLC also finish in MRS_FILL_DONE */
+  if(req->state == MRS_MLC_HIT_DONE)
+    level = MEM_LAT_LEVEL_MLC;
+  else if(req->state == MRS_L1_HIT_DONE)
+    level = MEM_LAT_LEVEL_L1;
+  else if(req->state == MRS_FILL_DONE)
+    level = req->l1_miss ? MEM_LAT_LEVEL_MEM : MEM_LAT_LEVEL_L1;
+  else
+    return; /* killed or dropped */
+
+  mem_lat_phase(req, req->lat_phase);
+
+  for(ii = 0; ii < MEM_LAT_NUM_ELEMS; ii++) {
+    if(!(req->lat_visited & (1 << ii)))
+      continue;
+    mem_lat_record(mem_lat_hist(level, req->type, ii), req->lat_cycles[ii]);
+    total += req->lat_cycles[ii];
+  }
+  mem_lat_record(mem_lat_hist(level, req->type, MEM_LAT_TOTAL), total);
+}
+
+/**************************************************************************************/
+/* mem_lat_dump: */
+
+void mem_lat_dump(void) {
+  uns   level, type, col;
+  FILE* file;
+
+  if(!MEM_LATENCY_HIST)
+    return;
+
+  file = file_tag_fopen(OUTPUT_DIR, "mem_latency", "w");
+  if(!file) {
+    WARNING(0, "Could not open mem_latency.out\n");
+    return;
+  }
+
+  fprintf(file, "# Memory request latency breakdown (L1 cycles)\n");
+  fprintf(file, "%-5s %-12s %-14s %12s %10s %8s %8s %8s %10s\n", "level",
+          "type", "phase", "count", "mean", "p50", "p99", "p99.9", "max");
+  for(level = 0; level < MEM_LAT_NUM_LEVELS; level++) {
+    for(type = 0; type < MRT_NUM_ELEMS; type++) {
+      for(col = 0; col < MEM_LAT_COLUMNS; col++) {
+        Lat_Hist* hist = mem_lat_hist(level, type, col);
+        if(!hist->count)
+          continue;
+        fprintf(file, "%-5s %-12s %-14s %12llu %10.2f %8llu %8llu %8llu %10llu\n",
+                mem_lat_level_names[level], Mem_Req_Type_str(type),
+                col == MEM_LAT_TOTAL ? "TOTAL" : Mem_Lat_Phase_str(col),
+                hist->count, (double)hist->sum / hist->count,
+                mem_lat_percentile(hist, 0.5), mem_lat_percentile(hist, 0.99),
+                mem_lat_percentile(hist, 0.999), hist->max);
+      }
+    }
+  }
+
+  fclose(file);
+}
+
+/**************************************************************************************/
+/* mem_lat_now: all phase timestamps are taken in the L1 clock domain */
+
+static inline Counter mem_lat_now(void) {
+  return freq_cycle_count(FREQ_DOMAIN_L1);
+}
+
+/**************************************************************************************/
+/* mem_lat_hist: */
+
+static Lat_Hist* mem_lat_hist(Mem_Lat_Level level, Mem_Req_Type type, uns col) {
+  ASSERT(0, level < MEM_LAT_NUM_LEVELS && type < MRT_NUM_ELEMS &&
+              col < MEM_LAT_COLUMNS);
+  return &mem_lat_hists[(level * MRT_NUM_ELEMS + type) * MEM_LAT_COLUMNS + col];
+}
+
+/**************************************************************************************/
+/* mem_lat_bucket: values below MEM_LAT_SUBS get their own bucket; above that
+   each power of two is split into MEM_LAT_SUBS linear buckets */
+
+static uns mem_lat_bucket(Counter value) {
+  if(value < MEM_LAT_SUBS)
+    return value;
+
+  uns exp    = LOG2_64(value);
+  uns sub    = (value >> (exp - MEM_LAT_SUB_BITS)) & (MEM_LAT_SUBS - 1);
+  uns bucket = (exp - MEM_LAT_SUB_BITS + 1) * MEM_LAT_SUBS + sub;
+  return MIN2(bucket, MEM_LAT_BUCKETS - 1);
+}
+
+/**************************************************************************************/
+/* mem_lat_bucket_low: smallest value that falls into bucket */
+
+static Counter mem_lat_bucket_low(uns bucket) {
+  if(bucket < MEM_LAT_SUBS)
+    return bucket;
+
+  uns exp = bucket / MEM_LAT_SUBS + MEM_LAT_SUB_BITS - 1;
+  uns sub = bucket % MEM_LAT_SUBS;
+  return (Counter)(MEM_LAT_SUBS + sub) << (exp - MEM_LAT_SUB_BITS);
+}
+
+/**************************************************************************************/
+/* mem_lat_record: */
+
+static void mem_lat_record(Lat_Hist* hist, Counter value) {
+  hist->min = hist->count ? MIN2(hist->min, value) : value;
+  hist->max = MAX2(hist->max, value);
+  hist->count++;
+  hist->sum += value;
+  hist->buckets[mem_lat_bucket(value)]++;
+}
+
+/**************************************************************************************/
+/* mem_lat_percentile: interpolates linearly inside the bucket holding the
+   requested rank (samples are assumed to sit in the middle of their share of
+   the bucket) */
+
+static Counter mem_lat_percentile(Lat_Hist* hist, double fraction) {
+  Counter rank = (Counter)(fraction * hist->count + 0.999999);
+  Counter seen = 0;
+  uns     ii;
+
+  rank = MAX2(rank, 1);
+  for(ii = 0; ii < MEM_LAT_BUCKETS; ii++) {
+    Counter in_bucket = hist->buckets[ii];
+    if(seen + in_bucket >= rank) {
+      Counter low   = mem_lat_bucket_low(ii);
+      Counter width = mem_lat_bucket_low(ii + 1) - low;
+      Counter value = low + (width * (2 * (rank - seen) - 1)) / (2 * in_bucket);
+      return MAX2(MIN2(value, hist->max), hist->min);
+    }
+    seen += in_bucket;
+  }
+  return hist->max;
+}
@@ -0,0 +1,60 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/mem_latency.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Per-request end-to-end latency breakdown of the memory
+ *                hierarchy.
+ ***************************************************************************************/
+
+#ifndef __MEM_LATENCY_H__
+#define __MEM_LATENCY_H__
+
+#include "globals/global_types.h"
+#include "memory/mem_req.h"
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Allocate the histograms (no-op unless MEM_LATENCY_HIST) */
+void init_mem_latency(void);
+
+/* A request buffer entry was just initialized and starts in phase */
+void mem_lat_start(Mem_Req* req, Mem_Lat_Phase phase);
+
+/* The request moves to phase; the time since the last transition is charged
+   to the phase it was in */
+void mem_lat_phase(Mem_Req* req, Mem_Lat_Phase phase);
+
+/* DRAM returned the data; service_cycles (DRAM cycles from the first command
+   to the data) are split off the DRAM queue time. The request moves to FILL. */
+void mem_lat_dram_done(Mem_Req* req, Counter service_cycles);
+
+/* The request is being freed; completed requests are added to the
+   histograms of the level that satisfied them */
+void mem_lat_done(Mem_Req* req);
+
+/* Write mem_latency.out */
+void mem_lat_dump(void);
+
+#endif /* #ifndef __MEM_LATENCY_H__ */
@@ -0,0 +1,207 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/mem_qos.c
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Per-core memory bandwidth throttling and multi-core
+ *                slowdown/fairness accounting.
+ *
+ * Throttling: MEM_QOS_BW_LIMIT gives, per core, the number of requests the
+ * core may send to DRAM in every MEM_QOS_BW_WINDOW cycles (0 = unlimited).
+ * A throttled request is rejected like one that finds the Ramulator queue
+ * full, so it stays where it is and retries on later cycles.
+ *
+ * Fairness: MEM_QOS_ALONE_IPC gives the IPC each core reaches when running
+ * alone. A core's slowdown is its alone IPC over its IPC in the shared run,
+ * measured when it reaches its instruction limit. fairness.out reports the
+ * slowdowns with weighted speedup, harmonic speedup and maximum slowdown
+ * (unfairness).
+ ***************************************************************************************/
+
+#include "debug/debug_macros.h"
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+#include "general.param.h"
+#include "memory/mem_qos.h"
+#include "memory/memory.param.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct Qos_Core_struct {
+  uns     bw_limit;     // requests per window, 0 = unlimited
+  uns     bw_used;      // requests sent in the current window
+  Counter bw_window;    // window bw_used belongs to
+  double  alone_ipc;    // 0 = not given
+  double  shared_ipc;   // measured in this run
+  Flag    done;         // shared_ipc is final
+} Qos_Core;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Qos_Core* qos_cores;
+static Flag      qos_throttle_on;
+static Flag      qos_fairness_on;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static double shared_ipc(uns proc_id);
+
+/**************************************************************************************/
+/* init_mem_qos */
+
+void init_mem_qos(void) {
+  uns    limits[MAX_NUM_PROCS];
+  double alone_ipcs[MAX_NUM_PROCS];
+
+  qos_cores = (Qos_Core*)calloc(NUM_CORES, sizeof(Qos_Core));
+
+  if(MEM_QOS_BW_LIMIT) {
+    ASSERTM(0, MEM_QOS_BW_WINDOW > 0, "MEM_QOS_BW_WINDOW must be positive\n");
+    uns num = parse_uns_array(limits, MEM_QOS_BW_LIMIT, NUM_CORES);
+    ASSERTM(0, num == 1 || num == NUM_CORES,
+            "MEM_QOS_BW_LIMIT needs one value or one per core (%d)\n",
+            NUM_CORES);
+    for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+      qos_cores[proc_id].bw_limit = limits[num == 1 ? 0 : proc_id];
+      qos_throttle_on |= qos_cores[proc_id].bw_limit > 0;
+    }
+  }
+
+  if(MEM_QOS_ALONE_IPC) {
+    uns num = parse_double_array(alone_ipcs, MEM_QOS_ALONE_IPC, NUM_CORES);
+    ASSERTM(0, num == NUM_CORES,
+            "MEM_QOS_ALONE_IPC needs one IPC per core (%d)\n", NUM_CORES);
+    for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+      ASSERTM(0, alone_ipcs[proc_id] > 0.0,
+              "Alone IPC of core %d must be positive\n", proc_id);
+      qos_cores[proc_id].alone_ipc = alone_ipcs[proc_id];
+    }
+    qos_fairness_on = TRUE;
+  }
+}
+
+/**************************************************************************************/
+/* mem_qos_throttled */
+
+Flag mem_qos_throttled(uns proc_id) {
+  if(!qos_throttle_on)
+    return FALSE;
+  Qos_Core* core = &qos_cores[proc_id];
+  if(!core->bw_limit)
+    return FALSE;
+
+  Counter window = cycle_count / MEM_QOS_BW_WINDOW;
+  if(core->bw_window != window) {
+    core->bw_window = window;
+    core->bw_used   = 0;
+  }
+  if(core->bw_used < core->bw_limit)
+    return FALSE;
+
+  STAT_EVENT(proc_id, MEM_QOS_THROTTLED);
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* mem_qos_sent: mem_qos_throttled() has already moved the core's window */
+
+void mem_qos_sent(uns proc_id) {
+  if(qos_throttle_on)
+    qos_cores[proc_id].bw_used++;
+}
+
+/**************************************************************************************/
+/* mem_qos_core_done */
+
+void mem_qos_core_done(uns proc_id) {
+  if(!qos_fairness_on || qos_cores[proc_id].done)
+    return;
+  Qos_Core* core   = &qos_cores[proc_id];
+  core->shared_ipc = shared_ipc(proc_id);
+  core->done       = TRUE;
+  if(core->shared_ipc > 0.0)
+    INC_STAT_VALUE(proc_id, MEM_QOS_SLOWDOWN,
+                   core->alone_ipc / core->shared_ipc);
+}
+
+/**************************************************************************************/
+/* mem_qos_dump */
+
+void mem_qos_dump(void) {
+  if(!qos_fairness_on)
+    return;
+
+  FILE* file = file_tag_fopen(OUTPUT_DIR, "fairness", "w");
+  ASSERT(0, file);
+
+  double weighted_speedup = 0.0;
+  double inv_speedup_sum  = 0.0;
+  double max_slowdown     = 0.0;
+  double min_slowdown     = 1.0e99;
+
+  fprintf(file, "%-6s %12s %12s %12s\n", "core", "alone_ipc", "shared_ipc",
+          "slowdown");
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Qos_Core* core = &qos_cores[proc_id];
+    if(!core->done) {
+      // cores that did not reach their limit are measured at the end
+      core->shared_ipc = shared_ipc(proc_id);
+      core->done       = TRUE;
+    }
+    double slowdown = core->shared_ipc > 0.0 ?
+                        core->alone_ipc / core->shared_ipc :
+                        1.0e99;
+    fprintf(file, "%-6d %12.4f %12.4f %12.4f\n", proc_id, core->alone_ipc,
+            core->shared_ipc, slowdown);
+    weighted_speedup += core->shared_ipc / core->alone_ipc;
+    inv_speedup_sum += slowdown;
+    max_slowdown = MAX2(max_slowdown, slowdown);
+    min_slowdown = MIN2(min_slowdown, slowdown);
+  }
+
+  fprintf(file, "\n");
+  fprintf(file, "%-20s %12.4f\n", "weighted_speedup", weighted_speedup);
+  fprintf(file, "%-20s %12.4f\n", "harmonic_speedup",
+          NUM_CORES / inv_speedup_sum);
+  fprintf(file, "%-20s %12.4f\n", "max_slowdown", max_slowdown);
+  fprintf(file, "%-20s %12.4f\n", "unfairness", max_slowdown / min_slowdown);
+  fclose(file);
+}
+
+/**************************************************************************************/
+/* shared_ipc: IPC over the measured (post-warmup) part of the run */
+
+static double shared_ipc(uns proc_id) {
+  Counter cycles = GET_STAT_EVENT(proc_id, NODE_CYCLE);
+  return cycles ? (double)GET_STAT_EVENT(proc_id, NODE_INST_COUNT) / cycles :
+                  0.0;
+}
@@ -0,0 +1,53 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/mem_qos.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Per-core memory bandwidth throttling and multi-core
+ *                slowdown/fairness accounting.
+ ***************************************************************************************/
+
+#ifndef __MEM_QOS_H__
+#define __MEM_QOS_H__
+
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Parse the per-core bandwidth limits and alone-run IPCs */
+void init_mem_qos(void);
+
+/* Has proc_id used up its DRAM request budget for the current window? */
+Flag mem_qos_throttled(uns proc_id);
+
+/* proc_id sent a request to DRAM */
+void mem_qos_sent(uns proc_id);
+
+/* proc_id reached its instruction limit: record its IPC and slowdown */
+void mem_qos_core_done(uns proc_id);
+
+/* Write fairness.out (no-op unless alone-run IPCs were given) */
+void mem_qos_dump(void);
+
+#endif /* #ifndef __MEM_QOS_H__ */
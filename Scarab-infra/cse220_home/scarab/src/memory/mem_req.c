@@ -35,6 +35,7 @@
 
 DEFINE_ENUM(Mem_Req_Type, MRT_LIST);
 DEFINE_ENUM(Dram_Req_Status, DRAM_REQ_STATUS_LIST);
+DEFINE_ENUM(Mem_Lat_Phase, MEM_LAT_PHASE_LIST);
 
 /**************************************************************************************/
 /* Global Variables */
@@ -63,7 +64,7 @@ Flag mem_req_type_is_prefetch(Mem_Req_Type type) {
 /* mem_req_type_is_stalling */
 
 Flag mem_req_type_is_stalling(Mem_Req_Type type) {
-  return type == MRT_IFETCH || type == MRT_DFETCH ||
+  return type == MRT_IFETCH || type == MRT_DFETCH || type == MRT_PTWALK ||
          (!STORES_DO_NOT_BLOCK_WINDOW && type == MRT_DSTORE);
 }
 
@@ -74,6 +74,8 @@ typedef enum Mem_Req_State_enum {
     elem(DPRF)         /* data prefetch */           \
     elem(WB)           /* writeback of dirty data */ \
     elem(WB_NODIRTY)   /* writeback of clean data */ \
+    elem(PTWALK)       /* page table walk read */    \
+    elem(COH)          /* coherence invalidation or downgrade */ \
     elem(MIN_PRIORITY) /* request of minimal priority */
 
 DECLARE_ENUM(Mem_Req_Type, MRT_LIST, MRT_);
@@ -96,6 +98,26 @@ typedef enum Destination_enum {
 
 DECLARE_ENUM(Dram_Req_Status, DRAM_REQ_STATUS_LIST, DRAM_REQ_ROW_);
 
+/* Phases of a request's lifetime for the latency breakdown (mem_latency.c).
+   QUEUE is the wait before the first port attempt, BANK the wait for a free
+   port after that. L1_NET is the request's trip over the NUCA network to its
+   slice (NUCA_ON). FILL covers everything from the DRAM response to the
+   request being freed. */
+#define MEM_LAT_PHASE_LIST(elem) \
+  elem(MLC_QUEUE)                \
+  elem(MLC_BANK)                 \
+  elem(MLC_ACCESS)               \
+  elem(L1_QUEUE)                 \
+  elem(L1_NET)                   \
+  elem(L1_BANK)                  \
+  elem(L1_ACCESS)                \
+  elem(BUS)                      \
+  elem(DRAM_QUEUE)               \
+  elem(DRAM_SERVICE)             \
+  elem(FILL)
+
+DECLARE_ENUM(Mem_Lat_Phase, MEM_LAT_PHASE_LIST, MEM_LAT_);
+
 // typedef in globals/global_types.h
 struct Mem_Req_struct {
   uns  proc_id;            /* processor id that generates the request */
@@ -198,6 +220,13 @@ struct Mem_Req_struct {
   Counter dram_core_service_cycles_at_start; /* "Virtual clock" timestamp */
   uns fdip_pref_off_path; /*set if the mem_req is requested by FDIP on the actual wrong path prediction*/
   Counter cyc_hit_by_demand_load; /*set if the mem_req (requested by FDIP) is hit by a demand load*/
+  Flag    nuca_sent;         /* has the request entered the NUCA network? */
+  Counter nuca_send_cycle;   /* cycle it left its core's network stop */
+  Counter nuca_arrive_cycle; /* cycle it reached its L1 slice */
+  Counter lat_stamp;   /* L1 cycle the current latency phase began */
+  uns8    lat_phase;   /* current Mem_Lat_Phase */
+  uns16   lat_visited; /* bit mask of the phases the request went through */
+  uns32   lat_cycles[MEM_LAT_NUM_ELEMS]; /* cycles spent in each phase */
 };
 
 /**************************************************************************************/
@@ -42,6 +42,10 @@
 #include "cache_part.h"
 #include "mem_req.h"
 #include "memory.h"
+#include "mem_latency.h"
+#include "compress.h"
+#include "mem_qos.h"
+#include "nuca.h"
 #include "op.h"
 #include "prefetcher//pref_stream.h"
 
@@ -106,7 +110,7 @@ Counter Mem_Req_Priority_Offset[MRT_NUM_ELEMS];
 static void init_mem_req_type_priorities(void);
 static void init_uncores(void);
 static void update_memory_queues(void);
-static void update_on_chip_memory_stats(void);
+static void update_on_chip_memory_stats(Counter cycles);
 
 static void mark_ops_as_l1_miss(Mem_Req* req);
 static void mark_l1_miss_deps(Op* op);
@@ -116,6 +120,7 @@ static void update_mem_req_occupancy_counter(Mem_Req_Type type, int delta);
 int         mem_compare_priority(const void* a, const void* b);
 void        mem_start_mlc_access(Mem_Req* req);
 static void mem_process_core_fill_reqs(uns proc_id);
+static void mem_process_coh_reqs(void);
 Flag mem_process_mlc_hit_access(Mem_Req* req, Mem_Queue_Entry* mlc_queue_entry,
                                 Addr* line_addr, MLC_Data* data,
                                 int lruu_position);
@@ -195,9 +200,6 @@ static inline void queue_sanity_check(int location);
 
 void mem_insert_req_round_robin(void);
 
-static Flag new_mem_mlc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr,
-                               uns size, uns delay, Op* op,
-                               Flag done_func(Mem_Req*), Counter unique_num);
 static Flag new_mem_l1_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr,
                               uns size, uns delay, Op* op,
                               Flag done_func(Mem_Req*), Counter unique_num);
@@ -281,6 +283,12 @@ void init_mem_req_type_priorities() {
       case MRT_WB_NODIRTY:
         priority = MEM_PRIORITY_WB_NODIRTY;
         break;
+      case MRT_PTWALK:
+        priority = MEM_PRIORITY_PTWALK;
+        break;
+      case MRT_COH:
+        priority = MEM_PRIORITY_COH;
+        break;
       case MRT_MIN_PRIORITY:
         priority = least_priority + 1;
         break;
@@ -373,6 +381,8 @@ void init_memory() {
                    QUEUE_CORE_FILL);
     core_fill_seq_num[proc_id] = 1;
   }
+  init_mem_queue(&mem->coh_queue, "COH_QUEUE", mem->total_mem_req_buffers,
+                 QUEUE_COH);
 
   init_uncores();
 
@@ -399,6 +409,8 @@ void init_memory() {
   reset_memory();
 
   init_perf_pred();
+  init_mem_latency();
+  init_mem_qos();
 }
 
 /**
@@ -423,7 +435,8 @@ void init_uncores(void) {
     MLC(proc_id) = mlc;
   }
 
-  /* Initialize LLC */
+  /* Initialize LLC (a compressed LLC has extra tags, see compress.c) */
+  uns l1_tag_factor = L1_COMPRESS ? L1_COMPRESS_TAG_FACTOR : 1;
   if(PRIVATE_L1) {
     ASSERTM(
       0, L1_SIZE % NUM_CORES == 0,
@@ -436,8 +449,9 @@ void init_uncores(void) {
 
       char buf[MAX_STR_LENGTH + 1];
       sprintf(buf, "L1[%d]", proc_id);
-      init_cache(&l1->cache, buf, L1_SIZE / NUM_CORES, L1_ASSOC, L1_LINE_SIZE,
-                 sizeof(L1_Data), L1_CACHE_REPL_POLICY);
+      init_cache(&l1->cache, buf, L1_SIZE / NUM_CORES * l1_tag_factor,
+                 L1_ASSOC * l1_tag_factor, L1_LINE_SIZE, sizeof(L1_Data),
+                 L1_CACHE_REPL_POLICY);
 
       l1->num_banks = L1_BANKS / NUM_CORES;
       l1->ports     = (Ports*)malloc(sizeof(Ports) * l1->num_banks);
@@ -450,8 +464,9 @@ void init_uncores(void) {
     }
   } else {
     Ported_Cache* l1 = (Ported_Cache*)malloc(sizeof(Ported_Cache));
-    init_cache(&l1->cache, "L1_CACHE", L1_SIZE, L1_ASSOC, L1_LINE_SIZE,
-               sizeof(L1_Data), L1_CACHE_REPL_POLICY);
+    init_cache(&l1->cache, "L1_CACHE", L1_SIZE * l1_tag_factor,
+               L1_ASSOC * l1_tag_factor, L1_LINE_SIZE, sizeof(L1_Data),
+               L1_CACHE_REPL_POLICY);
     l1->num_banks = L1_BANKS;
     l1->ports     = (Ports*)malloc(sizeof(Ports) * l1->num_banks);
     for(uns ii = 0; ii < l1->num_banks; ii++) {
@@ -463,6 +478,8 @@ void init_uncores(void) {
       L1(proc_id) = l1;
     }
   }
+  init_nuca(L1(0)->num_banks);
+  init_compress();
 
   if(L1_CACHE_REPL_POLICY == REPL_PARTITION) {
     // initially equally partition
@@ -557,8 +574,11 @@ void mem_free_reqbuf(Mem_Req* req) {
     mem->l1_queue.entry_count, mem->bus_out_queue.entry_count,
     mem->l1fill_queue.entry_count);
 
+  mem_lat_done(req);
 
-  if(req->state == MRS_MEM_DONE) {
+  if(req->type == MRT_COH) {
+    /* coherence messages are not memory accesses */
+  } else if(req->state == MRS_MEM_DONE) {
     ASSERT(req->proc_id, req->type == MRT_WB);
     ASSERT(req->proc_id, !req->off_path);
     STAT_EVENT(req->proc_id, MEM_REQ_COMPLETE_WB);
@@ -750,6 +770,9 @@ void print_mem_queue(Mem_Queue_Type queue_type) {
 
   if(queue_type & QUEUE_CORE_FILL)
     print_mem_queue_generic(&(mem->core_fill_queues[0]));
+
+  if(queue_type & QUEUE_COH)
+    print_mem_queue_generic(&(mem->coh_queue));
 }
 
 
@@ -882,26 +905,34 @@ void update_memory_queues() {
   }
 }
 
-void update_on_chip_memory_stats() {
-  STAT_EVENT_ALL(L1_CYCLE);
-  STAT_EVENT(0, MIN2(MEM_REQ_DEMANDS__0 + mem_req_demand_entries / 4,
-                     MEM_REQ_DEMANDS_64));
-  STAT_EVENT(
-    0, MIN2(MEM_REQ_PREFS__0 + mem_req_pref_entries / 4, MEM_REQ_PREFS_64));
-  STAT_EVENT(0, MIN2(MEM_REQ_WRITEBACKS__0 + mem_req_wb_entries / 4,
-                     MEM_REQ_WRITEBACKS_64));
-  INC_STAT_EVENT(0, MEM_REQ_DEMAND_CYCLES, mem_req_demand_entries);
-  INC_STAT_EVENT(0, MEM_REQ_PREF_CYCLES, mem_req_pref_entries);
-  INC_STAT_EVENT(0, MEM_REQ_WB_CYCLES, mem_req_wb_entries);
+/* update_on_chip_memory_stats: the per-cycle stats of as many cycles in
+   which the outstanding requests did not change */
+void update_on_chip_memory_stats(Counter cycles) {
+  INC_STAT_EVENT_ALL(L1_CYCLE, cycles);
+  INC_STAT_EVENT(0,
+                 MIN2(MEM_REQ_DEMANDS__0 + mem_req_demand_entries / 4,
+                      MEM_REQ_DEMANDS_64),
+                 cycles);
+  INC_STAT_EVENT(
+    0, MIN2(MEM_REQ_PREFS__0 + mem_req_pref_entries / 4, MEM_REQ_PREFS_64),
+    cycles);
+  INC_STAT_EVENT(0,
+                 MIN2(MEM_REQ_WRITEBACKS__0 + mem_req_wb_entries / 4,
+                      MEM_REQ_WRITEBACKS_64),
+                 cycles);
+  INC_STAT_EVENT(0, MEM_REQ_DEMAND_CYCLES, cycles * mem_req_demand_entries);
+  INC_STAT_EVENT(0, MEM_REQ_PREF_CYCLES, cycles * mem_req_pref_entries);
+  INC_STAT_EVENT(0, MEM_REQ_WB_CYCLES, cycles * mem_req_wb_entries);
   for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    STAT_EVENT(
+    INC_STAT_EVENT(
       proc_id,
-      CORE_MLP_0 + MIN2(mem->uncores[proc_id].num_outstanding_l1_misses, 32));
+      CORE_MLP_0 + MIN2(mem->uncores[proc_id].num_outstanding_l1_misses, 32),
+      cycles);
     INC_STAT_EVENT(proc_id, CORE_MLP,
-                   mem->uncores[proc_id].num_outstanding_l1_misses);
+                   cycles * mem->uncores[proc_id].num_outstanding_l1_misses);
     Counter l1_lines = GET_TOTAL_STAT_EVENT(proc_id, NORESET_L1_FILL) -
                        GET_TOTAL_STAT_EVENT(proc_id, NORESET_L1_EVICT);
-    INC_STAT_EVENT(proc_id, L1_LINES, l1_lines);
+    INC_STAT_EVENT(proc_id, L1_LINES, cycles * l1_lines);
   }
 }
 
@@ -920,10 +951,11 @@ void update_memory() {
 
     pref_update();
     update_memory_queues();
-    update_on_chip_memory_stats();
+    update_on_chip_memory_stats(1);
 
     mem_process_mlc_fill_reqs();
     mem_process_l1_fill_reqs();
+    mem_process_coh_reqs();
   }
 
   if(freq_is_ready(FREQ_DOMAIN_MEMORY)) {
@@ -933,6 +965,11 @@ void update_memory() {
     ramulator_tick();
   }
 
+  if(DRAM_CACHE_ON && freq_is_ready(FREQ_DOMAIN_DRAM_CACHE)) {
+    cycle_count = freq_cycle_count(FREQ_DOMAIN_DRAM_CACHE);
+    ramulator_dram_cache_tick();
+  }
+
   if(freq_is_ready(FREQ_DOMAIN_L1)) {
     cycle_count = freq_cycle_count(FREQ_DOMAIN_L1);
 
@@ -949,6 +986,83 @@ void update_memory() {
   }
 }
 
+/* the earliest cycle after now at which a request in the queue is handled */
+static Counter mem_queue_next_cycle(Mem_Queue* queue, Counter now) {
+  Counter next = MAX_CTR;
+  for(int ii = 0; ii < queue->entry_count && next > now + 1; ii++) {
+    Mem_Req* req = &mem->req_buffer[queue->base[ii].reqbuf];
+    next         = MIN2(next, MAX2(req->rdy_cycle, now + 1));
+  }
+  return next;
+}
+
+/**
+ * @brief the earliest time at which update_memory may do more than count
+ * cycles, if the cores send no new request
+ *
+ * Each queue only handles the requests whose rdy_cycle has come (or that
+ * failed to move on and retry every cycle). Ramulator tells how many of its
+ * upcoming ticks are idle.
+ */
+Counter memory_next_event_time() {
+  Counter next;
+
+  if(DRAM_CACHE_ON)  // the DRAM cache tier is ticked every cycle
+    return freq_cycle_start_time(
+      FREQ_DOMAIN_DRAM_CACHE, freq_cycle_count(FREQ_DOMAIN_DRAM_CACHE) + 1);
+
+  Counter mem_cycle = freq_cycle_count(FREQ_DOMAIN_MEMORY);
+  next = freq_cycle_start_time(FREQ_DOMAIN_MEMORY,
+                               mem_cycle + ramulator_idle_ticks() + 1);
+
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Freq_Domain_Id domain     = FREQ_DOMAIN_CORES[proc_id];
+    Counter        core_cycle = mem_queue_next_cycle(
+      &mem->core_fill_queues[proc_id], freq_cycle_count(domain));
+    if(core_cycle != MAX_CTR)
+      next = MIN2(next, freq_cycle_start_time(domain, core_cycle));
+  }
+
+  Counter now      = freq_cycle_count(FREQ_DOMAIN_L1);
+  Counter l1_cycle = MAX_CTR;
+  if(l1_in_buf_count || cycle_l1q_insert_count || cycle_mlcq_insert_count ||
+     cycle_busoutq_insert_count)
+    l1_cycle = now + 1;
+  l1_cycle = MIN2(l1_cycle, mem_queue_next_cycle(&mem->l1_queue, now));
+  l1_cycle = MIN2(l1_cycle, mem_queue_next_cycle(&mem->mlc_queue, now));
+  l1_cycle = MIN2(l1_cycle, mem_queue_next_cycle(&mem->bus_out_queue, now));
+  l1_cycle = MIN2(l1_cycle, mem_queue_next_cycle(&mem->l1fill_queue, now));
+  l1_cycle = MIN2(l1_cycle, mem_queue_next_cycle(&mem->mlc_fill_queue, now));
+  l1_cycle = MIN2(l1_cycle, mem_queue_next_cycle(&mem->coh_queue, now));
+  // scanning the prefetch queues only pays if the rest can wait
+  if(l1_cycle > now + 1 &&
+     freq_cycle_start_time(FREQ_DOMAIN_L1, now + 1) < next && !pref_idle())
+    l1_cycle = now + 1;
+  if(l1_cycle != MAX_CTR)
+    next = MIN2(next, freq_cycle_start_time(FREQ_DOMAIN_L1, l1_cycle));
+
+  return next;
+}
+
+/**
+ * @brief account for L1 and memory cycles skipped before
+ * memory_next_event_time, as if update_memory had run in each of them
+ */
+void memory_skip_cycles(Counter l1_cycles, Counter memory_cycles) {
+  if(l1_cycles) {
+    cycle_count = freq_cycle_count(FREQ_DOMAIN_L1);
+    perf_pred_cycle();
+    pref_skip_cycles(l1_cycles);
+    update_on_chip_memory_stats(l1_cycles);
+    INC_STAT_EVENT(0, L1_QUEUE_OCCUPANCY,
+                   l1_cycles * mem->l1_queue.entry_count);
+    INC_STAT_EVENT(0, MLC_QUEUE_OCCUPANCY,
+                   l1_cycles * mem->l1_queue.entry_count);
+  }
+  if(memory_cycles)
+    ramulator_skip_ticks(memory_cycles);
+}
+
 /**************************************************************************************/
 /* mem_compare_priority: */
 
@@ -988,6 +1102,7 @@ void mem_start_mlc_access(Mem_Req* req) {
     req->state     = MRS_MLC_WAIT;
     req->rdy_cycle = cycle_count + MLC_CYCLES;
   }
+  mem_lat_phase(req, avail ? MEM_LAT_MLC_ACCESS : MEM_LAT_MLC_BANK);
 
   if(need_wp)
     STAT_EVENT(req->proc_id, MLC_ST_BANK_BLOCK + avail);
@@ -1025,10 +1140,13 @@ void mem_start_l1_access(Mem_Req* req) {
     } else {
       req->rdy_cycle = cycle_count + L1_CYCLES;
     }
+    if(NUCA_ON)
+      nuca_slice_grant(req);
 
     mem->uncores[req->proc_id].num_outstanding_l1_accesses++;
     memview_l1(req);
   }
+  mem_lat_phase(req, avail ? MEM_LAT_L1_ACCESS : MEM_LAT_L1_BANK);
 
   if(need_wp)
     STAT_EVENT(req->proc_id, L1_ST_BANK_BLOCK + avail);
@@ -1094,6 +1212,8 @@ Flag mem_process_l1_hit_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry,
               (req->type == MRT_IFETCH)) {
       STAT_EVENT(req->proc_id, L1_DEMAND_HIT);
       STAT_EVENT(req->proc_id, CORE_L1_DEMAND_HIT);
+    } else if(req->type == MRT_PTWALK) {
+      STAT_EVENT(req->proc_id, L1_PTWALK_HIT);
     } else {  // CMP Watch out RA
       STAT_EVENT(req->proc_id, L1_WB_HIT);
       STAT_EVENT(req->proc_id, CORE_L1_WB_HIT);
@@ -1136,12 +1256,25 @@ Flag mem_process_l1_hit_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry,
   // this is just a stat collection
   wp_process_l1_hit(data, req);
 
+  mem_lat_phase(req, L1_WRITE_THROUGH && (req->type == MRT_WB) ? MEM_LAT_BUS :
+                                                                 MEM_LAT_FILL);
+  /* reading a compressed line out of the L1 */
+  uns decompress_cycles = data && req->type != MRT_WB &&
+                              req->type != MRT_WB_NODIRTY ?
+                            compress_hit_latency(req->proc_id, req->addr) :
+                            0;
+  /* the data leaves the slice now */
+  uns nuca_cycles = NUCA_ON && req->nuca_sent && req->type != MRT_WB &&
+                        req->type != MRT_WB_NODIRTY &&
+                        (fill_mlc || req->done_func) ?
+                      nuca_send_resp(req) :
+                      0;
   if(L1_WRITE_THROUGH && (req->type == MRT_WB)) {
     req->state     = MRS_BUS_NEW;
     req->rdy_cycle = cycle_count + L1Q_TO_FSB_TRANSFER_LATENCY;
   } else if(fill_mlc) {
     req->state     = MRS_FILL_MLC;
-    req->rdy_cycle = cycle_count + 1;
+    req->rdy_cycle = cycle_count + 1 + decompress_cycles + nuca_cycles;
     // insert into mlc queue
     req->queue = &(mem->mlc_fill_queue);
     if(!ORDER_BEYOND_BUS)
@@ -1158,8 +1291,9 @@ Flag mem_process_l1_hit_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry,
     mem_free_reqbuf(req);
   } else {
     req->state     = MRS_L1_HIT_DONE;
-    req->rdy_cycle = freq_cycle_count(
-      FREQ_DOMAIN_CORES[req->proc_id]);  // no +1 to match old performance
+    req->rdy_cycle = freq_cycle_count(FREQ_DOMAIN_CORES[req->proc_id]) +
+                     decompress_cycles +
+                     nuca_cycles;  // no +1 to match old performance
     // insert into core fill queue
     req->queue = &(mem->core_fill_queues[req->proc_id]);
     if(!ORDER_BEYOND_BUS)
@@ -1221,6 +1355,8 @@ Flag mem_process_mlc_hit_access(Mem_Req* req, Mem_Queue_Entry* mlc_queue_entry,
                 (req->type == MRT_IFETCH)) {
         STAT_EVENT(req->proc_id, MLC_DEMAND_HIT);
         STAT_EVENT(req->proc_id, CORE_MLC_DEMAND_HIT);
+      } else if(req->type == MRT_PTWALK) {
+        STAT_EVENT(req->proc_id, MLC_PTWALK_HIT);
       } else {  // CMP Watch out RA
         STAT_EVENT(req->proc_id, MLC_WB_HIT);
         STAT_EVENT(req->proc_id, CORE_MLC_WB_HIT);
@@ -1251,6 +1387,7 @@ Flag mem_process_mlc_hit_access(Mem_Req* req, Mem_Queue_Entry* mlc_queue_entry,
     if(MLC_WRITE_THROUGH && (req->type == MRT_WB)) {
       req->state     = MRS_L1_NEW;
       req->rdy_cycle = cycle_count + MLCQ_TO_L1Q_TRANSFER_LATENCY;
+      mem_lat_phase(req, MEM_LAT_L1_QUEUE);
     } else {  // writeback done
       /* Remove the entry from request buffer */
       req->state = MRS_MLC_HIT_DONE;
@@ -1296,6 +1433,8 @@ static Flag mem_process_l1_miss_access(Mem_Req*         req,
               (req->type == MRT_IFETCH)) {
       STAT_EVENT(req->proc_id, L1_DEMAND_MISS);
       STAT_EVENT(req->proc_id, CORE_L1_DEMAND_MISS);
+    } else if(req->type == MRT_PTWALK) {
+      STAT_EVENT(req->proc_id, L1_PTWALK_MISS);
     } else {  // CMP Watch out RA
       STAT_EVENT(req->proc_id, L1_WB_MISS);
       STAT_EVENT(req->proc_id, CORE_L1_WB_MISS);
@@ -1358,6 +1497,7 @@ static Flag mem_process_l1_miss_access(Mem_Req*         req,
       if(L1_WRITE_THROUGH && req->type == MRT_WB) {
         req->state     = MRS_BUS_NEW;
         req->rdy_cycle = cycle_count + L1Q_TO_FSB_TRANSFER_LATENCY;
+        mem_lat_phase(req, MEM_LAT_BUS);
       } else {  // CMP write back
         req->state     = MRS_L1_HIT_DONE;
         req->rdy_cycle = cycle_count + 1;
@@ -1433,6 +1573,8 @@ static Flag mem_process_mlc_miss_access(Mem_Req*         req,
               (req->type == MRT_IFETCH)) {
       STAT_EVENT(req->proc_id, MLC_DEMAND_MISS);
       STAT_EVENT(req->proc_id, CORE_MLC_DEMAND_MISS);
+    } else if(req->type == MRT_PTWALK) {
+      STAT_EVENT(req->proc_id, MLC_PTWALK_MISS);
     } else {  // CMP Watch out RA
       STAT_EVENT(req->proc_id, MLC_WB_MISS);
       STAT_EVENT(req->proc_id, CORE_MLC_WB_MISS);
@@ -1483,6 +1625,7 @@ static Flag mem_process_mlc_miss_access(Mem_Req*         req,
       if(MLC_WRITE_THROUGH && req->type == MRT_WB) {
         req->state     = MRS_L1_NEW;
         req->rdy_cycle = cycle_count + MLCQ_TO_L1Q_TRANSFER_LATENCY;
+        mem_lat_phase(req, MEM_LAT_L1_QUEUE);
       } else {  // CMP write back
         req->state     = MRS_MLC_HIT_DONE;
         req->rdy_cycle = cycle_count + 1;
@@ -1499,6 +1642,7 @@ static Flag mem_process_mlc_miss_access(Mem_Req*         req,
                      MLCQ_TO_L1Q_TRANSFER_LATENCY; /* this req will be ready to
                                                       be sent to memory in the
                                                       next cycle */
+    mem_lat_phase(req, MEM_LAT_L1_QUEUE);
     /* Set the priority so that this entry will be removed from the mlc_queue */
     mlc_queue_entry->priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
     return TRUE;
@@ -1672,6 +1816,7 @@ static Flag mem_complete_l1_access(Mem_Req*         req,
     if(l1_miss_access && l1_miss_send_bus) {
       if(CONSTANT_MEMORY_LATENCY) {
         mem->uncores[req->proc_id].num_outstanding_l1_misses++;
+        mem_lat_phase(req, MEM_LAT_DRAM_SERVICE);
         mem_complete_bus_in_access(req, l1_queue_entry->priority);
         req->rdy_cycle       = cycle_count + freq_convert(FREQ_DOMAIN_MEMORY,
                                                     MEMORY_CYCLES,
@@ -1706,6 +1851,7 @@ static Flag mem_complete_l1_access(Mem_Req*         req,
         } else {
           ASSERT(req->proc_id, req->mem_queue_cycle >= req->rdy_cycle);
           req->queue = NULL;
+          mem_lat_phase(req, MEM_LAT_DRAM_QUEUE);
 
           DEBUG(req->proc_id, "l1 miss request is sent to ramulator\n");
           mem_seq_num++;
@@ -1742,7 +1888,8 @@ static Flag mem_complete_l1_access(Mem_Req*         req,
           ASSERTM(0,
                   req->type == MRT_DSTORE || req->type == MRT_IFETCH ||
                     req->type == MRT_DFETCH || req->type == MRT_IPRF ||
-                    req->type == MRT_DPRF || req->type == MRT_UOCPRF || req->type == MRT_FDIPPRFON || req->type == MRT_FDIPPRFOFF,
+                    req->type == MRT_DPRF || req->type == MRT_UOCPRF || req->type == MRT_FDIPPRFON || req->type == MRT_FDIPPRFOFF ||
+                    req->type == MRT_PTWALK,
                   "ERROR: Issuing a currently unhandled request type (%s) to "
                   "Ramulator\n",
                   Mem_Req_Type_str(req->type));
@@ -1927,6 +2074,13 @@ static void mem_process_l1_reqs() {
 
     /* If this is a new request, reserve L1 port and transition to wait state */
     if(req->state == MRS_L1_NEW) {
+      if(NUCA_ON && !req->nuca_sent) {
+        /* cross the network to the slice before arbitrating for its port */
+        req->rdy_cycle = nuca_send_req(req);
+        mem_lat_phase(req, MEM_LAT_L1_NET);
+        if(cycle_count < req->rdy_cycle)
+          continue;
+      }
       mem_start_l1_access(req);
       STAT_EVENT(req->proc_id, L1_ACCESS);
       if(req->type == MRT_DPRF || req->type == MRT_IPRF || req->type == MRT_UOCPRF || req->type == MRT_FDIPPRFON || req->type == MRT_FDIPPRFOFF)
@@ -2357,6 +2511,7 @@ static void mem_process_bus_out_reqs() {
              // with mem_seq_num?
     if(sent) {
       ASSERT(req->proc_id, req->mem_queue_cycle >= req->rdy_cycle);
+      mem_lat_phase(req, MEM_LAT_DRAM_QUEUE);
     }
 
     mem_seq_num++;  // Ramulator_note: Do we need to move this after
@@ -2434,7 +2589,7 @@ void mem_complete_bus_in_access(Mem_Req* req, Counter priority) {
     // INC_STAT_EVENT(req->proc_id, CORE_MEM_STALLING_LATENCY_IFETCH +
     // req->type, dram_sched_stalling_age(req)); // Ramulator_todo: replicate
     // this stat
-    INC_STAT_EVENT(req->proc_id, CORE_MEM_LATENCY_IFETCH + req->type,
+    INC_STAT_EVENT(req->proc_id, CORE_MEM_LATENCY_IFETCH + MIN2(req->type, 8),
                    req->rdy_cycle - req->mem_queue_cycle);
     if(req->type != MRT_DPRF && req->type != MRT_IPRF && req->type != MRT_UOCPRF && req->type != MRT_FDIPPRFON && req->type != MRT_FDIPPRFOFF &&
        !req->demand_match_prefetch) {
@@ -2497,6 +2652,7 @@ static void mem_process_l1_fill_reqs() {
       continue;
 
     if(req->state == MRS_FILL_L1) {
+      mem_lat_phase(req, MEM_LAT_FILL);
       DEBUG(req->proc_id,
             "Mem request about to fill L1  index:%ld  type:%s  addr:0x%s  "
             "size:%d  state: %s\n",
@@ -2513,6 +2669,10 @@ static void mem_process_l1_fill_reqs() {
           req->state     = MRS_FILL_DONE;
           req->rdy_cycle = cycle_count + 1;
         }
+        /* the data leaves the slice once it is written into it */
+        if(NUCA_ON && req->nuca_sent &&
+           (req->state == MRS_FILL_MLC || req->done_func))
+          req->rdy_cycle += nuca_send_resp(req);
         if(PERF_PRED_REQS_FINISH_AT_FILL) {
           perf_pred_mem_req_done(req);
         }
@@ -2672,9 +2832,12 @@ static void mem_process_core_fill_reqs(uns proc_id) {
     ASSERT(req->proc_id, req->state != MRS_INV);
     ASSERT(req->proc_id, (req->type != MRT_WB) || req->wb_requested_back);
     ASSERT(req->proc_id, req->type != MRT_WB_NODIRTY);
-    ASSERT(req->proc_id, cycle_count >= req->rdy_cycle);
     ASSERT(proc_id,
            req->state == MRS_L1_HIT_DONE || req->state == MRS_FILL_DONE);
+
+    /* the data may still be crossing the NUCA network */
+    if(cycle_count < req->rdy_cycle)
+      continue;
     ASSERT(proc_id,
            req->done_func);  // requests w/o done_func() should be done by now
 
@@ -2701,6 +2864,36 @@ static void mem_process_core_fill_reqs(uns proc_id) {
   }
 }
 
+/**************************************************************************************/
+/* mem_process_coh_reqs: deliver the coherence messages whose latency has
+   elapsed. A done_func that returns FALSE (e.g. its writeback could not be
+   queued) is retried in the next cycle. */
+
+static void mem_process_coh_reqs() {
+  Mem_Queue* coh_queue     = &mem->coh_queue;
+  int        removal_count = 0;
+  int        ii;
+
+  for(ii = 0; ii < coh_queue->entry_count; ii++) {
+    Mem_Req* req = &mem->req_buffer[coh_queue->base[ii].reqbuf];
+
+    ASSERT(req->proc_id, req->type == MRT_COH && req->done_func);
+    if(cycle_count < req->rdy_cycle || !req->done_func(req))
+      continue;
+
+    mem_free_reqbuf(req);
+    removal_count++;
+    coh_queue->base[ii].priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+  }
+
+  if(removal_count > 0) {
+    qsort(coh_queue->base, coh_queue->entry_count, sizeof(Mem_Queue_Entry),
+          mem_compare_priority);
+    coh_queue->entry_count -= removal_count;
+    ASSERT(0, coh_queue->entry_count >= 0);
+  }
+}
+
 /**************************************************************************************/
 /* scan_stores: */
 
@@ -2902,7 +3095,8 @@ static inline Mem_Req* mem_search_reqbuf(
 
   // ASSERT(proc_id, !(queues_to_search & QUEUE_MEM));
   if(queues_to_search & QUEUE_MEM) {
-    req = ramulator_search_queue(addr_translate(addr), type);
+    // a lookup, so it must not map the page
+    req = ramulator_search_queue(addr_translate(addr, TRUE), type);
     if(req) {
       *ramulator_match = TRUE;
       if(req->type == MRT_IPRF) {
@@ -2994,11 +3188,11 @@ Flag mem_adjust_matching_request(Mem_Req* req, Mem_Req_Type type, Addr addr,
       req->done_func         = done_func;
       req->wb_requested_back = TRUE;
       STAT_EVENT(req->proc_id, DEMAND_MATCH_WB + (req->type == MRT_WB_NODIRTY));
-      STAT_EVENT_ALL(DEMAND_MATCH_WBALL_IFETCH + type);
+      STAT_EVENT_ALL(DEMAND_MATCH_WBALL_IFETCH + MIN2(type, 6));
       if(req->type == MRT_WB_NODIRTY) {
-        STAT_EVENT(req->proc_id, DEMAND_MATCH_WB_ND_IFETCH + type);
+        STAT_EVENT(req->proc_id, DEMAND_MATCH_WB_ND_IFETCH + MIN2(type, 6));
       } else {
-        STAT_EVENT(req->proc_id, DEMAND_MATCH_WB_IFETCH + type);
+        STAT_EVENT(req->proc_id, DEMAND_MATCH_WB_IFETCH + MIN2(type, 6));
       }
     } else {
       // somebody already requested this writeback
@@ -3016,6 +3210,7 @@ Flag mem_adjust_matching_request(Mem_Req* req, Mem_Req_Type type, Addr addr,
     }
   }
 
+  Flag old_off_path           = req->off_path;
   Flag old_off_path_confirmed = req->off_path_confirmed;
   Flag old_type               = req->type;
   Flag type_added             = FALSE;
@@ -3198,6 +3393,12 @@ Flag mem_adjust_matching_request(Mem_Req* req, Mem_Req_Type type, Addr addr,
      && req->fdip_pref_off_path != fdip_off_path(req->proc_id))
     req->fdip_pref_off_path = 2;
 
+  // an off-path request did not map its page; map it now that the request
+  // is on the correct path, unless it has already gone to DRAM
+  if(old_off_path && !req->off_path && !MEMORY_RANDOM_ADDR &&
+     req->state < MRS_MEM_NEW)
+    req->phys_addr = addr_translate(req->addr, FALSE);
+
   update_mem_req_occupancy_counter(old_type, -1);
   update_mem_req_occupancy_counter(
     req->type, +1);  // BUG? req->type does not always match type
@@ -3244,7 +3445,9 @@ Flag mem_can_allocate_req_buffer(uns proc_id, Mem_Req_Type type,
     }
   }
 
-  if(type != MRT_WB && type != MRT_WB_NODIRTY) {
+  /* coherence messages unblock fills and never allocate further requests
+     (except a downgrade writeback), so they may use the writeback reserve */
+  if(type != MRT_WB && type != MRT_WB_NODIRTY && type != MRT_COH) {
     if(PRIVATE_MSHR_ON &&
        mem->num_req_buffers_per_core[proc_id] + MEM_REQ_BUFFER_WB_VALVE >=
          MEM_REQ_BUFFER_ENTRIES) {
@@ -3536,11 +3739,6 @@ static void mem_init_new_req(
   new_req->queue              = to_mlc ? &mem->mlc_queue : &mem->l1_queue;
   new_req->proc_id            = proc_id;
   new_req->addr               = addr;
-  new_req->phys_addr          = addr_translate(addr);
-
-  if(MEMORY_RANDOM_ADDR)
-    new_req->phys_addr = convert_to_cmp_addr(proc_id,
-                                             rand() * VA_PAGE_SIZE_BYTES);
   new_req->priority = new_priority;
   new_req->size     = size;
   ASSERT(new_req->proc_id, new_req->size <= VA_PAGE_SIZE_BYTES);
@@ -3556,7 +3754,9 @@ static void mem_init_new_req(
   */
   new_req->mlc_bank = BANK(addr, MLC(proc_id)->num_banks,
                            MLC_INTERLEAVE_FACTOR);
-  new_req->l1_bank  = BANK(addr, L1(proc_id)->num_banks, L1_INTERLEAVE_FACTOR);
+  new_req->l1_bank  = NUCA_ON ? nuca_slice(addr) :
+                               BANK(addr, L1(proc_id)->num_banks,
+                                    L1_INTERLEAVE_FACTOR);
   new_req->start_cycle          = freq_cycle_count(FREQ_DOMAIN_L1) + delay;
   new_req->rdy_cycle            = freq_cycle_count(FREQ_DOMAIN_L1) + delay;
   new_req->first_stalling_cycle = mem_req_type_is_stalling(type) ?
@@ -3588,6 +3788,9 @@ static void mem_init_new_req(
   new_req->fq_finish_time      = MAX_CTR;
   new_req->dram_access_cycle   = 0;
   new_req->dram_latency        = 0;
+  new_req->nuca_sent           = FALSE;
+  new_req->nuca_send_cycle     = 0;
+  new_req->nuca_arrive_cycle   = 0;
 
   new_req->belong_to_batch = FALSE;
   new_req->rank            = 0;
@@ -3616,14 +3819,19 @@ static void mem_init_new_req(
       fdip_off_path(proc_id))
     new_req->off_path = TRUE;
 
-  STAT_EVENT(proc_id, MEM_REQ_INIT_IFETCH + type);
+  new_req->phys_addr = addr_translate(addr, new_req->off_path);
+  if(MEMORY_RANDOM_ADDR)
+    new_req->phys_addr = convert_to_cmp_addr(proc_id,
+                                             rand() * VA_PAGE_SIZE_BYTES);
+
+  STAT_EVENT(proc_id, MEM_REQ_INIT_IFETCH + MIN2(type, 6));
   STAT_EVENT(proc_id, MEM_REQ_INIT);
   STAT_EVENT(proc_id, MEM_REQ_INIT_ONPATH + new_req->off_path);
   if(new_req->off_path) {
-    STAT_EVENT(proc_id, MEM_REQ_INIT_OFFPATH_IFETCH + type);
+    STAT_EVENT(proc_id, MEM_REQ_INIT_OFFPATH_IFETCH + MIN2(type, 6));
     STAT_EVENT(proc_id, REQBUF_CREATE_OFFPATH);
   } else {
-    STAT_EVENT(proc_id, MEM_REQ_INIT_ONPATH_IFETCH + type);
+    STAT_EVENT(proc_id, MEM_REQ_INIT_ONPATH_IFETCH + MIN2(type, 6));
     STAT_EVENT(proc_id, REQBUF_CREATE_ONPATH);
 
     if(type != MRT_WB) {
@@ -3644,6 +3852,8 @@ static void mem_init_new_req(
       addr, NUM_ADDR_NON_SIGN_EXTEND_BITS, TRUE);
   }
 
+  mem_lat_start(new_req, to_mlc ? MEM_LAT_MLC_QUEUE : MEM_LAT_L1_QUEUE);
+
   DEBUG(new_req->proc_id,
         "New mem request is initiated index:%ld type:%s addr:0x%s state:%s\n",
         (long int)(new_req - mem->req_buffer), Mem_Req_Type_str(new_req->type),
@@ -3882,7 +4092,7 @@ Flag new_mem_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size,
       STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL);
       if((type == MRT_IFETCH) || (type == MRT_DFETCH) || (type == MRT_DSTORE))
         STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_DEMAND);
-      STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_IFETCH + type);
+      STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_IFETCH + MIN2(type, 6));
       return FALSE;
     } else {
       kicked_out = TRUE;
@@ -4019,6 +4229,54 @@ static Flag insert_new_req_into_mlc_queue(uns proc_id, Mem_Req* new_req) {
   return TRUE;
 }
 
+/**************************************************************************************/
+/* new_mem_coh_req: queue a coherence message to core proc_id for the line at
+   addr (proc_id's copy). done_func runs delay L1 cycles later and performs
+   the invalidation or downgrade. Returns FAILURE if no request buffer is
+   free. */
+
+Flag new_mem_coh_req(uns8 proc_id, Addr addr, uns delay,
+                     Flag done_func(Mem_Req*)) {
+  Mem_Req* new_req;
+
+  ASSERT(proc_id, done_func);
+  if(queue_full(&mem->coh_queue))
+    return FAILURE;
+
+  new_req = mem_allocate_req_buffer(proc_id, MRT_COH, FALSE);
+  if(!new_req) {
+    STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL);
+    return FAILURE;
+  }
+  mem->req_count++;
+
+  new_req->type                 = MRT_COH;
+  new_req->types                = 0;
+  mem_req_set_types(new_req, MRT_COH);
+  new_req->state                = MRS_L1_WAIT;
+  new_req->proc_id              = proc_id;
+  new_req->addr                 = addr;
+  new_req->phys_addr            = addr;
+  new_req->size                 = L1_LINE_SIZE;
+  new_req->off_path             = FALSE;
+  new_req->off_path_confirmed   = FALSE;
+  new_req->priority             = Mem_Req_Priority_Offset[MRT_COH];
+  new_req->reserved_entry_count = 0;
+  new_req->emitted_cycle        = cycle_count;
+  new_req->start_cycle          = freq_cycle_count(FREQ_DOMAIN_L1);
+  new_req->rdy_cycle            = new_req->start_cycle + delay;
+  new_req->first_stalling_cycle = MAX_CTR;
+  new_req->op_count             = 0;
+  new_req->req_count            = 1;
+  new_req->done_func            = done_func;
+  new_req->dirty_l0             = FALSE;
+  new_req->wb_requested_back    = FALSE;
+  new_req->destination          = DEST_NONE;
+  new_req->queue                = &mem->coh_queue;
+  mem_insert_req_into_queue(new_req, new_req->queue, 0);
+  return SUCCESS;
+}
+
 /**************************************************************************************/
 /* new_mem_dc_wb_req: */
 /* Returns TRUE if the request is successfully entered into the memory system */
@@ -4100,7 +4358,7 @@ Flag new_mem_dc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size,
     STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL);
     if((type == MRT_IFETCH) || (type == MRT_DFETCH) || (type == MRT_DSTORE))
       STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_DEMAND);
-    STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_IFETCH + type);
+    STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_IFETCH + MIN2(type, 6));
     return FALSE;
   }
 
@@ -4123,9 +4381,9 @@ Flag new_mem_dc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size,
 /* new_mem_mlc_wb_req: */
 /* Returns TRUE if the request is successfully entered into the memory system */
 
-static Flag new_mem_mlc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr,
-                               uns size, uns delay, Op* op,
-                               Flag done_func(Mem_Req*), Counter unique_num) {
+Flag new_mem_mlc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size,
+                        uns delay, Op* op, Flag done_func(Mem_Req*),
+                        Counter unique_num) {
   Mem_Req*         new_req              = NULL;
   Mem_Req*         matching_req         = NULL;
   Mem_Queue_Entry* queue_entry          = NULL;
@@ -4193,7 +4451,7 @@ static Flag new_mem_mlc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr,
     STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL);
     if((type == MRT_IFETCH) || (type == MRT_DFETCH) || (type == MRT_DSTORE))
       STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_DEMAND);
-    STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_IFETCH + type);
+    STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_IFETCH + MIN2(type, 6));
     return FALSE;
   }
   /* Step 5: Allocate a new request buffer -- new_req */
@@ -4322,7 +4580,7 @@ static Flag new_mem_l1_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr,
       STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL);
       if((type == MRT_IFETCH) || (type == MRT_DFETCH) || (type == MRT_DSTORE))
         STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_DEMAND);
-      STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_IFETCH + type);
+      STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL_DENIED_IFETCH + MIN2(type, 6));
       return FALSE;
     } else {
       kicked_out = TRUE;
@@ -4377,6 +4635,43 @@ void op_nuke_mem_req(Op* op) {
 }
 
 
+/**************************************************************************************/
+/* l1_compress_make_room: evict lines of the set, in the replacement policy's
+   order, until the data array has room for the compressed size of the line
+   at addr. Every path that inserts into a compressed L1 calls this first and
+   compress_fill after the insert. Warmup drops dirty victims without a
+   writeback, like warmup_l1_insert does. Returns FAILURE if a dirty victim
+   could not be written back; the lines evicted so far stay evicted, so the
+   retry resumes where this one stopped. */
+
+Flag l1_compress_make_room(uns8 proc_id, Addr addr, Flag warmup) {
+  Cache*   l1_cache = &L1(proc_id)->cache;
+  uns      size     = compress_line_size(addr);
+  Addr     repl_line_addr, line_addr;
+  L1_Data* data;
+
+  while((data = (L1_Data*)cache_next_comp_victim(l1_cache, proc_id, addr, size,
+                                                 &repl_line_addr))) {
+    if(!warmup && !L1_WRITE_THROUGH && !L1_IGNORE_WB && data->dirty) {
+      DEBUG(data->proc_id, "Scheduling compression writeback of addr:0x%s\n",
+            hexstr64s(repl_line_addr));
+      if(!new_mem_l1_wb_req(MRT_WB, data->proc_id, repl_line_addr, L1_LINE_SIZE,
+                            0, NULL, NULL, unique_count))
+        return FAILURE;
+      STAT_EVENT(proc_id, L1_FILL_DIRTY);
+    }
+
+    STAT_EVENT(data->proc_id, NORESET_L1_EVICT);
+    STAT_EVENT(data->proc_id, L1_COMPRESS_EXTRA_EVICT);
+    if(!warmup) {
+      STAT_EVENT(data->proc_id, L1_DATA_EVICT);
+      pref_ul1evict(data->proc_id, repl_line_addr);
+    }
+    cache_invalidate(l1_cache, repl_line_addr, &line_addr);
+  }
+  return SUCCESS;
+}
+
 /**
  * @brief
  *
@@ -4425,6 +4720,10 @@ Flag l1_fill_line(Mem_Req* req) {
     return SUCCESS;
   }
 
+  /* A compressed L1 may have to evict several lines to fit the new one */
+  if(L1_COMPRESS && !l1_compress_make_room(req->proc_id, req->addr, FALSE))
+    return FAILURE;
+
   /* Do not insert the line yet, just check which line we
      need to replace. If that line is dirty, it's possible
      that we won't be able to insert the writeback into the
@@ -4607,6 +4906,8 @@ Flag l1_fill_line(Mem_Req* req) {
     data = (L1_Data*)cache_insert(&L1(req->proc_id)->cache, req->proc_id,
                                   req->addr, &line_addr, &repl_line_addr);
   }
+  if(L1_COMPRESS)
+    compress_fill(req->proc_id, req->addr);
 
   STAT_EVENT(req->proc_id, NORESET_L1_FILL);
   if(mem_req_type_is_prefetch(req->type) || req->demand_match_prefetch)
@@ -4760,28 +5061,6 @@ Flag mlc_fill_line(Mem_Req* req) {
   /* if (!get_write_port(&MLC(req->proc_id)->ports[req->mlc_bank])) return
    * FAILURE; */
 
-  // Put prefetches in the right position for replacement
-  // cmp FIXME prefetchers
-  if(req->type == MRT_DPRF || req->type == MRT_IPRF) {
-    mem->pref_replpos = INSERT_REPL_DEFAULT;
-    if(PREF_INSERT_LRU) {
-      mem->pref_replpos = INSERT_REPL_LRU;
-      STAT_EVENT(req->proc_id, PREF_REPL_LRU);
-    } else if(PREF_INSERT_MIDDLE) {
-      mem->pref_replpos = INSERT_REPL_MID;
-      STAT_EVENT(req->proc_id, PREF_REPL_MID);
-    } else if(PREF_INSERT_LOWQTR) {
-      mem->pref_replpos = INSERT_REPL_LOWQTR;
-      STAT_EVENT(req->proc_id, PREF_REPL_LOWQTR);
-    }
-    data = (MLC_Data*)cache_insert_replpos(
-      &MLC(req->proc_id)->cache, req->proc_id, req->addr, &line_addr,
-      &repl_line_addr, mem->pref_replpos, TRUE);
-  } else {
-    data = (MLC_Data*)cache_insert(&MLC(req->proc_id)->cache, req->proc_id,
-                                   req->addr, &line_addr, &repl_line_addr);
-  }
-
   if(req->type == MRT_WB_NODIRTY || req->type == MRT_WB) {
     STAT_EVENT(req->proc_id, MLC_WB_FILL);
     STAT_EVENT(req->proc_id, CORE_MLC_WB_FILL);
@@ -4919,6 +5198,29 @@ Flag mlc_fill_line(Mem_Req* req) {
     }
   }
 
+  /* the victim has been handled above, now insert the line */
+  // Put prefetches in the right position for replacement
+  // cmp FIXME prefetchers
+  if(req->type == MRT_DPRF || req->type == MRT_IPRF) {
+    mem->pref_replpos = INSERT_REPL_DEFAULT;
+    if(PREF_INSERT_LRU) {
+      mem->pref_replpos = INSERT_REPL_LRU;
+      STAT_EVENT(req->proc_id, PREF_REPL_LRU);
+    } else if(PREF_INSERT_MIDDLE) {
+      mem->pref_replpos = INSERT_REPL_MID;
+      STAT_EVENT(req->proc_id, PREF_REPL_MID);
+    } else if(PREF_INSERT_LOWQTR) {
+      mem->pref_replpos = INSERT_REPL_LOWQTR;
+      STAT_EVENT(req->proc_id, PREF_REPL_LOWQTR);
+    }
+    data = (MLC_Data*)cache_insert_replpos(
+      &MLC(req->proc_id)->cache, req->proc_id, req->addr, &line_addr,
+      &repl_line_addr, mem->pref_replpos, TRUE);
+  } else {
+    data = (MLC_Data*)cache_insert(&MLC(req->proc_id)->cache, req->proc_id,
+                                   req->addr, &line_addr, &repl_line_addr);
+  }
+
   /* this will make it bring the line into the mlc and then modify it */
   data->proc_id = req->proc_id;
   data->dirty   = ((req->type == MRT_WB) &&
@@ -5107,15 +5409,17 @@ void mark_ops_as_l1_miss_satisfied(Mem_Req* req) {
 /* recursively go through the wake up lists of the op and mark ops as
  * l1_miss_dep */
 static void mark_l1_miss_deps(Op* op) {
-  Wake_Up_Entry* temp;
+  Wake_Up_Slab* slab = op->wake_up_slab_head;
+  uns           idx;
 
   ASSERT(op->proc_id,
          (op->engine_info.l1_miss && !op->engine_info.l1_miss_satisfied) ||
            op->engine_info.dep_on_l1_miss);
 
-  for(temp = op->wake_up_head; temp; temp = temp->next) {
-    Op*     dep_op         = temp->op;
-    Counter dep_unique_num = temp->unique_num;
+  for(idx = 0; idx < op->wake_up_count; idx++) {
+    Wake_Up_Entry* temp           = get_wake_up_entry(op, idx, &slab);
+    Op*            dep_op         = temp->op;
+    Counter        dep_unique_num = temp->unique_num;
 
 
     if(dep_op->unique_num == dep_unique_num && dep_op->op_pool_valid) {
@@ -5142,7 +5446,8 @@ static void mark_l1_miss_deps(Op* op) {
  * l1_miss_dep */
 
 static void unmark_l1_miss_deps(Op* op) {
-  Wake_Up_Entry* temp;
+  Wake_Up_Slab* slab = op->wake_up_slab_head;
+  uns           idx;
 
   ASSERT(op->proc_id, op->engine_info.l1_miss_satisfied ||
                         (!op->engine_info.dep_on_l1_miss &&
@@ -5150,9 +5455,10 @@ static void unmark_l1_miss_deps(Op* op) {
 
   /* Go thru the wake up list and unmark ops if they are not dependent on
    * another l1 miss */
-  for(temp = op->wake_up_head; temp; temp = temp->next) {
-    Op*     dep_op         = temp->op;
-    Counter dep_unique_num = temp->unique_num;
+  for(idx = 0; idx < op->wake_up_count; idx++) {
+    Wake_Up_Entry* temp           = get_wake_up_entry(op, idx, &slab);
+    Op*            dep_op         = temp->op;
+    Counter        dep_unique_num = temp->unique_num;
 
     if(dep_op->unique_num == dep_unique_num && dep_op->op_pool_valid) {
       int      ii;
@@ -5207,8 +5513,14 @@ L1_Data* l1_pref_cache_access(Mem_Req* req) {
     return pref_data;
 
   if(pref_data) {
+    /* if a compressed L1 cannot make room, the line stays in the pref cache */
+    if(L1_COMPRESS &&
+       !l1_compress_make_room(req->proc_id, req->addr, FALSE))
+      return pref_data;
     data = cache_insert(&L1(req->proc_id)->cache, req->proc_id, req->addr,
                         &line_addr, &repl_line_addr);
+    if(L1_COMPRESS)
+      compress_fill(req->proc_id, req->addr);
     STAT_EVENT(req->proc_id, L1_DATA_EVICT);
     STAT_EVENT(req->proc_id, L1_PREF_MOVE_L1);
     if(data) {
@@ -5268,6 +5580,8 @@ int mem_get_req_count(uns proc_id) {
 /**************************************************************************************/
 /* stats_per_core_collect */
 void stats_per_core_collect(uns8 proc_id) {
+  mem_qos_core_done(proc_id);
+
   Counter pref_fill             = GET_STAT_EVENT(proc_id, CORE_L1_PREF_FILL);
   Counter pref_fill_patial_used = GET_STAT_EVENT(
     proc_id, CORE_L1_PREF_FILL_PARTIAL_USED);
@@ -5289,6 +5603,8 @@ void stats_per_core_collect(uns8 proc_id) {
 /* mem_done */
 void finalize_memory() {
   perf_pred_done();
+  mem_lat_dump();
+  mem_qos_dump();
 }
 
 /***************************************************************************************/
@@ -5510,6 +5826,7 @@ static void update_mem_req_occupancy_counter(Mem_Req_Type type, int delta) {
     case MRT_IFETCH:
     case MRT_DFETCH:
     case MRT_DSTORE:
+    case MRT_PTWALK:
       counter = &mem_req_demand_entries;
       break;
     case MRT_IPRF:
@@ -5521,6 +5838,7 @@ static void update_mem_req_occupancy_counter(Mem_Req_Type type, int delta) {
       break;
     case MRT_WB:
     case MRT_WB_NODIRTY:
+    case MRT_COH:
       counter = &mem_req_wb_entries;
       break;
     default:
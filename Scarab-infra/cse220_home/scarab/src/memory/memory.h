@@ -90,6 +90,7 @@ typedef enum Mem_Queue_Type_enum {
   QUEUE_MLC       = 1 << 4,
   QUEUE_MLC_FILL  = 1 << 5,
   QUEUE_CORE_FILL = 1 << 6,
+  QUEUE_COH       = 1 << 7,
 } Mem_Queue_Type;
 
 typedef struct Mem_Queue_Entry_struct {
@@ -159,6 +160,7 @@ typedef struct Memory_struct {
   Mem_Queue  bus_out_queue;
   Mem_Queue  l1fill_queue;
   Mem_Queue* core_fill_queues;
+  Mem_Queue  coh_queue; /* coherence messages in flight */
 
   Counter last_mem_queue_cycle;
 
@@ -224,6 +226,8 @@ void reset_memory(void);
 void recover_memory(void);
 void debug_memory(void);
 void update_memory(void);
+Counter memory_next_event_time(void);
+void    memory_skip_cycles(Counter l1_cycles, Counter memory_cycles);
 
 Flag     scan_stores(Addr, uns);
 void     op_nuke_mem_req(Op*);
@@ -244,8 +248,14 @@ void print_mem_queue(Mem_Queue_Type queue_type);
 Flag new_mem_dc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size,
                        uns delay, Op* op, Flag done_func(Mem_Req*),
                        Counter unique_num, Flag used_onpath);
+Flag new_mem_mlc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size,
+                        uns delay, Op* op, Flag done_func(Mem_Req*),
+                        Counter unique_num);
+Flag new_mem_coh_req(uns8 proc_id, Addr addr, uns delay,
+                     Flag done_func(Mem_Req*));
 Flag mlc_fill_line(Mem_Req* req);
 Flag l1_fill_line(Mem_Req* req);
+Flag l1_compress_make_room(uns8 proc_id, Addr addr, Flag warmup);
 
 void mark_ops_as_l1_miss_satisfied(Mem_Req* req);
 int  mem_get_req_count(uns proc_id);
@@ -0,0 +1,211 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/nuca.c
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Sliced (NUCA) shared L1 with a ring or mesh on-chip network.
+ *
+ * Each L1 bank is a slice sitting on one network stop. Lines are assigned to
+ * slices by a hash of the line address. Core c is attached to stop
+ * c % num_slices, so with one slice per core each core has a local slice.
+ *
+ * A request crosses the network from its core to the slice before it
+ * arbitrates for the slice's port. Unless it is a writeback, its data crosses
+ * back when it is ready: when the L1 hit completes, or when the fill from
+ * memory is written into the slice. Every hop costs NUCA_HOP_CYCLES and every
+ * directed link carries one flit per cycle: a message of n flits holds the
+ * link for n cycles, and later messages wait for it (a simple reservation
+ * model with no buffering limits). Requests are one flit and data messages
+ * are L1_LINE_SIZE / NUCA_LINK_BYTES flits.
+ ***************************************************************************************/
+
+#include "debug/debug_macros.h"
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+#include "debug/debug.param.h"
+#include "memory/mem_req.h"
+#include "memory/memory.param.h"
+#include "memory/nuca.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_NUCA, ##args)
+
+/* directed links per stop: ring uses 0 (clockwise) and 1, mesh uses
+   0 (east), 1 (west), 2 (north), 3 (south) */
+#define NUCA_LINKS_PER_STOP 4
+
+/* per-slice stats are kept for this many slices */
+#define NUCA_MAX_SLICES 16
+
+/**************************************************************************************/
+/* Global Variables */
+
+DEFINE_ENUM(Nuca_Topology, NUCA_TOPOLOGY_LIST);
+
+static uns      nuca_num_slices;
+static uns      nuca_mesh_width;
+static Counter* nuca_link_free;  // first cycle each directed link is free
+
+/**************************************************************************************/
+/* init_nuca */
+
+void init_nuca(uns num_slices) {
+  if(!NUCA_ON)
+    return;
+  ASSERTM(0, !PRIVATE_L1, "NUCA_ON models a shared L1\n");
+  ASSERTM(0, num_slices == (1 << LOG2(num_slices)),
+          "L1_BANKS must be a power of two\n");
+  ASSERTM(0, num_slices <= NUCA_MAX_SLICES, "At most %d NUCA slices\n",
+          NUCA_MAX_SLICES);
+  ASSERT(0, NUCA_LINK_BYTES > 0);
+  nuca_num_slices = num_slices;
+  nuca_mesh_width = 1 << ((LOG2(num_slices) + 1) / 2);  // w x n/w grid
+  nuca_link_free = (Counter*)calloc(num_slices * NUCA_LINKS_PER_STOP,
+                                    sizeof(Counter));
+}
+
+/**************************************************************************************/
+/* nuca_slice: xor-fold the line address so that strided streams spread over
+   the slices */
+
+uns nuca_slice(Addr addr) {
+  Addr line = addr >> LOG2(L1_LINE_SIZE);
+  uns  bits = LOG2(nuca_num_slices);
+  Addr hash = 0;
+  if(!bits)
+    return 0;
+  for(; line; line >>= bits)
+    hash ^= line;
+  return hash & N_BIT_MASK(bits);
+}
+
+/**************************************************************************************/
+/* nuca_next_hop: next stop and outgoing link from stop towards dest */
+
+static uns nuca_next_hop(uns stop, uns dest, uns* link) {
+  if(NUCA_TOPOLOGY == NUCA_TOPOLOGY_RING) {
+    uns cw = (dest + nuca_num_slices - stop) % nuca_num_slices;
+    if(cw <= nuca_num_slices - cw) {
+      *link = stop * NUCA_LINKS_PER_STOP + 0;
+      return (stop + 1) % nuca_num_slices;
+    }
+    *link = stop * NUCA_LINKS_PER_STOP + 1;
+    return (stop + nuca_num_slices - 1) % nuca_num_slices;
+  }
+
+  // mesh with XY routing
+  uns x = stop % nuca_mesh_width, y = stop / nuca_mesh_width;
+  uns dx = dest % nuca_mesh_width, dy = dest / nuca_mesh_width;
+  if(x != dx) {
+    *link = stop * NUCA_LINKS_PER_STOP + (x < dx ? 0 : 1);
+    return x < dx ? stop + 1 : stop - 1;
+  }
+  *link = stop * NUCA_LINKS_PER_STOP + (y < dy ? 3 : 2);
+  return y < dy ? stop + nuca_mesh_width : stop - nuca_mesh_width;
+}
+
+/**************************************************************************************/
+/* nuca_traverse: send a message of flits from src to dest starting at cycle
+   start; returns the arrival cycle */
+
+static Counter nuca_traverse(uns proc_id, uns src, uns dest, uns flits,
+                             Counter start) {
+  Counter t    = start;
+  uns     hops = 0;
+  for(uns stop = src; stop != dest; hops++) {
+    uns link;
+    uns next = nuca_next_hop(stop, dest, &link);
+    if(nuca_link_free[link] > t) {
+      INC_STAT_EVENT(proc_id, NUCA_LINK_STALL_CYCLES,
+                     nuca_link_free[link] - t);
+      t = nuca_link_free[link];
+    }
+    nuca_link_free[link] = t + flits;
+    t += NUCA_HOP_CYCLES;
+    stop = next;
+  }
+  STAT_EVENT(proc_id, NUCA_HOPS_0 + MIN2(hops, 8));
+  return t;
+}
+
+/**************************************************************************************/
+/* nuca_send_req: writebacks carry their data to the slice, other requests
+   are one flit */
+
+Counter nuca_send_req(Mem_Req* req) {
+  Flag wb         = req->type == MRT_WB || req->type == MRT_WB_NODIRTY;
+  uns  data_flits = MAX2(L1_LINE_SIZE / NUCA_LINK_BYTES, 1);
+  uns  core_stop  = req->proc_id % nuca_num_slices;
+
+  ASSERT(req->proc_id, !req->nuca_sent);
+  req->nuca_sent         = TRUE;
+  req->nuca_send_cycle   = cycle_count;
+  req->nuca_arrive_cycle = nuca_traverse(req->proc_id, core_stop, req->l1_bank,
+                                         wb ? data_flits : 1, cycle_count);
+
+  uns net_cycles = req->nuca_arrive_cycle - cycle_count;
+  STAT_EVENT(req->proc_id, NUCA_ACCESS);
+  STAT_EVENT(req->proc_id, NUCA_SLICE_REQS_0 + req->l1_bank);
+  INC_STAT_EVENT(req->proc_id, NUCA_NET_CYCLES, net_cycles);
+  DEBUG(req->proc_id, "req %llx to slice %d: %d network cycles\n", req->addr,
+        req->l1_bank, net_cycles);
+  return req->nuca_arrive_cycle;
+}
+
+/**************************************************************************************/
+/* nuca_slice_grant: */
+
+void nuca_slice_grant(Mem_Req* req) {
+  ASSERT(req->proc_id, req->nuca_sent && cycle_count >= req->nuca_arrive_cycle);
+  INC_STAT_EVENT(req->proc_id, NUCA_SLICE_QUEUE_CYCLES_0 + req->l1_bank,
+                 cycle_count - req->nuca_arrive_cycle);
+}
+
+/**************************************************************************************/
+/* nuca_send_resp: */
+
+uns nuca_send_resp(Mem_Req* req) {
+  uns data_flits = MAX2(L1_LINE_SIZE / NUCA_LINK_BYTES, 1);
+  uns core_stop  = req->proc_id % nuca_num_slices;
+
+  ASSERT(req->proc_id, req->nuca_sent);
+  Counter t = nuca_traverse(req->proc_id, req->l1_bank, core_stop, data_flits,
+                            cycle_count);
+
+  uns net_cycles = t - cycle_count;
+  INC_STAT_EVENT(req->proc_id, NUCA_NET_CYCLES, net_cycles);
+  STAT_EVENT(req->proc_id, NUCA_SLICE_RESPS_0 + req->l1_bank);
+  INC_STAT_EVENT(req->proc_id, NUCA_SLICE_LATENCY_0 + req->l1_bank,
+                 t - req->nuca_send_cycle);
+  DEBUG(req->proc_id, "req %llx data from slice %d: %d network cycles\n",
+        req->addr, req->l1_bank, net_cycles);
+  return net_cycles;
+}
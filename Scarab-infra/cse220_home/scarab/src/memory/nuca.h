@@ -0,0 +1,66 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/nuca.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Sliced (NUCA) shared L1 with a ring or mesh on-chip network.
+ ***************************************************************************************/
+
+#ifndef __NUCA_H__
+#define __NUCA_H__
+
+#include "globals/enum.h"
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Forward Declarations */
+
+struct Mem_Req_struct;
+
+/**************************************************************************************/
+/* Types */
+
+#define NUCA_TOPOLOGY_LIST(elem) elem(RING) elem(MESH)
+
+DECLARE_ENUM(Nuca_Topology, NUCA_TOPOLOGY_LIST, NUCA_TOPOLOGY_);
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Initialize (no-op unless NUCA_ON) */
+void init_nuca(uns num_slices);
+
+/* Address-hashed slice of a line */
+uns nuca_slice(Addr addr);
+
+/* Send a request from its core to its slice now; returns the arrival cycle */
+Counter nuca_send_req(struct Mem_Req_struct* req);
+
+/* The request won a port at its slice (queueing stats) */
+void nuca_slice_grant(struct Mem_Req_struct* req);
+
+/* Send a request's data from its slice back to its core now; returns the
+   network cycles */
+uns nuca_send_resp(struct Mem_Req_struct* req);
+
+#endif /* #ifndef __NUCA_H__ */
@@ -0,0 +1,369 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/tlb.c
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Per-core ITLB/DTLB/STLB hierarchy with a page walk cache and a
+ *                radix page table walker that reads PTEs through the memory
+ *                system.
+ *
+ * All pages are TLB_PAGE_SIZE bytes (4K, 2M or 1G), which sets the walk depth
+ * to 4, 3 or 2 levels of a 9-bit-per-level x86-64 style radix table. Page sizes
+ * cannot be mixed: TLB entries carry no page size and there are no separate
+ * 2M/1G arrays. There is
+ * no OS, so the page tables live in a reserved region of each core's address
+ * space: the entry for (level, va) sits at a fixed address derived from the va
+ * bits above that level, so walks of neighbouring pages share PTE lines the same
+ * way they would with a real page table.
+ *
+ * The L1 TLBs and the STLB are looked up with the page number (line size 1) so
+ * that 1G pages do not overflow the cache_lib size. The page walk cache holds
+ * non-leaf entries keyed by their PTE address.
+ *
+ * PTE reads are MRT_PTWALK requests, so they are cached in the L1/MLC like
+ * any data line but are counted apart from the demand hit and miss stats.
+ * Off-path accesses may use the TLBs and the STLB but never start a walk; they
+ * wait until they are flushed or an on-path access starts the walk. Walks
+ * only finish through the memory system, so the TLBs need MODEL_MEM.
+ ***************************************************************************************/
+
+#include "debug/debug_macros.h"
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+#include "debug/debug.param.h"
+#include "libs/cache_lib.h"
+#include "memory/mem_req.h"
+#include "memory/memory.h"
+#include "memory/memory.param.h"
+#include "memory/tlb.h"
+#include "model.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_TLB, ##args)
+
+#define TLB_PT_LEVELS 4
+#define TLB_PT_LEVEL_BITS 9
+#define TLB_PTE_SIZE 8
+/* base of the synthetic page table region; level l tables start at base + l *
+   2^40, which leaves room for the 2^27 leaf tables of a 48-bit va space */
+#define TLB_PT_BASE_ADDR 0x500000000000ULL
+
+/**************************************************************************************/
+/* Types */
+
+/* One outstanding translation: either an STLB hit waiting out the STLB latency
+   or a page walk. The L1 TLBs that asked for it are filled on completion. */
+typedef struct Tlb_Miss_struct {
+  Flag    valid;
+  Addr    page;        // page number (proc_id bits included)
+  Addr    addr;        // an address in the page, used for the walk
+  Flag    fill_itlb;
+  Flag    fill_dtlb;
+  Flag    walk;        // TRUE if the STLB missed
+  uns     level;       // next page table level to read
+  Flag    waiting;     // PTE request in flight
+  Addr    pte_line_addr;
+  Counter issue_cycle;  // earliest cycle to send the next PTE request
+  Counter rdy_cycle;    // MAX_CTR while walking
+  Counter start_cycle;
+} Tlb_Miss;
+
+typedef struct Tlb_struct {
+  Cache     itlb;
+  Cache     dtlb;
+  Cache     stlb;
+  Cache     pwc;
+  Tlb_Miss* misses;
+  uns       num_walks;
+} Tlb;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Tlb* tlbs;
+static uns  page_shift;
+static uns  leaf_level;
+
+/**************************************************************************************/
+/* Static Prototypes */
+
+static inline Addr tlb_pte_addr(uns proc_id, Addr addr, uns level);
+static void        tlb_fill(uns proc_id, Tlb_Miss* miss);
+
+/**************************************************************************************/
+/* init_tlb */
+
+void init_tlb(void) {
+  if(!TLB_ENABLE)
+    return;
+
+  page_shift = LOG2(TLB_PAGE_SIZE);
+  ASSERTM(0,
+          TLB_PAGE_SIZE == (1 << page_shift) && page_shift >= 12 &&
+            (page_shift - 12) % TLB_PT_LEVEL_BITS == 0 &&
+            (page_shift - 12) / TLB_PT_LEVEL_BITS < TLB_PT_LEVELS - 1,
+          "TLB_PAGE_SIZE must be 4K, 2M or 1G\n");
+  leaf_level = TLB_PT_LEVELS - 1 - (page_shift - 12) / TLB_PT_LEVEL_BITS;
+  ASSERT(0, TLB_MISS_ENTRIES > 0 && TLB_PAGE_WALKERS > 0);
+  ASSERTM(0, model->mem == MODEL_MEM,
+          "TLB_ENABLE needs MODEL_MEM to read page table entries\n");
+
+  tlbs = (Tlb*)calloc(NUM_CORES, sizeof(Tlb));
+  for(uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Tlb* tlb = &tlbs[proc_id];
+    init_cache(&tlb->itlb, "ITLB", ITLB_ENTRIES, ITLB_ASSOC, 1, sizeof(Flag),
+               REPL_TRUE_LRU);
+    init_cache(&tlb->dtlb, "DTLB", DTLB_ENTRIES, DTLB_ASSOC, 1, sizeof(Flag),
+               REPL_TRUE_LRU);
+    init_cache(&tlb->stlb, "STLB", STLB_ENTRIES, STLB_ASSOC, 1, sizeof(Flag),
+               REPL_TRUE_LRU);
+    init_cache(&tlb->pwc, "PWC", PWC_ENTRIES * TLB_PTE_SIZE, PWC_ASSOC,
+               TLB_PTE_SIZE, sizeof(Flag), REPL_TRUE_LRU);
+    tlb->misses = (Tlb_Miss*)calloc(TLB_MISS_ENTRIES, sizeof(Tlb_Miss));
+  }
+}
+
+/**************************************************************************************/
+/* tlb_pte_addr: address of the page table entry read at level for addr */
+
+static inline Addr tlb_pte_addr(uns proc_id, Addr addr, uns level) {
+  uns  shift = 12 + TLB_PT_LEVEL_BITS * (TLB_PT_LEVELS - 1 - level);
+  Addr va    = addr & N_BIT_MASK(NUM_ADDR_NON_SIGN_EXTEND_BITS);
+  Addr table = va >> (shift + TLB_PT_LEVEL_BITS);
+  Addr index = (va >> shift) & N_BIT_MASK(TLB_PT_LEVEL_BITS);
+  Addr pte   = TLB_PT_BASE_ADDR + ((Addr)level << 40) +
+             (table << 12) + index * TLB_PTE_SIZE;
+  return convert_to_cmp_addr(proc_id, pte);
+}
+
+/**************************************************************************************/
+/* tlb_translate: */
+
+Flag tlb_translate(uns proc_id, Addr addr, Flag ifetch, Flag off_path) {
+  Tlb*  tlb  = &tlbs[proc_id];
+  Addr  page = addr >> page_shift;
+  Addr  dummy_addr;
+  Cache* l1_tlb = ifetch ? &tlb->itlb : &tlb->dtlb;
+
+  if(cache_access(l1_tlb, page, &dummy_addr, TRUE)) {
+    STAT_EVENT(proc_id, ifetch ? ITLB_HIT : DTLB_HIT);
+    return TRUE;
+  }
+
+  Tlb_Miss* free_miss = NULL;
+  for(uns ii = 0; ii < TLB_MISS_ENTRIES; ii++) {
+    Tlb_Miss* miss = &tlb->misses[ii];
+    if(!miss->valid) {
+      if(!free_miss)
+        free_miss = miss;
+    } else if(miss->page == page) {
+      // already being translated
+      miss->fill_itlb |= ifetch;
+      miss->fill_dtlb |= !ifetch;
+      STAT_EVENT(proc_id, ifetch ? ITLB_MISS_PENDING : DTLB_MISS_PENDING);
+      return FALSE;
+    }
+  }
+
+  if(!free_miss) {
+    STAT_EVENT(proc_id, TLB_MISS_ENTRIES_FULL);
+    return FALSE;
+  }
+
+  Flag stlb_hit = cache_access(&tlb->stlb, page, &dummy_addr, TRUE) != NULL;
+  if(!stlb_hit && off_path) {
+    STAT_EVENT(proc_id, PAGE_WALK_OFFPATH_SKIPPED);
+    return FALSE;
+  }
+  if(!stlb_hit && tlb->num_walks == TLB_PAGE_WALKERS) {
+    STAT_EVENT(proc_id, TLB_WALKERS_FULL);
+    return FALSE;
+  }
+
+  STAT_EVENT(proc_id, ifetch ? ITLB_MISS : DTLB_MISS);
+  STAT_EVENT(proc_id, stlb_hit ? STLB_HIT : STLB_MISS);
+
+  memset(free_miss, 0, sizeof(Tlb_Miss));
+  free_miss->valid       = TRUE;
+  free_miss->page        = page;
+  free_miss->addr        = addr;
+  free_miss->fill_itlb   = ifetch;
+  free_miss->fill_dtlb   = !ifetch;
+  free_miss->start_cycle = cycle_count;
+
+  if(stlb_hit) {
+    free_miss->rdy_cycle = cycle_count + STLB_CYCLES;
+  } else {
+    // skip the upper levels whose entries are in the page walk cache
+    uns level = 0;
+    for(int ll = leaf_level - 1; ll >= 0; ll--) {
+      if(cache_access(&tlb->pwc, tlb_pte_addr(proc_id, addr, ll), &dummy_addr,
+                      TRUE)) {
+        level = ll + 1;
+        break;
+      }
+    }
+    STAT_EVENT(proc_id, level ? PWC_HIT : PWC_MISS);
+    free_miss->walk        = TRUE;
+    free_miss->level       = level;
+    free_miss->issue_cycle = cycle_count + STLB_CYCLES;
+    free_miss->rdy_cycle   = MAX_CTR;
+    tlb->num_walks++;
+  }
+
+  DEBUG(proc_id, "%s miss for %llx, stlb_hit:%d\n", ifetch ? "ITLB" : "DTLB",
+        addr, stlb_hit);
+  return FALSE;
+}
+
+/**************************************************************************************/
+/* tlb_warmup: */
+
+void tlb_warmup(uns proc_id, Addr addr, Flag ifetch) {
+  Tlb*  tlb  = &tlbs[proc_id];
+  Addr  page = addr >> page_shift;
+  Addr  dummy_addr;
+  Addr  repl_addr;
+  Cache* l1_tlb = ifetch ? &tlb->itlb : &tlb->dtlb;
+
+  if(cache_access(l1_tlb, page, &dummy_addr, TRUE))
+    return;
+  cache_insert(l1_tlb, proc_id, page, &dummy_addr, &repl_addr);
+  if(cache_access(&tlb->stlb, page, &dummy_addr, TRUE))
+    return;
+  cache_insert(&tlb->stlb, proc_id, page, &dummy_addr, &repl_addr);
+  for(uns ll = 0; ll < leaf_level; ll++) {
+    Addr pte = tlb_pte_addr(proc_id, addr, ll);
+    if(!cache_access(&tlb->pwc, pte, &dummy_addr, TRUE))
+      cache_insert(&tlb->pwc, proc_id, pte, &dummy_addr, &repl_addr);
+  }
+}
+
+/**************************************************************************************/
+/* tlb_fill: install a finished translation */
+
+static void tlb_fill(uns proc_id, Tlb_Miss* miss) {
+  Tlb* tlb = &tlbs[proc_id];
+  Addr dummy_addr;
+  Addr repl_addr;
+
+  if(miss->walk) {
+    cache_insert(&tlb->stlb, proc_id, miss->page, &dummy_addr, &repl_addr);
+    ASSERT(proc_id, tlb->num_walks > 0);
+    tlb->num_walks--;
+    INC_STAT_EVENT(proc_id, PAGE_WALK_CYCLES, cycle_count - miss->start_cycle);
+  }
+  if(miss->fill_itlb)
+    cache_insert(&tlb->itlb, proc_id, miss->page, &dummy_addr, &repl_addr);
+  if(miss->fill_dtlb)
+    cache_insert(&tlb->dtlb, proc_id, miss->page, &dummy_addr, &repl_addr);
+  miss->valid = FALSE;
+}
+
+/**************************************************************************************/
+/* update_tlb: send the next PTE read of each walk and retire finished misses */
+
+void update_tlb(uns proc_id) {
+  if(!TLB_ENABLE)
+    return;
+
+  Tlb* tlb = &tlbs[proc_id];
+  for(uns ii = 0; ii < TLB_MISS_ENTRIES; ii++) {
+    Tlb_Miss* miss = &tlb->misses[ii];
+    if(!miss->valid)
+      continue;
+
+    if(miss->walk && !miss->waiting && miss->rdy_cycle == MAX_CTR &&
+       cycle_count >= miss->issue_cycle) {
+      Addr pte = tlb_pte_addr(proc_id, miss->addr, miss->level);
+      Addr line_addr = pte & ~(Addr)(DCACHE_LINE_SIZE - 1);
+      if(new_mem_req(MRT_PTWALK, proc_id, line_addr, DCACHE_LINE_SIZE, 0, NULL,
+                     tlb_walk_fill, unique_count, 0)) {
+        miss->waiting       = TRUE;
+        miss->pte_line_addr = line_addr;
+        STAT_EVENT(proc_id, PAGE_WALK_MEM_REQ);
+        DEBUG(proc_id, "walk of %llx reads level %d pte %llx\n", miss->addr,
+              miss->level, pte);
+      }
+    }
+
+    if(cycle_count >= miss->rdy_cycle)
+      tlb_fill(proc_id, miss);
+  }
+}
+
+/**************************************************************************************/
+/* tlb_next_cycle: */
+
+Counter tlb_next_cycle(uns proc_id) {
+  Counter next = MAX_CTR;
+  if(!TLB_ENABLE)
+    return next;
+
+  Tlb* tlb = &tlbs[proc_id];
+  for(uns ii = 0; ii < TLB_MISS_ENTRIES; ii++) {
+    Tlb_Miss* miss = &tlb->misses[ii];
+    if(!miss->valid)
+      continue;
+
+    if(miss->walk && !miss->waiting && miss->rdy_cycle == MAX_CTR)
+      next = MIN2(next, MAX2(miss->issue_cycle, cycle_count + 1));
+    if(miss->rdy_cycle != MAX_CTR)
+      next = MIN2(next, MAX2(miss->rdy_cycle, cycle_count + 1));
+  }
+  return next;
+}
+
+/**************************************************************************************/
+/* tlb_walk_fill: a PTE line arrived; advance every walk waiting on it */
+
+Flag tlb_walk_fill(Mem_Req* req) {
+  Tlb* tlb = &tlbs[req->proc_id];
+  Addr dummy_addr;
+  Addr repl_addr;
+
+  for(uns ii = 0; ii < TLB_MISS_ENTRIES; ii++) {
+    Tlb_Miss* miss = &tlb->misses[ii];
+    if(!miss->valid || !miss->waiting || miss->pte_line_addr != req->addr)
+      continue;
+    miss->waiting = FALSE;
+    if(miss->level == leaf_level) {
+      miss->rdy_cycle = cycle_count;
+    } else {
+      Addr pte = tlb_pte_addr(req->proc_id, miss->addr, miss->level);
+      if(!cache_access(&tlb->pwc, pte, &dummy_addr, FALSE))
+        cache_insert(&tlb->pwc, req->proc_id, pte, &dummy_addr, &repl_addr);
+      miss->level++;
+      miss->issue_cycle = cycle_count;
+    }
+  }
+  return TRUE;
+}
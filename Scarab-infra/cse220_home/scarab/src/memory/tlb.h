@@ -0,0 +1,65 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : memory/tlb.h
+ * Author       : HPS Research Group
+ * Date         : 10/18/2026
+ * Description  : Per-core ITLB/DTLB/STLB hierarchy with a page walk cache and a
+ *                radix page table walker that reads PTEs through the memory
+ *                system.
+ ***************************************************************************************/
+
+#ifndef __TLB_H__
+#define __TLB_H__
+
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Forward Declarations */
+
+struct Mem_Req_struct;
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Initialize (no-op unless TLB_ENABLE) */
+void init_tlb(void);
+
+/* Translate addr for proc_id. Returns TRUE if the translation is available this
+   cycle; otherwise a miss is started (or merged) and the caller retries.
+   Off-path accesses do not start page walks. */
+Flag tlb_translate(uns proc_id, Addr addr, Flag ifetch, Flag off_path);
+
+/* Install the translation for addr without timing (warmup mode) */
+void tlb_warmup(uns proc_id, Addr addr, Flag ifetch);
+
+/* Call every core cycle */
+void update_tlb(uns proc_id);
+
+/* The next core cycle after cycle_count on which update_tlb has something to
+   do, absent new misses and page walk fills (MAX_CTR if none) */
+Counter tlb_next_cycle(uns proc_id);
+
+/* done_func for page table walk requests */
+Flag tlb_walk_fill(struct Mem_Req_struct* req);
+
+#endif /* #ifndef __TLB_H__ */
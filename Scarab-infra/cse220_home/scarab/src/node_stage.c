@@ -41,6 +41,7 @@
 #include "bp/bp.h"
 #include "exec_ports.h"
 #include "frontend/frontend.h"
+#include "lsq.h"
 #include "memory/memory.h"
 #include "node_stage.h"
 #include "thread.h"
@@ -77,6 +78,7 @@ Rob_Block_Issue_Reason rob_block_issue_reason = ROB_BLOCK_ISSUE_NONE;
 /* Prototypes */
 
 void debug_print_retired_uop(Op* op);
+void node_rdy_remove(Op* op);
 void flush_ready_list(void);
 void flush_scheduling_buffer(void);
 void flush_rs(void);
@@ -89,6 +91,7 @@ Flag is_node_table_empty(void);
 void collect_not_ready_to_retire_stats(Op* op);
 Flag is_node_table_full(void);
 void collect_node_table_full_stats(Op* op);
+static inline void node_issue_op(Op* op);
 
 /**************************************************************************************/
 /* set_node_stage:*/
@@ -111,6 +114,11 @@ void init_node_stage(uns8 proc_id, const char* name) {
   node->sd.max_op_count = NUM_FUS;  // Bandwidth between schedule and FUS
   node->sd.ops          = (Op**)malloc(sizeof(Op*) * node->sd.max_op_count);
 
+  // ready bitmap, one slot per node table entry
+  node->rdy_bits = (uns64*)calloc((NODE_TABLE_OPS + 63) / 64, sizeof(uns64));
+  node->rdy_ops  = (Op**)calloc(NODE_TABLE_OPS, sizeof(Op*));
+  node->node_ops = (Op**)calloc(NODE_TABLE_OPS, sizeof(Op*));
+
   reset_node_stage();
 }
 
@@ -125,10 +133,14 @@ void reset_node_stage() {
 
   node->node_head       = NULL;
   node->node_tail       = NULL;
-  node->rdy_head        = NULL;
   node->next_op_into_rs = NULL;
+  node->rdy_count       = 0;
+  memset(node->rdy_bits, 0, sizeof(uns64) * ((NODE_TABLE_OPS + 63) / 64));
+  memset(node->node_ops, 0, sizeof(Op*) * NODE_TABLE_OPS);
+  reset_lsq(node->proc_id);
 
   node->node_count           = 0;
+  node->fused_count          = 0;
   node->ret_op               = 1;
   node->last_scheduled_opnum = 0;
   node->mem_blocked          = FALSE;
@@ -147,11 +159,14 @@ void reset_all_ops_node_stage() {
 
   node->node_head       = NULL;
   node->node_tail       = NULL;
-  node->rdy_head        = NULL;
   node->next_op_into_rs = NULL;
+  node->rdy_count       = 0;
+  memset(node->rdy_bits, 0, sizeof(uns64) * ((NODE_TABLE_OPS + 63) / 64));
+  memset(node->node_ops, 0, sizeof(Op*) * NODE_TABLE_OPS);
+  reset_lsq(node->proc_id);
 
   node->node_count       = 0;
-  node->node_count       = 0;
+  node->fused_count      = 0;
   node->mem_blocked      = FALSE;
   node->ret_stall_length = 0;
 }
@@ -170,6 +185,7 @@ void recover_node_stage() {
   flush_ready_list();
   flush_scheduling_buffer();
   flush_rs();
+  recover_lsq(node->proc_id);
   flush_window();
 
   // recover last_scheduled_opnum
@@ -181,17 +197,95 @@ void recover_node_stage() {
     debug_node_stage();
 }
 
+/**************************************************************************************/
+/* Ready bitmap:
+ *      Ready ops are kept in a bitmap indexed by node table slot (op_num modulo
+ * NODE_TABLE_OPS). The ops in the node table have consecutive op_nums, so
+ * every ready op owns a distinct slot and walking the bitmap from the slot of
+ * the node table head visits the ready ops oldest first. Insertion and
+ * removal are O(1) and no sorting is needed. */
+
+
+void node_rdy_insert(Op* op) {
+  uns slot = NODE_SLOT(op->op_num);
+  ASSERT(node->proc_id, !op->in_rdy_list);
+  ASSERT(node->proc_id, node->node_head &&
+                          op->op_num >= node->node_head->op_num &&
+                          op->op_num - node->node_head->op_num <
+                            NODE_TABLE_OPS);
+  ASSERTM(node->proc_id, !(node->rdy_bits[slot / 64] & (1ULL << (slot % 64))),
+          "ready slot %u already taken by op_num %llu\n", slot,
+          node->rdy_ops[slot]->op_num);
+  node->rdy_bits[slot / 64] |= 1ULL << (slot % 64);
+  node->rdy_ops[slot] = op;
+  node->rdy_count++;
+  op->in_rdy_list = TRUE;
+}
+
+void node_rdy_remove(Op* op) {
+  uns slot = NODE_SLOT(op->op_num);
+  ASSERT(node->proc_id, op->in_rdy_list && node->rdy_ops[slot] == op);
+  ASSERT(node->proc_id, node->rdy_count > 0);
+  node->rdy_bits[slot / 64] &= ~(1ULL << (slot % 64));
+  node->rdy_count--;
+  op->in_rdy_list = FALSE;
+}
+
+/* rdy_find: first set slot in [from, to), or to if there is none */
+static inline uns rdy_find(uns from, uns to) {
+  while(from < to) {
+    uns64 word = node->rdy_bits[from / 64] >> (from % 64);
+    if(word) {
+      uns slot = from + __builtin_ctzll(word);
+      return MIN2(slot, to);
+    }
+    from = (from / 64 + 1) * 64;
+  }
+  return to;
+}
+
+/* rdy_scan: oldest ready op at least 'age' ops younger than the node table
+ * head, or NULL */
+static Op* rdy_scan(Counter age) {
+  uns base, start, slot;
+  if(!node->rdy_count || age >= NODE_TABLE_OPS)
+    return NULL;
+  base  = NODE_SLOT(node->node_head->op_num);
+  start = base + (uns)age;
+  if(start < NODE_TABLE_OPS) {
+    slot = rdy_find(start, NODE_TABLE_OPS);
+    if(slot < NODE_TABLE_OPS)
+      return node->rdy_ops[slot];
+    start = NODE_TABLE_OPS;
+  }
+  slot = rdy_find(start - NODE_TABLE_OPS, base);
+  return slot < base ? node->rdy_ops[slot] : NULL;
+}
+
+/* node_rdy_first: oldest ready op */
+Op* node_rdy_first() {
+  return rdy_scan(0);
+}
+
+/* node_rdy_next: next older-to-younger ready op after op. op may already have
+ * been removed from the bitmap. */
+Op* node_rdy_next(Op* op) {
+  return rdy_scan(op->op_num - node->node_head->op_num + 1);
+}
+
 void flush_ready_list() {
-  Op*  op;
-  Op** last;
-  for(op = node->rdy_head, last = &node->rdy_head; op; op = op->next_rdy) {
+  Op*     op;
+  Counter age = 0;
+  // only ops younger than the recovery op can be flushed, start the walk there
+  if(node->rdy_count &&
+     bp_recovery_info->recovery_op_num >= node->node_head->op_num)
+    age = bp_recovery_info->recovery_op_num + 1 - node->node_head->op_num;
+  for(op = rdy_scan(age); op; op = node_rdy_next(op)) {
     ASSERT(node->proc_id, node->proc_id == op->proc_id);
     if(FLUSH_OP(op)) {
       ASSERT(node->proc_id, op->op_num > bp_recovery_info->recovery_op_num);
-      *last           = op->next_rdy;
-      op->in_rdy_list = FALSE;
-    } else
-      last = &op->next_rdy;
+      node_rdy_remove(op);
+    }
   }
 }
 
@@ -224,47 +318,66 @@ void flush_rs() {
 
 void flush_window() {
   Op*  op;
-  Op** last;
+  Op*  keep_tail = NULL;  // youngest op that is kept, NULL if none
   uns  flush_ops = 0;
   uns  keep_ops  = 0;
 
-  node->node_tail = NULL;
-  for(op = node->node_head, last = &node->node_head; op; op = *last) {
-    ASSERT(node->proc_id, node->proc_id == op->proc_id);
+  if(is_node_table_empty())
+    return;
 
-    if(FLUSH_OP(op)) {
-      DEBUG(node->proc_id, "Node flushing  op:%s\n", unsstr64(op->op_num));
-      flush_ops++;
-      ASSERT(node->proc_id, op->op_num > bp_recovery_info->recovery_op_num);
-      op->in_node_list = FALSE;
-      *last            = op->next_node;
-      if(op->state == OS_IN_RS || op->state == OS_READY ||
-         op->state == OS_WAIT_FWD) {
-        ASSERT(op->proc_id, node->rs[op->rs_id].rs_op_count > 0);
-        node->rs[op->rs_id].rs_op_count--;
-      }
-      free_op(op);
-    } else {
-      /* Keep op */
+  /* The node table holds consecutive op_nums, so the flushed ops are exactly
+     the ones after the recovery op. Jump to it through its slot instead of
+     walking the kept part of the window. */
+  if(bp_recovery_info->recovery_op_num >= node->node_head->op_num) {
+    if(bp_recovery_info->recovery_op_num >= node->node_tail->op_num)
+      keep_tail = node->node_tail;
+    else
+      keep_tail = node->node_ops[NODE_SLOT(bp_recovery_info->recovery_op_num)];
+    ASSERT(node->proc_id, keep_tail);
+    ASSERT(node->proc_id,
+           keep_tail->op_num <= bp_recovery_info->recovery_op_num);
+    ASSERT(node->proc_id, !FLUSH_OP(keep_tail));
+    keep_ops = keep_tail->op_num - node->node_head->op_num + 1;
+
+    if(IS_FLUSHING_OP(keep_tail)) {
+      /* Mark that the scheduled recovery has occurred */
+      keep_tail->recovery_scheduled = FALSE;
+    }
+  }
 
-      if(IS_FLUSHING_OP(op)) {
-        /* Mark that the scheduled recovery has occurred */
-        op->recovery_scheduled = FALSE;
-      }
-      DEBUG(node->proc_id, "Node keeping  op:%s node_id:%llu\n",
-            unsstr64(op->op_num), op->node_id);
-      keep_ops++;
-      last            = &op->next_node;
-      node->node_tail = op;
+  for(op = keep_tail ? keep_tail->next_node : node->node_head; op;) {
+    Op* next = op->next_node;
+    ASSERT(node->proc_id, node->proc_id == op->proc_id);
+    ASSERT(node->proc_id, FLUSH_OP(op));
+
+    DEBUG(node->proc_id, "Node flushing  op:%s\n", unsstr64(op->op_num));
+    flush_ops++;
+    if(op->fused)
+      node->fused_count--;
+    op->in_node_list                      = FALSE;
+    node->node_ops[NODE_SLOT(op->op_num)] = NULL;
+    if(op->state == OS_IN_RS || op->state == OS_READY ||
+       op->state == OS_WAIT_FWD) {
+      ASSERT(op->proc_id,
+             node->rs[op->rs_id].rs_op_count >= OP_RS_ENTRIES(op));
+      node->rs[op->rs_id].rs_op_count -= OP_RS_ENTRIES(op);
     }
+    free_op(op);
+    op = next;
   }
 
+  if(keep_tail)
+    keep_tail->next_node = NULL;
+  else
+    node->node_head = NULL;
+  node->node_tail = keep_tail;
+
   ASSERT(node->proc_id, flush_ops + keep_ops == node->node_count);
   node->node_count = keep_ops;
-  ASSERT(node->proc_id, node->node_count <= NODE_TABLE_SIZE);
+  ASSERT(node->proc_id, node->node_count <= NODE_TABLE_OPS);
+  ASSERT(node->proc_id, node->fused_count >= 0);
 }
 
-
 /**************************************************************************************/
 /* debug_node_stage:*/
 
@@ -346,7 +459,7 @@ void debug_print_rs() {
       if(op->rs_id == i && OP_IS_IN_RS(op)) {
         // Op belongs to this RS
         DPRINTF("%lld ", op->op_num);
-        printed++;
+        printed += OP_RS_ENTRIES(op);
         if(printed % 8 == 0)
           DPRINTF("\n");
       }
@@ -365,7 +478,7 @@ void debug_print_ready_list() {
 
   DPRINTF("Ready list:");
 
-  for(op = node->rdy_head; op; op = op->next_rdy) {
+  for(op = node_rdy_first(); op; op = node_rdy_next(op)) {
     DPRINTF(" %s", unsstr64(op->op_num));
   }
 
@@ -437,46 +550,91 @@ void node_issue(Stage_Data* src_sd) {
     if((op->table_info->bar_type & BAR_ISSUE) && (node->node_count > 0))
       break;
 
+    /* stall if the op's load or store queue is full */
+    if(!lsq_can_issue(op)) {
+      rob_block_issue_reason = ROB_BLOCK_ISSUE_FULL;
+      break;
+    }
+
     /* remove op from previous stage */
     src_sd->ops[ii] = NULL;
     src_sd->op_count--;
     ASSERT(node->proc_id, src_sd->op_count >= 0);
 
-    /* set op fields */
-    op->node_id     = node->node_count;
-    op->issue_cycle = cycle_count;
+    node_issue_op(op);
+    on_path |= !op->off_path;
 
-    /* add to node list & update node state*/
-    ASSERT(node->proc_id, !op->in_node_list);
-    if(node->node_tail)
-      node->node_tail->next_node = op;
-    if(node->node_head == NULL)
-      node->node_head = op;
-    op->next_node    = NULL;
-    op->in_node_list = TRUE;
-    node->node_tail  = op;
+    /* the op fused into this one shares its node table entry */
+    if(op->fused_op) {
+      Op* fused_op = op->fused_op;
+      op->fused_op = NULL;
+      ASSERT(node->proc_id, fused_op->fused);
+      node_issue_op(fused_op);
+      node->fused_count++;
+    }
+    ASSERTM(node->proc_id,
+            node->node_count - node->fused_count <= NODE_TABLE_SIZE,
+            "node_count: %d fused_count: %d src_max_op_count: %d "
+            "src_op_count: %d\n",
+            node->node_count, node->fused_count, src_sd->max_op_count,
+            src_sd->op_count);
 
-    STAT_EVENT(node->proc_id, OP_ISSUED);
+    /* always stop issuing after a synchronizing op */
+    if(op->table_info->bar_type & BAR_ISSUE)
+      break;
+  }
+}
 
-    if(!node->next_op_into_rs)    /* if there are no ops waiting to enter RS */
-      node->next_op_into_rs = op; /* this will be the first one */
+/**************************************************************************************/
+/* node_issue_op: allocates one op into the node table */
+
+static inline void node_issue_op(Op* op) {
+  /* set op fields */
+  op->node_id     = node->node_count;
+  op->issue_cycle = cycle_count;
+
+  /* add to node list & update node state*/
+  ASSERT(node->proc_id, !op->in_node_list);
+  ASSERT(node->proc_id, !node->node_ops[NODE_SLOT(op->op_num)]);
+  ASSERT(node->proc_id,
+         !node->node_tail || op->op_num == node->node_tail->op_num + 1);
+  node->node_ops[NODE_SLOT(op->op_num)] = op;
+  if(node->node_tail) {
+    node->node_tail->next_node = op;
+    op->older_cf_op_num = node->node_tail->table_info->cf_type ?
+                            node->node_tail->op_num :
+                            node->node_tail->older_cf_op_num;
+  }
+  if(node->node_head == NULL)
+    node->node_head = op;
+  op->next_node    = NULL;
+  op->in_node_list = TRUE;
+  node->node_tail  = op;
+  lsq_issue(op);
 
-    node->node_count++;
-    ASSERTM(node->proc_id, node->node_count <= NODE_TABLE_SIZE,
-            "node_count: %d src_max_op_count: %d src_op_count: %d\n",
-            node->node_count, src_sd->max_op_count, src_sd->op_count);
+  STAT_EVENT(node->proc_id, OP_ISSUED);
 
-    on_path |= !op->off_path;
+  if(!node->next_op_into_rs)    /* if there are no ops waiting to enter RS */
+    node->next_op_into_rs = op; /* this will be the first one */
 
-    DEBUG(node->proc_id, "Issuing the op op_num:%s off_path:%d\n",
-          unsstr64(op->op_num), op->off_path);
+  node->node_count++;
+  ASSERT(node->proc_id, node->node_count <= NODE_TABLE_OPS);
 
-    op->state = OS_ISSUED;
+  DEBUG(node->proc_id, "Issuing the op op_num:%s off_path:%d fused:%d\n",
+        unsstr64(op->op_num), op->off_path, op->fused);
 
-    /* always stop issuing after a synchronizing op */
-    if(op->table_info->bar_type & BAR_ISSUE)
-      break;
-  }
+  op->state = OS_ISSUED;
+}
+
+/**************************************************************************************/
+/* node_fused_jcc: the Jcc macro-fused with op, or NULL */
+
+Op* node_fused_jcc(Op* op) {
+  Op* jcc = node->node_ops[NODE_SLOT(op->op_num + 1)];
+  if(!jcc || !jcc->in_node_list || jcc->op_num != op->op_num + 1 ||
+     jcc->fused != MACRO_FUSED)
+    return NULL;
+  return jcc;
 }
 
 /**************************************************************************************/
@@ -506,78 +664,6 @@ void check_if_mem_blocked() {
   node->mem_block_length += node->mem_blocked;
 }
 
-/**************************************************************************************/
-/* bubble: bubble pass for the ready list. Part of the bubble sort function
- * below. */
-
-static Flag bubble(Op* head, int n) {
-  Flag swapped     = FALSE;
-  Flag swapped_now = FALSE;
-  int  i;
-  Op*  prev = NULL;
-  Op*  cur  = head;
-  Op*  next = head->next_rdy;
-
-  for(i = 0; i < n - 1; i++) {
-    swapped_now = FALSE;
-    if(cur->op_num > next->op_num) {
-      if(prev)
-        prev->next_rdy = next;
-      cur->next_rdy  = next->next_rdy;
-      next->next_rdy = cur;
-      swapped        = TRUE;
-      swapped_now    = TRUE;
-      if(!prev)
-        node->rdy_head = next;
-    }
-    if(swapped_now) {
-      prev = next;
-      next = cur->next_rdy;
-    } else {
-      prev = cur;
-      cur  = next;
-      next = next->next_rdy;
-    }
-  }
-
-  return swapped;
-}
-
-/**************************************************************************************/
-/* sort_node_ready_list: sorts the ready list */
-
-inline static void sort_node_ready_list() {
-  Op* op;
-  int i;
-  int count_rdy = 0;
-  for(op = node->rdy_head; op; op = op->next_rdy) {
-    count_rdy++;
-  }
-
-  DEBUG(node->proc_id, "Unsorted ready list: count: %d\n", count_rdy);
-  if(DEBUG_NODE_STAGE && DEBUG_RANGE_COND(node->proc_id)) {
-    for(op = node->rdy_head; op; op = op->next_rdy) {
-      DPRINTF("%s ", unsstr64(op->op_num));
-    }
-    DPRINTF("\n");
-  }
-
-  for(i = count_rdy; (i > 1) && bubble(node->rdy_head, i); i--)
-    ;
-
-  count_rdy = 0;
-  for(op = node->rdy_head; op; op = op->next_rdy)
-    count_rdy++;
-
-  DEBUG(node->proc_id, "Sorted ready list: count: %d\n", count_rdy);
-  if(DEBUG_NODE_STAGE && DEBUG_RANGE_COND(node->proc_id)) {
-    for(op = node->rdy_head; op; op = op->next_rdy) {
-      DPRINTF("%s ", unsstr64(op->op_num));
-    }
-    DPRINTF("\n");
-  }
-}
-
 /**************************************************************************************/
 /* Schedulers:
  *      The interface to the schedule functions is that Scarab will pass the
@@ -585,70 +671,112 @@ inline static void sort_node_ready_list() {
  * node->sd. See OLDEST_FIRST_SCHED for an example. Note, it is not
  * necessary to look at FU availability in this stage, if the FU is busy,
  * then the op will be ignored and available to schedule again in the next
- * stage.
+ * stage. sched_ready_fus narrows the choice to the FUs that can take the op
+ * next cycle when port contention is modeled.
  *
  *      +OLDEST_FIRST_SCHED: will always select the oldest ready ops to schedule
  */
 
-void oldest_first_sched(Op* op) {
-  int32 youngest_slot_op_id = -1;  //-1 means not found
-
-  // Iterate through the FUs that this RS is connected to.
-  Reservation_Station* rs = &node->rs[op->rs_id];
-  for(uns32 i = 0; i < rs->num_fus; ++i) {
-    Func_Unit* fu    = rs->connected_fus[i];
-    uns32      fu_id = fu->fu_id;
-
-    // check if this op can be executed by this FU
-    if(get_fu_type(op->table_info->op_type, op->table_info->is_simd) &
-       fu->type) {
-      Op* s_op = node->sd.ops[fu_id];
-      if(!s_op) {  // nobody has been scheduled to this FU yet
-        DEBUG(node->proc_id,
-              "Scheduler selecting    op_num:%s  fu_id:%d op:%s l1:%d\n",
-              unsstr64(op->op_num), fu_id, disasm_op(op, TRUE),
-              op->engine_info.l1_miss);
-        ASSERT(node->proc_id, fu_id < node->sd.max_op_count);
-        op->fu_num                 = fu_id;
-        node->sd.ops[op->fu_num]   = op;
-        node->last_scheduled_opnum = op->op_num;
-        node->sd.op_count += !s_op;
-        ASSERT(node->proc_id, node->sd.op_count <= node->sd.max_op_count);
-        youngest_slot_op_id = -1;
-        break;
-      } else if(op->op_num < s_op->op_num) {
-        // The slot is not empty, but we are older than the op that is in the
-        // slot
-        if(youngest_slot_op_id == -1) {
-          youngest_slot_op_id = fu_id;
-        } else {
-          Op* youngest_op = node->sd.ops[youngest_slot_op_id];
-          if(s_op->op_num > youngest_op->op_num) {
-            // this slot is younger than the youngest known op
-            youngest_slot_op_id = fu_id;
-          }
-        }
-      }
-    }
+/* sched_bypass_fus: the FUs the op's register sources have been forwarded to
+   by next cycle. A result reaches its producer's cluster at wake_cycle and
+   the other clusters BYPASS_CROSS_CLUSTER_DELAY cycles later. */
+static uns64 sched_bypass_fus(Op* op) {
+  uns64 fus = N_BIT_MASK_64;
+  uns   ii;
+  for(ii = 0; ii < op->oracle_info.num_srcs; ii++) {
+    Src_Info* src_info = &op->oracle_info.src_info[ii];
+    Op*       src_op   = src_info->op;
+    if(src_info->type != REG_DATA_DEP || !src_op->op_pool_valid ||
+       src_op->unique_num != src_info->unique_num || src_op->fu_num >= NUM_FUS)
+      continue;
+    if(src_op->wake_cycle + BYPASS_CROSS_CLUSTER_DELAY > cycle_count + 1)
+      fus &= exec->fus[src_op->fu_num].cluster_fus;
   }
+  return fus;
+}
 
-  if(youngest_slot_op_id != -1) {
-    /*Did not find an empty slot, but we did find a slot that is younger that
-     * us*/
-    uns32 fu_id = youngest_slot_op_id;
-    DEBUG(node->proc_id,
-          "Scheduler selecting    op_num:%s  fu_id:%d op:%s l1:%d\n",
-          unsstr64(op->op_num), fu_id, disasm_op(op, TRUE),
-          op->engine_info.l1_miss);
-    ASSERT(node->proc_id, fu_id < node->sd.max_op_count);
-    op->fu_num                 = fu_id;
-    node->sd.ops[op->fu_num]   = op;
-    node->last_scheduled_opnum = op->op_num;
-    node->sd.op_count += 0;  // replacing an op, not adding a new one.
-    ASSERT(node->proc_id, node->sd.op_count <= node->sd.max_op_count);
+/* sched_ready_fus: the eligible FUs that can take the op next cycle */
+static uns64 sched_ready_fus(Op* op, uns64 eligible) {
+  uns64 fus = eligible;
+  if(SCHED_AVOID_BUSY_FUS || WB_PORT_CONFLICTS) {
+    fus &= exec_fus_ready(op, cycle_count + 1);
+    if(eligible && !fus)
+      STAT_EVENT(node->proc_id, SCHED_FU_NOT_READY);
+  }
+  if(BYPASS_CROSS_CLUSTER_DELAY && fus) {
+    uns64 bypass_fus = fus & sched_bypass_fus(op);
+    if(!bypass_fus)
+      STAT_EVENT(node->proc_id, SCHED_BYPASS_DELAY);
+    fus = bypass_fus;
+  }
+  return fus;
+}
+
+/* sched_fused_jcc_ready: the macro-fused Jcc can go with op next cycle: it
+   is in the RS and waits on nothing but op */
+static Flag sched_fused_jcc_ready(Op* op, Op* jcc) {
+  uns ii;
+  if((jcc->state != OS_IN_RS && jcc->state != OS_READY &&
+      jcc->state != OS_WAIT_FWD) ||
+     jcc->rdy_cycle > cycle_count + 1)
+    return FALSE;
+  for(ii = 0; ii < jcc->oracle_info.num_srcs; ii++)
+    if(test_not_rdy_bit(jcc, ii) && jcc->oracle_info.src_info[ii].op != op)
+      return FALSE;
+  return TRUE;
+}
+
+void oldest_first_sched(Op* op) {
+  Reservation_Station* rs  = &node->rs[op->rs_id];
+  Op*                  jcc = MACRO_FUSION ? node_fused_jcc(op) : NULL;
+  uns64 eligible = rs->fu_eligible[get_fu_type_idx(op->table_info->op_type,
+                                                   op->table_info->is_simd)];
+  uns64 free_fus;
+  uns32 fu_id;
+
+  /* a macro-fused pair issues as one uop on a port that can take both */
+  if(jcc) {
+    uns64 jcc_fus = rs->fu_eligible[get_fu_type_idx(
+      jcc->table_info->op_type, jcc->table_info->is_simd)];
+    if(!sched_fused_jcc_ready(op, jcc))
+      return;
+    if(eligible & jcc_fus)
+      eligible &= jcc_fus;
+  }
+  eligible = sched_ready_fus(op, eligible);
+  free_fus = eligible & node->sd_free_fus;
+
+  if(free_fus) {
+    // take the lowest numbered free FU that can execute this op
+    fu_id = __builtin_ctzll(free_fus);
+    node->sd_free_fus &= ~(1ull << fu_id);
+    node->sd.op_count++;
   } else {
-    /*Did not find an empty slot or a slot that is younger than me, do nothing*/
+    /* Every FU that can execute this op is taken. Replace the youngest op in
+     * those slots if it is younger than us. This never happens when the ops
+     * are presented oldest first. */
+    Op* youngest_op = NULL;
+    for(uns64 taken = eligible; taken; taken &= taken - 1) {
+      Op* s_op = node->sd.ops[__builtin_ctzll(taken)];
+      if(op->op_num < s_op->op_num &&
+         (!youngest_op || s_op->op_num > youngest_op->op_num))
+        youngest_op = s_op;
+    }
+    if(!youngest_op)
+      return;
+    fu_id = youngest_op->fu_num;
+    // replacing an op, not adding a new one.
   }
+
+  DEBUG(node->proc_id,
+        "Scheduler selecting    op_num:%s  fu_id:%d op:%s l1:%d\n",
+        unsstr64(op->op_num), fu_id, disasm_op(op, TRUE),
+        op->engine_info.l1_miss);
+  ASSERT(node->proc_id, fu_id < node->sd.max_op_count);
+  op->fu_num                 = fu_id;
+  node->sd.ops[op->fu_num]   = op;
+  node->last_scheduled_opnum = op->op_num;
+  ASSERT(node->proc_id, node->sd.op_count <= node->sd.max_op_count);
 }
 
 /**************************************************************************************/
@@ -667,11 +795,16 @@ void node_sched_ops() {
   /* the next stage is supposed to clear them out, regardless of
      whether they are actually sent to a functional unit */
   ASSERT(node->proc_id, node->sd.op_count == 0);
+  node->sd_free_fus = NUM_FUS == 64 ? N_BIT_MASK_64 : N_BIT_MASK(NUM_FUS);
 
   // Check to see if the L1 Q is (still) full
   check_if_mem_blocked();
 
-  for(op = node->rdy_head; op; op = op->next_rdy) {
+  /* The ready ops are visited oldest first, so once every FU has been given
+     an op no younger op can displace one and the walk can stop. */
+  for(op = node_rdy_first();
+      op && node->sd.op_count < node->sd.max_op_count;
+      op = node_rdy_next(op)) {
     ASSERT(node->proc_id, node->proc_id == op->proc_id);
     ASSERTM(node->proc_id, op->in_rdy_list, "op_num %llu\n", op->op_num);
     if(op->state == OS_WAIT_MEM) {
@@ -726,7 +859,8 @@ void node_retire() {
 
   // Iterate through the first NODE_RET_WIDTH number of ops and try to retire
   // them
-  for(op = node->node_head; op && ret_count < NODE_RET_WIDTH;
+  // A fused pair takes one retire slot and retires as a whole
+  for(op = node->node_head; op && (ret_count < NODE_RET_WIDTH || op->fused);
       op = op->next_node) {
     ASSERT(node->proc_id, node->proc_id == op->proc_id);
 
@@ -736,13 +870,19 @@ void node_retire() {
       collect_not_ready_to_retire_stats(op);
       break;
     }
+    if(op->next_node && op->next_node->fused &&
+       op_not_ready_for_retire(op->next_node)) {
+      collect_not_ready_to_retire_stats(op->next_node);
+      break;
+    }
 
     rob_stall_reason = ROB_STALL_NONE;
 
     /**op is ready to retire**/
     ASSERTM(node->proc_id, op->state != OS_TENTATIVE, "op_num: %llu\n",
             op->op_num);
-    ret_count++;
+    if(!op->fused)
+      ret_count++;
     DEBUG(node->proc_id, "Retiring op:%llu\n", op->op_num);
 
     // Debug prints mainly used for testing the uop generation of PIN frontend
@@ -803,6 +943,9 @@ void node_retire() {
     }
     uop_count[node->proc_id]++;
     STAT_EVENT(op->proc_id, NODE_UOP_COUNT);
+    if(op->fused)  // both uops of the pair have retired now
+      INC_STAT_EVENT(op->proc_id, RET_UOP_MACRO_FUSED + op->fused - MACRO_FUSED,
+                     2);
     ASSERTM(node->proc_id, uop_count[node->proc_id] == node->ret_op,
             "%s  %s op_num: %s\n", unsstr64(uop_count[node->proc_id]),
             unsstr64(node->ret_op), unsstr64(op->op_num));
@@ -830,7 +973,7 @@ void node_retire() {
                  LD_EXEC_CYCLES_0 + (op->done_cycle - op->sched_cycle));
     }
     if(op->table_info->mem_type == MEM_LD) {
-      STAT_EVENT(op->proc_id, LD_NO_DEPENDENTS + (op->wake_up_head ? 1 : 0));
+      STAT_EVENT(op->proc_id, LD_NO_DEPENDENTS + (op->wake_up_count ? 1 : 0));
     }
     STAT_EVENT(op->proc_id, RET_OP_EXEC_COUNT_0 + MIN2(32, op->exec_count));
 
@@ -839,6 +982,10 @@ void node_retire() {
     // free the previous register entries with same architectural destination
     rename_table_commit(op);
 
+    node->node_ops[NODE_SLOT(op->op_num)] = NULL;
+    if(op->fused)
+      node->fused_count--;
+    lsq_retire(op);
     if(model->op_retired_hook)
       model->op_retired_hook(op);
     else
@@ -884,20 +1031,16 @@ int64 find_emptiest_rs(Op* op) {
     ASSERT(node->proc_id, !rs->size || rs->rs_op_count <= rs->size);
     ASSERTM(node->proc_id, rs->size,
             "Infinite RS not suppoted by find_emptiest_rs issuer.");
-    for(uns32 i = 0; i < rs->num_fus; ++i) {
-      Func_Unit* fu = rs->connected_fus[i];
-
-      // This FU can execute this op
-      if(get_fu_type(op->table_info->op_type, op->table_info->is_simd) &
-         fu->type) {
-        // Find the emptiest RS
-        int32 num_empty_slots = rs->size - rs->rs_op_count;
-        if(num_empty_slots != 0) {
-          if(emptiest_rs_slots < num_empty_slots) {
-            // Found a new emptiest rs
-            emptiest_rs_id    = rs_id;
-            emptiest_rs_slots = num_empty_slots;
-          }
+    // This RS is connected to an FU that can execute this op
+    if(rs->fu_eligible[get_fu_type_idx(op->table_info->op_type,
+                                       op->table_info->is_simd)]) {
+      // Find the emptiest RS
+      int32 num_empty_slots = rs->size - rs->rs_op_count;
+      if(num_empty_slots >= OP_RS_ENTRIES(op)) {
+        if(emptiest_rs_slots < num_empty_slots) {
+          // Found a new emptiest rs
+          emptiest_rs_id    = rs_id;
+          emptiest_rs_slots = num_empty_slots;
         }
       }
     }
@@ -932,24 +1075,25 @@ void node_fill_rs() {
 
     Reservation_Station* rs = &node->rs[rs_id];
     ASSERT(node->proc_id, rs_id < NUM_RS);
-    ASSERTM(node->proc_id, !rs->size || rs->rs_op_count < rs->size,
-            "There must be at least one free space in selected RS!\n");
+    ASSERTM(node->proc_id,
+            !rs->size || rs->rs_op_count + OP_RS_ENTRIES(op) <= rs->size,
+            "There must be enough free space in selected RS!\n");
 
     ASSERT(node->proc_id, op->state == OS_ISSUED);
     op->state = OS_IN_RS;
     op->rs_id = (Counter)rs_id;
-    rs->rs_op_count++;
+    rs->rs_op_count += OP_RS_ENTRIES(op);
     num_fill_rs++;
     DEBUG(node->proc_id, "Filling %s with op_num:%s (%d)\n", rs->name,
           unsstr64(op->op_num), rs->rs_op_count);
-    if(op->srcs_not_rdy_vector == 0) {
+    /* a macro-fused Jcc is never ready on its own, it is scheduled with the
+       op before it (see oldest_first_sched) */
+    if(op->srcs_not_rdy_vector == 0 && op->fused != MACRO_FUSED) {
       /* op is ready to issue right now */
       DEBUG(node->proc_id, "Adding to ready list  op_num:%s op:%s l1:%d\n",
             unsstr64(op->op_num), disasm_op(op, TRUE), op->engine_info.l1_miss);
       op->state = (cycle_count + 1 >= op->rdy_cycle ? OS_READY : OS_WAIT_FWD);
-      op->next_rdy    = node->rdy_head;
-      node->rdy_head  = op;
-      op->in_rdy_list = TRUE;
+      node_rdy_insert(op);
     }
 
     // This is the max number of ops we can fill into the RS per cycle.
@@ -970,18 +1114,15 @@ void node_handle_scheduled_ops() {
   /* this traversal could be made more efficient since we know what
      ops we tried to schedule last cycle, but for now let's look at
      the whole ready list */
-  Op** last = &node->rdy_head;
-  for(Op* op = node->rdy_head; op; op = op->next_rdy) {
+  for(Op* op = node_rdy_first(); op; op = node_rdy_next(op)) {
     if(op->state == OS_SCHEDULED || op->state == OS_MISS) {
       DEBUG(node->proc_id,
             "Removing from RS (and ready list)  op_num:%s op:%s l1:%d\n",
             unsstr64(op->op_num), disasm_op(op, TRUE), op->engine_info.l1_miss);
-      *last           = op->next_rdy;
-      op->in_rdy_list = FALSE;
-      ASSERT(node->proc_id, node->rs[op->rs_id].rs_op_count > 0);
-      node->rs[op->rs_id].rs_op_count--;
-    } else {
-      last = &op->next_rdy;
+      node_rdy_remove(op);
+      ASSERT(node->proc_id,
+             node->rs[op->rs_id].rs_op_count >= OP_RS_ENTRIES(op));
+      node->rs[op->rs_id].rs_op_count -= OP_RS_ENTRIES(op);
     }
   }
 }
@@ -991,9 +1132,9 @@ void node_handle_scheduled_ops() {
  * ready ops */
 
 Flag is_node_stage_stalled() {
-  return (node->node_count == NODE_TABLE_SIZE) && /* node table is full */
-         !node->rdy_head &&                       /* no ready ops */
-         !node->next_op_into_rs; /* no ops waiting to enter RS */
+  return is_node_table_full() &&   /* node table is full */
+         !node->rdy_count &&       /* no ready ops */
+         !node->next_op_into_rs;   /* no ops waiting to enter RS */
 }
 
 void debug_print_retired_uop(Op* op) {
@@ -1022,7 +1163,8 @@ void debug_print_retired_uop(Op* op) {
 
 Flag op_not_ready_for_retire(Op* op) {
   return !(op->state == OS_DONE || OP_DONE(op)) || op->off_path ||
-         op->recovery_scheduled || op->redirect_scheduled;
+         op->recovery_scheduled || op->redirect_scheduled ||
+         cycle_count < op->mem_viol_cycle;
 }
 
 Flag is_node_table_empty() {
@@ -1078,8 +1220,9 @@ void collect_not_ready_to_retire_stats(Op* op) {
 }
 
 Flag is_node_table_full() {
-  ASSERT(node->proc_id, node->node_count <= NODE_TABLE_SIZE);
-  return (node->node_count == NODE_TABLE_SIZE);
+  ASSERT(node->proc_id,
+         node->node_count - node->fused_count <= NODE_TABLE_SIZE);
+  return (node->node_count - node->fused_count == NODE_TABLE_SIZE);
 }
 
 void collect_node_table_full_stats(Op* op) {
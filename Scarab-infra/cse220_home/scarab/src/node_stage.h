@@ -33,6 +33,20 @@
 #include "stage_data.h"
 
 
+/**************************************************************************************/
+// Defines
+
+/* ops the node table can hold: NODE_TABLE_SIZE entries, a fused pair takes one
+ * entry */
+#define NODE_TABLE_OPS \
+  (NODE_TABLE_SIZE * ((MACRO_FUSION || MICRO_FUSION) ? 2 : 1))
+/* node_ops slot of an op in the node table */
+#define NODE_SLOT(op_num) ((uns)((op_num) % NODE_TABLE_OPS))
+/* scheduler entries an op takes: a macro-fused Jcc shares the entry of its
+ * pair, a micro-fused pair unlaminates into two entries */
+#define OP_RS_ENTRIES(op) ((op)->fused == MACRO_FUSED ? 0 : 1)
+
+
 /**************************************************************************************/
 // Types
 
@@ -44,6 +58,8 @@ typedef struct Reservation_Station_struct {
   Func_Unit** connected_fus;  // FUs that this reservation station is connected
                               // to.
   uns32 num_fus;              // number of fus that this rs is connected to.
+  uns64* fu_eligible;  // per FU type index, bitmask of the connected FUs that
+                       // can execute that type
   uns32 rs_op_count;          // number of ops in this reservation station
 } Reservation_Station;
 
@@ -53,11 +69,18 @@ typedef struct Node_Stage_struct {
 
   Op*   node_head;   // linked-list of ops in the node stage
   Op*   node_tail;   // linked-list of ops in the node stage
-  int32 node_count;  // number of ops in the node table
-
-  Op* rdy_head;  // linked-list of ops that are ready to schedule. Ops
-                 // are put in here when they are issued, or after they
-                 // are issued and another op wakes them up.
+  int32 node_count;   // number of ops in the node table
+  int32 fused_count;  // ops in the node table fused into the op before them
+                      // (node table entries used: node_count - fused_count)
+  Op**  node_ops;     // op held in each node table slot (op_num modulo
+                      // NODE_TABLE_OPS), used to find the recovery point
+
+  uns64* rdy_bits;   // ready ops, one bit per node table slot. Ops are put
+                     // in here when they are issued, or after they are
+                     // issued and another op wakes them up.
+  Op**    rdy_ops;    // ready op held in each node table slot
+  uns     rdy_count;  // number of ops in the ready bitmap
+  uns64   sd_free_fus;  // FUs that have not been given an op this cycle
 
   Counter ret_op;  // next op number to retire
 
@@ -91,11 +114,16 @@ void debug_node_stage(void);
 void update_node_stage(Stage_Data*);
 Flag is_node_stage_stalled(void);
 
+void  node_rdy_insert(Op*);
+Op*   node_rdy_first(void);
+Op*   node_rdy_next(Op*);
+
 void  node_sched_ops(void);
 void  node_handle_scheduled_ops(void);
 void  node_issue(Stage_Data*);
 void  node_fill_rs(void);
 void  node_retire(void);
+Op*   node_fused_jcc(Op*);
 void  check_if_mem_blocked(void);
 void  oldest_first_sched(Op*);
 int64 find_emptiest_rs(Op*);
@@ -47,6 +47,9 @@
 #define MULTI_CYCLE_OP(x)                       \
   ((x)->inst_info->latency > 1 + RFILE_STAGE || \
    (x)->table_info->mem_type == MEM_LD)
+#define WAKE_UP_INLINE_ENTRIES 4 /* consumers held directly in the op */
+#define WAKE_UP_SLAB_ENTRIES 16  /* consumers per overflow slab */
+
 #define MAX_STRANDS 400
 #define MAX_STRAND_BYTES (MAX_STRANDS / 8)
 #define STRAND_BYTE(number) (((number) >> 3) % MAX_STRAND_BYTES)
@@ -83,12 +86,17 @@ DECLARE_ENUM(Op_State, OP_STATE_LIST, OS_);
 /*------------------------------------------------------------------------------------*/
 // {{{ Wake_Up_Entry
 typedef struct Wake_Up_Entry_struct {
-  Op*                          op;
-  Counter                      unique_num;
-  Dep_Type                     dep_type;
-  uns8                         rdy_bit;
-  struct Wake_Up_Entry_struct* next;
+  Op*      op;
+  Counter  unique_num;  // generation of op, stale once its pool entry is reused
+  Dep_Type dep_type;
+  uns8     rdy_bit;
 } Wake_Up_Entry;
+
+// overflow storage for ops with more than WAKE_UP_INLINE_ENTRIES consumers
+typedef struct Wake_Up_Slab_struct {
+  Wake_Up_Entry               entries[WAKE_UP_SLAB_ENTRIES];
+  struct Wake_Up_Slab_struct* next;
+} Wake_Up_Slab;
 // }}}
 
 /*------------------------------------------------------------------------------------*/
@@ -145,6 +153,18 @@ typedef struct Dp_Info_struct {
 } Dp_Info;
 // }}}
 
+/**************************************************************************************/
+// {{{ Fusion_Type
+// Fusion_Type says how an op is fused with the op before it in program order
+
+typedef enum Fusion_Type_enum {
+  NOT_FUSED,
+  MACRO_FUSED, /* conditional branch fused with the flag-setting op before it */
+  MICRO_FUSED, /* ALU uop fused with the load uop of the same instruction */
+  NUM_FUSION_TYPES
+} Fusion_Type;
+// }}}
+
 
 /**************************************************************************************/
 // {{{ Op
@@ -224,7 +244,6 @@ struct Op_struct {
   Counter chkpt_num;  // id for chkpt (WARNING: this can change due to
                       // recoveries)
 
-  struct Op_struct* next_rdy;      // pointer to next ready op (node table)
   Flag              in_rdy_list;   // is the op in the node stage's ready list?
   struct Op_struct* next_node;     // pointer to the next op in the node table
   Flag              in_node_list;  // is the op in the node list?
@@ -240,9 +259,11 @@ struct Op_struct {
   Flag wake_up_signaled[NUM_DEP_TYPES];  // set to true once a wake up has been
                                          // signaled by the op for the given
                                          // type
-  Wake_Up_Entry* wake_up_head;  // list of ops that are dependent on this op, by
-                                // dependency type
-  Wake_Up_Entry* wake_up_tail;  // last entry in each wake up list (for speed)
+  Wake_Up_Entry wake_up_inline[WAKE_UP_INLINE_ENTRIES];  // first ops that are
+                                                         // dependent on this op
+  Wake_Up_Slab* wake_up_slab_head;  // further dependent ops, in the order they
+                                    // were added
+  Wake_Up_Slab* wake_up_slab_tail;  // last overflow slab (for speed)
   uns wake_up_count;   // count of ops to be awakened by this op (wake up list
                        // length)
   Counter wake_cycle;  // used by wake up logic for time wake up signal is sent
@@ -259,7 +280,6 @@ struct Op_struct {
   // (along with any related structs above)
 
   // {{{ pipelined scheduler specific fields (move these)
-  struct Sched_Info_struct* sched_info;
   Counter request_cycle;  // first cycle inst can request func unit i.e. is
                           // awake
   uns gps_not_rdy;        // vector for determining which gs's aren't ready.
@@ -310,11 +330,29 @@ struct Op_struct {
   // {{{ uop cache
   Flag fetched_from_uop_cache;
   // }}}
+  // {{{ uop fusion
+  Fusion_Type fused;     // op shares the pipeline slot of the op before it
+  Op*         fused_op;  // op fused into this one, carried along with it from
+                         // fetch until it is issued into the node table
+  // }}}
   int bp_confidence;
 
   // {{{ register renaming
   int dst_reg_file_ptag[MAX_DESTS]; // ptag of allocated entries in register file in the renaming table
   // }}}
+
+  // {{{ load/store queue
+  Op*     mem_dep_store;         // youngest older store the load reads from
+  Counter mem_dep_store_unique;  // unique_num of mem_dep_store
+  Counter store_seq;       // stores mapped before the load, or the store's own
+                           // number
+  Counter mem_viol_cycle;  // the op re-executes after a memory ordering
+                           // violation: its result is not ready and it cannot
+                           // retire before this cycle (0 if it does not)
+  Counter older_cf_op_num;  // youngest cf op in the node table when the op
+                            // was issued (0 if none); a memory ordering flush
+                            // restores the branch predictor from it
+  // }}}
 };
 // }}}
 
@@ -79,10 +79,11 @@ struct Op_Info_struct {
   struct Table_Info_struct* table_info;  // copy of op->table_info
   struct Inst_Info_struct*  inst_info;   // copy of op->inst_info
 
-  uns      num_srcs;            // number of dependencies to obey
-  Src_Info src_info[MAX_DEPS];  // information about each source
-  Flag     update_fpcr;         // need to update the fpcr
-  UQuad    new_fpcr;            // fpcr value resulting from this op
+  uns       num_srcs;     // number of dependencies to obey
+  Src_Info* src_info;     // information about each source (MAX_DEPS entries
+                          // in the op pool's cold array; NULL in engine_info)
+  Flag      update_fpcr;  // need to update the fpcr
+  UQuad     new_fpcr;     // fpcr value resulting from this op
 
   // mem op fields
   Addr va;        // virtual address for memory instructions
@@ -141,6 +141,12 @@ void free_op(Op* op) {
   ASSERT(0, op->op_pool_valid);
   ASSERT(0, !op->marked);
 
+  // an op fused into this one before issue is always flushed along with it
+  if(op->fused_op) {
+    free_op(op->fused_op);
+    op->fused_op = NULL;
+  }
+
   if(PIPEVIEW)
     pipeview_print_op(op);
 
@@ -151,9 +157,6 @@ void free_op(Op* op) {
   DEBUG(0, "Freed op  id:%u  op_pool_active_ops: %u\n", op->op_pool_id,
         op_pool_active_ops);
 
-  if(op->sched_info)
-    free(op->sched_info);
-
   if(op->table_info->mem_type == MEM_ST)
     delete_store_hash_entry(op);
 
@@ -196,7 +199,6 @@ void op_pool_setup_op(uns proc_id, Op* op) {
   op->srcs_not_rdy_vector     = 0x0;
   op->derived_from_prog_input = 0;
   op->sources_addr_reg        = 0;
-  op->sched_info              = NULL;
   op->marked                  = FALSE;
 
   op->op_num              = op_count[proc_id];
@@ -252,7 +254,12 @@ void op_pool_setup_op(uns proc_id, Op* op) {
 
   op->recovery_scheduled = FALSE;
   op->redirect_scheduled = FALSE;
+  op->mem_dep_store      = NULL;
+  op->mem_viol_cycle     = 0;
+  op->older_cf_op_num    = 0;
   op->fetched_from_uop_cache         = FALSE;
+  op->fused                          = NOT_FUSED;
+  op->fused_op                       = NULL;
 
   for(ii = 0; ii < NUM_DEP_TYPES; ii++)
     op->wake_up_signaled[ii] = FALSE;
@@ -267,7 +274,11 @@ void op_pool_setup_op(uns proc_id, Op* op) {
 
 static inline void expand_op_pool() {
   Op* new_pool = (Op*)calloc(OP_POOL_ENTRIES_INC, sizeof(Op));
-  uns ii;
+  /* the source lists are only written at map and read when the wake up lists
+     are built, so they live in a parallel array instead of inside each op */
+  Src_Info* new_srcs = (Src_Info*)calloc(OP_POOL_ENTRIES_INC * MAX_DEPS,
+                                         sizeof(Src_Info));
+  uns       ii;
 
   DEBUGU(0, "Expanding op pool to size %d\n",
          op_pool_entries + OP_POOL_ENTRIES_INC);
@@ -275,11 +286,13 @@ static inline void expand_op_pool() {
     new_pool[ii].op_pool_valid = FALSE;
     new_pool[ii].op_pool_next  = &new_pool[ii + 1];
     new_pool[ii].op_pool_id    = op_pool_entries++;
+    new_pool[ii].oracle_info.src_info = &new_srcs[ii * MAX_DEPS];
     op_pool_init_op(&new_pool[ii]);
   }
   new_pool[ii].op_pool_valid = FALSE;
   new_pool[ii].op_pool_next  = op_pool_free_head;
   new_pool[ii].op_pool_id    = op_pool_entries++;
+  new_pool[ii].oracle_info.src_info = &new_srcs[ii * MAX_DEPS];
   op_pool_init_op(&new_pool[ii]);
 
   op_pool_free_head = &new_pool[0];
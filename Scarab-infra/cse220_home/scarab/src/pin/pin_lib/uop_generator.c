@@ -839,7 +839,7 @@ void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi,
     info                   = (Inst_Info*)calloc(1, sizeof(Inst_Info));
     if (generated_dummy_nop) {
       *info = dummy_nop;
-      info->addr = pi->instruction_addr;
+      info->addr = convert_to_cmp_addr(proc_id, pi->instruction_addr);
     }
     info->fake_inst        = TRUE;
     info->fake_inst_reason = pi->fake_inst_reason;
@@ -43,6 +43,7 @@
 #include "libs/cache_lib.h"
 #include "libs/hash_lib.h"
 #include "libs/list_lib.h"
+#include "memory/coherence.h"
 #include "memory/memory.h"
 #include "memory/memory.param.h"
 #include "prefetcher//stream.param.h"
@@ -327,6 +328,7 @@ Dcache_Data* dc_pref_cache_access(Op* op) {
     // old_data->HW_prefetch = TRUE;  // do not mark it as prefetch - train the
     // prefetcher if old_HW_prefetch is true
     old_data->HW_prefetch = data->HW_prefetch;
+    old_data->coh_state   = data->coh_state;
     /* line is invalidate */
     cache_invalidate(&dc->pref_dcache, op->oracle_info.va, &pref_line_addr);
 
@@ -373,9 +375,13 @@ Flag dc_pref_cache_fill_line(Mem_Req* req) {
   Addr         addr = req->addr;
   Dcache_Data* old_data;
   Addr         line_addr, repl_line_addr;
+  if(COHERENCE_ON && !coh_fill_ready(dc->proc_id, addr, FALSE))
+    return FAILURE;
   old_data = (Dcache_Data*)cache_insert(&dc->pref_dcache, dc->proc_id, addr,
                                         &line_addr, &repl_line_addr);
   old_data->rdy_cycle = cycle_count + DC_PREF_CACHE_CYCLE;
+  if(COHERENCE_ON)
+    old_data->coh_state = coh_fill(dc->proc_id, addr, FALSE);
   DEBUG(dc->proc_id, "Filling pref_cache addr:0x%s :%8s index:%7s \n",
         hexstr64s(addr), unsstr64(addr),
         unsstr64(addr >> LOG2(DCACHE_LINE_SIZE)));
@@ -414,6 +420,8 @@ void dc_pref_cache_insert(Addr addr) {
     STAT_EVENT(0, DC_PREF_CACHE_INSERT);
     new_data->read_count[0] = 1;
     new_data->rdy_cycle     = cycle_count + DC_PREF_CACHE_CYCLE;
+    if(COHERENCE_ON)
+      new_data->coh_state = coh_fill_now(dc->proc_id, addr, FALSE);
   }
 }
 
@@ -448,6 +456,9 @@ void ideal_l2l1_prefetcher(Op* op) {
       dcache_data->read_count[1]  = 0;
       dcache_data->write_count[0] = 0;
       dcache_data->write_count[1] = 0;
+      if(COHERENCE_ON)
+        dcache_data->coh_state = coh_fill_now(dc->proc_id, op->oracle_info.va,
+                                              FALSE);
     } else {
       // l1 miss
       STAT_EVENT(0, L2_IDEAL_MISS_L2);
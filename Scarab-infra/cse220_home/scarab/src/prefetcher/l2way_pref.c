@@ -42,6 +42,7 @@
 #include "libs/cache_lib.h"
 #include "libs/hash_lib.h"
 #include "libs/list_lib.h"
+#include "memory/coherence.h"
 #include "memory/memory.h"
 #include "memory/memory.param.h"
 #include "prefetcher/l2l1pref.h"
@@ -199,6 +200,8 @@ void l2way_pref_pred(Mem_Req_Info* req) {
                       "This writeback code is wrong. Writebacks may be lost.");
         }
         data->HW_prefetch = TRUE;
+        if(COHERENCE_ON)
+          data->coh_state = coh_fill_now(dc->proc_id, va, FALSE);
         STAT_EVENT(0, L2WAY_PREF_REQ);
         STAT_EVENT(0, L2WAY_PREF_HIT_DATA_REQ);
       } else
@@ -253,6 +256,8 @@ void update_l2way_pref_req_queue(void) {
                 0, "This writeback code is wrong. Writebacks may be lost.");
             }
             data->HW_prefetch = TRUE;
+            if(COHERENCE_ON)
+              data->coh_state = coh_fill_now(dc->proc_id, req_va, FALSE);
             STAT_EVENT(0, L2WAY_PREF_REQ);
             STAT_EVENT(0, L2WAY_PREF_HIT_DATA_REQ);
           } else {
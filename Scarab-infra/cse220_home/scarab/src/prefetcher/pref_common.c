@@ -868,6 +868,95 @@ void pref_update_core(uns proc_id) {
   }
 }
 
+/* pref_idle: TRUE if pref_update has no queued request to send, so that it
+   only moves the send positions */
+static Flag pref_queue_empty(Pref_Mem_Req* queue, uns size) {
+  for(uns ii = 0; ii < size; ii++) {
+    if(queue[ii].valid)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+Flag pref_idle(void) {
+  if(!PREF_FRAMEWORK_ON)
+    return TRUE;
+
+  for(uns proc_id = 0; proc_id < (PREF_SHARED_QUEUES ? 1 : NUM_CORES);
+      proc_id++) {
+    HWP_Core* core = pref.cores[proc_id];
+    if(!pref_queue_empty(core->dl0req_queue, PREF_DL0REQ_QUEUE_SIZE) ||
+       !pref_queue_empty(core->umlc_req_queue, PREF_UMLC_REQ_QUEUE_SIZE) ||
+       !pref_queue_empty(core->ul1req_queue, PREF_UL1REQ_QUEUE_SIZE))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/* pref_skip_cycles: do what pref_update would have done in the given number
+   of cycles up to cycle_count while pref_idle */
+void pref_skip_cycles(Counter cycles) {
+  if(!PREF_FRAMEWORK_ON)
+    return;
+
+  if(PREF_HFILTER_ON && PREF_HFILTER_RESET_ENABLE &&
+     cycle_count / PREF_HFILTER_RESET_INTERVAL !=
+       (cycle_count - cycles) / PREF_HFILTER_RESET_INTERVAL)
+    pref_hfilter_pht_reset();
+
+  for(uns proc_id = 0; proc_id < (PREF_SHARED_QUEUES ? 1 : NUM_CORES);
+      proc_id++) {
+    HWP_Core* core                = pref.cores[proc_id];
+    core->dl0req_queue_send_pos   = (core->dl0req_queue_send_pos +
+                                   cycles * PREF_DL0SCHEDULE_NUM) %
+                                  PREF_DL0REQ_QUEUE_SIZE;
+    core->umlc_req_queue_send_pos = (core->umlc_req_queue_send_pos +
+                                     cycles * PREF_UMLC_SCHEDULE_NUM) %
+                                    PREF_UMLC_REQ_QUEUE_SIZE;
+    core->ul1req_queue_send_pos   = (core->ul1req_queue_send_pos +
+                                   cycles * PREF_UL1SCHEDULE_NUM) %
+                                  PREF_UL1REQ_QUEUE_SIZE;
+  }
+}
+
+/* pref_warmup_drain: functional counterpart of pref_update_core used in
+   warmup. Every queued request is installed immediately; dl0 requests that
+   miss the dcache are installed in the L1 like the ones forwarded to the
+   ul1req_queue. */
+static void pref_warmup_drain_queue(Pref_Mem_Req* queue, uns size,
+                                    Flag check_dcache, Flag to_mlc) {
+  for(uns ii = 0; ii < size; ii++) {
+    Pref_Mem_Req* req = &queue[ii];
+    Addr          dummy_line_addr;
+    if(!req->valid)
+      continue;
+    req->valid  = FALSE;
+    uns proc_id = req->line_addr >> 58;
+    if(check_dcache &&
+       cache_access(&cmp_model.dcache_stage[proc_id].dcache, req->line_addr,
+                    &dummy_line_addr, FALSE))
+      continue;
+    cmp_warmup_pref_fill(proc_id, req->line_addr, to_mlc && MLC_PRESENT,
+                         req);
+  }
+}
+
+void pref_warmup_drain(void) {
+  if(!PREF_FRAMEWORK_ON)
+    return;
+
+  for(uns proc_id = 0; proc_id < (PREF_SHARED_QUEUES ? 1 : NUM_CORES);
+      proc_id++) {
+    HWP_Core* core = pref.cores[proc_id];
+    pref_warmup_drain_queue(core->dl0req_queue, PREF_DL0REQ_QUEUE_SIZE, TRUE,
+                            FALSE);
+    pref_warmup_drain_queue(core->umlc_req_queue, PREF_UMLC_REQ_QUEUE_SIZE,
+                            FALSE, TRUE);
+    pref_warmup_drain_queue(core->ul1req_queue, PREF_UL1REQ_QUEUE_SIZE, FALSE,
+                            FALSE);
+  }
+}
+
 void pref_ul1sent(uns8 proc_id, Addr addr, uns8 prefetcher_id) {
   if(!PREF_FRAMEWORK_ON)
     return;
@@ -206,6 +206,9 @@ void pref_ul1_pref_hit_late(uns8 proc_id, Addr line_addr, Addr load_PC,
                             uns32 global_hist, uns8 prefetcher_id);
 
 void pref_update(void);
+Flag pref_idle(void);
+void pref_skip_cycles(Counter cycles);
+void pref_warmup_drain(void);
 
 // returns true if req hits in the req queue. It also invalidates the request in
 // the pref queue.
@@ -33,12 +33,15 @@
 
 
 #include "ramulator/Config.h"
+#include "ramulator/DramCache.h"
 #include "ramulator/Request.h"
 #include "ramulator/ScarabWrapper.h"
 
 extern "C" {
 #include "general.param.h"
 #include "globals/assert.h"
+#include "memory/mem_latency.h"
+#include "memory/mem_qos.h"
 #include "memory/memory.h"
 #include "memory/memory.param.h"
 #include "ramulator.h"
@@ -59,10 +62,21 @@ using namespace ramulator;
 ScarabWrapper* wrapper = NULL;
 Config*        configs = NULL;
 
+// DRAM cache tier (DRAM_CACHE_ON): tags in dram_cache, data in a second
+// Ramulator instance ticked in its own frequency domain
+ScarabWrapper* dram_cache_wrapper = NULL;
+Config*        dram_cache_configs = NULL;
+DramCache*     dram_cache         = NULL;
+
 void to_ramulator_req(const Mem_Req* scarab_req, Request* ramulator_req);
 void init_configs();
+void init_dram_cache_configs();
 bool try_completing_request(Mem_Req* req);
 void enqueue_response(Request& req);
+bool dram_cache_send(Request& req);
+void dram_cache_read_done(Request& dc_req, long addr, bool hit);
+void dram_cache_fill(Request& req);
+void dram_cache_evict(const DramCache::Victim& victim, int way, int coreid);
 
 void stats_callback(int coreid, int type);
 
@@ -72,6 +86,14 @@ deque<pair<long, Mem_Req*>> resp_queue;  // completed read request that need to
 map<long, list<Mem_Req*>> inflight_read_reqs;
 // map<long, Mem_Req*> inflight_read_reqs;
 
+deque<Request> dram_cache_mem_queue;  // DRAM cache misses and dirty victims
+                                      // waiting for main memory
+deque<Request> dram_cache_queue;      // fills and victim reads waiting for
+                                      // the DRAM cache
+uns dram_cache_pending_misses = 0;    // read misses still in the DRAM cache,
+                                      // each will take a dram_cache_mem_queue
+                                      // entry
+
 void ramulator_init() {
   ASSERTM(0, ICACHE_LINE_SIZE == DCACHE_LINE_SIZE,
           "Ramulator"
@@ -85,6 +107,18 @@ void ramulator_init() {
 
   wrapper = new ScarabWrapper(*configs, DCACHE_LINE_SIZE, &stats_callback);
 
+  if(DRAM_CACHE_ON) {
+    dram_cache_configs = new Config();
+    init_dram_cache_configs();
+    // the POWER_DRAM_* stats are for main memory only
+    dram_cache_wrapper = new ScarabWrapper(*dram_cache_configs,
+                                           DCACHE_LINE_SIZE,
+                                           [](int coreid, int type) {});
+    dram_cache = new DramCache((long)DRAM_CACHE_SIZE_MB << 20,
+                               DRAM_CACHE_BLOCK_SIZE, DCACHE_LINE_SIZE,
+                               DRAM_CACHE_ASSOC);
+  }
+
   DPRINTF("Initialized Ramulator. \n");
 }
 
@@ -93,6 +127,14 @@ void ramulator_finish() {
 
   delete wrapper;
   delete configs;
+
+  if(DRAM_CACHE_ON) {
+    dram_cache_wrapper->finish();
+
+    delete dram_cache_wrapper;
+    delete dram_cache_configs;
+    delete dram_cache;
+  }
 }
 
 void stats_callback(int coreid, int type) {
@@ -141,10 +183,26 @@ void init_configs() {
                RAMULATOR_USE_REST_OF_ADDR_AS_ROW_ADDR);
 
   configs->add("scheduling_policy", RAMULATOR_SCHEDULING_POLICY);
+  configs->add("qos_quantum", to_string(RAMULATOR_QOS_QUANTUM));
+  configs->add("atlas_starvation", to_string(RAMULATOR_ATLAS_STARVATION));
+  configs->add("tcm_cluster_thresh", to_string(RAMULATOR_TCM_CLUSTER_THRESH));
+  configs->add("tcm_shuffle", to_string(RAMULATOR_TCM_SHUFFLE));
+  configs->add("bliss_threshold", to_string(RAMULATOR_BLISS_THRESHOLD));
+  configs->add("bliss_clear", to_string(RAMULATOR_BLISS_CLEAR));
   configs->add("readq_entries", to_string(RAMULATOR_READQ_ENTRIES));
   configs->add("writeq_entries", to_string(RAMULATOR_WRITEQ_ENTRIES));
   configs->add("output_dir", OUTPUT_DIR);
 
+  if(RAMULATOR_ENERGY) {
+    configs->add("VDD", to_string(RAMULATOR_VDD));
+    configs->add("IDD0", to_string(RAMULATOR_IDD0));
+    configs->add("IDD2N", to_string(RAMULATOR_IDD2N));
+    configs->add("IDD3N", to_string(RAMULATOR_IDD3N));
+    configs->add("IDD4R", to_string(RAMULATOR_IDD4R));
+    configs->add("IDD4W", to_string(RAMULATOR_IDD4W));
+    configs->add("IDD5B", to_string(RAMULATOR_IDD5B));
+  }
+
   // TODO: make these optional and use the preset values specified by
   // RAMULATOR_SPEED for timings that are not explicitly provided in
   // ramulator.param.def
@@ -167,6 +225,36 @@ void init_configs() {
   configs->add("tRAS", to_string(RAMULATOR_TRAS));
 }
 
+void init_dram_cache_configs() {
+  ASSERTM(0, DRAM_CACHE_BLOCK_SIZE % DCACHE_LINE_SIZE == 0 &&
+               DRAM_CACHE_BLOCK_SIZE / DCACHE_LINE_SIZE <= 64,
+          "DRAM_CACHE_BLOCK_SIZE must be 1 to 64 cache lines\n");
+  ASSERTM(0, ((long)DRAM_CACHE_SIZE_MB << 20) >=
+               (long)DRAM_CACHE_BLOCK_SIZE * DRAM_CACHE_ASSOC,
+          "DRAM cache smaller than one set\n");
+
+  dram_cache_configs->set_core_num(NUM_CORES);
+
+  dram_cache_configs->add("standard", DRAM_CACHE_STANDARD);
+  dram_cache_configs->add("speed", DRAM_CACHE_SPEED);
+  dram_cache_configs->add("org", DRAM_CACHE_ORG);
+  dram_cache_configs->add("channels", to_string(DRAM_CACHE_CHANNELS));
+  dram_cache_configs->add("ranks", to_string(DRAM_CACHE_RANKS));
+  // the other timings come from the DRAM_CACHE_SPEED preset
+  dram_cache_configs->add("tCK", to_string(DRAM_CACHE_TCK));
+
+  dram_cache_configs->add("record_cmd_trace", "off");
+  dram_cache_configs->add("print_cmd_trace", "off");
+  dram_cache_configs->add("use_rest_of_addr_as_row_addr", "on");
+  dram_cache_configs->add("scheduling_policy", RAMULATOR_SCHEDULING_POLICY);
+  dram_cache_configs->add("readq_entries",
+                          to_string(DRAM_CACHE_READQ_ENTRIES));
+  dram_cache_configs->add("writeq_entries",
+                          to_string(DRAM_CACHE_WRITEQ_ENTRIES));
+  dram_cache_configs->add("output_dir", OUTPUT_DIR);
+  dram_cache_configs->add("stat_file", "ramulator_dram_cache.stat.out");
+}
+
 
 int ramulator_send(Mem_Req* scarab_req) {
   Request req;
@@ -195,9 +283,16 @@ int ramulator_send(Mem_Req* scarab_req) {
     return true;  // a request to the same address is already issued
   }
 
-  bool is_sent = wrapper->send(req);
+  if(mem_qos_throttled(scarab_req->proc_id)) {
+    DEBUG(scarab_req->proc_id,
+          "Ramulator: The request has been throttled.\n");
+    return false;
+  }
+
+  bool is_sent = DRAM_CACHE_ON ? dram_cache_send(req) : wrapper->send(req);
 
   if(is_sent) {
+    mem_qos_sent(scarab_req->proc_id);
     STAT_EVENT(scarab_req->proc_id, POWER_MEMORY_CTRL_ACCESS);
 
     if(req.type == Request::Type::READ) {
@@ -233,14 +328,107 @@ void enqueue_response(Request& req) {
           "Ramulator request that read address: %lu\n",
           req.addr);
 
+  long issue = req.issue >= 0 ? req.issue : req.arrive;
   auto it_scarab_req = inflight_read_reqs.find(req.addr);
-  for(auto req : it_scarab_req->second)
-    resp_queue.push_back(make_pair(it_scarab_req->first, req));
+  for(auto scarab_req : it_scarab_req->second) {
+    mem_lat_dram_done(scarab_req, req.depart - issue);
+    resp_queue.push_back(make_pair(it_scarab_req->first, scarab_req));
+  }
   // resp_queue.push_back(make_pair(it_scarab_req->first,
   // it_scarab_req->second));
   inflight_read_reqs.erase(it_scarab_req);
 }
 
+/* dram_cache_send: every request first accesses the DRAM cache. Hits and
+   misses are decided here from the tags; a read miss goes on to main memory
+   once its DRAM cache access (the tag read) completes. Writes allocate.
+
+   A request is rejected (and retried by memory.c) while either side queue is
+   full. Read misses already in the DRAM cache count against
+   dram_cache_mem_queue. The dirty lines of a victim block are queued
+   together, so an eviction can take a queue past DRAM_CACHE_QUEUE_ENTRIES
+   by up to one block's lines. */
+bool dram_cache_send(Request& req) {
+  long addr = req.addr;
+  bool block_hit;
+  int  way = dram_cache->find_way(addr, &block_hit);
+  bool hit = block_hit && dram_cache->lookup(addr);
+
+  if(dram_cache_mem_queue.size() + dram_cache_pending_misses >=
+       DRAM_CACHE_QUEUE_ENTRIES ||
+     dram_cache_queue.size() >= DRAM_CACHE_QUEUE_ENTRIES) {
+    STAT_EVENT(req.coreid, DRAM_CACHE_QUEUE_FULL);
+    return false;
+  }
+
+  Request dc_req(dram_cache->cache_addr(addr, way), req.type, req.coreid);
+  if(req.type == Request::Type::READ)
+    dc_req.callback = [addr, hit](Request& dc_req) {
+      dram_cache_read_done(dc_req, addr, hit);
+    };
+  if(!dram_cache_wrapper->send(dc_req))
+    return false;
+
+  INC_STAT_EVENT(req.coreid, DRAM_CACHE_BYTES, DCACHE_LINE_SIZE);
+  if(req.type == Request::Type::READ) {
+    STAT_EVENT(req.coreid, DRAM_CACHE_READ);
+    STAT_EVENT(req.coreid, hit ? DRAM_CACHE_READ_HIT : DRAM_CACHE_READ_MISS);
+    if(hit)
+      dram_cache->touch(addr, way);
+    else
+      dram_cache_pending_misses++;
+  } else {
+    STAT_EVENT(req.coreid, DRAM_CACHE_WRITE);
+    if(hit)
+      STAT_EVENT(req.coreid, DRAM_CACHE_WRITE_HIT);
+    dram_cache_evict(dram_cache->fill(addr, way, true), way, req.coreid);
+  }
+  return true;
+}
+
+void dram_cache_read_done(Request& dc_req, long addr, bool hit) {
+  if(hit) {
+    Request resp = dc_req;
+    resp.addr    = addr;
+    enqueue_response(resp);
+  } else {
+    ASSERT(dc_req.coreid, dram_cache_pending_misses > 0);
+    dram_cache_pending_misses--;
+    dram_cache_mem_queue.push_back(
+      Request(addr, Request::Type::READ, dram_cache_fill, dc_req.coreid));
+  }
+}
+
+/* dram_cache_fill: main memory returned a DRAM cache miss */
+void dram_cache_fill(Request& req) {
+  bool block_hit;
+  int  way = dram_cache->find_way(req.addr, &block_hit);
+
+  STAT_EVENT(req.coreid, DRAM_CACHE_FILL);
+  dram_cache_evict(dram_cache->fill(req.addr, way, false), way, req.coreid);
+  dram_cache_queue.push_back(Request(dram_cache->cache_addr(req.addr, way),
+                                     Request::Type::WRITE, req.coreid));
+  enqueue_response(req);
+}
+
+/* dram_cache_evict: dirty lines of the victim, which was in way, are read
+   out of the DRAM cache and written to main memory */
+void dram_cache_evict(const DramCache::Victim& victim, int way, int coreid) {
+  if(!victim.valid)
+    return;
+  STAT_EVENT(coreid, DRAM_CACHE_EVICT);
+  for(int ii = 0; ii < dram_cache->lines_per_block(); ii++) {
+    if(!(victim.dirty & (uint64_t(1) << ii)))
+      continue;
+    long addr = victim.addr + ii * DCACHE_LINE_SIZE;
+    STAT_EVENT(coreid, DRAM_CACHE_DIRTY_WB);
+    dram_cache_queue.push_back(Request(dram_cache->cache_addr(addr, way),
+                                       Request::Type::READ, coreid));
+    dram_cache_mem_queue.push_back(
+      Request(addr, Request::Type::WRITE, coreid));
+  }
+}
+
 bool try_completing_request(Mem_Req* req) {
   if((unsigned int)mem->l1fill_queue.entry_count < MEM_L1_FILL_QUEUE_ENTRIES) {
     DEBUG(req->proc_id,
@@ -282,7 +470,8 @@ void to_ramulator_req(const Mem_Req* scarab_req, Request* ramulator_req) {
     ramulator_req->type = Request::Type::WRITE;
   else if(scarab_req->type == MRT_DFETCH || scarab_req->type == MRT_DSTORE ||
           scarab_req->type == MRT_IFETCH || scarab_req->type == MRT_IPRF ||
-          scarab_req->type == MRT_DPRF || scarab_req->type == MRT_UOCPRF || scarab_req->type == MRT_FDIPPRFON || scarab_req->type == MRT_FDIPPRFOFF)
+          scarab_req->type == MRT_DPRF || scarab_req->type == MRT_UOCPRF || scarab_req->type == MRT_FDIPPRFON || scarab_req->type == MRT_FDIPPRFOFF ||
+          scarab_req->type == MRT_PTWALK)
     ramulator_req->type = Request::Type::READ;
   else
     ASSERTM(scarab_req->proc_id, false,
@@ -298,12 +487,43 @@ void to_ramulator_req(const Mem_Req* scarab_req, Request* ramulator_req) {
 void ramulator_tick() {
   wrapper->tick();
 
+  while(!dram_cache_mem_queue.empty() &&
+        wrapper->send(dram_cache_mem_queue.front())) {
+    INC_STAT_EVENT(dram_cache_mem_queue.front().coreid, DRAM_CACHE_MEM_BYTES,
+                   DCACHE_LINE_SIZE);
+    dram_cache_mem_queue.pop_front();
+  }
+
   if(resp_queue.size() > 0) {
     if(try_completing_request(resp_queue.front().second))
       resp_queue.pop_front();
   }
 }
 
+void ramulator_dram_cache_tick() {
+  dram_cache_wrapper->tick();
+
+  while(!dram_cache_queue.empty() &&
+        dram_cache_wrapper->send(dram_cache_queue.front())) {
+    INC_STAT_EVENT(dram_cache_queue.front().coreid, DRAM_CACHE_BYTES,
+                   DCACHE_LINE_SIZE);
+    dram_cache_queue.pop_front();
+  }
+}
+
+/* Ticks on which ramulator_tick() would neither issue a DRAM command nor
+   return data to Scarab, unless a new request is sent */
+Counter ramulator_idle_ticks() {
+  if(DRAM_CACHE_ON || !resp_queue.empty() || !dram_cache_mem_queue.empty())
+    return 0;
+  return wrapper->idle_ticks();
+}
+
+void ramulator_skip_ticks(Counter ticks) {
+  ASSERT(0, ticks <= ramulator_idle_ticks());
+  wrapper->skip_ticks(ticks);
+}
+
 int ramulator_get_chip_width() {
   return wrapper->get_chip_width();
 }
@@ -325,7 +545,8 @@ Mem_Req* ramulator_search_queue(long phys_addr, Mem_Req_Type type) {
     0,
     (type == MRT_IFETCH) || (type == MRT_DFETCH) || (type == MRT_IPRF) ||
       (type == MRT_DPRF) || (type == MRT_DSTORE) || (type == MRT_MIN_PRIORITY) ||
-      (type == MRT_FDIPPRFON) || (type == MRT_FDIPPRFOFF) || (type == MRT_UOCPRF),
+      (type == MRT_FDIPPRFON) || (type == MRT_FDIPPRFOFF) || (type == MRT_UOCPRF) ||
+      (type == MRT_PTWALK),
     "Ramulator: Cannot search write requests in Ramulator request queue\n");
   auto it_req = inflight_read_reqs.find(phys_addr);
 
@@ -339,6 +560,8 @@ Mem_Req* ramulator_search_queue(long phys_addr, Mem_Req_Type type) {
                req->type == MRT_DSTORE) &&
               (type == MRT_DFETCH || type == MRT_DPRF || type == MRT_DSTORE))
         return req;
+      else if(req->type == MRT_PTWALK && type == MRT_PTWALK)
+        return req;
     }
   }
 
@@ -354,6 +577,8 @@ Mem_Req* ramulator_search_queue(long phys_addr, Mem_Req_Type type) {
                resp.second->type == MRT_DSTORE) &&
               (type == MRT_DFETCH || type == MRT_DPRF || type == MRT_DSTORE))
         return resp.second;
+      else if(resp.second->type == MRT_PTWALK && type == MRT_PTWALK)
+        return resp.second;
     }
   }
 
@@ -43,6 +43,9 @@ EXTERNC void ramulator_finish();
 
 EXTERNC int  ramulator_send(Mem_Req* scarab_req);
 EXTERNC void ramulator_tick();
+EXTERNC void ramulator_dram_cache_tick();
+EXTERNC Counter ramulator_idle_ticks();
+EXTERNC void    ramulator_skip_ticks(Counter ticks);
 
 EXTERNC int ramulator_get_chip_width();
 EXTERNC int ramulator_get_chip_size();
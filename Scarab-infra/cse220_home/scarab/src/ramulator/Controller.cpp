@@ -66,6 +66,17 @@ bool Controller<SALP>::is_ready(list<Request>::iterator req){
     else return channel->check(cmd, req->addr_vec.data(), clk);
 }
 
+template <>
+long Controller<SALP>::ready_at(list<Request>::iterator req){
+    SALP::Command cmd = get_first_cmd(req);
+    if (cmd == SALP::Command::PRE_OTHER){
+
+        vector<int> addr_vec = get_offending_subarray(channel, req->addr_vec);
+        return channel->get_next(cmd, addr_vec.data());
+    }
+    else return channel->get_next(cmd, req->addr_vec.data());
+}
+
 template <>
 void Controller<ALDRAM>::update_temp(ALDRAM::Temp current_temperature){
     channel->spec->aldram_timing(current_temperature);
@@ -164,6 +175,8 @@ void Controller<TLDRAM>::tick(){
     }
 
     // issue command on behalf of request
+    if (req->issue < 0)
+        req->issue = clk;
     auto cmd = get_first_cmd(req);
     issue_cmd(cmd, get_addr_vec(cmd, req), req->coreid);
 
@@ -180,10 +193,19 @@ void Controller<TLDRAM>::tick(){
         channel->update_serving_requests(req->addr_vec.data(), -1, clk);
     }
 
+    if (req->type != Request::Type::REFRESH)
+        scheduler->served(*req);
+
     // remove request from queue
     queue->q.erase(req);
 }
 
+// TLDRAM has its own tick(), so never skip its cycles
+template <>
+long Controller<TLDRAM>::idle_ticks(){
+    return 0;
+}
+
 template<>
 void Controller<TLDRAM>::cmd_issue_autoprecharge(typename TLDRAM::Command& cmd,
                                                     const vector<int>& addr_vec) {
@@ -32,6 +32,7 @@
 
 #include "Config.h"
 #include "DRAM.h"
+#include "Energy.h"
 #include "Refresh.h"
 #include "Request.h"
 #include "Scheduler.h"
@@ -95,6 +96,7 @@ public:
     RowPolicy<T>* rowpolicy;  // determines the row-policy (e.g., closed-row vs. open-row)
     RowTable<T>* rowtable;  // tracks metadata about rows (e.g., which are open and for how long)
     Refresh<T>* refresh;
+    Energy<T>* energy;  // IDD-based energy accounting from the issued commands
 
     struct Queue {
         list<Request> q;
@@ -135,6 +137,7 @@ public:
         rowpolicy(new RowPolicy<T>(this)),
         rowtable(new RowTable<T>(this)),
         refresh(new Refresh<T>(this)),
+        energy(new Energy<T>(this, configs)),
         cmd_trace_files(channel->children.size())
     {
 
@@ -317,6 +320,7 @@ public:
         delete rowtable;
         delete channel;
         delete refresh;
+        delete energy;
         for (auto& file : cmd_trace_files)
             file.close();
         cmd_trace_files.clear();
@@ -327,6 +331,7 @@ public:
       req_queue_length_avg = req_queue_length_sum.value() / dram_cycles;
       read_req_queue_length_avg = read_req_queue_length_sum.value() / dram_cycles;
       write_req_queue_length_avg = write_req_queue_length_sum.value() / dram_cycles;
+      energy->finish(clk);
       // call finish function of each channel
       channel->finish(dram_cycles);
     }
@@ -354,6 +359,7 @@ public:
         // necessary for coherence
         if (req.type == Request::Type::READ && find_if(writeq.q.begin(), writeq.q.end(),
                 [req](Request& wreq){ return req.addr == wreq.addr;}) != writeq.q.end()){
+            req.issue = clk;
             req.depart = clk + 1;
             pending.push_back(req);
             readq.q.pop_back();
@@ -461,6 +467,8 @@ public:
         }
 
         // issue command on behalf of request
+        if (req->issue < 0)
+            req->issue = clk;
         auto cmd = get_first_cmd(req);
         issue_cmd(cmd, get_addr_vec(cmd, req), req->coreid);
 
@@ -486,6 +494,9 @@ public:
             channel->update_serving_requests(req->addr_vec.data(), -1, clk);
         }
 
+        if (req->type != Request::Type::REFRESH)
+            scheduler->served(*req);
+
         // remove request from queue
         queue->q.erase(req);
     }
@@ -496,6 +507,13 @@ public:
         return channel->check(cmd, req->addr_vec.data(), clk);
     }
 
+    // Earliest clk at which is_ready(req) can hold
+    long ready_at(list<Request>::iterator req)
+    {
+        typename T::Command cmd = get_first_cmd(req);
+        return channel->get_next(cmd, req->addr_vec.data());
+    }
+
     bool is_ready(typename T::Command cmd, const vector<int>& addr_vec)
     {
         return channel->check(cmd, addr_vec.data(), clk);
@@ -534,6 +552,38 @@ public:
       return (channel->cur_serving_requests > 0);
     }
 
+    // Number of upcoming ticks that cannot issue a command or serve a read,
+    // assuming no new request arrives. Such ticks only advance clk and add
+    // the (unchanging) queue lengths to the per-cycle sums. A queued request
+    // can issue no earlier than its next command's timing constraints allow,
+    // which only change when a command is issued.
+    long idle_ticks()
+    {
+        if (otherq.size())
+            return 0;
+        // a closing row policy may still precharge an open row
+        if (rowpolicy->type != RowPolicy<T>::Type::Opened && !rowtable->table.empty())
+            return 0;
+
+        long ticks = refresh->idle_ticks();
+        if (pending.size())
+            ticks = min(ticks, pending[0].depart - clk - 1);
+        for (Queue* queue : {&actq, &readq, &writeq})
+            for (auto req = queue->q.begin(); ticks > 0 && req != queue->q.end(); ++req)
+                ticks = min(ticks, ready_at(req) - clk - 1);
+        return max(ticks, 0L);
+    }
+
+    // Bulk equivalent of calling tick() 'ticks' times while idle_ticks() >= ticks
+    void skip_idle_ticks(long ticks)
+    {
+        clk += ticks;
+        req_queue_length_sum += ticks * (readq.size() + writeq.size() + pending.size());
+        read_req_queue_length_sum += ticks * (readq.size() + pending.size());
+        write_req_queue_length_sum += ticks * writeq.size();
+        refresh->clk += ticks;
+    }
+
     // For telling whether this channel is under refresh
     bool is_refresh() {
       return clk <= channel->end_of_refreshing;
@@ -640,7 +690,9 @@ private:
             }
         }
  
+        int open_rows = rowtable->table.size() + (channel->spec->is_opening(cmd) ? 1 : 0);
         rowtable->update(cmd, addr_vec, clk);
+        energy->update(cmd, addr_vec, open_rows - rowtable->table.size(), clk);
         if (record_cmd_trace){
             // select rank
             auto& file = cmd_trace_files[addr_vec[1]];
@@ -675,12 +727,18 @@ vector<int> Controller<SALP>::get_addr_vec(
 template <>
 bool Controller<SALP>::is_ready(list<Request>::iterator req);
 
+template <>
+long Controller<SALP>::ready_at(list<Request>::iterator req);
+
 template <>
 void Controller<ALDRAM>::update_temp(ALDRAM::Temp current_temperature);
 
 template <>
 void Controller<TLDRAM>::tick();
 
+template <>
+long Controller<TLDRAM>::idle_ticks();
+
 template <>
 void Controller<TLDRAM>::cmd_issue_autoprecharge(typename TLDRAM::Command& cmd,
                                                     const vector<int>& addr_vec);
@@ -74,6 +74,10 @@ public:
     // Insert a node as one of my child nodes
     void insert(DRAM<T>* child);
 
+    // The functions below are called on the channel (root) node. They index
+    // the flattened per-level tables built by flatten() instead of recursing
+    // through the children, and produce the same results as the tree walk.
+
     // Decode a command into its "prerequisite" command (if any is needed)
     typename T::Command decode(typename T::Command cmd, const int* addr);
 
@@ -116,7 +120,7 @@ private:
 
     // Timing
     long cur_clk = 0;
-    long next[int(T::Command::MAX)]; // the earliest time in the future when a command could be ready
+    long* next = NULL; // the earliest time in the future when a command could be ready (row of the channel's next_table)
     deque<long> prev[int(T::Command::MAX)]; // the most recent history of when commands were issued
 
     // Lookup table for which commands must be preceded by which other commands (i.e., "prerequisite")
@@ -137,9 +141,42 @@ private:
     // E.g., activate->precharge: tRAS@bank, activate->activate: tRC@bank
     vector<typename T::TimingEntry>* timing;
 
+    // Flattened organization (only populated on the channel node)
+    // Nodes of each level are numbered in address order, so the index of the
+    // node an address selects at level l+1 is index(l) * count[l+1] + addr[l+1].
+    static const int num_cmds = int(T::Command::MAX);
+    int leaf_level = 0;                               // deepest instantiated level (e.g., Bank)
+    int level_count[int(T::Level::MAX)];              // children per node of the level above
+    long level_span[int(T::Level::MAX)];              // leaf nodes under one node of a level
+    vector<DRAM<T>*> level_nodes[int(T::Level::MAX)];
+
+    // Struct-of-arrays "next allowed cycle" per node and command, indexed by
+    // [node * num_cmds + cmd]. Each node's next[] points into its level's table.
+    vector<long> next_table[int(T::Level::MAX)];
+    // Ancestor-inclusive next allowed cycle per leaf node and command, so a
+    // full-depth check is a single load and compare
+    vector<long> leaf_ready;
+
+    // Decode and row-buffer results depend only on the state of the nodes on
+    // the address path, which only changes on update(). They are tabulated per
+    // (deepest node, command) and reused until the next state change.
+    struct DecodeEntry {
+        long decode_epoch = -1, hit_epoch = -1, open_epoch = -1;
+        int decode_arg, hit_arg, open_arg;
+        typename T::Command decode;
+        bool hit, open;
+    };
+    vector<DecodeEntry> decode_table[int(T::Level::MAX)];
+    long state_epoch = 0;
+
     // Helper Functions
+    void flatten();
+    int locate(const int* addr, int max_level, int* idx);
+    long ready_at(typename T::Command cmd, const int* addr);
+    void raise_next(int lev, int idx, int cmd, long future);
     void update_state(typename T::Command cmd, const int* addr);
     void update_timing(typename T::Command cmd, const int* addr, long clk);
+    void update_target_timing(DRAM<T>* node, int lev, int idx, typename T::Command cmd, long clk);
 }; /* class DRAM */
 
 
@@ -219,7 +256,6 @@ DRAM<T>::DRAM(T* spec, typename T::Level level) :
     lambda = spec->lambda[int(level)];
     timing = spec->timing[int(level)];
 
-    fill_n(next, int(T::Command::MAX), -1); // initialize future
     for (int cmd = 0; cmd < int(T::Command::MAX); cmd++) {
         int dist = 0;
         for (auto& t : timing[cmd])
@@ -231,21 +267,21 @@ DRAM<T>::DRAM(T* spec, typename T::Level level) :
 
     // try to recursively construct my children
     int child_level = int(level) + 1;
-    if (child_level == int(T::Level::Row))
-        return; // stop recursion: rows are not instantiated as nodes
-
-    int child_max = spec->org_entry.count[child_level];
-    if (!child_max)
-        return; // stop recursion: the number of children is unspecified
-
-    // recursively construct my children
-    for (int i = 0; i < child_max; i++) {
-        DRAM<T>* child = new DRAM<T>(spec, typename T::Level(child_level));
-        child->parent = this;
-        child->id = i;
-        children.push_back(child);
+    if (child_level != int(T::Level::Row)) { // rows are not instantiated as nodes
+        int child_max = spec->org_entry.count[child_level];
+
+        // recursively construct my children (unless their number is unspecified)
+        for (int i = 0; i < child_max; i++) {
+            DRAM<T>* child = new DRAM<T>(spec, typename T::Level(child_level));
+            child->parent = this;
+            child->id = i;
+            children.push_back(child);
+        }
     }
 
+    // the channel owns the flattened tables of the whole tree
+    if (int(level) == 0)
+        flatten();
 }
 
 template <typename T>
@@ -264,22 +300,116 @@ void DRAM<T>::insert(DRAM<T>* child)
     children.push_back(child);
 }
 
+// Flatten: number the nodes of each level in address order and allocate the
+// per-level tables. The tree built by the constructor is uniform, so a node's
+// index can be computed from the address vector alone.
+template <typename T>
+void DRAM<T>::flatten()
+{
+    leaf_level = int(level);
+    level_count[leaf_level] = 1;
+    level_nodes[leaf_level].assign(1, this);
+    while (level_nodes[leaf_level][0]->children.size()) {
+        for (auto node : level_nodes[leaf_level])
+            for (auto child : node->children)
+                level_nodes[leaf_level + 1].push_back(child);
+        leaf_level++;
+        level_count[leaf_level] = level_nodes[leaf_level].size() / level_nodes[leaf_level - 1].size();
+    }
+
+    for (int l = int(level); l <= leaf_level; l++) {
+        level_span[l] = level_nodes[leaf_level].size() / level_nodes[l].size();
+        next_table[l].assign(level_nodes[l].size() * num_cmds, -1); // initialize future
+        decode_table[l].resize(level_nodes[l].size() * num_cmds);
+        for (size_t i = 0; i < level_nodes[l].size(); i++)
+            level_nodes[l][i]->next = &next_table[l][i * num_cmds];
+    }
+    leaf_ready.assign(level_nodes[leaf_level].size() * num_cmds, -1);
+}
+
+// Locate: follow the address down from the channel the same way the tree walk
+// does, stopping at max_level, at the deepest instantiated level, or at an
+// unspecified (negative) address component. Returns the level reached and
+// sets idx to the index of the node there.
+template <typename T>
+int DRAM<T>::locate(const int* addr, int max_level, int* idx)
+{
+    int l = int(level);
+    int i = 0;
+    while (l < max_level && l < leaf_level && addr[l + 1] >= 0) {
+        i = i * level_count[l + 1] + addr[l + 1];
+        l++;
+    }
+    *idx = i;
+    return l;
+}
+
+// Ready at: the earliest clock allowed by every node on the command's path
+template <typename T>
+long DRAM<T>::ready_at(typename T::Command cmd, const int* addr)
+{
+    int idx;
+    int depth = locate(addr, int(spec->scope[int(cmd)]), &idx);
+    if (depth == leaf_level)
+        return leaf_ready[idx * num_cmds + int(cmd)];
+
+    long ready = next_table[int(level)][int(cmd)];
+    int i = 0;
+    for (int l = int(level); l < depth; l++) {
+        i = i * level_count[l + 1] + addr[l + 1];
+        ready = max(ready, next_table[l + 1][i * num_cmds + int(cmd)]);
+    }
+    return ready;
+}
+
+// Raise the next allowed cycle of a command at one node, keeping the
+// ancestor-inclusive leaf table in sync for commands checked down to the leaves
+template <typename T>
+void DRAM<T>::raise_next(int lev, int idx, int cmd, long future)
+{
+    long& cur = next_table[lev][idx * num_cmds + cmd];
+    if (future <= cur)
+        return;
+    cur = future;
+
+    if (int(spec->scope[cmd]) < leaf_level)
+        return; // never checked at the leaves
+
+    long* ready = &leaf_ready[(idx * level_span[lev]) * num_cmds + cmd];
+    for (long i = 0; i < level_span[lev]; i++, ready += num_cmds)
+        *ready = max(*ready, future);
+}
+
 // Decode
 template <typename T>
 typename T::Command DRAM<T>::decode(typename T::Command cmd, const int* addr)
 {
-    int child_id = addr[int(level)+1];
-    if (prereq[int(cmd)]) {
-        typename T::Command prereq_cmd = prereq[int(cmd)](this, cmd, child_id);
-        if (prereq_cmd != T::Command::MAX)
-            return prereq_cmd; // stop recursion: there is a prerequisite at this level
+    int deepest;
+    int depth = locate(addr, leaf_level, &deepest);
+    DecodeEntry& entry = decode_table[depth][deepest * num_cmds + int(cmd)];
+    int arg = addr[depth + 1];
+    if (entry.decode_epoch == state_epoch && entry.decode_arg == arg)
+        return entry.decode;
+
+    typename T::Command result = cmd; // no prerequisites at any level
+    int idx = 0;
+    for (int l = int(level); l <= depth; l++) {
+        if (l > int(level))
+            idx = idx * level_count[l] + addr[l];
+        DRAM<T>* node = level_nodes[l][idx];
+        if (node->prereq[int(cmd)]) {
+            typename T::Command prereq_cmd = node->prereq[int(cmd)](node, cmd, addr[l + 1]);
+            if (prereq_cmd != T::Command::MAX) {
+                result = prereq_cmd; // there is a prerequisite at this level
+                break;
+            }
+        }
     }
 
-    if (child_id < 0 || !children.size())
-        return cmd; // stop recursion: there were no prequisites at any level
-
-    // recursively decode at my child
-    return children[child_id]->decode(cmd, addr);
+    entry.decode_epoch = state_epoch;
+    entry.decode_arg = arg;
+    entry.decode = result;
+    return result;
 }
 
 
@@ -287,15 +417,7 @@ typename T::Command DRAM<T>::decode(typename T::Command cmd, const int* addr)
 template <typename T>
 bool DRAM<T>::check(typename T::Command cmd, const int* addr, long clk)
 {
-    if (next[int(cmd)] != -1 && clk < next[int(cmd)])
-        return false; // stop recursion: the check failed at this level
-
-    int child_id = addr[int(level)+1];
-    if (child_id < 0 || level == spec->scope[int(cmd)] || !children.size())
-        return true; // stop recursion: the check passed at all levels
-
-    // recursively check my child
-    return children[child_id]->check(cmd, addr, clk);
+    return clk >= ready_at(cmd, addr);
 }
 
 // SAUGATA: added function to check whether a command is a row hit
@@ -303,43 +425,63 @@ bool DRAM<T>::check(typename T::Command cmd, const int* addr, long clk)
 template <typename T>
 bool DRAM<T>::check_row_hit(typename T::Command cmd, const int* addr)
 {
-    int child_id = addr[int(level)+1];
-    if (rowhit[int(cmd)]) {
-        return rowhit[int(cmd)](this, cmd, child_id);  // stop recursion: there is a row hit at this level
+    int deepest;
+    int depth = locate(addr, leaf_level, &deepest);
+    DecodeEntry& entry = decode_table[depth][deepest * num_cmds + int(cmd)];
+    int arg = addr[depth + 1];
+    if (entry.hit_epoch == state_epoch && entry.hit_arg == arg)
+        return entry.hit;
+
+    bool result = false; // no row hits at any level
+    int idx = 0;
+    for (int l = int(level); l <= depth; l++) {
+        if (l > int(level))
+            idx = idx * level_count[l] + addr[l];
+        DRAM<T>* node = level_nodes[l][idx];
+        if (node->rowhit[int(cmd)]) {
+            result = node->rowhit[int(cmd)](node, cmd, addr[l + 1]);
+            break;
+        }
     }
 
-    if (child_id < 0 || !children.size())
-        return false; // stop recursion: there were no row hits at any level
-
-    // recursively check for row hits at my child
-    return children[child_id]->check_row_hit(cmd, addr);
+    entry.hit_epoch = state_epoch;
+    entry.hit_arg = arg;
+    entry.hit = result;
+    return result;
 }
 
 template <typename T>
 bool DRAM<T>::check_row_open(typename T::Command cmd, const int* addr)
 {
-    int child_id = addr[int(level)+1];
-    if (rowopen[int(cmd)]) {
-        return rowopen[int(cmd)](this, cmd, child_id);  // stop recursion: there is a row hit at this level
+    int deepest;
+    int depth = locate(addr, leaf_level, &deepest);
+    DecodeEntry& entry = decode_table[depth][deepest * num_cmds + int(cmd)];
+    int arg = addr[depth + 1];
+    if (entry.open_epoch == state_epoch && entry.open_arg == arg)
+        return entry.open;
+
+    bool result = false; // no open rows at any level
+    int idx = 0;
+    for (int l = int(level); l <= depth; l++) {
+        if (l > int(level))
+            idx = idx * level_count[l] + addr[l];
+        DRAM<T>* node = level_nodes[l][idx];
+        if (node->rowopen[int(cmd)]) {
+            result = node->rowopen[int(cmd)](node, cmd, addr[l + 1]);
+            break;
+        }
     }
 
-    if (child_id < 0 || !children.size())
-        return false; // stop recursion: there were no row hits at any level
-
-    // recursively check for row hits at my child
-    return children[child_id]->check_row_open(cmd, addr);
+    entry.open_epoch = state_epoch;
+    entry.open_arg = arg;
+    entry.open = result;
+    return result;
 }
 
 template <typename T>
 long DRAM<T>::get_next(typename T::Command cmd, const int* addr)
 {
-    long next_clk = max(cur_clk, next[int(cmd)]);
-    auto node = this;
-    for (int l = int(level); l < int(spec->scope[int(cmd)]) && node->children.size() && addr[l + 1] >= 0; l++){
-        node = node->children[addr[l + 1]];
-        next_clk = max(next_clk, node->next[int(cmd)]);
-    }
-    return next_clk;
+    return max(cur_clk, ready_at(cmd, addr));
 }
 
 // Update
@@ -347,6 +489,7 @@ template <typename T>
 void DRAM<T>::update(typename T::Command cmd, const int* addr, long clk)
 {
     cur_clk = clk;
+    state_epoch++; // invalidate the decode table
     update_state(cmd, addr);
     update_timing(cmd, addr, clk);
 }
@@ -356,15 +499,18 @@ void DRAM<T>::update(typename T::Command cmd, const int* addr, long clk)
 template <typename T>
 void DRAM<T>::update_state(typename T::Command cmd, const int* addr)
 {
-    int child_id = addr[int(level)+1];
-    if (lambda[int(cmd)])
-        lambda[int(cmd)](this, child_id); // update this level
+    int idx = 0;
+    for (int l = int(level); ; l++) {
+        DRAM<T>* node = level_nodes[l][idx];
+        int child_id = addr[l + 1];
+        if (node->lambda[int(cmd)])
+            node->lambda[int(cmd)](node, child_id); // update this level
 
-    if (level == spec->scope[int(cmd)] || !children.size())
-        return; // stop recursion: updated all levels
+        if (l == int(spec->scope[int(cmd)]) || l == leaf_level)
+            return; // updated all levels
 
-    // recursively update my child
-    children[child_id]->update_state(cmd, addr);
+        idx = idx * level_count[l + 1] + child_id;
+    }
 }
 
 
@@ -372,58 +518,68 @@ void DRAM<T>::update_state(typename T::Command cmd, const int* addr)
 template <typename T>
 void DRAM<T>::update_timing(typename T::Command cmd, const int* addr, long clk)
 {
-    // I am not a target node: I am merely one of its siblings
-    if (id != addr[int(level)]) {
-        for (auto& t : timing[int(cmd)]) {
-            if (!t.sibling)
-                continue; // not an applicable timing parameter
-
-            assert (t.dist == 1);
-
-            long future = clk + t.val;
-            next[int(t.cmd)] = max(next[int(t.cmd)], future); // update future
+    assert(id == addr[int(level)]);
+
+    // Walk the target nodes. Some commands have timings that are higher than
+    // their scope levels, thus we do not stop at the cmd's scope level.
+    int idx = 0;
+    for (int l = int(level); ; l++) {
+        update_target_timing(level_nodes[l][idx], l, idx, cmd, clk);
+        if (l == leaf_level)
+            return; // updated all levels
+
+        // the other children of a target node are merely its siblings
+        int child_id = addr[l + 1];
+        int first = idx * level_count[l + 1];
+        for (int c = 0; c < level_count[l + 1]; c++) {
+            if (c == child_id)
+                continue;
+            for (auto& t : spec->timing[l + 1][int(cmd)]) {
+                if (!t.sibling)
+                    continue; // not an applicable timing parameter
+
+                assert (t.dist == 1);
+
+                raise_next(l + 1, first + c, int(t.cmd), clk + t.val); // update future
+            }
         }
 
-        return; // stop recursion: only target nodes should be recursed
+        if (child_id < 0)
+            return; // only target nodes are walked
+        idx = first + child_id;
     }
+}
 
-    // I am a target node
-    if (prev[int(cmd)].size()) {
-        prev[int(cmd)].pop_back();  // FIXME TIANSHI why pop back?
-        prev[int(cmd)].push_front(clk); // update history
+template <typename T>
+void DRAM<T>::update_target_timing(DRAM<T>* node, int lev, int idx, typename T::Command cmd, long clk)
+{
+    deque<long>& history = node->prev[int(cmd)];
+    if (history.size()) {
+        history.pop_back();  // FIXME TIANSHI why pop back?
+        history.push_front(clk); // update history
     }
 
-    for (auto& t : timing[int(cmd)]) {
+    for (auto& t : node->timing[int(cmd)]) {
         if (t.sibling)
             continue; // not an applicable timing parameter
 
-        long past = prev[int(cmd)][t.dist-1];
+        long past = history[t.dist-1];
         if (past < 0)
             continue; // not enough history
 
         long future = past + t.val;
-        next[int(t.cmd)] = max(next[int(t.cmd)], future); // update future
+        raise_next(lev, idx, int(t.cmd), future); // update future
         // TIANSHI: for refresh statistics
         if (spec->is_refreshing(cmd) && spec->is_opening(t.cmd)) {
           assert(past == clk);
-          begin_of_refreshing = clk;
-          end_of_refreshing = max(end_of_refreshing, next[int(t.cmd)]);
-          refresh_cycles += end_of_refreshing - clk;
-          if (cur_serving_requests > 0) {
-            refresh_intervals.push_back(make_pair(begin_of_refreshing, end_of_refreshing));
+          node->begin_of_refreshing = clk;
+          node->end_of_refreshing = max(node->end_of_refreshing, node->next[int(t.cmd)]);
+          node->refresh_cycles += node->end_of_refreshing - clk;
+          if (node->cur_serving_requests > 0) {
+            node->refresh_intervals.push_back(make_pair(node->begin_of_refreshing, node->end_of_refreshing));
           }
         }
     }
-
-    // Some commands have timings that are higher that their scope levels, thus
-    // we do not stop at the cmd's scope level
-    if (!children.size())
-        return; // stop recursion: updated all levels
-
-    // recursively update *all* of my children
-    for (auto child : children)
-        child->update_timing(cmd, addr, clk);
-
 }
 
 template <typename T>
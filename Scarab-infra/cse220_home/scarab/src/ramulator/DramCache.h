@@ -0,0 +1,163 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * DramCache.h
+ *
+ * Tag organization of a DRAM cache (HBM or DRAM tier) that sits in front of
+ * main memory. The data lives in a second Ramulator instance; this class only
+ * decides hits, placement and victims and maps lines to addresses inside that
+ * instance.
+ *
+ * Blocks of block_size bytes are placed in assoc-way sets with LRU
+ * replacement. With 64-byte blocks and one way this is Alloy Cache (Qureshi
+ * and Loh, MICRO 2012): tag and data are read together in one burst. With
+ * page-sized blocks it is the Unison Cache organization (Jevdjic et al., MICRO
+ * 2014): a page is allocated on a miss, but only the lines that are touched
+ * are fetched, so each block keeps a valid and a dirty bit per line
+ * (footprint). Footprint prediction is not modeled.
+ */
+
+#ifndef __DRAM_CACHE_H
+#define __DRAM_CACHE_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+namespace ramulator
+{
+
+class DramCache
+{
+public:
+    struct Victim {
+        bool valid = false;
+        long addr = 0;          // first byte of the evicted block
+        uint64_t dirty = 0;     // dirty lines of the evicted block
+    };
+
+    DramCache(long size, int block_size, int line_size, int assoc)
+        : block_size(block_size), line_size(line_size), assoc(assoc)
+    {
+        assert(block_size >= line_size && block_size % line_size == 0);
+        assert(block_size / line_size <= 64 && "at most 64 lines per block");
+        assert(assoc > 0 && size >= long(block_size) * assoc);
+        sets = size / block_size / assoc;
+        blocks.resize(sets * assoc);
+    }
+
+    // Way of the set holding addr's block, or the way its block would
+    // replace (an invalid way first, otherwise the LRU way). Changes nothing.
+    int find_way(long addr, bool* block_hit) const
+    {
+        long set = get_set(addr), tag = get_tag(addr);
+        int victim = 0;
+        for (int way = 0; way < assoc; way++) {
+            const Block& blk = blocks[set * assoc + way];
+            if (blk.valid && blk.tag == tag) {
+                *block_hit = true;
+                return way;
+            }
+            const Block& cur = blocks[set * assoc + victim];
+            if (cur.valid && (!blk.valid || blk.last_use < cur.last_use))
+                victim = way;
+        }
+        *block_hit = false;
+        return victim;
+    }
+
+    // Is the line holding addr present?
+    bool lookup(long addr) const
+    {
+        bool block_hit;
+        int way = find_way(addr, &block_hit);
+        return block_hit &&
+               (blocks[get_set(addr) * assoc + way].valid_lines & line_bit(addr));
+    }
+
+    // Make the line holding addr present in way (from find_way), evicting
+    // the block that was there if it belongs to another address.
+    Victim fill(long addr, int way, bool dirty)
+    {
+        Block& blk = blocks[get_set(addr) * assoc + way];
+        Victim victim;
+        long tag = get_tag(addr);
+        if (!blk.valid || blk.tag != tag) {
+            if (blk.valid) {
+                victim.valid = true;
+                victim.addr = long((uint64_t(blk.tag) * sets + get_set(addr)) * block_size);
+                victim.dirty = blk.dirty_lines;
+            }
+            blk.valid = true;
+            blk.tag = tag;
+            blk.valid_lines = blk.dirty_lines = 0;
+        }
+        blk.valid_lines |= line_bit(addr);
+        if (dirty)
+            blk.dirty_lines |= line_bit(addr);
+        blk.last_use = ++use_count;
+        return victim;
+    }
+
+    // The lookup of addr hit: update LRU
+    void touch(long addr, int way)
+    {
+        blocks[get_set(addr) * assoc + way].last_use = ++use_count;
+    }
+
+    // Address of addr's line inside the DRAM cache when its block is in way
+    long cache_addr(long addr, int way) const
+    {
+        return (get_set(addr) * assoc + way) * block_size + get_offset(addr);
+    }
+
+    int lines_per_block() const { return block_size / line_size; }
+
+private:
+    struct Block {
+        bool valid = false;
+        long tag = 0;
+        uint64_t valid_lines = 0;
+        uint64_t dirty_lines = 0;
+        uint64_t last_use = 0;
+    };
+
+    int block_size, line_size, assoc;
+    long sets;
+    vector<Block> blocks;
+    uint64_t use_count = 0;
+
+    // physical addresses carry the core id in their top bits
+    long get_set(long addr) const { return uint64_t(addr) / block_size % sets; }
+    long get_tag(long addr) const { return uint64_t(addr) / block_size / sets; }
+    long get_offset(long addr) const { return uint64_t(addr) % block_size; }
+    uint64_t line_bit(long addr) const
+    {
+        return uint64_t(1) << (get_offset(addr) / line_size);
+    }
+};
+
+} /*namespace ramulator*/
+
+#endif /*__DRAM_CACHE_H*/
@@ -0,0 +1,257 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Energy.h
+ *
+ * IDD-based DRAM energy model in the style of DRAMPower (Chandrasekar et al.,
+ * "Improved Power Modeling of DDR SDRAMs", DSD 2011). Energy is computed per
+ * rank from the commands the controller issues and from the time each rank
+ * spends with at least one bank open (active standby) or all banks closed
+ * (precharge standby):
+ *
+ *   ACT        (IDD0  - IDD3N) x tRAS
+ *   PRE        (IDD0  - IDD2N) x tRP   (per bank closed, incl. PREA/RDA/WRA)
+ *   RD         (IDD4R - IDD3N) x tBL
+ *   WR         (IDD4W - IDD3N) x tBL
+ *   REF        (IDD5B - IDD3N) x tRFC
+ *   standby    IDD3N / IDD2N x residency
+ *
+ * each multiplied by VDD and by the number of devices in a rank. Currents are
+ * in mA and times in ns, so energies are in pJ. Power-down and self-refresh
+ * are not modeled since the controller never enters them.
+ */
+
+#ifndef __ENERGY_H
+#define __ENERGY_H
+
+#include <string>
+#include <vector>
+
+#include "Config.h"
+#include "Statistics.h"
+
+using namespace std;
+
+namespace ramulator
+{
+
+template <typename T>
+class Controller;
+
+template <typename T>
+class Energy
+{
+public:
+    Controller<T>* ctrl;
+    bool enabled = false;
+
+    // Device currents (mA) and supply voltage (V)
+    double vdd = 0, idd0 = 0, idd2n = 0, idd3n = 0, idd4r = 0, idd4w = 0, idd5b = 0;
+    // Timings (memory cycles) and clock period (ns)
+    int nRAS = 0, nRP = 0, nBL = 0, nRFC = 0;
+    double tCK = 0;
+    int devices = 1;  // DRAM devices per rank
+
+    // Per-rank state for the standby residencies
+    vector<int> open_banks;
+    vector<long> last_change;
+
+    ScalarStat energy_total;
+    ScalarStat power_avg;
+    VectorStat act_cmds;
+    VectorStat pre_cmds;
+    VectorStat rd_cmds;
+    VectorStat wr_cmds;
+    VectorStat ref_cmds;
+    VectorStat act_standby_cycles;
+    VectorStat pre_standby_cycles;
+    VectorStat act_energy;
+    VectorStat pre_energy;
+    VectorStat rd_energy;
+    VectorStat wr_energy;
+    VectorStat ref_energy;
+    VectorStat act_standby_energy;
+    VectorStat pre_standby_energy;
+    VectorStat rank_energy;
+
+    Energy(Controller<T>* ctrl, const Config& configs) : ctrl(ctrl)
+    {
+        if (!configs.contains("IDD0"))
+            return;
+        enabled = true;
+
+        vdd   = stod(configs["VDD"]);
+        idd0  = stod(configs["IDD0"]);
+        idd2n = stod(configs["IDD2N"]);
+        idd3n = stod(configs["IDD3N"]);
+        idd4r = stod(configs["IDD4R"]);
+        idd4w = stod(configs["IDD4W"]);
+        idd5b = stod(configs["IDD5B"]);
+
+        T* spec = ctrl->channel->spec;
+        tCK  = spec->speed_entry.tCK;
+        nBL  = spec->speed_entry.nBL;
+        // the row timings are named differently across standards (e.g.
+        // nRP vs. nRPpb), so take them from the timing constraints
+        nRAS = get_timing(T::Command::ACT, T::Command::PRE);
+        nRP  = get_timing(T::Command::PRE, T::Command::ACT);
+        nRFC = get_timing(T::Command::REF, T::Command::ACT);
+        devices = max(spec->channel_width / spec->org_entry.dq, 1);
+
+        int ranks = ctrl->channel->children.size();
+        open_banks.assign(ranks, 0);
+        last_change.assign(ranks, 0);
+
+        string chan = "_channel_" + to_string(ctrl->channel->id);
+        string rank_desc = " per channel per rank";
+
+        energy_total
+            .name("dram_energy" + chan)
+            .desc("Total DRAM energy (pJ) per channel")
+            .precision(0)
+            ;
+        power_avg
+            .name("dram_power_avg" + chan)
+            .desc("Average DRAM power (mW) per channel")
+            .precision(3)
+            ;
+
+        act_cmds.init(ranks).name("dram_act_cmds" + chan + "_rank")
+            .desc("Number of ACT commands" + rank_desc).precision(0);
+        pre_cmds.init(ranks).name("dram_pre_cmds" + chan + "_rank")
+            .desc("Number of banks precharged" + rank_desc).precision(0);
+        rd_cmds.init(ranks).name("dram_rd_cmds" + chan + "_rank")
+            .desc("Number of RD/RDA commands" + rank_desc).precision(0);
+        wr_cmds.init(ranks).name("dram_wr_cmds" + chan + "_rank")
+            .desc("Number of WR/WRA commands" + rank_desc).precision(0);
+        ref_cmds.init(ranks).name("dram_ref_cmds" + chan + "_rank")
+            .desc("Number of refresh commands" + rank_desc).precision(0);
+        act_standby_cycles.init(ranks).name("dram_act_standby_cycles" + chan + "_rank")
+            .desc("Cycles with at least one bank open" + rank_desc).precision(0);
+        pre_standby_cycles.init(ranks).name("dram_pre_standby_cycles" + chan + "_rank")
+            .desc("Cycles with all banks closed" + rank_desc).precision(0);
+
+        act_energy.init(ranks).name("dram_act_energy" + chan + "_rank")
+            .desc("Activation energy (pJ)" + rank_desc).precision(0);
+        pre_energy.init(ranks).name("dram_pre_energy" + chan + "_rank")
+            .desc("Precharge energy (pJ)" + rank_desc).precision(0);
+        rd_energy.init(ranks).name("dram_rd_energy" + chan + "_rank")
+            .desc("Read burst energy (pJ)" + rank_desc).precision(0);
+        wr_energy.init(ranks).name("dram_wr_energy" + chan + "_rank")
+            .desc("Write burst energy (pJ)" + rank_desc).precision(0);
+        ref_energy.init(ranks).name("dram_ref_energy" + chan + "_rank")
+            .desc("Refresh energy (pJ)" + rank_desc).precision(0);
+        act_standby_energy.init(ranks).name("dram_act_standby_energy" + chan + "_rank")
+            .desc("Active standby energy (pJ)" + rank_desc).precision(0);
+        pre_standby_energy.init(ranks).name("dram_pre_standby_energy" + chan + "_rank")
+            .desc("Precharge standby energy (pJ)" + rank_desc).precision(0);
+        rank_energy.init(ranks).name("dram_energy" + chan + "_rank")
+            .desc("Total DRAM energy (pJ)" + rank_desc).precision(0);
+    }
+
+    // Called after the row table has been updated for an issued command.
+    // closed_banks is the number of open rows the command closed.
+    void update(typename T::Command cmd, const vector<int>& addr_vec, int closed_banks, long clk)
+    {
+        if (!enabled)
+            return;
+        T* spec = ctrl->channel->spec;
+        int rank = addr_vec[int(T::Level::Rank)];
+
+        if (spec->is_opening(cmd))
+            act_cmds[rank]++;
+        if (spec->is_reading(cmd))
+            rd_cmds[rank]++;
+        if (spec->is_writing(cmd))
+            wr_cmds[rank]++;
+        if (spec->is_refreshing(cmd))
+            ref_cmds[rank]++;
+        pre_cmds[rank] += closed_banks;
+
+        if (spec->is_opening(cmd) || closed_banks)
+            set_open_banks(rank, count_open_banks(rank), clk);
+    }
+
+    void finish(long clk)
+    {
+        if (!enabled)
+            return;
+        double total = 0;
+        for (unsigned int rank = 0; rank < open_banks.size(); rank++) {
+            set_open_banks(rank, open_banks[rank], clk);
+
+            double scale = vdd * tCK * devices;
+            act_energy[rank] = act_cmds[rank].value() * (idd0 - idd3n) * nRAS * scale;
+            pre_energy[rank] = pre_cmds[rank].value() * (idd0 - idd2n) * nRP * scale;
+            rd_energy[rank] = rd_cmds[rank].value() * (idd4r - idd3n) * nBL * scale;
+            wr_energy[rank] = wr_cmds[rank].value() * (idd4w - idd3n) * nBL * scale;
+            ref_energy[rank] = ref_cmds[rank].value() * (idd5b - idd3n) * nRFC * scale;
+            act_standby_energy[rank] = act_standby_cycles[rank].value() * idd3n * scale;
+            pre_standby_energy[rank] = pre_standby_cycles[rank].value() * idd2n * scale;
+            rank_energy[rank] = act_energy[rank].value() + pre_energy[rank].value() +
+                                rd_energy[rank].value() + wr_energy[rank].value() +
+                                ref_energy[rank].value() +
+                                act_standby_energy[rank].value() +
+                                pre_standby_energy[rank].value();
+            total += rank_energy[rank].value();
+        }
+        energy_total = total;
+        power_avg = clk ? total / (clk * tCK) : 0;
+    }
+
+private:
+    // Largest constraint between two commands at any level, 0 if none
+    int get_timing(typename T::Command from, typename T::Command to)
+    {
+        T* spec = ctrl->channel->spec;
+        int val = 0;
+        for (int lev = 0; lev < int(T::Level::MAX); lev++)
+            for (auto& t : spec->timing[lev][int(from)])
+                if (t.cmd == to && t.dist == 1)
+                    val = max(val, t.val);
+        return val;
+    }
+
+    int count_open_banks(int rank)
+    {
+        int count = 0;
+        for (auto& entry : ctrl->rowtable->table)
+            if (entry.first[int(T::Level::Rank)] == rank)
+                count++;
+        return count;
+    }
+
+    void set_open_banks(int rank, int count, long clk)
+    {
+        long cycles = clk - last_change[rank];
+        if (open_banks[rank])
+            act_standby_cycles[rank] += cycles;
+        else
+            pre_standby_cycles[rank] += cycles;
+        open_banks[rank] = count;
+        last_change[rank] = clk;
+    }
+};
+
+} /*namespace ramulator*/
+
+#endif /*__ENERGY_H*/
@@ -42,6 +42,7 @@
 #include <cassert>
 #include <tuple>
 #include <limits.h>
+#include <limits>
 
 using namespace std;
 
@@ -54,6 +55,8 @@ public:
     virtual ~MemoryBase() {}
     virtual double clk_ns() const = 0;
     virtual void tick() = 0;
+    virtual long idle_ticks() = 0;
+    virtual void skip_ticks(long ticks) = 0;
     virtual bool send(Request req) = 0;
     virtual int pending_requests() = 0;
     virtual void finish(void) = 0;
@@ -109,6 +112,11 @@ protected:
 #endif
 
   long max_address;
+
+  // idle-cycle skipping: cycles elided so far, and how many more may be
+  // elided before some controller has work (absent a new request)
+  long idle_cycles = 0;
+  long idle_budget = 0;
 public:
     enum class Type {
         ChRaBaRoCo,
@@ -324,6 +332,15 @@ public:
 
     void tick()
     {
+        // Cycles on which no controller can do anything are only counted
+        // here and credited in bulk once there is work again.
+        if (idle_budget > 0) {
+            --idle_budget;
+            ++idle_cycles;
+            return;
+        }
+        skip_idle_cycles();
+
         ++num_dram_cycles;
         int cur_que_req_num = 0;
         int cur_que_readreq_num = 0;
@@ -345,6 +362,51 @@ public:
         if (is_active) {
           ramulator_active_cycles++;
         }
+
+        idle_budget = numeric_limits<long>::max();
+        for (auto ctrl : ctrls)
+          idle_budget = min(idle_budget, ctrl->idle_ticks());
+    }
+
+    // Upcoming ticks that tick() would elide, absent a new request
+    long idle_ticks()
+    {
+        return idle_budget;
+    }
+
+    // Elide that many ticks at once, as that many calls to tick() would
+    void skip_ticks(long ticks)
+    {
+        assert(ticks <= idle_budget);
+        idle_budget -= ticks;
+        idle_cycles += ticks;
+    }
+
+    // Credit the cycles elided by tick() as if each had been simulated
+    void skip_idle_cycles()
+    {
+        if (!idle_cycles)
+          return;
+
+        num_dram_cycles += idle_cycles;
+        int cur_que_req_num = 0;
+        int cur_que_readreq_num = 0;
+        int cur_que_writereq_num = 0;
+        bool is_active = false;
+        for (auto ctrl : ctrls) {
+          cur_que_req_num += ctrl->readq.size() + ctrl->writeq.size() + ctrl->pending.size();
+          cur_que_readreq_num += ctrl->readq.size() + ctrl->pending.size();
+          cur_que_writereq_num += ctrl->writeq.size();
+          is_active = is_active || ctrl->is_active();
+          ctrl->skip_idle_ticks(idle_cycles);
+        }
+        in_queue_req_num_sum += idle_cycles * cur_que_req_num;
+        in_queue_read_req_num_sum += idle_cycles * cur_que_readreq_num;
+        in_queue_write_req_num_sum += idle_cycles * cur_que_writereq_num;
+        if (is_active) {
+          ramulator_active_cycles += idle_cycles;
+        }
+        idle_cycles = 0;
     }
 
     bool send(Request req)
@@ -386,7 +448,10 @@ public:
                 assert(false);
         }
 
+        // the controller must see the current clk before it accepts a request
+        skip_idle_cycles();
         if(ctrls[req.addr_vec[0]]->enqueue(req)) {
+            idle_budget = 0;
             // tally stats here to avoid double counting for requests that aren't enqueued
             ++num_incoming_requests;
             if (req.type == Request::Type::READ) {
@@ -422,6 +487,7 @@ public:
     }
 
     void finish(void) {
+      skip_idle_cycles();
       dram_capacity = max_address;
       int *sz = spec->org_entry.count;
       maximum_bandwidth = spec->speed_entry.rate * 1e6 * spec->channel_width * sz[int(T::Level::Channel)] / 8;
@@ -271,6 +271,12 @@ void Refresh<DSARP>::tick_ref() {
   if ((clk - refreshed) >= refresh_interval)
     inject_refresh(b_ref_rank);
 }
+
+// DSARP may pull refreshes in on any cycle, so no cycle is provably idle
+template<>
+long Refresh<DSARP>::idle_ticks() const {
+  return 0;
+}
 /**** End DSARP specialization ****/
 
 } /* namespace ramulator */
@@ -104,6 +104,12 @@ public:
     }
   }
 
+  // Number of upcoming tick_ref() calls that will not inject a refresh
+  long idle_ticks() const {
+    long refresh_interval = ctrl->channel->spec->speed_entry.nREFI;
+    return max(refresh_interval - (clk - refreshed) - 1, 0L);
+  }
+
 private:
   // Keeping track of refresh status of every bank: + means ahead of schedule, - means behind schedule
   vector<vector<int>*> bank_refresh_backlog;
@@ -153,6 +159,7 @@ private:
 // where to look for these definitions when controller calls them!
 template<> Refresh<DSARP>::Refresh(Controller<DSARP>* ctrl);
 template<> void Refresh<DSARP>::tick_ref();
+template<> long Refresh<DSARP>::idle_ticks() const;
 
 } /* namespace ramulator */
 
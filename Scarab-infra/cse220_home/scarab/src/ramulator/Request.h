@@ -52,6 +52,7 @@ public:
     } type;
 
     long arrive = -1;
+    long issue = -1; // first command issued on behalf of the request
     long depart = -1;
     function<void(Request&)> callback; // call back with more info
 
@@ -60,9 +60,15 @@ ScarabWrapper::ScarabWrapper(const Config&      configs,
   const string& std_name = configs["standard"];
   assert(name_to_func.find(std_name) != name_to_func.end() &&
          "unrecognized standard name");
+  // a second memory (e.g. a DRAM cache) writes its stats to its own file
+  stats_begin = Stats::statlist.size();
   mem = name_to_func[std_name](configs, cacheline, stats_callback);
+  stats_end = Stats::statlist.size();
   // tCK = mem->clk_ns();
-  Stats::statlist.output(configs["output_dir"] + "/ramulator.stat.out");
+  string stat_file = configs.contains("stat_file") ? configs["stat_file"] :
+                                                     "ramulator.stat.out";
+  stat_output.open(configs["output_dir"] + "/" + stat_file);
+  assert(stat_output.good() && "cannot open the Ramulator stat file");
 }
 
 
@@ -74,13 +80,21 @@ void ScarabWrapper::tick() {
   mem->tick();
 }
 
+long ScarabWrapper::idle_ticks() {
+  return mem->idle_ticks();
+}
+
+void ScarabWrapper::skip_ticks(long ticks) {
+  mem->skip_ticks(ticks);
+}
+
 bool ScarabWrapper::send(Request req) {
   return mem->send(req);
 }
 
 void ScarabWrapper::finish(void) {
   mem->finish();
-  Stats::statlist.printall();
+  Stats::statlist.printall(stat_output, stats_begin, stats_end);
 }
 
 int ScarabWrapper::get_chip_width() const {
@@ -22,6 +22,7 @@
 #ifndef __SCARAB_WRAPPER_H
 #define __SCARAB_WRAPPER_H
 
+#include <fstream>
 #include <string>
 
 #include "Config.h"
@@ -38,11 +39,15 @@ class ScarabWrapper
 {
 private:
     MemoryBase *mem;
+    ofstream stat_output;
+    size_t stats_begin, stats_end;  // this memory's entries in the stat list
 public:
     //double tCK;
     ScarabWrapper(const Config& configs, const unsigned int cacheline, void (* stats_callback)(int, int));
     ~ScarabWrapper();
     void tick();
+    long idle_ticks();
+    void skip_ticks(long ticks);
     bool send(Request req);
     void finish(void);
 
@@ -29,6 +29,8 @@
 #include <map>
 #include <list>
 #include <functional>
+#include <algorithm>
+#include <numeric>
 #include <cassert>
 
 using namespace std;
@@ -46,14 +48,71 @@ public:
     Controller<T>* ctrl;
 
     enum class Policy {
-        FCFS, FRFCFS, FRFCFS_Cap, FRFCFS_PriorHit, MAX
+        FCFS, FRFCFS, FRFCFS_Cap, FRFCFS_PriorHit, ATLAS, TCM, BLISS, MAX
     } policy = Policy::FRFCFS_Cap;
 
     long cap = 16;
 
+    /* Core-aware policies. Cores are re-ranked at the end of every quantum
+       from the service each one received during it:
+       - ATLAS (Kim et al., HPCA 2010): least attained service first, with
+         exponential decay across quanta; requests older than
+         atlas_starvation cycles go first.
+       - TCM (Kim et al., MICRO 2010): cores using at most tcm_cluster_thresh
+         of the bandwidth form the latency cluster, ranked above the rest by
+         lowest usage; the bandwidth cluster's ranking is rotated every
+         tcm_shuffle cycles.
+       - BLISS (Subramanian et al., ICCD 2014): a core served more than
+         bliss_threshold requests in a row is blacklisted until the
+         blacklist is cleared every bliss_clear cycles.
+       Within a priority level they all fall back to FR-FCFS. */
+    int num_cores = 1;
+    long quantum = 100000;
+    long quantum_end = 0;
+    vector<long> quantum_service;  // service cycles received this quantum
+    vector<double> attained_service;  // ATLAS
+    vector<int> core_rank;  // higher is more important
+
+    double atlas_alpha = 0.875;
+    long atlas_starvation = 100000;
+
+    double tcm_cluster_thresh = 0.1;
+    long tcm_shuffle = 800;
+    long tcm_next_shuffle = 0;
+    vector<int> tcm_bw_cluster;  // bandwidth cluster cores, in rank order
+    int tcm_rotation = 0;
+
+    int bliss_threshold = 4;
+    long bliss_clear = 10000;
+    long bliss_next_clear = 0;
+    int bliss_last_core = -1;
+    int bliss_streak = 0;
+    vector<bool> blacklisted;
+
     Scheduler(Controller<T>* ctrl, const Config& configs) : ctrl(ctrl){ 
         string policy_str = configs["scheduling_policy"];
 
+        num_cores = max(configs.get_core_num(), 1);
+        quantum_service.assign(num_cores, 0);
+        attained_service.assign(num_cores, 0);
+        core_rank.assign(num_cores, 0);
+        blacklisted.assign(num_cores, false);
+        if (configs.contains("qos_quantum"))
+            quantum = configs.get_int("qos_quantum");
+        if (configs.contains("atlas_starvation"))
+            atlas_starvation = configs.get_int("atlas_starvation");
+        if (configs.contains("tcm_cluster_thresh"))
+            tcm_cluster_thresh = stod(configs["tcm_cluster_thresh"]);
+        if (configs.contains("tcm_shuffle"))
+            tcm_shuffle = configs.get_int("tcm_shuffle");
+        if (configs.contains("bliss_threshold"))
+            bliss_threshold = configs.get_int("bliss_threshold");
+        if (configs.contains("bliss_clear"))
+            bliss_clear = configs.get_int("bliss_clear");
+        quantum_end = quantum;
+        tcm_next_shuffle = tcm_shuffle;
+        bliss_next_clear = bliss_clear;
+
         if(policy_str == "FCFS")
             policy = Policy::FCFS;
         else if (policy_str == "FRFCFS")
@@ -62,14 +121,46 @@ public:
             policy = Policy::FRFCFS_Cap;
         else if (policy_str == "FRFCFS_PriorHit")
             policy = Policy::FRFCFS_PriorHit;
+        else if (policy_str == "ATLAS")
+            policy = Policy::ATLAS;
+        else if (policy_str == "TCM")
+            policy = Policy::TCM;
+        else if (policy_str == "BLISS")
+            policy = Policy::BLISS;
         else
             assert(false && "Unknown memory request scheduler. Please make \
 sure to set RAMULATOR_SCHEDULING_POLICY to one of the \
 available policies: FCFS, FRFCFS, FRFCFS_Cap, \
-FRFCFS_PriorHit"); }
+FRFCFS_PriorHit, ATLAS, TCM, BLISS"); }
+
+    bool is_core_aware() const
+    {
+        return policy == Policy::ATLAS || policy == Policy::TCM || policy == Policy::BLISS;
+    }
+
+    // A request issued its column command, which finishes it from the
+    // scheduler's point of view
+    void served(const Request& req)
+    {
+        if (!is_core_aware())
+            return;
+        int core = core_of(req);
+        quantum_service[core] += ctrl->clk - req.issue + 1;
+
+        if (core == bliss_last_core) {
+            if (++bliss_streak > bliss_threshold)
+                blacklisted[core] = true;
+        } else {
+            bliss_last_core = core;
+            bliss_streak = 1;
+        }
+    }
 
     list<Request>::iterator get_head(list<Request>& q)
     {
+      if (is_core_aware())
+        update_ranks();
+
       // TODO make the decision at compile time
       if (policy != Policy::FRFCFS_PriorHit) {
         if (!q.size())
@@ -141,6 +232,90 @@ FRFCFS_PriorHit"); }
 
 private:
     typedef list<Request>::iterator ReqIter;
+
+    int core_of(const Request& req) const
+    {
+        return (req.coreid >= 0 && req.coreid < num_cores) ? req.coreid : 0;
+    }
+
+    // Quantum and interval boundaries are checked lazily, so cycles the
+    // controller skips while idle are accounted for on the next call
+    void update_ranks()
+    {
+        long clk = ctrl->clk;
+        if (clk >= quantum_end) {
+            if (policy == Policy::ATLAS)
+                rank_atlas();
+            else if (policy == Policy::TCM)
+                rank_tcm();
+            fill(quantum_service.begin(), quantum_service.end(), 0);
+            quantum_end = clk - (clk - quantum_end) % quantum + quantum;
+        }
+        if (policy == Policy::TCM && clk >= tcm_next_shuffle) {
+            int n = tcm_bw_cluster.size();
+            if (n > 1) {
+                tcm_rotation = (tcm_rotation + 1) % n;
+                for (int i = 0; i < n; i++)
+                    core_rank[tcm_bw_cluster[i]] = (i + tcm_rotation) % n;
+            }
+            tcm_next_shuffle = clk - (clk - tcm_next_shuffle) % tcm_shuffle + tcm_shuffle;
+        }
+        if (policy == Policy::BLISS && clk >= bliss_next_clear) {
+            fill(blacklisted.begin(), blacklisted.end(), false);
+            bliss_next_clear = clk - (clk - bliss_next_clear) % bliss_clear + bliss_clear;
+        }
+    }
+
+    void rank_atlas()
+    {
+        for (int c = 0; c < num_cores; c++)
+            attained_service[c] = atlas_alpha * attained_service[c] +
+                                  (1 - atlas_alpha) * quantum_service[c];
+        vector<int> order(num_cores);
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [this] (int a, int b) {
+            return attained_service[a] > attained_service[b];});
+        for (int i = 0; i < num_cores; i++)
+            core_rank[order[i]] = i;
+    }
+
+    void rank_tcm()
+    {
+        vector<int> order(num_cores);
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [this] (int a, int b) {
+            return quantum_service[a] < quantum_service[b];});
+        long total = accumulate(quantum_service.begin(), quantum_service.end(), 0L);
+
+        // least intensive cores join the latency cluster until it would
+        // exceed its share of the bandwidth
+        long used = 0;
+        int n_lat = 0;
+        while (n_lat < num_cores && used + quantum_service[order[n_lat]] <= tcm_cluster_thresh * total)
+            used += quantum_service[order[n_lat++]];
+
+        tcm_bw_cluster.assign(order.begin() + n_lat, order.end());
+        int n_bw = tcm_bw_cluster.size();
+        for (int i = 0; i < n_lat; i++)
+            core_rank[order[i]] = num_cores - 1 - i;
+        for (int i = 0; i < n_bw; i++)
+            core_rank[tcm_bw_cluster[i]] = (i + tcm_rotation) % n_bw;
+    }
+
+    ReqIter compare_frfcfs(ReqIter req1, ReqIter req2)
+    {
+        bool ready1 = this->ctrl->is_ready(req1);
+        bool ready2 = this->ctrl->is_ready(req2);
+
+        if (ready1 ^ ready2) {
+            if (ready1) return req1;
+            return req2;
+        }
+
+        if (req1->arrive <= req2->arrive) return req1;
+        return req2;
+    }
+
     function<ReqIter(ReqIter, ReqIter)> compare[int(Policy::MAX)] = {
         // FCFS
         [this] (ReqIter req1, ReqIter req2) {
@@ -186,7 +361,47 @@ private:
             }
 
             if (req1->arrive <= req2->arrive) return req1;
-            return req2;}
+            return req2;},
+
+        // ATLAS
+        [this] (ReqIter req1, ReqIter req2) {
+            bool starved1 = this->ctrl->clk - req1->arrive > this->atlas_starvation;
+            bool starved2 = this->ctrl->clk - req2->arrive > this->atlas_starvation;
+            if (starved1 ^ starved2) {
+                if (starved1) return req1;
+                return req2;
+            }
+
+            int rank1 = this->core_rank[this->core_of(*req1)];
+            int rank2 = this->core_rank[this->core_of(*req2)];
+            if (rank1 != rank2) {
+                if (rank1 > rank2) return req1;
+                return req2;
+            }
+
+            return this->compare_frfcfs(req1, req2);},
+
+        // TCM
+        [this] (ReqIter req1, ReqIter req2) {
+            int rank1 = this->core_rank[this->core_of(*req1)];
+            int rank2 = this->core_rank[this->core_of(*req2)];
+            if (rank1 != rank2) {
+                if (rank1 > rank2) return req1;
+                return req2;
+            }
+
+            return this->compare_frfcfs(req1, req2);},
+
+        // BLISS
+        [this] (ReqIter req1, ReqIter req2) {
+            bool black1 = this->blacklisted[this->core_of(*req1)];
+            bool black2 = this->blacklisted[this->core_of(*req2)];
+            if (black1 ^ black2) {
+                if (black2) return req1;
+                return req2;
+            }
+
+            return this->compare_frfcfs(req1, req2);}
     };
 };
 
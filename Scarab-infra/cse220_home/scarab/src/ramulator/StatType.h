@@ -119,7 +119,12 @@ class StatList {
     }
   }
   void printall() {
-    for(off_type i = 0 ; i < list.size() ; ++i) {
+    printall(stat_output, 0, list.size());
+  }
+  // Print the stats registered in [begin, end), e.g. those of one of
+  // several memories
+  void printall(std::ofstream& out, size_t begin, size_t end) {
+    for(off_type i = begin ; i < end ; ++i) {
       if (!list[i]) {
         continue;
       }
@@ -128,10 +133,13 @@ class StatList {
       }
       if (list[i]->is_display()) {
         list[i]->prepare();
-        list[i]->print(stat_output);
+        list[i]->print(out);
       }
     }
   }
+  size_t size() const {
+    return list.size();
+  }
   ~StatList() {
     stat_output.close();
   }
@@ -50,6 +50,7 @@
 #include "debug/memview.h"
 #include "debug/pipeview.h"
 #include "dumb_model.h"
+#include "interval_model.h"
 #include "frontend/pin_trace_fe.h"
 #include "model.h"
 #include "optimizer2.h"
@@ -75,7 +75,7 @@ void recover_thread(Thread_Data* td, Addr new_pc, Counter op_num,
                     uns64 inst_uid, Flag remain_wrongpath) {
   rename_table_recover(op_num);
   recover_seq_op_list(td, op_num);
-  recover_map();
+  recover_map(op_num);
   ASSERT(td->proc_id, !remain_wrongpath);
 }
 
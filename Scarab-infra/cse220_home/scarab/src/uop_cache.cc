@@ -424,14 +424,16 @@ void accumulate_op(Op* op) {
   ASSERT(uop_cache_proc_id, current_accumulating_ft->static_info.start == op->ft_info.static_info.start &&
                             current_accumulating_ft->static_info.length == op->ft_info.static_info.length);
 
+  // a fused pair takes one uop slot of the line; its second op ends the slot
+  Op* last_op = op->fused_op ? op->fused_op : op;
   current_accumulating_line->n_uops++;
-  *current_accumulating_op_num = op->op_num;
+  *current_accumulating_op_num = last_op->op_num;
 
   // uop cache line end detection
   Addr addr_following_ft = current_accumulating_ft->static_info.start + current_accumulating_ft->static_info.length;
-  Addr addr_following_inst = op->inst_info->addr + op->inst_info->trace_info.inst_size;
+  Addr addr_following_inst = last_op->inst_info->addr + last_op->inst_info->trace_info.inst_size;
   // condition 1: if the FT ends
-  bool end_condition_1 = op->eom && addr_following_inst == addr_following_ft;
+  bool end_condition_1 = last_op->eom && addr_following_inst == addr_following_ft;
   // condition 2: if the uop cache line reaches the uop num limit
   bool end_condition_2 = current_accumulating_line->n_uops == ISSUE_WIDTH;
   if (end_condition_1 || end_condition_2) {
@@ -441,14 +443,14 @@ void accumulate_op(Op* op) {
       // otherwise, calculate offset pointing to the next uop cache line
       ASSERT(uop_cache_proc_id, current_accumulating_line->line_start);
       Addr next_line_start;
-      if (op->eom) {
-        next_line_start = op->inst_info->addr + op->inst_info->trace_info.inst_size;
+      if (last_op->eom) {
+        next_line_start = last_op->inst_info->addr + last_op->inst_info->trace_info.inst_size;
       } else {
-        next_line_start = op->inst_info->addr;
+        next_line_start = last_op->inst_info->addr;
       }
 
       // if next_line_start != npc, the decoupled fe did not end the FT correctly (mispredict or btb miss), or op is off-path
-      ASSERT(uop_cache_proc_id, next_line_start == op->oracle_info.npc || op->oracle_info.recover_at_decode || op->oracle_info.recover_at_exec || op->off_path);
+      ASSERT(uop_cache_proc_id, next_line_start == last_op->oracle_info.npc || last_op->oracle_info.recover_at_decode || last_op->oracle_info.recover_at_exec || last_op->off_path);
       current_accumulating_line->offset = next_line_start - current_accumulating_line->line_start;
     }
 
@@ -128,7 +128,7 @@ void recover_uop_queue_stage(void) {
     for (uns op_idx = 0; op_idx < STAGE_MAX_OP_COUNT; op_idx++) {
       Op* op = sd->ops[op_idx];
       if (op && FLUSH_OP(op)) {
-        ASSERT(op->proc_id, op->off_path);
+        ASSERT(op->proc_id, op->off_path || bp_recovery_info->load_recovery);
         free_op(op);
         sd->ops[op_idx] = NULL;
       } else if (op) {